@@ -0,0 +1,42 @@
+open! Basis.Rudiments
+open! Basis
+
+(* Spawn 100k actors on the main executor, paired off, of which an increasing number of pairs play
+   ping-pong while the rest wait idle, and measure message throughput, including actor spawn and
+   teardown. Load statistics are dumped to stderr meanwhile. *)
+external sched_pp: File.t -> unit = "hemlock_basis_executor_sched_pp"
+
+let n = 100_000L
+
+let n_messages = 10_000_000L
+
+let bench_one active =
+  let rounds = n_messages / (2L * active) in
+  let t0 = Unix.gettimeofday () in
+  let n_sent = Executor.Actor.pingpong ~n ~active ~rounds in
+  let t1 = Unix.gettimeofday () in
+  let elapsed = Real.(t1 - t0) in
+  File.Fmt.stdout
+  |> Fmt.fmt "actors="
+  |> Uns.fmt n
+  |> Fmt.fmt " active_pairs="
+  |> Uns.fmt active
+  |> Fmt.fmt ": "
+  |> Uns.fmt n_sent
+  |> Fmt.fmt " msgs in "
+  |> Real.fmt ~pmode:Fmt.Fixed ~precision:3L elapsed
+  |> Fmt.fmt " s ("
+  |> Real.fmt ~pmode:Fmt.Fixed ~precision:0L Real.(of_sint (Uns.bits_to_sint n_sent) / elapsed)
+  |> Fmt.fmt " msgs/s)\n"
+  |> Fmt.flush
+  |> ignore
+
+let bench () =
+  Executor.Stats.dump_start ~interval_ms:250L (File.fd File.stderr);
+  List.iter [1L; 10L; 100L; 1_000L; 10_000L; 50_000L] ~f:(fun active ->
+    bench_one active
+  );
+  Executor.Stats.dump_stop ();
+  sched_pp File.stdout
+
+let _ = bench ()
@@ -0,0 +1,56 @@
+open! Basis.Rudiments
+open! Basis
+
+(* Sum a large array via recursive Executor.fork2 with 0..N pool executors, where N is one less than
+   the number of CPUs, and compare against sequential Array.reduce. OCaml code is serialized by the
+   runtime lock, so this measures fork/join and stealing overhead rather than parallel speedup. *)
+external wsdeque_pp: File.t -> unit = "hemlock_basis_executor_wsdeque_pp"
+
+let n = 16_000_000L
+
+(* Leaf size below which reduction is sequential. *)
+let grain = 4096L
+
+let rec reduce base past arr =
+  match past - base <= grain with
+  | true -> Range.Uns.fold (base =:< past) ~init:0L ~f:(fun accum i -> accum + Array.get i arr)
+  | false -> begin
+      let mid = base + (past - base) / 2L in
+      let lo, hi = Executor.fork2 (fun () -> reduce base mid arr) (fun () -> reduce mid past arr) in
+      lo + hi
+    end
+
+let report label elapsed baseline =
+  File.Fmt.stdout
+  |> label
+  |> Fmt.fmt ": "
+  |> Real.fmt ~pmode:Fmt.Fixed ~precision:3L elapsed
+  |> Fmt.fmt " s ("
+  |> Real.fmt ~pmode:Fmt.Fixed ~precision:2L Real.(baseline / elapsed)
+  |> Fmt.fmt "x)\n"
+  |> Fmt.flush
+  |> ignore
+
+let bench () =
+  let arr = Array.init (0L =:< n) ~f:(fun i -> i) in
+  let expected = n * (n - 1L) / 2L in
+  let t0 = Unix.gettimeofday () in
+  let sum = Array.reduce_hlt ~f:( + ) arr in
+  let t1 = Unix.gettimeofday () in
+  assert (sum = expected);
+  let baseline = Real.(t1 - t0) in
+  report (Fmt.fmt "Array.reduce") baseline baseline;
+  let n_pool_max = Executor.ncpus () - 1L in
+  Range.Uns.iter (0L =:< (n_pool_max + 1L)) ~f:(fun n_pool ->
+    if n_pool > 0L then Executor.Pool.start_hlt ~n:n_pool ();
+    let t0 = Unix.gettimeofday () in
+    let sum = reduce 0L n arr in
+    let t1 = Unix.gettimeofday () in
+    assert (sum = expected);
+    Executor.Pool.stop ();
+    report (fun formatter -> formatter |> Fmt.fmt "fork2 pool=" |> Uns.fmt n_pool) Real.(t1 - t0)
+      baseline
+  );
+  wsdeque_pp File.stdout
+
+let _ = bench ()
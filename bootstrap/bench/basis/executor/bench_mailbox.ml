@@ -0,0 +1,51 @@
+open! Basis.Rudiments
+open! Basis
+
+(* Flood the main executor's mailbox from 1..N pool executors at once, where N is one less than the
+   number of CPUs (but at least 1), and measure throughput as received by the main executor and p99
+   send-to-receipt latency. Each producer waits for all of its messages to be returned before it
+   finishes, so the measurement includes the full send/ack/reclaim protocol. *)
+external mailbox_pp: File.t -> unit = "hemlock_basis_executor_mailbox_pp"
+
+let n = 1_000_000L
+
+let bench_one n_producers =
+  let n_per_producer = n / n_producers in
+  let n_total = n_per_producer * n_producers in
+  Executor.Pool.start_hlt ~n:n_producers ();
+  let t0 = Unix.gettimeofday () in
+  Range.Uns.iter (1L =:< (n_producers + 1L)) ~f:(fun i ->
+    Executor.Pool.run i (fun () ->
+      Executor.Mailbox.send ~n:n_per_producer 0L i;
+      Executor.Mailbox.drain ()
+    )
+  );
+  let _payloads, latencies = Executor.Mailbox.receive n_total in
+  let t1 = Unix.gettimeofday () in
+  Executor.Pool.stop ();
+  let elapsed = Real.(t1 - t0) in
+  let latencies = Array.sort ~cmp:Uns.cmp latencies in
+  let p99 = Array.get (n_total * 99L / 100L) latencies in
+  File.Fmt.stdout
+  |> Fmt.fmt "producers="
+  |> Uns.fmt n_producers
+  |> Fmt.fmt ": "
+  |> Uns.fmt n_total
+  |> Fmt.fmt " msgs in "
+  |> Real.fmt ~pmode:Fmt.Fixed ~precision:3L elapsed
+  |> Fmt.fmt " s ("
+  |> Real.fmt ~pmode:Fmt.Fixed ~precision:0L Real.(of_sint (Uns.bits_to_sint n_total) / elapsed)
+  |> Fmt.fmt " msgs/s, p99 "
+  |> Uns.fmt p99
+  |> Fmt.fmt " ns)\n"
+  |> Fmt.flush
+  |> ignore
+
+let bench () =
+  let n_producers_max = Uns.max 1L (Executor.ncpus () - 1L) in
+  Range.Uns.iter (1L =:< (n_producers_max + 1L)) ~f:(fun n_producers ->
+    bench_one n_producers
+  );
+  mailbox_pp File.stdout
+
+let _ = bench ()
@@ -0,0 +1,42 @@
+open! Basis.Rudiments
+open! Basis
+
+(* Spawn CPU-bound actors on the main executor and measure how long they take to finish as they
+   migrate to the pool executors. Load statistics are dumped to stderr meanwhile. *)
+
+let n = 64L
+
+let units = 100_000L
+
+let bench () =
+  Executor.Pool.start_hlt ();
+  Executor.Stats.dump_start ~interval_ms:100L (File.fd File.stderr);
+  let t0 = Unix.gettimeofday () in
+  let _ : uns = Executor.Actor.spin ~n ~units in
+  let t1 = Unix.gettimeofday () in
+  Executor.Stats.dump_stop ();
+  File.Fmt.stdout
+  |> Fmt.fmt "actors="
+  |> Uns.fmt n
+  |> Fmt.fmt " units="
+  |> Uns.fmt units
+  |> Fmt.fmt ": "
+  |> Real.fmt ~pmode:Fmt.Fixed ~precision:3L Real.(t1 - t0)
+  |> Fmt.fmt " s\n"
+  |> ignore;
+  Range.Uns.iter (Range.Uns.( =:< ) 0L (Executor.length ())) ~f:(fun i ->
+    let stats = Executor.Stats.get i in
+    File.Fmt.stdout
+    |> Fmt.fmt "executor "
+    |> Uns.fmt i
+    |> Fmt.fmt ": migrations="
+    |> Uns.fmt stats.migrations
+    |> Fmt.fmt " rejections="
+    |> Uns.fmt stats.rejections
+    |> Fmt.fmt "\n"
+    |> ignore
+  );
+  File.Fmt.stdout |> Fmt.flush |> ignore;
+  Executor.Pool.stop ()
+
+let _ = bench ()
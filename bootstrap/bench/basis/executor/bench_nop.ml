@@ -0,0 +1,42 @@
+open! Basis.Rudiments
+open! Basis
+
+external nop_submit: unit -> (sint * uns) = "hemlock_basis_executor_nop_submit_inner"
+external complete: uns -> sint = "hemlock_basis_executor_complete_inner"
+external user_data_decref: uns -> unit = "hemlock_basis_executor_user_data_decref"
+external user_data_slab_pp: File.t -> unit = "hemlock_basis_executor_user_data_slab_pp"
+
+(* Submit nops in batches that fill the submission queue, then complete the batch. This exercises
+   user_data allocation/deallocation at the same rate as I/O submission. *)
+let n = 4_000_000L
+let batch = 32L
+
+let bench () =
+  let user_datas = Stdlib.Array.make (Uns.trunc_to_int batch) 0L in
+  let t0 = Unix.gettimeofday () in
+  Range.Uns.iter (0L =:< (n / batch)) ~f:(fun _ ->
+    Range.Uns.iter (0L =:< batch) ~f:(fun i ->
+      let _, user_data = nop_submit () in
+      Stdlib.Array.set user_datas (Uns.trunc_to_int i) user_data
+    );
+    Range.Uns.iter (0L =:< batch) ~f:(fun i ->
+      let user_data = Stdlib.Array.get user_datas (Uns.trunc_to_int i) in
+      let _ = complete user_data in
+      user_data_decref user_data
+    )
+  );
+  let t1 = Unix.gettimeofday () in
+  let elapsed = Real.(t1 - t0) in
+  File.Fmt.stdout
+  |> Fmt.fmt "nop: "
+  |> Uns.fmt n
+  |> Fmt.fmt " ops in "
+  |> Real.fmt ~pmode:Fmt.Fixed ~precision:3L elapsed
+  |> Fmt.fmt " s ("
+  |> Real.fmt ~pmode:Fmt.Fixed ~precision:0L Real.(of_sint (Uns.bits_to_sint n) / elapsed)
+  |> Fmt.fmt " ops/s)\n"
+  |> Fmt.flush
+  |> ignore;
+  user_data_slab_pp File.stdout
+
+let _ = bench ()
@@ -0,0 +1,59 @@
+open! Basis.Rudiments
+open! Basis
+
+(* For each CPU placement policy, start a pool of one less than the number of CPUs (but at least 1)
+   executors, and measure mailbox throughput and p99 send-to-receipt latency with every pool
+   executor flooding the main executor's mailbox, then the time taken by CPU-bound actors that
+   migrate across the pool. Cross-node placement shows up as lower throughput and higher latency. *)
+external topology_pp: File.t -> unit = "hemlock_basis_executor_topology_pp"
+
+let n_messages = 1_000_000L
+
+let n_actors = 64L
+
+let units = 10_000L
+
+let bench_one placement =
+  let n_producers = Uns.max 1L (Executor.ncpus () - 1L) in
+  let n_per_producer = n_messages / n_producers in
+  let n_total = n_per_producer * n_producers in
+  Executor.Pool.start_hlt ~placement ~n:n_producers ();
+  let t0 = Unix.gettimeofday () in
+  Range.Uns.iter (1L =:< (n_producers + 1L)) ~f:(fun i ->
+    Executor.Pool.run i (fun () ->
+      Executor.Mailbox.send ~n:n_per_producer 0L i;
+      Executor.Mailbox.drain ()
+    )
+  );
+  let _payloads, latencies = Executor.Mailbox.receive n_total in
+  let t1 = Unix.gettimeofday () in
+  let _ : uns = Executor.Actor.spin ~n:n_actors ~units in
+  let t2 = Unix.gettimeofday () in
+  topology_pp File.stdout;
+  Executor.Pool.stop ();
+  let elapsed = Real.(t1 - t0) in
+  let latencies = Array.sort ~cmp:Uns.cmp latencies in
+  let p99 = Array.get (n_total * 99L / 100L) latencies in
+  File.Fmt.stdout
+  |> Fmt.fmt "placement="
+  |> Executor.Placement.pp placement
+  |> Fmt.fmt ": "
+  |> Uns.fmt n_total
+  |> Fmt.fmt " msgs in "
+  |> Real.fmt ~pmode:Fmt.Fixed ~precision:3L elapsed
+  |> Fmt.fmt " s ("
+  |> Real.fmt ~pmode:Fmt.Fixed ~precision:0L Real.(of_sint (Uns.bits_to_sint n_total) / elapsed)
+  |> Fmt.fmt " msgs/s, p99 "
+  |> Uns.fmt p99
+  |> Fmt.fmt " ns), spin "
+  |> Real.fmt ~pmode:Fmt.Fixed ~precision:3L Real.(t2 - t1)
+  |> Fmt.fmt " s\n"
+  |> Fmt.flush
+  |> ignore
+
+let bench () =
+  List.iter Executor.Placement.[Depth_first; Breadth_first; Random] ~f:(fun placement ->
+    bench_one placement
+  )
+
+let _ = bench ()
@@ -0,0 +1,40 @@
+open! Basis.Rudiments
+open! Basis
+
+(* Copy a (preferably multi-GB) file given as the first argument to the path given as the second
+   argument, comparing kernel-side copies with the read/write loop. [File.copy] uses
+   copy_file_range(2), which on reflink-capable filesystems (e.g. btrfs, XFS) shares extents rather
+   than copying data, so place both paths on a filesystem without reflinks, e.g. ext4, to measure
+   data movement. Results are dominated by the page cache unless caches are dropped between runs,
+   e.g. via `echo 3 > /proc/sys/vm/drop_caches`. *)
+
+let bench_one name src_path dst_path copy =
+  let src = File.of_path_hlt src_path in
+  let dst = File.of_path_hlt ~flag:File.Flag.W dst_path in
+  let t0 = Unix.gettimeofday () in
+  let n = copy src dst in
+  let t1 = Unix.gettimeofday () in
+  let elapsed = Real.(t1 - t0) in
+  File.close_hlt src;
+  File.close_hlt dst;
+  File.Fmt.stdout
+  |> Fmt.fmt name
+  |> Fmt.fmt ": "
+  |> Uns.fmt n
+  |> Fmt.fmt " bytes in "
+  |> Real.fmt ~pmode:Fmt.Fixed ~precision:3L elapsed
+  |> Fmt.fmt " s ("
+  |> Real.fmt ~pmode:Fmt.Fixed ~precision:1L
+    Real.(of_sint (Uns.bits_to_sint n) / elapsed / 1_048_576.)
+  |> Fmt.fmt " MiB/s)\n"
+  |> Fmt.flush
+  |> ignore
+
+let bench () =
+  let src_path = Path.of_bytes (Bytes.Slice.init (Array.get 1L Os.argv)) in
+  let dst_path = Path.of_bytes (Bytes.Slice.init (Array.get 2L Os.argv)) in
+  bench_one "copy_file_range" src_path dst_path (fun src dst -> File.copy_hlt src dst);
+  bench_one "splice" src_path dst_path (fun src dst -> File.splice_hlt src dst);
+  bench_one "read/write" src_path dst_path (fun src dst -> File.copy_hlt ~kernel:false src dst)
+
+let _ = bench ()
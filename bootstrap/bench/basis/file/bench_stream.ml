@@ -0,0 +1,57 @@
+open! Basis.Rudiments
+open! Basis
+
+(* Stream a (preferably multi-GB) file given as the sole argument, comparing the former
+   one-read-at-a-time stream implementation with read-ahead configurations of
+   [File.Stream.of_file]. Results are dominated by the page cache unless caches are dropped between
+   runs, e.g. via `echo 3 > /proc/sys/vm/drop_caches`. *)
+
+(* The former [File.Stream.of_file]: a blocking 1 KiB read per forced stream element. *)
+let of_file_serial file =
+  Stream.init_indef file ~f:(fun file ->
+    match File.read ~n:1024L file with
+    | Error _ -> None
+    | Ok buffer -> begin
+        match Bytes.Slice.length buffer > 0L with
+        | false -> begin
+            let _ = File.close file in
+            None
+          end
+        | true -> Some (buffer, file)
+      end
+  )
+
+let rec consume n t =
+  match Lazy.force t with
+  | Stream.Nil -> n
+  | Stream.Cons(buffer, t') -> consume (n + Bytes.Slice.length buffer) t'
+
+let bench_one name path of_file =
+  let file = File.of_path_hlt path in
+  let t0 = Unix.gettimeofday () in
+  let n = consume 0L (of_file file) in
+  let t1 = Unix.gettimeofday () in
+  let elapsed = Real.(t1 - t0) in
+  File.Fmt.stdout
+  |> Fmt.fmt name
+  |> Fmt.fmt ": "
+  |> Uns.fmt n
+  |> Fmt.fmt " bytes in "
+  |> Real.fmt ~pmode:Fmt.Fixed ~precision:3L elapsed
+  |> Fmt.fmt " s ("
+  |> Real.fmt ~pmode:Fmt.Fixed ~precision:1L
+    Real.(of_sint (Uns.bits_to_sint n) / elapsed / 1_048_576.)
+  |> Fmt.fmt " MiB/s)\n"
+  |> Fmt.flush
+  |> ignore
+
+let bench () =
+  let path = Path.of_bytes (Bytes.Slice.init (Array.get 1L Os.argv)) in
+  bench_one "serial chunk=1024" path of_file_serial;
+  bench_one "read-ahead chunk=16384 window=1" path (File.Stream.of_file ~chunk:16384L ~window:1L);
+  bench_one "read-ahead chunk=16384 window=4" path (File.Stream.of_file ~chunk:16384L ~window:4L);
+  bench_one "read-ahead chunk=16384 window=16" path
+    (File.Stream.of_file ~chunk:16384L ~window:16L);
+  bench_one "read-ahead chunk=65536 window=8" path (File.Stream.of_file ~chunk:65536L ~window:8L)
+
+let _ = bench ()
@@ -2,6 +2,18 @@ open Basis
 include Basis.Rudiments
 open Hmc
 
+(* Map regular files, and stream others, e.g. pipes. A mapped source that is truncated while being
+   scanned terminates hmc with SIGBUS (see [File.Mmap]). *)
+let text_of_path path =
+  match File.Mmap.of_path path with
+  | Ok bytes -> Ok (Text.of_bytes_slice ~path bytes)
+  | Error Errno.ENODEV -> begin
+      match File.of_path path with
+      | Ok f -> Ok (Text.of_bytes_stream ~path (File.Stream.of_file f))
+      | Error error -> Error error
+    end
+  | Error error -> Error error
+
 let scan_file path =
   let rec fn scanner = begin
     let scanner', tok = Scan.next scanner in
@@ -14,10 +26,8 @@ let scan_file path =
     | Scan.Token.Tok_end_of_input _ -> ()
     | _ -> fn scanner'
   end in
-  let () = match File.of_path path with
-    | Ok f -> begin
-        let stream = File.Stream.of_file f in
-        let text = Text.of_bytes_stream ~path stream in
+  let () = match text_of_path path with
+    | Ok text -> begin
         let scanner = Scan.init text in
         fn scanner
       end
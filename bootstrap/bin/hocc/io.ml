@@ -27,14 +27,21 @@ let path_with_suffix ?(is_report=false) conf suffix =
     ]);
   ]
 
+(* Map regular files, and stream others, e.g. pipes. Mapped inputs must not be truncated while hocc
+   runs (see [File.Mmap]), which hocc itself never does, since it writes only to other paths. *)
 let open_infile_as_text path =
-  match File.of_path path with
-  | Ok f -> begin
-      let stream = File.Stream.of_file f in
-      let text = Text.of_bytes_stream ~path stream in
-      Ok text
+  match File.Mmap.of_path path with
+  | Ok bytes -> Ok (Text.of_bytes_slice ~path bytes)
+  | Error Errno.ENODEV -> begin
+      match File.of_path path with
+      | Ok f -> begin
+          let stream = File.Stream.of_file f in
+          let text = Text.of_bytes_stream ~path stream in
+          Ok text
+        end
+      | Error _ as error -> error
     end
-  | Error _ as error -> error
+  | Error error -> Error error
 
 let init_hmhi conf =
   let path = path_with_suffix conf ".hmhi" in
@@ -0,0 +1,681 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "common.h"
+#include "actor.h"
+
+/*
+ * The scheduler follows the "Scheduling actors" and "Time slice procedures" sections of
+ * `doc/design/executors.md`. Each time slice ends when the running actor suspends, at which point
+ * the actor is rescheduled according to the state it suspended in:
+ *   - Runnable: it used its full quantum, and is queued `HEMLOCK_SCHED_FORWARD` segments forward
+ *     with a fresh quantum.
+ *   - Receiving: it may have used much less than its quantum, so it is placed in the timed-out set
+ *     `HEMLOCK_SCHED_FORWARD * (fraction of quantum used)` segments forward, and keeps the
+ *     remainder of its quantum. Once the wheel turns to that segment, it is run again with the
+ *     remainder if it has become runnable, and otherwise joins the idle set.
+ *   - Halted: it is moved to the halted queue.
+ * Actors in the idle set that become runnable are run at the first opportunity, with a fresh
+ * quantum. The idle set is implicit, since its members are only ever activated individually; only
+ * its size is tracked.
+ *
+ * Migration follows the "Actor migration" section: runnable actors that have just yielded are
+ * queued `HEMLOCK_SCHED_FORWARD` segments forward by the receiving scheduler, and idle actors that
+ * have just become runnable are run at its first opportunity. Actors waiting for messages or I/O
+ * are never migrated, since they are in neither position.
+ */
+
+#define HEMLOCK_INDENT_SIZE 4
+
+// Number of actor stacks per `mmap(2)`ed chunk.
+#define HEMLOCK_SCHED_CHUNK_STACKS 64
+
+// Initial inbox capacity. Must be a power of two.
+#define HEMLOCK_ACTOR_INBOX_SIZE 4
+
+static char const *
+hemlock_actor_state_str(uint8_t state) {
+    switch (state) {
+    case HEMLOCK_ACTOR_RECEIVING: return "Receiving";
+    case HEMLOCK_ACTOR_RUNNABLE: return "Runnable";
+    case HEMLOCK_ACTOR_RUNNING: return "Running";
+    case HEMLOCK_ACTOR_HALTED: return "Halted";
+    default: return "<unknown>";
+    }
+}
+
+void
+hemlock_actor_pp(int fd, int indent, hemlock_actor_t *actor) {
+    dprintf(fd, "%*sactor:\n", indent, "");
+    indent += HEMLOCK_INDENT_SIZE;
+    dprintf(fd,
+        "%*sstate: %s\n"
+        "%*sin: %u\n"
+        "%*squantum_ns: %ld\n"
+        "%*sinbox_n: %u\n"
+        ,
+        indent, "", hemlock_actor_state_str(actor->state),
+        indent, "", actor->in,
+        indent, "", actor->quantum_ns,
+        indent, "", actor->inbox_n
+    );
+}
+
+void
+hemlock_sched_pp(int fd, int indent, hemlock_sched_t *sched) {
+    dprintf(fd, "%*ssched:\n", indent, "");
+    indent += HEMLOCK_INDENT_SIZE;
+    dprintf(fd,
+        "%*squantum_ns: %ld\n"
+        "%*ssegment: %lu\n"
+        "%*sn_live: %lu\n"
+        "%*sn_runnable: %lu\n"
+        "%*sn_idle: %lu\n"
+        "%*sn_spawned: %lu\n"
+        "%*sn_slices: %lu\n"
+        "%*sn_turns: %lu\n"
+        "%*sn_sent: %lu\n"
+        "%*sn_abroad: %lu\n"
+        "%*sn_emigrated: %lu\n"
+        "%*sn_immigrated: %lu\n"
+        ,
+        indent, "", sched->quantum_ns,
+        indent, "", sched->segment,
+        indent, "", sched->n_live,
+        indent, "", sched->n_runnable,
+        indent, "", sched->n_idle,
+        indent, "", sched->n_spawned,
+        indent, "", sched->n_slices,
+        indent, "", sched->n_turns,
+        indent, "", sched->n_sent,
+        indent, "", sched->n_abroad,
+        indent, "", sched->n_emigrated,
+        indent, "", sched->n_immigrated
+    );
+}
+
+static int64_t
+hemlock_sched_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void
+hemlock_actor_queue_push(hemlock_actor_queue_t *queue, hemlock_actor_t *actor) {
+    actor->next = NULL;
+    if (queue->tail == NULL) {
+        queue->head = actor;
+    } else {
+        queue->tail->next = actor;
+    }
+    queue->tail = actor;
+}
+
+static hemlock_actor_t *
+hemlock_actor_queue_pop(hemlock_actor_queue_t *queue) {
+    hemlock_actor_t *actor = queue->head;
+    if (actor != NULL) {
+        queue->head = actor->next;
+        if (queue->head == NULL) {
+            queue->tail = NULL;
+        }
+        actor->next = NULL;
+    }
+
+    return actor;
+}
+
+// Context switching.
+
+void hemlock_sched_actor_main(hemlock_actor_t *actor) __attribute__((visibility("hidden")));
+
+#if defined(__x86_64__)
+// Save the callee-saved registers and the SSE/x87 control words on the current stack, store the
+// stack pointer to `*from_sp`, then restore the same from `to_sp` and return to its saved return
+// address. A new actor's stack is prepared so that the return lands in `hemlock_sched_trampoline`
+// with the actor in `%r12`.
+void hemlock_sched_switch(void **from_sp, void *to_sp) __attribute__((visibility("hidden")));
+void hemlock_sched_trampoline(void) __attribute__((visibility("hidden")));
+__asm__(
+    ".pushsection .text\n"
+    ".globl hemlock_sched_switch\n"
+    ".hidden hemlock_sched_switch\n"
+    ".type hemlock_sched_switch, @function\n"
+    ".p2align 4\n"
+    "hemlock_sched_switch:\n"
+    "    pushq %rbp\n"
+    "    pushq %rbx\n"
+    "    pushq %r12\n"
+    "    pushq %r13\n"
+    "    pushq %r14\n"
+    "    pushq %r15\n"
+    "    subq $8, %rsp\n"
+    "    stmxcsr (%rsp)\n"
+    "    fnstcw 4(%rsp)\n"
+    "    movq %rsp, (%rdi)\n"
+    "    movq %rsi, %rsp\n"
+    "    ldmxcsr (%rsp)\n"
+    "    fldcw 4(%rsp)\n"
+    "    addq $8, %rsp\n"
+    "    popq %r15\n"
+    "    popq %r14\n"
+    "    popq %r13\n"
+    "    popq %r12\n"
+    "    popq %rbx\n"
+    "    popq %rbp\n"
+    "    ret\n"
+    ".size hemlock_sched_switch, .-hemlock_sched_switch\n"
+    ".globl hemlock_sched_trampoline\n"
+    ".hidden hemlock_sched_trampoline\n"
+    ".type hemlock_sched_trampoline, @function\n"
+    ".p2align 4\n"
+    "hemlock_sched_trampoline:\n"
+    "    movq %r12, %rdi\n"
+    "    call hemlock_sched_actor_main\n"
+    "    ud2\n"
+    ".size hemlock_sched_trampoline, .-hemlock_sched_trampoline\n"
+    ".popsection\n"
+);
+
+static void
+hemlock_sched_context_init(hemlock_actor_t *actor) {
+    // The initial frame mirrors what `hemlock_sched_switch` saves, from the lowest address: the
+    // control words, `%r15`, `%r14`, `%r13`, `%r12`, `%rbx`, `%rbp`, and the return address. The
+    // stack top is 16-byte aligned, so that the trampoline's call conforms to the ABI.
+    uint64_t *top = (uint64_t *)((uintptr_t)(actor->stack + actor->stack_size) & ~(uintptr_t)15);
+    uint64_t *sp = top - 8;
+    memset(sp, 0, sizeof(uint64_t) * 8);
+    __asm__ volatile ("stmxcsr %0" : "=m" (*(uint32_t *)&sp[0]));
+    __asm__ volatile ("fnstcw %0" : "=m" (*((uint16_t *)&sp[0] + 2)));
+    sp[4] = (uint64_t)actor;
+    sp[7] = (uint64_t)hemlock_sched_trampoline;
+    actor->context.sp = sp;
+}
+
+static void
+hemlock_sched_context_switch(hemlock_sched_context_t *from, hemlock_sched_context_t *to) {
+    hemlock_sched_switch(&from->sp, to->sp);
+}
+#else
+// `makecontext(3)` only passes int arguments, so the actor pointer is split in two.
+static void
+hemlock_sched_actor_main_uc(uint32_t hi, uint32_t lo) {
+    hemlock_sched_actor_main((hemlock_actor_t *)(((uintptr_t)hi << 32) | (uintptr_t)lo));
+}
+
+static void
+hemlock_sched_context_init(hemlock_actor_t *actor) {
+    if (getcontext(&actor->context.uc) != 0) {
+        abort();
+    }
+    actor->context.uc.uc_stack.ss_sp = actor->stack;
+    actor->context.uc.uc_stack.ss_size = actor->stack_size;
+    actor->context.uc.uc_link = NULL;
+    uintptr_t p = (uintptr_t)actor;
+    makecontext(&actor->context.uc, (void (*)(void))hemlock_sched_actor_main_uc, 2,
+      (uint32_t)(p >> 32), (uint32_t)p);
+}
+
+static void
+hemlock_sched_context_switch(hemlock_sched_context_t *from, hemlock_sched_context_t *to) {
+    if (swapcontext(&from->uc, &to->uc) != 0) {
+        abort();
+    }
+}
+#endif
+
+void
+hemlock_sched_actor_main(hemlock_actor_t *actor) {
+    actor->fn(actor);
+    actor->state = HEMLOCK_ACTOR_HALTED;
+    hemlock_sched_context_switch(&actor->context, &actor->sched->context);
+    // Halted actors are never resumed.
+    abort();
+}
+
+// Suspend the current actor, in whatever state it has set, and switch to the scheduler loop.
+static void
+hemlock_actor_suspend(hemlock_actor_t *actor) {
+    assert(actor->sched->current == actor);
+    hemlock_sched_context_switch(&actor->context, &actor->sched->context);
+}
+
+// Scheduler.
+
+void
+hemlock_sched_setup(hemlock_sched_t *sched, int64_t quantum_ns) {
+    memset(sched, 0, sizeof(hemlock_sched_t));
+    sched->quantum_ns = quantum_ns;
+}
+
+// Size of the guard page at the base of each stack slot.
+static size_t
+hemlock_sched_guard_size(void) {
+    return (size_t)sysconf(_SC_PAGESIZE);
+}
+
+// Size of each stack slot: a guard page followed by the stack, with the actor record atop it.
+static size_t
+hemlock_sched_slot_size(void) {
+    return hemlock_sched_guard_size() + HEMLOCK_ACTOR_STACK_SIZE;
+}
+
+void
+hemlock_sched_teardown(hemlock_sched_t *sched) {
+    assert(sched->current == NULL);
+    hemlock_sched_immigrate(sched);
+    for (hemlock_actor_t *actor = sched->all; actor != NULL; actor = actor->all_next) {
+        free(actor->inbox);
+    }
+    for (size_t i = 0; i < sched->n_chunks; i++) {
+        if (munmap(sched->chunks[i], HEMLOCK_SCHED_CHUNK_STACKS * hemlock_sched_slot_size()) != 0) {
+            abort();
+        }
+    }
+    free(sched->chunks);
+    memset(sched, 0, sizeof(hemlock_sched_t));
+}
+
+// Size of the actor record atop each stack.
+#define HEMLOCK_ACTOR_RECORD_SIZE ((sizeof(hemlock_actor_t) + HEMLOCK_CACHE_LINE_SIZE - 1) & \
+  ~(size_t)(HEMLOCK_CACHE_LINE_SIZE - 1))
+
+// Allocate an actor record atop a fresh stack. Stacks are carved out of chunks mapped directly
+// rather than allocated via `malloc(3)`, so that no allocator metadata shares their pages, and an
+// actor that has barely run touches a single page of memory: the one holding its record and the
+// base of its stack. Each stack slot begins with a guard page, which sits between the stack and the
+// record of the slot below.
+static hemlock_actor_t *
+hemlock_sched_actor_alloc(hemlock_sched_t *sched) {
+    if (sched->free == NULL) {
+        size_t slot_size = hemlock_sched_slot_size();
+        uint8_t *chunk = (uint8_t *)mmap(NULL, HEMLOCK_SCHED_CHUNK_STACKS * slot_size,
+          PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (chunk == MAP_FAILED) {
+            abort();
+        }
+        for (size_t i = 0; i < HEMLOCK_SCHED_CHUNK_STACKS; i++) {
+            if (mprotect(chunk + i * slot_size, hemlock_sched_guard_size(), PROT_NONE) != 0) {
+                abort();
+            }
+        }
+        if (sched->n_chunks == sched->chunks_max) {
+            sched->chunks_max = (sched->chunks_max == 0) ? 16 : sched->chunks_max * 2;
+            sched->chunks = (uint8_t **)realloc(sched->chunks,
+              sizeof(uint8_t *) * sched->chunks_max);
+            assert(sched->chunks != NULL);
+        }
+        sched->chunks[sched->n_chunks] = chunk;
+        sched->n_chunks++;
+        for (size_t i = HEMLOCK_SCHED_CHUNK_STACKS; i > 0; i--) {
+            hemlock_actor_t *actor = (hemlock_actor_t *)(chunk + i * slot_size -
+              HEMLOCK_ACTOR_RECORD_SIZE);
+            actor->next = sched->free;
+            sched->free = actor;
+        }
+    }
+    hemlock_actor_t *actor = sched->free;
+    sched->free = actor->next;
+    memset(actor, 0, sizeof(hemlock_actor_t));
+    actor->stack = (uint8_t *)actor + HEMLOCK_ACTOR_RECORD_SIZE - HEMLOCK_ACTOR_STACK_SIZE;
+    actor->stack_size = HEMLOCK_ACTOR_STACK_SIZE - HEMLOCK_ACTOR_RECORD_SIZE;
+
+    return actor;
+}
+
+static void
+hemlock_sched_actor_free(hemlock_sched_t *sched, hemlock_actor_t *actor) {
+    free(actor->inbox);
+    actor->next = sched->free;
+    sched->free = actor;
+}
+
+static void
+hemlock_sched_all_insert(hemlock_sched_t *sched, hemlock_actor_t *actor) {
+    actor->all_prev = NULL;
+    actor->all_next = sched->all;
+    if (sched->all != NULL) {
+        sched->all->all_prev = actor;
+    }
+    sched->all = actor;
+}
+
+static void
+hemlock_sched_all_remove(hemlock_sched_t *sched, hemlock_actor_t *actor) {
+    if (actor->all_prev == NULL) {
+        sched->all = actor->all_next;
+    } else {
+        actor->all_prev->all_next = actor->all_next;
+    }
+    if (actor->all_next != NULL) {
+        actor->all_next->all_prev = actor->all_prev;
+    }
+}
+
+// Queue `actor` on the runnable queue or in the timed-out set `forward` segments forward.
+static void
+hemlock_sched_schedule(hemlock_sched_t *sched, hemlock_actor_t *actor, uint64_t forward,
+  uint8_t in) {
+    assert(forward < HEMLOCK_SCHED_SEGMENTS);
+    hemlock_sched_segment_t *segment =
+      &sched->segments[(sched->segment + forward) & (HEMLOCK_SCHED_SEGMENTS - 1)];
+    actor->in = in;
+    hemlock_actor_queue_push(
+      (in == HEMLOCK_ACTOR_IN_RUNNABLE) ? &segment->runnable : &segment->timed_out, actor);
+}
+
+hemlock_actor_t *
+hemlock_sched_spawn(
+    hemlock_sched_t *sched,
+    void (*fn)(hemlock_actor_t *actor),
+    void *env
+) {
+    hemlock_actor_t *actor = hemlock_sched_actor_alloc(sched);
+    actor->sched = sched;
+    actor->home = sched;
+    actor->fn = fn;
+    actor->env = env;
+    actor->state = HEMLOCK_ACTOR_RUNNABLE;
+    actor->quantum_ns = sched->quantum_ns;
+    hemlock_sched_context_init(actor);
+
+    hemlock_sched_all_insert(sched, actor);
+    sched->n_live++;
+    sched->n_runnable++;
+    sched->n_spawned++;
+    hemlock_sched_schedule(sched, actor, 0, HEMLOCK_ACTOR_IN_RUNNABLE);
+
+    return actor;
+}
+
+// Push `actor` onto one of `to`'s handover stacks, and notify `to`.
+static void
+hemlock_sched_hand(hemlock_sched_t *sched, hemlock_actor_t *actor, hemlock_sched_t *to,
+  hemlock_actor_t *_Atomic *stack) {
+    actor->next = atomic_load_explicit(stack, memory_order_relaxed);
+    // Publish the actor, including its stack contents, to `to`'s thread.
+    while (!atomic_compare_exchange_weak_explicit(stack, &actor->next, actor, memory_order_release,
+      memory_order_relaxed));
+    if (sched->notify != NULL) {
+        sched->notify(to, sched->env);
+    }
+}
+
+bool
+hemlock_sched_is_handed(hemlock_sched_t *sched) {
+    return atomic_load_explicit(&sched->immigrants, memory_order_relaxed) != NULL ||
+      atomic_load_explicit(&sched->returned, memory_order_relaxed) != NULL;
+}
+
+size_t
+hemlock_sched_reap(hemlock_sched_t *sched) {
+    size_t n = 0;
+    hemlock_actor_t *actor;
+    while ((actor = hemlock_actor_queue_pop(&sched->halted)) != NULL) {
+        hemlock_sched_all_remove(sched, actor);
+        if (actor->home == sched) {
+            hemlock_sched_actor_free(sched, actor);
+        } else {
+            actor->sched = actor->home;
+            hemlock_sched_hand(sched, actor, actor->home, &actor->home->returned);
+        }
+        n++;
+    }
+    if (atomic_load_explicit(&sched->returned, memory_order_relaxed) != NULL) {
+        actor = atomic_exchange_explicit(&sched->returned, NULL, memory_order_acquire);
+        while (actor != NULL) {
+            hemlock_actor_t *next = actor->next;
+            assert(sched->n_abroad > 0);
+            sched->n_abroad--;
+            hemlock_sched_actor_free(sched, actor);
+            actor = next;
+            n++;
+        }
+    }
+
+    return n;
+}
+
+// Offer `actor`, which is runnable but in no scheduler data structure, to the `migrate` hook, and
+// if the hook chooses a scheduler, hand `actor` over, to be placed per `in` (either
+// `HEMLOCK_ACTOR_IN_READY` or `HEMLOCK_ACTOR_IN_RUNNABLE`). Returns whether `actor` was handed
+// over.
+static bool
+hemlock_sched_migrate(hemlock_sched_t *sched, hemlock_actor_t *actor, uint8_t in) {
+    if ((actor->flags & HEMLOCK_ACTOR_PINNED) != 0 || sched->migrate == NULL) {
+        return false;
+    }
+    hemlock_sched_t *to = sched->migrate(sched, actor, sched->env);
+    if (to == NULL || to == sched) {
+        return false;
+    }
+    hemlock_sched_all_remove(sched, actor);
+    assert(sched->n_live > 0);
+    sched->n_live--;
+    if (actor->home == sched) {
+        sched->n_abroad++;
+    }
+    sched->n_emigrated++;
+    actor->in = in;
+    actor->sched = to;
+    hemlock_sched_hand(sched, actor, to, &to->immigrants);
+
+    return true;
+}
+
+size_t
+hemlock_sched_immigrate(hemlock_sched_t *sched) {
+    if (atomic_load_explicit(&sched->immigrants, memory_order_relaxed) == NULL) {
+        return 0;
+    }
+    size_t n = 0;
+    hemlock_actor_t *actor = atomic_exchange_explicit(&sched->immigrants, NULL,
+      memory_order_acquire);
+    while (actor != NULL) {
+        hemlock_actor_t *next = actor->next;
+        assert(actor->sched == sched && actor->state == HEMLOCK_ACTOR_RUNNABLE);
+        hemlock_sched_all_insert(sched, actor);
+        sched->n_live++;
+        sched->n_runnable++;
+        if (actor->home == sched) {
+            assert(sched->n_abroad > 0);
+            sched->n_abroad--;
+        }
+        sched->n_immigrated++;
+        if (actor->in == HEMLOCK_ACTOR_IN_READY) {
+            hemlock_actor_queue_push(&sched->ready, actor);
+        } else {
+            hemlock_sched_schedule(sched, actor, HEMLOCK_SCHED_FORWARD, HEMLOCK_ACTOR_IN_RUNNABLE);
+        }
+        actor = next;
+        n++;
+    }
+
+    return n;
+}
+
+void
+hemlock_sched_activate(hemlock_actor_t *actor) {
+    hemlock_sched_t *sched = actor->sched;
+    if (actor->state != HEMLOCK_ACTOR_RECEIVING) {
+        return;
+    }
+    actor->state = HEMLOCK_ACTOR_RUNNABLE;
+    switch (actor->in) {
+    case HEMLOCK_ACTOR_IN_IDLE:
+        assert(sched->n_idle > 0);
+        sched->n_idle--;
+        actor->quantum_ns = sched->quantum_ns;
+        actor->in = HEMLOCK_ACTOR_IN_NONE;
+        if (!hemlock_sched_migrate(sched, actor, HEMLOCK_ACTOR_IN_READY)) {
+            sched->n_runnable++;
+            actor->in = HEMLOCK_ACTOR_IN_READY;
+            hemlock_actor_queue_push(&sched->ready, actor);
+        }
+        break;
+    case HEMLOCK_ACTOR_IN_TIMED_OUT:
+        // Left in place, to be run with the remainder of its quantum once the wheel turns to its
+        // segment.
+        sched->n_runnable++;
+        break;
+    default:
+        abort();
+    }
+}
+
+// Run `actor` for a time slice, then perform the time slice procedures: reschedule `actor` per the
+// state in which it suspended, and then call the `between` hook, which may activate actors.
+static void
+hemlock_sched_slice(hemlock_sched_t *sched, hemlock_actor_t *actor) {
+    assert(actor->state == HEMLOCK_ACTOR_RUNNABLE);
+    assert(sched->n_runnable > 0);
+    sched->n_runnable--;
+    actor->state = HEMLOCK_ACTOR_RUNNING;
+    actor->in = HEMLOCK_ACTOR_IN_NONE;
+    sched->current = actor;
+    actor->slice_ns = hemlock_sched_now_ns();
+    hemlock_sched_context_switch(&sched->context, &actor->context);
+    sched->current = NULL;
+    sched->n_slices++;
+    sched->now_ns = hemlock_sched_now_ns();
+    actor->quantum_ns -= sched->now_ns - actor->slice_ns;
+
+    switch (actor->state) {
+    case HEMLOCK_ACTOR_RUNNABLE:
+        actor->quantum_ns = sched->quantum_ns;
+        if (!hemlock_sched_migrate(sched, actor, HEMLOCK_ACTOR_IN_RUNNABLE)) {
+            sched->n_runnable++;
+            hemlock_sched_schedule(sched, actor, HEMLOCK_SCHED_FORWARD, HEMLOCK_ACTOR_IN_RUNNABLE);
+        }
+        break;
+    case HEMLOCK_ACTOR_RECEIVING: {
+        uint64_t forward;
+        if (actor->quantum_ns <= 0) {
+            // No remainder to preserve; its next opportunity is on the next turn of the wheel.
+            actor->quantum_ns = sched->quantum_ns;
+            forward = HEMLOCK_SCHED_FORWARD;
+        } else {
+            forward = HEMLOCK_SCHED_FORWARD * (sched->quantum_ns - actor->quantum_ns) /
+              sched->quantum_ns;
+            // The current segment's timed-out set has already been processed.
+            if (forward == 0) {
+                forward = 1;
+            }
+        }
+        hemlock_sched_schedule(sched, actor, forward, HEMLOCK_ACTOR_IN_TIMED_OUT);
+        break;
+    }
+    case HEMLOCK_ACTOR_HALTED:
+        assert(sched->n_live > 0);
+        sched->n_live--;
+        actor->in = HEMLOCK_ACTOR_IN_HALTED;
+        hemlock_actor_queue_push(&sched->halted, actor);
+        break;
+    default:
+        abort();
+    }
+
+    if (sched->between != NULL) {
+        sched->between(sched, sched->env);
+    }
+}
+
+// Turn the wheel to the next segment, and sort the segment's timed-out set into runnable actors,
+// which are resumed, and idle actors, which join the idle set.
+static void
+hemlock_sched_turn(hemlock_sched_t *sched) {
+    sched->segment++;
+    if ((sched->segment & (HEMLOCK_SCHED_SEGMENTS - 1)) == 0) {
+        sched->n_turns++;
+    }
+    hemlock_sched_segment_t *segment =
+      &sched->segments[sched->segment & (HEMLOCK_SCHED_SEGMENTS - 1)];
+    hemlock_actor_t *actor;
+    while ((actor = hemlock_actor_queue_pop(&segment->timed_out)) != NULL) {
+        if (actor->state == HEMLOCK_ACTOR_RUNNABLE) {
+            actor->in = HEMLOCK_ACTOR_IN_RESUMED;
+            hemlock_actor_queue_push(&sched->resumed, actor);
+        } else {
+            actor->in = HEMLOCK_ACTOR_IN_IDLE;
+            sched->n_idle++;
+        }
+    }
+}
+
+void
+hemlock_sched_run(hemlock_sched_t *sched) {
+    assert(sched->current == NULL);
+    while (sched->n_runnable > 0) {
+        hemlock_sched_segment_t *segment =
+          &sched->segments[sched->segment & (HEMLOCK_SCHED_SEGMENTS - 1)];
+        hemlock_actor_t *actor;
+        if ((actor = hemlock_actor_queue_pop(&sched->ready)) != NULL ||
+          (actor = hemlock_actor_queue_pop(&sched->resumed)) != NULL ||
+          (actor = hemlock_actor_queue_pop(&segment->runnable)) != NULL) {
+            hemlock_sched_slice(sched, actor);
+        } else {
+            hemlock_sched_turn(sched);
+        }
+    }
+}
+
+// Actors.
+
+void
+hemlock_actor_send(hemlock_actor_t *actor, uint64_t payload) {
+    assert(actor->state != HEMLOCK_ACTOR_HALTED);
+    if (actor->inbox_n == actor->inbox_max) {
+        uint32_t inbox_max = (actor->inbox_max == 0) ? HEMLOCK_ACTOR_INBOX_SIZE :
+          actor->inbox_max * 2;
+        uint64_t *inbox = (uint64_t *)malloc(sizeof(uint64_t) * inbox_max);
+        assert(inbox != NULL);
+        for (uint32_t i = 0; i < actor->inbox_n; i++) {
+            inbox[i] = actor->inbox[(actor->inbox_head + i) & (actor->inbox_max - 1)];
+        }
+        free(actor->inbox);
+        actor->inbox = inbox;
+        actor->inbox_head = 0;
+        actor->inbox_max = inbox_max;
+    }
+    actor->inbox[(actor->inbox_head + actor->inbox_n) & (actor->inbox_max - 1)] = payload;
+    actor->inbox_n++;
+    actor->sched->n_sent++;
+    hemlock_sched_activate(actor);
+}
+
+uint64_t
+hemlock_actor_receive(hemlock_actor_t *actor) {
+    while (actor->inbox_n == 0) {
+        actor->state = HEMLOCK_ACTOR_RECEIVING;
+        hemlock_actor_suspend(actor);
+    }
+    uint64_t payload = actor->inbox[actor->inbox_head];
+    actor->inbox_head = (actor->inbox_head + 1) & (actor->inbox_max - 1);
+    actor->inbox_n--;
+
+    return payload;
+}
+
+void
+hemlock_actor_wait(hemlock_actor_t *actor, bool (*is_ready)(void *env), void *env) {
+    while (!is_ready(env)) {
+        actor->state = HEMLOCK_ACTOR_RECEIVING;
+        hemlock_actor_suspend(actor);
+    }
+}
+
+void
+hemlock_actor_yield(hemlock_actor_t *actor) {
+    if (hemlock_sched_now_ns() - actor->slice_ns >= actor->quantum_ns) {
+        actor->state = HEMLOCK_ACTOR_RUNNABLE;
+        hemlock_actor_suspend(actor);
+    }
+}
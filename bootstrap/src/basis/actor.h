@@ -0,0 +1,225 @@
+#pragma once
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#if !defined(__x86_64__)
+#include <ucontext.h>
+#endif
+
+#include "common.h"
+
+// Saved execution context of an actor or of the scheduler loop. On x86-64, contexts are switched by
+// hand-rolled assembly that saves only callee-saved state, so the context is just the stack pointer
+// at which that state was saved. Elsewhere, `swapcontext(3)` is used.
+typedef struct {
+#if defined(__x86_64__)
+    void *sp;
+#else
+    ucontext_t uc;
+#endif
+} hemlock_sched_context_t;
+
+// Actor states.
+//   - Receiving: waiting for a message or for I/O completion.
+//   - Runnable: waiting to be run by the scheduler.
+//   - Running: actively running.
+//   - Halted: returned from its body, and awaiting cleanup.
+#define HEMLOCK_ACTOR_RECEIVING 0
+#define HEMLOCK_ACTOR_RUNNABLE 1
+#define HEMLOCK_ACTOR_RUNNING 2
+#define HEMLOCK_ACTOR_HALTED 3
+
+// Scheduler data structure which currently holds an actor.
+#define HEMLOCK_ACTOR_IN_NONE 0
+#define HEMLOCK_ACTOR_IN_READY 1
+#define HEMLOCK_ACTOR_IN_RUNNABLE 2
+#define HEMLOCK_ACTOR_IN_RESUMED 3
+#define HEMLOCK_ACTOR_IN_TIMED_OUT 4
+#define HEMLOCK_ACTOR_IN_IDLE 5
+#define HEMLOCK_ACTOR_IN_HALTED 6
+
+// Actor flags.
+//   - Pinned: never migrated to another scheduler.
+#define HEMLOCK_ACTOR_PINNED 0x1
+
+// Green thread with its own stack, which runs `fn(actor)` under the control of the scheduler that
+// currently holds it: initially its home scheduler, which spawned it and owns its stack, and
+// thereafter whichever scheduler it has been migrated to, if any. All operations on an actor must
+// be performed by the thread that runs its current scheduler.
+typedef struct hemlock_actor_s {
+    hemlock_sched_context_t context;
+    struct hemlock_sched_s *sched;
+    struct hemlock_sched_s *home;
+    void (*fn)(struct hemlock_actor_s *actor);
+    void *env;
+    uint8_t flags;
+
+    uint8_t *stack;
+    size_t stack_size;
+
+    // Link in whichever scheduler queue or set currently holds the actor, per `in`.
+    struct hemlock_actor_s *next;
+    uint8_t state;
+    uint8_t in;
+
+    // Links in the scheduler's list of all actors.
+    struct hemlock_actor_s *all_prev;
+    struct hemlock_actor_s *all_next;
+
+    // Remaining quantum for the current turn of the wheel, and the start time of the current time
+    // slice.
+    int64_t quantum_ns;
+    int64_t slice_ns;
+
+    // Pending messages, as a FIFO ring of `inbox_max` (0 or a power of two) payloads.
+    uint64_t *inbox;
+    uint32_t inbox_head;
+    uint32_t inbox_n;
+    uint32_t inbox_max;
+} hemlock_actor_t;
+void hemlock_actor_pp(int fd, int indent, hemlock_actor_t *actor);
+
+typedef struct {
+    hemlock_actor_t *head;
+    hemlock_actor_t *tail;
+} hemlock_actor_queue_t;
+
+// Number of segments in the scheduling wheel, and the number of segments forward that runnable
+// actors are rescheduled upon using their full quantum. Segments must be a power of two, and
+// greater than the reschedule distance.
+#define HEMLOCK_SCHED_SEGMENTS 64
+#define HEMLOCK_SCHED_FORWARD 8
+
+// Segment of the scheduling wheel: a queue of runnable actors, and a set of actors that timed out
+// while idle, each of which is rechecked for runnability once the wheel turns to the segment.
+typedef struct {
+    hemlock_actor_queue_t runnable;
+    hemlock_actor_queue_t timed_out;
+} hemlock_sched_segment_t;
+
+// Scheduling wheel actor scheduler, as described in `doc/design/executors.md`. The scheduler loop
+// rolls the wheel one segment at a time, and between time slices calls `between`, which is expected
+// to reap I/O completions (activating the actors that await them) and submit pending I/O.
+//
+// Unpinned actors that have just used up their quantum, or that have just become runnable while in
+// the idle set, are offered to `migrate`, which may choose another scheduler to hand them to.
+// Actors are handed over via the receiving scheduler's lock-free `immigrants` stack, and actors
+// that halt away from home are handed back via their home scheduler's `returned` stack, so that
+// their stacks are freed by the scheduler that allocated them. `notify` is called with the
+// receiving scheduler after each handover, e.g. to wake its thread.
+typedef struct hemlock_sched_s {
+    hemlock_sched_context_t context;
+    hemlock_actor_t *current;
+
+    // Time slice limit for each actor on each turn of the wheel.
+    int64_t quantum_ns;
+
+    // Index of the current segment, which increases monotonically. The wheel has turned once each
+    // time the index passes a multiple of `HEMLOCK_SCHED_SEGMENTS`.
+    uint64_t segment;
+    hemlock_sched_segment_t segments[HEMLOCK_SCHED_SEGMENTS];
+
+    // Actors that became runnable while in the idle set, which are run at the first opportunity,
+    // and runnable actors taken from the current segment's timed-out set, which are run before the
+    // segment's runnable queue.
+    hemlock_actor_queue_t ready;
+    hemlock_actor_queue_t resumed;
+
+    // Halted actors awaiting cleanup via `hemlock_sched_reap`, and all actors.
+    hemlock_actor_queue_t halted;
+    hemlock_actor_t *all;
+
+    // Actor stacks are carved out of `mmap(2)`ed chunks, and recycled via a free list of the actor
+    // records atop them.
+    uint8_t **chunks;
+    size_t n_chunks;
+    size_t chunks_max;
+    hemlock_actor_t *free;
+
+    // Numbers of live (not halted) actors, of runnable actors, wherever they are, and of actors in
+    // the idle set.
+    uint64_t n_live;
+    uint64_t n_runnable;
+    uint64_t n_idle;
+
+    // Number of actors spawned by this scheduler that are currently held by others.
+    uint64_t n_abroad;
+
+    // Time at which the latest time slice ended.
+    int64_t now_ns;
+
+    // Hooks, each called with `env`.
+    void (*between)(struct hemlock_sched_s *sched, void *env);
+    struct hemlock_sched_s *(*migrate)(struct hemlock_sched_s *sched, hemlock_actor_t *actor,
+      void *env);
+    void (*notify)(struct hemlock_sched_s *to, void *env);
+    void *env;
+
+    // Statistics.
+    uint64_t n_spawned;
+    uint64_t n_slices;
+    uint64_t n_turns;
+    uint64_t n_sent;
+    uint64_t n_emigrated;
+    uint64_t n_immigrated;
+
+    // Actors handed to this scheduler by others, linked via `next`: migrated actors, and actors
+    // spawned by this scheduler that halted elsewhere. Pushed by any thread, and taken all at once
+    // by this scheduler's thread.
+    _Alignas(HEMLOCK_CACHE_LINE_SIZE) hemlock_actor_t *_Atomic immigrants;
+    hemlock_actor_t *_Atomic returned;
+} hemlock_sched_t;
+void hemlock_sched_pp(int fd, int indent, hemlock_sched_t *sched);
+void hemlock_sched_setup(hemlock_sched_t *sched, int64_t quantum_ns);
+// Tear down `sched`, freeing all of its actors, halted or not. Must not be called from an actor,
+// nor while actors spawned by `sched` are held by other schedulers, since their stacks are
+// unmapped.
+void hemlock_sched_teardown(hemlock_sched_t *sched);
+
+// Size of each actor's stack, including the actor record atop it. Must be a multiple of the page
+// size. Each stack is preceded by a `PROT_NONE` guard page, so that overflow faults rather than
+// corrupting the record of the actor below.
+#define HEMLOCK_ACTOR_STACK_SIZE (16 * 1024)
+
+// Create a runnable actor, which runs `fn(actor)` once scheduled. `actor->env` is initialized to
+// `env`.
+hemlock_actor_t *hemlock_sched_spawn(
+    hemlock_sched_t *sched,
+    void (*fn)(hemlock_actor_t *actor),
+    void *env
+);
+
+// Run actors until none are runnable. Actors that are waiting for messages or I/O remain in the
+// scheduler, to be run by a later call once activated.
+void hemlock_sched_run(hemlock_sched_t *sched);
+
+// Take in the actors that other schedulers have migrated to `sched`, and schedule them. Returns the
+// number taken in.
+size_t hemlock_sched_immigrate(hemlock_sched_t *sched);
+
+// Whether other schedulers have handed `sched` actors that it has yet to take in or free. Safe to
+// call from any thread.
+bool hemlock_sched_is_handed(hemlock_sched_t *sched);
+
+// Free halted actors, hand those spawned by other schedulers back home, and free actors that were
+// handed back. Returns the number freed or handed back.
+size_t hemlock_sched_reap(hemlock_sched_t *sched);
+
+// Make `actor` runnable if it is receiving. Called for example upon I/O completion.
+void hemlock_sched_activate(hemlock_actor_t *actor);
+
+// Append `payload` to `actor`'s inbox, and activate it. `actor` must be held by the current
+// scheduler, so actors that are sent messages must be pinned if schedulers may migrate actors.
+void hemlock_actor_send(hemlock_actor_t *actor, uint64_t payload);
+
+// Receive the oldest message in the current actor's inbox, suspending until there is one. Must be
+// called from `actor`.
+uint64_t hemlock_actor_receive(hemlock_actor_t *actor);
+
+// Suspend the current actor until `is_ready(env)`, e.g. until an I/O operation that will activate
+// the actor completes. Must be called from `actor`.
+void hemlock_actor_wait(hemlock_actor_t *actor, bool (*is_ready)(void *env), void *env);
+
+// Yield to the scheduler if the current actor has used up its quantum. Must be called from `actor`,
+// and should be called regularly by actors that run for long without receiving.
+void hemlock_actor_yield(hemlock_actor_t *actor);
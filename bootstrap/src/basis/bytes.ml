@@ -1,34 +1,39 @@
 open Rudiments0
 
-type t = byte array
+(* Byte arrays are allocated outside the OCaml heap and never move, so I/O operations can transfer
+   data directly to/from them. Accessors are annotated with [t] so that the compiler specializes
+   bigarray accesses rather than calling the generic C implementations. *)
+type t =
+  (char, Stdlib.Bigarray.int8_unsigned_elt, Stdlib.Bigarray.c_layout) Stdlib.Bigarray.Array1.t
 
-module ArraySeq = struct
-  module T = struct
-    type t = {
-      slice: String.B.Slice.t;
-      bindex: uns;
-    }
-    type elm = byte
+let create n : t =
+  Stdlib.Bigarray.(Array1.create Char C_layout (Uns.trunc_to_int n))
 
-    let init slice =
-      {slice=String.C.Slice.to_bslice slice; bindex=0L}
+let length_inner (t:t) =
+  Stdlib.(Int64.of_int (Bigarray.Array1.dim t))
 
-    let length t =
-      String.B.Slice.length t.slice - t.bindex
+let get_inner i (t:t) =
+  Byte.of_char (Stdlib.Bigarray.Array1.get t (Uns.trunc_to_int i))
 
-    let next t =
-      assert (length t > 0L);
-      let b = String.B.Slice.get t.bindex t.slice in
-      let t' = {t with bindex=Uns.succ t.bindex} in
-      b, t'
-  end
-  include T
-  include Array.Seq.MakeMono(T)
-end
+let set_inner i b (t:t) =
+  let c = Stdlib.Char.unsafe_chr (Uns.trunc_to_int (Byte.extend_to_uns b)) in
+  Stdlib.Bigarray.Array1.set t (Uns.trunc_to_int i) c
+
+let init range ~f =
+  let base = Range.Uns.base range in
+  let t = create (Range.Uns.length_hlt range) in
+  Range.Uns.iter range ~f:(fun i -> set_inner (i - base) (f i) t);
+  t
+
+let of_array array =
+  init (0L =:< Array.length array) ~f:(fun i -> Array.get i array)
+
+let to_array t =
+  Array.init (0L =:< length_inner t) ~f:(fun i -> get_inner i t)
 
 module Cursor = struct
   module T = struct
-    type container = byte array
+    type container = t
     type elm = byte
     type t = {
       array: container;
@@ -44,7 +49,7 @@ module Cursor = struct
       {array; index=0L}
 
     let tl array =
-      {array; index=(Array.length array)}
+      {array; index=(length_inner array)}
 
     let seek i t =
       match Sint.(i < 0L) with
@@ -54,7 +59,7 @@ module Cursor = struct
           | false -> {t with index=(t.index - Uns.(bits_of_sint (Sint.neg i)))}
         end
       | false -> begin
-          match (t.index + (Uns.bits_of_sint i)) > (Array.length t.array) with
+          match (t.index + (Uns.bits_of_sint i)) > (length_inner t.array) with
           | true -> halt "Cannot seek past end of array"
           | false -> {t with index=(t.index + (Uns.bits_of_sint i))}
         end
@@ -66,10 +71,10 @@ module Cursor = struct
       seek (Sint.kv 1L) t
 
     let lget t =
-      Array.get (Uns.pred t.index) t.array
+      get_inner (Uns.pred t.index) t.array
 
     let rget t =
-      Array.get t.index t.array
+      get_inner t.index t.array
 
     let prev t =
       lget t, pred t
@@ -180,85 +185,70 @@ module StringSeq = struct
 end
 
 module Slice = struct
+  type container = Cursor.container
   include Slice.MakeMonoIndex(Cursor)
 
   let length t =
     (Cursor.index (past t)) - (Cursor.index (base t))
 
   let get i t =
-    Array.get (Cursor.index (base t) + i) (container t)
+    get_inner (Cursor.index (base t) + i) (container t)
+
+  (* Bigarray view of the bytes enclosed by [t], which shares storage with [container t]. *)
+  let sub t =
+    Stdlib.Bigarray.Array1.sub (container t) (Uns.trunc_to_int (Cursor.index (base t)))
+      (Uns.trunc_to_int (length t))
+
+  let blit t0 t1 =
+    assert (length t0 = length t1);
+    Stdlib.Bigarray.Array1.blit (sub t0) (sub t1)
+
+  let blit_of_string i s t =
+    assert (i + length t <= String.B.length s);
+    let container = container t in
+    let base = Uns.trunc_to_int (Cursor.index (base t)) in
+    let i = Uns.trunc_to_int i in
+    let n = Uns.trunc_to_int (length t) in
+    (* Loop over native ints with unchecked accesses, since this is on the formatting fast path. *)
+    let rec fn j = begin
+      match Stdlib.(j < n) with
+      | false -> ()
+      | true -> begin
+          Stdlib.(Bigarray.Array1.unsafe_set container (base + j) (String.unsafe_get s (i + j)));
+          fn (Stdlib.succ j)
+        end
+    end in
+    fn 0
 
   let pp t formatter =
-    let slice = Array.Slice.init ~range:(range t) (container t) in
-    Array.Slice.fmt (Byte.fmt ~alt:true ~radix:Radix.Hex ~pretty:true) slice formatter
+    let array = Array.init (0L =:< length t) ~f:(fun i -> get i t) in
+    Array.fmt (Byte.fmt ~alt:true ~radix:Radix.Hex ~pretty:true) array formatter
 
   let hash_fold t state =
     Hash.State.Gen.init state
-    |> Hash.State.Gen.fold_u8 (length t) ~f:(fun i ->
-      (Byte.extend_to_uns (Cursor.(rget (seek (Uns.bits_to_sint i) (base t))))))
+    |> Hash.State.Gen.fold_u8 (length t) ~f:(fun i -> Byte.extend_to_uns (get i t))
     |> Hash.State.Gen.fini
 
-  let to_bytes slice =
-    let bytes = container slice in
-    Array.init (range slice) ~f:(fun i -> Array.get i bytes)
+  let to_bytes t =
+    let bytes = create (length t) in
+    Stdlib.Bigarray.Array1.blit (sub t) bytes;
+    bytes
 
   let of_codepoint cp =
-    init (Array.of_list (Codepoint.to_bytes cp))
+    init (of_array (Array.of_list (Codepoint.to_bytes cp)))
 
   let of_string_slice slice =
-    init (ArraySeq.to_array (ArraySeq.init slice))
-
-  module SliceJoin = struct
-    module T = struct
-      type outer = t
-      type t = {
-        sep: outer;
-        slices: outer list;
-        length: uns;
-        in_sep: bool;
-        index: uns;
-      }
-      type elm = byte
-
-      let init length sep slices =
-        {sep; slices; length; in_sep=false; index=0L}
-
-      let next t =
-        let rec fn t = begin
-          match t.in_sep with
-          | false -> begin
-              let array = List.hd t.slices in
-              match t.index < length array with
-              | true -> begin
-                  let elm = get t.index array in
-                  let t' = {t with index=succ t.index} in
-                  elm, t'
-                end
-              | false -> fn {t with slices=List.tl t.slices; in_sep=true; index=0L}
-            end
-          | true -> begin
-              match t.index < length t.sep with
-              | true -> begin
-                  let elm = get t.index t.sep in
-                  let t' = {t with index=succ t.index} in
-                  elm, t'
-                end
-              | false -> fn {t with in_sep=false; index=0L}
-            end
-        end in
-        fn t
-
-      let length t =
-        t.length
-    end
-    include T
-    include Array.Seq.MakeMono(T)
-  end
+    let bslice = String.C.Slice.to_bslice slice in
+    let n = String.B.Slice.length bslice in
+    let t = init (create n) in
+    blit_of_string (String.B.Cursor.index (String.B.Slice.base bslice))
+      (String.B.Slice.container bslice) t;
+    t
 
   let join ?sep tlist =
-    let sep, sep_len = match sep with
-      | None -> init [||], 0L
-      | Some sep -> sep, length sep
+    let sep_len = match sep with
+      | None -> 0L
+      | Some sep -> length sep
     in
     let _, tlist_length = List.fold tlist ~init:(0L, 0L) ~f:(fun (i, accum) list ->
       let i' = Uns.succ i in
@@ -269,7 +259,21 @@ module Slice = struct
       let accum' = accum + sep_len' + (length list) in
       i', accum'
     ) in
-    init SliceJoin.(to_array (init tlist_length sep tlist))
+    let bytes = create tlist_length in
+    let blit_at index t =
+      let index' = index + length t in
+      blit t (init ~range:(index =:< index') bytes);
+      index'
+    in
+    let _ = List.foldi tlist ~init:0L ~f:(fun i index t ->
+      let index = match i, sep with
+        | 0L, _
+        | _, None -> index
+        | _, Some sep -> blit_at index sep
+      in
+      blit_at index t
+    ) in
+    init bytes
 
   let transcode ?(on_invalid=Error) t =
     let cursor, past = cursors t in
@@ -307,7 +311,7 @@ let of_codepoint cp =
   Slice.(to_bytes (of_codepoint cp))
 
 let of_string_slice slice =
-  Slice.(to_bytes (of_string_slice slice))
+  Slice.(container (of_string_slice slice))
 
 let to_string t =
   Slice.(to_string (init t))
@@ -1,20 +1,36 @@
 (** Byte array convenience functions. {!type:string} can represent only well formed UTF-8-encoded
     {!type:codepoint} sequences, and byte arrays provide a convenient less constrained
-    representation for conversion to/from {!type:string}. *)
+    representation for conversion to/from {!type:string}. Byte arrays are allocated outside the
+    OCaml heap and never move, so I/O operations can transfer data directly to/from them. *)
 
 open Rudiments0
 
-type t = byte array
+type t =
+  (char, Stdlib.Bigarray.int8_unsigned_elt, Stdlib.Bigarray.c_layout) Stdlib.Bigarray.Array1.t
+
+val create: uns -> t
+(** [create n] creates a byte array of length [n] with unspecified contents, e.g. as the destination
+    of a read. *)
+
+val init: range -> f:(uns -> byte) -> t
+(** [init range ~f:(fun i -> ...)] creates a byte array of length [Range.Uns.length_hlt range] using
+    [~f] to map range elements to bytes. *)
+
+val of_array: byte array -> t
+(** [of_array array] creates a byte array with the contents of [array]. *)
+
+val to_array: t -> byte array
+(** [to_array t] creates an array with the contents of [t]. *)
 
 module Cursor : sig
   include CursorIntf.SMonoIndex
-    with type container := byte array
+    with type container := t
     with type elm := byte
 end
 
 module Slice : sig
   include SliceIntf.SMonoIndex
-    with type container := byte array
+    with type container = t
     with type cursor := Cursor.t
     with type elm := byte
   include FormattableIntf.SMono with type t := t
@@ -29,7 +45,15 @@ module Slice : sig
   val get: uns -> t -> byte
   (** [get i t] returns the byte at index [i] within [t]. *)
 
-  val to_bytes: t -> byte array
+  val blit: t -> t -> unit
+  (** Set bytes in place (mutate). [blit t0 t1] sets the bytes of [t1] to equal the bytes of [t0].
+      [t0] and [t1] must have equal length. *)
+
+  val blit_of_string: uns -> string -> t -> unit
+  (** Set bytes in place (mutate). [blit_of_string i s t] sets the bytes of [t] to equal the
+      [length t] bytes of [s] starting at byte index [i]. *)
+
+  val to_bytes: t -> container
   (** [to_bytes t] creates a new byte array containing the contents enclosed by [t]. *)
 
   val of_codepoint: codepoint -> t
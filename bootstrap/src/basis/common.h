@@ -4,6 +4,10 @@
 #include <stdint.h>
 #include <stdio.h>
 
+// Cache line size assumed for alignment/padding of data structures that are hot or shared between
+// threads.
+#define HEMLOCK_CACHE_LINE_SIZE 64
+
 typedef enum {
     HEMLOCK_OE_ERROR = -1,
     HEMLOCK_OE_NONE
@@ -1,32 +1,647 @@
+#define _GNU_SOURCE
 #include <assert.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <threads.h>
+#include <time.h>
+#include <unistd.h>
 
 #define CAML_NAME_SPACE
 #include <caml/memory.h>
 #include <caml/mlvalues.h>
 #include <caml/alloc.h>
+#include <caml/callback.h>
+#include <caml/fail.h>
+#include <caml/printexc.h>
+#include <caml/signals.h>
+#include <caml/threads.h>
 
 #include "common.h"
 #include "ioring.h"
+#include "topology.h"
 
 #include "executor.h"
 
+// Executor of threads other than pool executor threads, i.e. the main executor.
 thread_local hemlock_executor_t executor = {0};
 
+// Executor of the current pool executor thread, or NULL.
+static thread_local hemlock_executor_t *executor_pool = NULL;
+
+// Global lookup array of live executors. Executors are emplaced at `executors[n]` before `n` is
+// incremented, so that readers never observe a live slot that is not yet filled. Executor records
+// are never freed, because user_data allocated from their slabs may outlive them.
+static hemlock_executor_t *_Atomic hemlock_executors[HEMLOCK_EXECUTORS_MAX];
+static atomic_size_t hemlock_executors_n = 0;
+
+// Pool executor records, indexed by executor index, allocated on first use and reused each time the
+// pool is restarted.
+static hemlock_executor_t *hemlock_executor_pool[HEMLOCK_EXECUTORS_MAX];
+static size_t hemlock_executor_pool_n = 0;
+
+// All executor threads run OCaml code while holding the OCaml runtime lock, and all executor state
+// reachable from OCaml (iorings, slabs, user_data) is only accessed while holding it. Executor
+// threads release the lock while blocked waiting for completions, whether in
+// `hemlock_basis_executor_{complete,wait}_inner` or while idle. Idle executors wait in their
+// iorings, so that a single system call waits for both I/O and doorbells rung by other executors.
+
+size_t
+hemlock_executors_length(void) {
+    return atomic_load_explicit(&hemlock_executors_n, memory_order_acquire);
+}
+
+hemlock_executor_t *
+hemlock_executors_get(size_t i) {
+    assert(i < hemlock_executors_length());
+    return atomic_load_explicit(&hemlock_executors[i], memory_order_relaxed);
+}
+
+// Make `executor` live at index `executors[n]`. Only one thread at a time controls the executor
+// set, so `n` is not contended.
+static void
+hemlock_executors_push(hemlock_executor_t *executor) {
+    size_t n = atomic_load_explicit(&hemlock_executors_n, memory_order_relaxed);
+    assert(n < HEMLOCK_EXECUTORS_MAX);
+    executor->id = n;
+    atomic_store_explicit(&hemlock_executors[n], executor, memory_order_relaxed);
+    atomic_store_explicit(&hemlock_executors_n, n + 1, memory_order_release);
+}
+
+static void
+hemlock_executors_truncate(size_t n) {
+    assert(n <= hemlock_executors_length());
+    atomic_store_explicit(&hemlock_executors_n, n, memory_order_release);
+}
+
+static hemlock_executor_t *
+hemlock_executor_of_slab(hemlock_user_data_slab_t *slab) {
+    return (hemlock_executor_t *)((uint8_t *)slab - offsetof(hemlock_executor_t, slab));
+}
+
+// Wake `receiver` if it is idle, after giving it something to do. The receiver marks itself idle
+// before its final check for something to do, and the fences order each side's store before its
+// subsequent load, so either the receiver observes the work or the waker observes the idleness.
+// Doorbell failure is reported but otherwise ignored; there is no way to recover. Returns whether
+// the doorbell was rung.
+static bool
+hemlock_executor_wake(hemlock_executor_t *receiver) {
+    hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
+    hemlock_executor_t *waker = hemlock_executor_get();
+
+    atomic_thread_fence(memory_order_seq_cst);
+    if (receiver == waker ||
+      atomic_load_explicit(&receiver->idle, memory_order_relaxed) == HEMLOCK_EXECUTOR_BUSY ||
+      atomic_exchange_explicit(&receiver->idle, HEMLOCK_EXECUTOR_BUSY, memory_order_relaxed) ==
+      HEMLOCK_EXECUTOR_BUSY) {
+        return false;
+    }
+    HEMLOCK_OE(oe, hemlock_ioring_doorbell_ring(&receiver->ioring, &waker->ioring));
+
+LABEL_OUT:
+    return true;
+}
+
+void
+hemlock_executor_send(hemlock_executor_t *receiver, hemlock_message_t *message) {
+    hemlock_executor_t *sender = hemlock_executor_get();
+    message->sender = sender->id;
+    message->state = HEMLOCK_MESSAGE_SENT;
+    sender->n_unacked++;
+    hemlock_mailbox_send(&receiver->mailbox, message);
+    hemlock_executor_wake(receiver);
+}
+
+size_t
+hemlock_executor_receive(
+    void (*receive)(hemlock_message_t *message, void *env),
+    void (*reclaim)(hemlock_message_t *message, void *env),
+    void *env
+) {
+    hemlock_executor_t *executor = hemlock_executor_get();
+    size_t n = 0;
+    hemlock_message_t *message;
+    while ((message = hemlock_mailbox_receive(&executor->mailbox)) != NULL) {
+        switch (message->state) {
+        case HEMLOCK_MESSAGE_SENT: {
+            // The message is not touched after it is returned, since the sender may reclaim it
+            // immediately. Senders are live by the time their messages arrive, and executor records
+            // are never freed.
+            receive(message, env);
+            n++;
+            message->state = HEMLOCK_MESSAGE_ACKED;
+            hemlock_executor_t *sender =
+              atomic_load_explicit(&hemlock_executors[message->sender], memory_order_relaxed);
+            hemlock_mailbox_send(&sender->mailbox, message);
+            hemlock_executor_wake(sender);
+            break;
+        }
+        case HEMLOCK_MESSAGE_ACKED:
+            assert(message->sender == executor->id);
+            assert(executor->n_unacked > 0);
+            executor->n_unacked--;
+            reclaim(message, env);
+            break;
+        default:
+            abort();
+        }
+    }
+
+    return n;
+}
+
+#define HEMLOCK_INDENT_SIZE 4
+
+// Scheduling quantum: the time slice limit for each actor on each turn of the scheduling wheel.
+// Forked tasks are only stolen once they have awaited joining for a quantum.
+#define HEMLOCK_EXECUTOR_QUANTUM_NS 1000000
+
+// Victim selection pseudo-random number generator seed. Must be non-zero.
+#define HEMLOCK_EXECUTOR_RNG_SEED 0x9e3779b97f4a7c15
+
+// Minimum interval between load statistics samples, and the time constant with which rates are
+// smoothed. Wheel segments are turned in bursts, so rates are noisy at the sampling interval.
+#define HEMLOCK_EXECUTOR_STATS_INTERVAL_NS 10000000
+#define HEMLOCK_EXECUTOR_STATS_DECAY_NS 100000000
+
+// Number of executors whose load statistics are sampled for each migration opportunity, and the
+// minimum interval between migrations away from an executor, which gives the receiving executors a
+// chance to publish statistics that reflect the migrations.
+#define HEMLOCK_EXECUTOR_MIGRATE_SAMPLES 2
+#define HEMLOCK_EXECUTOR_MIGRATE_INTERVAL_NS HEMLOCK_EXECUTOR_STATS_INTERVAL_NS
+
+static int64_t
+hemlock_basis_executor_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+// Blend `sample` into the smoothed statistic `stat`, weighted by the sample's interval.
+static void
+hemlock_executor_stats_smooth(_Atomic double *stat, double sample, int64_t interval_ns) {
+    double weight = (interval_ns < HEMLOCK_EXECUTOR_STATS_DECAY_NS)
+      ? (double)interval_ns / (double)HEMLOCK_EXECUTOR_STATS_DECAY_NS : 1.0;
+    double prev = atomic_load_explicit(stat, memory_order_relaxed);
+    atomic_store_explicit(stat, prev + (sample - prev) * weight, memory_order_relaxed);
+}
+
+// Sample the executor's load statistics, if the sampling interval has elapsed since the previous
+// sample, or unconditionally if `force`.
+static void
+hemlock_executor_stats_sample(hemlock_executor_t *executor, int64_t now_ns, bool force) {
+    hemlock_executor_stats_t *stats = &executor->stats;
+    int64_t interval_ns = now_ns - atomic_load_explicit(&stats->sample_ns, memory_order_relaxed);
+    if (!force && interval_ns < HEMLOCK_EXECUTOR_STATS_INTERVAL_NS) {
+        return;
+    }
+
+    uint64_t segment = executor->sched.segment;
+    // The ioring's count restarts if the ioring is reconfigured.
+    uint64_t n_reaped = executor->ioring.n_reaped;
+    uint64_t d_cqes = n_reaped - ((n_reaped >= executor->stats_cqes) ? executor->stats_cqes : 0);
+    uint64_t d_idle_ns = executor->idle_ns - executor->stats_idle_ns;
+    if (interval_ns > 0) {
+        double seconds = (double)interval_ns / 1e9;
+        double idle = (double)d_idle_ns / (double)interval_ns;
+        double turns = (double)(segment - executor->stats_segment) / HEMLOCK_SCHED_SEGMENTS;
+        hemlock_executor_stats_smooth(&stats->turn_rate, turns / seconds, interval_ns);
+        hemlock_executor_stats_smooth(&stats->cqe_rate, (double)d_cqes / seconds, interval_ns);
+        hemlock_executor_stats_smooth(&stats->idle, (idle < 1.0) ? idle : 1.0, interval_ns);
+    }
+    atomic_store_explicit(&stats->n_runnable, executor->sched.n_runnable, memory_order_relaxed);
+    atomic_store_explicit(&stats->n_inflight, executor->ioring.n_inflight, memory_order_relaxed);
+    atomic_store_explicit(&stats->n_turns, executor->sched.n_turns, memory_order_relaxed);
+    atomic_store_explicit(&stats->n_cqes,
+      atomic_load_explicit(&stats->n_cqes, memory_order_relaxed) + d_cqes, memory_order_relaxed);
+    atomic_store_explicit(&stats->idle_ns, executor->idle_ns, memory_order_relaxed);
+    atomic_store_explicit(&stats->sample_ns, now_ns, memory_order_relaxed);
+    executor->stats_segment = segment;
+    executor->stats_cqes = n_reaped;
+    executor->stats_idle_ns = executor->idle_ns;
+}
+
+// Start sampling load statistics afresh.
+static void
+hemlock_executor_stats_setup(hemlock_executor_t *executor) {
+    memset(&executor->stats, 0, sizeof(hemlock_executor_stats_t));
+    executor->stats_segment = executor->sched.segment;
+    executor->stats_cqes = executor->ioring.n_reaped;
+    executor->stats_idle_ns = executor->idle_ns;
+    atomic_store_explicit(&executor->stats.sample_ns, hemlock_basis_executor_now_ns(),
+      memory_order_relaxed);
+}
+
+// io_uring fd of the first executor to be set up, normally the main executor. Executors configured
+// with `IORING_SETUP_ATTACH_WQ` (the default) but no explicit `wq_fd` share this executor's async
+// backend, rather than each creating their own.
+static atomic_int hemlock_executor_wq_fd = -1;
+
+// Pins are released as CQEs are reaped, which may happen while the executor runs actors without the
+// runtime lock, in which case the lock is taken just for the release.
+static void
+hemlock_executor_user_data_unpin(hemlock_user_data_t *user_data) {
+    bool unlocked = hemlock_executor_of_slab(user_data->slab)->unlocked;
+    if (unlocked) {
+        caml_leave_blocking_section();
+    }
+    caml_remove_generational_global_root((value *)&user_data->pin);
+    if (unlocked) {
+        caml_enter_blocking_section();
+    }
+}
+
+// Keep `a_pin` alive until the kernel completes `user_data`'s operation, and transfer ownership of
+// the operation's data buffer to `a_pin`, e.g. a bigarray that the kernel reads into.
+void
+hemlock_executor_user_data_pin(hemlock_user_data_t *user_data, value a_pin) {
+    hemlock_user_data_pin(user_data, (uintptr_t)a_pin);
+    caml_register_generational_global_root((value *)&user_data->pin);
+}
+
+static void
+hemlock_executor_user_data_complete(hemlock_user_data_t *user_data) {
+    hemlock_sched_activate((hemlock_actor_t *)user_data->waiter);
+}
+
+static bool
+hemlock_executor_user_data_is_complete(void *env) {
+    return hemlock_user_data_is_complete((hemlock_user_data_t *)env);
+}
+
+// The actor is pinned while it waits, so that it is not migrated upon activation: the user data
+// belongs to this executor, and the operation's CQE is reaped here regardless.
+void
+hemlock_executor_actor_io_wait(hemlock_actor_t *actor, hemlock_user_data_t *user_data) {
+    if (!hemlock_user_data_is_complete(user_data)) {
+        uint8_t flags = actor->flags;
+        actor->flags |= HEMLOCK_ACTOR_PINNED;
+        user_data->waiter = actor;
+        hemlock_actor_wait(actor, hemlock_executor_user_data_is_complete, user_data);
+        actor->flags = flags;
+    }
+}
+
+// Time slice procedures, between actor time slices: take in migrated actors, reap CQEs, which
+// activates the actors awaiting them, and submit whatever SQEs the actor that just ran left behind.
+// Errors are reported but otherwise ignored, since there is no actor to report them to.
+static void
+hemlock_executor_sched_between(hemlock_sched_t *sched, void *env) {
+    hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
+    hemlock_executor_t *executor = (hemlock_executor_t *)env;
+    hemlock_executor_stats_sample(executor, sched->now_ns, false);
+    hemlock_sched_immigrate(sched);
+    HEMLOCK_OE(oe, hemlock_ioring_poll_lazy(&executor->ioring));
+
+LABEL_OUT:
+    return;
+}
+
+static hemlock_executor_t *
+hemlock_executor_of_sched(hemlock_sched_t *sched) {
+    return (hemlock_executor_t *)((uint8_t *)sched - offsetof(hemlock_executor_t, sched));
+}
+
+static uint64_t hemlock_executor_random(hemlock_executor_t *executor);
+
+// Migration policy: sample the load statistics of `HEMLOCK_EXECUTOR_MIGRATE_SAMPLES` random pool
+// executors, and migrate `actor` to the least loaded of them if that would even out the load. Load
+// is compared by number of runnable actors, which, unlike the smoothed wheel turn rate, reflects
+// migrations as soon as the receiving executor samples its statistics. A waiting executor has no
+// runnable actors. The main executor only runs actors on behalf of its caller, so it is never a
+// destination.
+static hemlock_sched_t *
+hemlock_executor_sched_migrate(hemlock_sched_t *sched, hemlock_actor_t *actor, void *env) {
+    hemlock_executor_t *executor = (hemlock_executor_t *)env;
+    size_t n = hemlock_executors_length();
+    if (n <= ((executor->id == 0) ? 1 : 2) ||
+      sched->now_ns - executor->migrate_ns < HEMLOCK_EXECUTOR_MIGRATE_INTERVAL_NS) {
+        return NULL;
+    }
+
+    hemlock_executor_t *to = NULL;
+    uint64_t to_runnable = UINT64_MAX;
+    for (size_t i = 0; i < HEMLOCK_EXECUTOR_MIGRATE_SAMPLES; i++) {
+        hemlock_executor_t *candidate =
+          hemlock_executors_get(1 + hemlock_executor_random(executor) % (n - 1));
+        if (candidate == executor) {
+            continue;
+        }
+        hemlock_executor_stats_t *stats = &candidate->stats;
+        uint64_t runnable = (atomic_load_explicit(&stats->wait_ns, memory_order_relaxed) != 0) ? 0 :
+          atomic_load_explicit(&stats->n_runnable, memory_order_relaxed);
+        if (runnable < to_runnable) {
+            to = candidate;
+            to_runnable = runnable;
+        }
+    }
+    // `actor` is not counted among `sched`'s runnable actors while it is offered, so migration
+    // evens out the load only if the destination has fewer runnable actors than `sched` has others.
+    if (to == NULL || to_runnable >= sched->n_runnable) {
+        atomic_store_explicit(&executor->stats.n_rejections,
+          atomic_load_explicit(&executor->stats.n_rejections, memory_order_relaxed) + 1,
+          memory_order_relaxed);
+        return NULL;
+    }
+    executor->migrate_ns = sched->now_ns;
+    atomic_store_explicit(&executor->stats.n_migrations,
+      atomic_load_explicit(&executor->stats.n_migrations, memory_order_relaxed) + 1,
+      memory_order_relaxed);
+
+    return &to->sched;
+}
+
+static void
+hemlock_executor_sched_notify(hemlock_sched_t *to, void *env) {
+    hemlock_executor_wake(hemlock_executor_of_sched(to));
+}
+
+static void
+hemlock_executor_sched_setup(hemlock_executor_t *executor) {
+    hemlock_sched_setup(&executor->sched, HEMLOCK_EXECUTOR_QUANTUM_NS);
+    executor->sched.between = hemlock_executor_sched_between;
+    executor->sched.migrate = hemlock_executor_sched_migrate;
+    executor->sched.notify = hemlock_executor_sched_notify;
+    executor->sched.env = executor;
+}
+
+// Arena of aligned buffers, registered as the fixed buffer of every executor's ioring so that reads
+// and writes of buffers carved from it are submitted as `IORING_OP_{READ,WRITE}_FIXED`, whichever
+// executor submits them. Buffers of up to `HEMLOCK_EXECUTOR_ARENA_BUF_MAX` bytes are carved from
+// the arena until it is exhausted, in the same size classes as the executors' pools. Arena buffers
+// are never returned to the system, since the iorings keep the arena's pages pinned; freed buffers
+// are retained in per-class free lists for reuse by any executor. The arena is mapped along with
+// the first ioring and is never unmapped. Like the pools, its free lists are only accessed while
+// holding the runtime lock.
+static struct {
+    uint8_t *vm;
+    size_t n_carved;
+    void *free[HEMLOCK_EXECUTOR_ALIGNPOOL_CLASSES];
+} hemlock_executor_arena;
+static pthread_once_t hemlock_executor_arena_once = PTHREAD_ONCE_INIT;
+
+static void
+hemlock_executor_arena_map(void) {
+    void *vm = mmap(0, HEMLOCK_EXECUTOR_ARENA_SIZE, PROT_READ | PROT_WRITE,
+      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    // Without an arena, all aligned buffers are allocated from the pools.
+    hemlock_executor_arena.vm = (vm == MAP_FAILED) ? NULL : (uint8_t *)vm;
+}
+
+static bool
+hemlock_executor_arena_contains(void const *buf) {
+    uintptr_t vm = (uintptr_t)hemlock_executor_arena.vm;
+    return vm != 0 && (uintptr_t)buf >= vm && (uintptr_t)buf < vm + HEMLOCK_EXECUTOR_ARENA_SIZE;
+}
+
+// Allocate a buffer of size class `class` from the arena, or return NULL if the class is too large
+// or the arena is exhausted.
+static void *
+hemlock_executor_arena_alloc(size_t class) {
+    void *buf = hemlock_executor_arena.free[class];
+    if (buf != NULL) {
+        hemlock_executor_arena.free[class] = *(void **)buf;
+        return buf;
+    }
+
+    size_t size = (size_t)HEMLOCK_EXECUTOR_ALIGNPOOL_ALIGN << class;
+    if (hemlock_executor_arena.vm == NULL || size > HEMLOCK_EXECUTOR_ARENA_BUF_MAX
+      || size > HEMLOCK_EXECUTOR_ARENA_SIZE - hemlock_executor_arena.n_carved) {
+        return NULL;
+    }
+    // Sizes are multiples of the alignment, so every carved buffer is aligned.
+    buf = &hemlock_executor_arena.vm[hemlock_executor_arena.n_carved];
+    hemlock_executor_arena.n_carved += size;
+    return buf;
+}
+
+static void
+hemlock_executor_arena_free(void *buf, size_t class) {
+    *(void **)buf = hemlock_executor_arena.free[class];
+    hemlock_executor_arena.free[class] = buf;
+}
+
+static hemlock_opt_error_t
+hemlock_executor_ioring_setup(hemlock_executor_t *executor, hemlock_ioring_conf_t const *conf) {
+    hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
+
+    hemlock_ioring_conf_t ioring_conf = *conf;
+    if ((ioring_conf.flags & IORING_SETUP_ATTACH_WQ) && ioring_conf.wq_fd < 0) {
+        ioring_conf.wq_fd = atomic_load(&hemlock_executor_wq_fd);
+    }
+    HEMLOCK_OE(oe, hemlock_ioring_setup(&executor->ioring, &ioring_conf, &executor->slab));
+    executor->ioring.unpin = hemlock_executor_user_data_unpin;
+    executor->ioring.complete = hemlock_executor_user_data_complete;
+    pthread_once(&hemlock_executor_arena_once, hemlock_executor_arena_map);
+    if (hemlock_executor_arena.vm != NULL) {
+        hemlock_ioring_regbuf_register(hemlock_executor_arena.vm, HEMLOCK_EXECUTOR_ARENA_SIZE,
+          &executor->ioring);
+    }
+
+    int wq_fd = -1;
+    atomic_compare_exchange_strong(&hemlock_executor_wq_fd, &wq_fd, executor->ioring.fd);
+
+LABEL_OUT:
+    return oe;
+}
+
+static void
+hemlock_executor_ioring_teardown(hemlock_executor_t *executor) {
+    int wq_fd = executor->ioring.fd;
+    atomic_compare_exchange_strong(&hemlock_executor_wq_fd, &wq_fd, -1);
+
+    hemlock_ioring_teardown(&executor->ioring);
+}
+
+void
+hemlock_executor_alignpool_pp(int fd, int indent, hemlock_executor_alignpool_t *alignpool) {
+    dprintf(fd, "%*salignpool:\n", indent, "");
+    indent += HEMLOCK_INDENT_SIZE;
+    dprintf(fd,
+        "%*sn_allocs: %lu\n"
+        "%*sn_reuses: %lu\n"
+        "%*sn_arena: %lu\n"
+        ,
+        indent, "", alignpool->n_allocs,
+        indent, "", alignpool->n_reuses,
+        indent, "", alignpool->n_arena
+    );
+    dprintf(fd, "%*sn_free:\n", indent, "");
+    for (size_t i = 0; i < HEMLOCK_EXECUTOR_ALIGNPOOL_CLASSES; i++) {
+        dprintf(fd, "%*s%lu: %u\n", indent + HEMLOCK_INDENT_SIZE, "",
+          (size_t)HEMLOCK_EXECUTOR_ALIGNPOOL_ALIGN << i, alignpool->n_free[i]);
+    }
+}
+
+static void
+hemlock_executor_alignpool_setup(hemlock_executor_alignpool_t *alignpool) {
+    memset(alignpool, 0, sizeof(hemlock_executor_alignpool_t));
+}
+
+static void
+hemlock_executor_alignpool_teardown(hemlock_executor_alignpool_t *alignpool) {
+    for (size_t i = 0; i < HEMLOCK_EXECUTOR_ALIGNPOOL_CLASSES; i++) {
+        while (alignpool->free[i] != NULL) {
+            void *buf = alignpool->free[i];
+            alignpool->free[i] = *(void **)buf;
+            free(buf);
+        }
+    }
+    memset(alignpool, 0, sizeof(hemlock_executor_alignpool_t));
+}
+
+// Size class of a `size`-byte buffer, or `HEMLOCK_EXECUTOR_ALIGNPOOL_CLASSES` if it is too large to
+// be pooled.
+static size_t
+hemlock_executor_alignpool_class(size_t size) {
+    size_t class = 0;
+    while (class < HEMLOCK_EXECUTOR_ALIGNPOOL_CLASSES
+      && ((size_t)HEMLOCK_EXECUTOR_ALIGNPOOL_ALIGN << class) < size) {
+        class++;
+    }
+    return class;
+}
+
+void *
+hemlock_executor_aligned_alloc(size_t size) {
+    hemlock_executor_alignpool_t *alignpool = &hemlock_executor_get()->alignpool;
+    size_t class = hemlock_executor_alignpool_class(size);
+    alignpool->n_allocs++;
+    if (class < HEMLOCK_EXECUTOR_ALIGNPOOL_CLASSES) {
+        void *buf = hemlock_executor_arena_alloc(class);
+        if (buf != NULL) {
+            alignpool->n_arena++;
+            return buf;
+        }
+        buf = alignpool->free[class];
+        if (buf != NULL) {
+            alignpool->free[class] = *(void **)buf;
+            alignpool->n_free[class]--;
+            alignpool->n_reuses++;
+            return buf;
+        }
+        size = (size_t)HEMLOCK_EXECUTOR_ALIGNPOOL_ALIGN << class;
+    } else {
+        size = (size + HEMLOCK_EXECUTOR_ALIGNPOOL_ALIGN - 1)
+          & ~((size_t)HEMLOCK_EXECUTOR_ALIGNPOOL_ALIGN - 1);
+    }
+
+    void *buf;
+    if (posix_memalign(&buf, HEMLOCK_EXECUTOR_ALIGNPOOL_ALIGN, size) != 0) {
+        return NULL;
+    }
+    return buf;
+}
+
+void
+hemlock_executor_aligned_free(void *buf, size_t size) {
+    hemlock_executor_alignpool_t *alignpool = &hemlock_executor_get()->alignpool;
+    size_t class = hemlock_executor_alignpool_class(size);
+    if (hemlock_executor_arena_contains(buf)) {
+        hemlock_executor_arena_free(buf, class);
+        return;
+    }
+    if (class < HEMLOCK_EXECUTOR_ALIGNPOOL_CLASSES
+      && alignpool->n_free[class] < HEMLOCK_EXECUTOR_ALIGNPOOL_RETAIN) {
+        *(void **)buf = alignpool->free[class];
+        alignpool->free[class] = buf;
+        alignpool->n_free[class]++;
+        return;
+    }
+    free(buf);
+}
+
 hemlock_opt_error_t
-hemlock_executor_setup(hemlock_executor_t *executor) {
-    return hemlock_ioring_setup(&executor->ioring);
+hemlock_executor_setup(hemlock_executor_t *executor, hemlock_ioring_conf_t const *conf) {
+    hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
+
+    hemlock_user_data_slab_setup(&executor->slab);
+    hemlock_mailbox_setup(&executor->mailbox);
+    hemlock_wsdeque_setup(&executor->deque);
+    hemlock_executor_alignpool_setup(&executor->alignpool);
+    hemlock_executor_sched_setup(executor);
+    executor->rng = HEMLOCK_EXECUTOR_RNG_SEED;
+    executor->cpu = -1;
+    HEMLOCK_OE(oe, hemlock_executor_ioring_setup(executor, conf));
+    hemlock_executor_stats_setup(executor);
+    hemlock_executors_push(executor);
+
+LABEL_OUT:
+    return oe;
+}
+
+// Replace the executor's ioring with one configured according to `conf`. This is only possible
+// while no I/O is in flight, since the old ioring's resources are released.
+hemlock_opt_error_t
+hemlock_executor_reconfigure(hemlock_executor_t *executor, hemlock_ioring_conf_t const *conf) {
+    if (!hemlock_ioring_is_quiescent(&executor->ioring)) {
+        return EBUSY;
+    }
+
+    hemlock_executor_ioring_teardown(executor);
+    return hemlock_executor_ioring_setup(executor, conf);
 }
 
 void
 hemlock_executor_teardown(hemlock_executor_t *executor) {
-    hemlock_ioring_teardown(&executor->ioring);
+    hemlock_executor_ioring_teardown(executor);
+    hemlock_mailbox_teardown(&executor->mailbox);
+    hemlock_wsdeque_teardown(&executor->deque);
+    hemlock_executor_alignpool_teardown(&executor->alignpool);
+    hemlock_sched_teardown(&executor->sched);
+    free(executor->received);
+    executor->received = NULL;
+    executor->n_received = 0;
+    executor->received_max = 0;
+    hemlock_user_data_slab_teardown(&executor->slab);
 }
 
 hemlock_executor_t *
 hemlock_executor_get() {
-    return &executor;
+    return (executor_pool != NULL) ? executor_pool : &executor;
+}
+
+// Waits for completions count as idle time. Statistics are sampled as the wait begins, so that they
+// reflect the executor's state throughout the wait.
+static void
+hemlock_executor_block(void) {
+    hemlock_executor_t *executor = hemlock_executor_get();
+    int64_t now_ns = hemlock_basis_executor_now_ns();
+    hemlock_executor_stats_sample(executor, now_ns, true);
+    atomic_store_explicit(&executor->stats.wait_ns, now_ns, memory_order_relaxed);
+    caml_enter_blocking_section();
+}
+
+static void
+hemlock_executor_unblock(void) {
+    caml_leave_blocking_section();
+    hemlock_executor_t *executor = hemlock_executor_get();
+    int64_t now_ns = hemlock_basis_executor_now_ns();
+    executor->idle_ns += now_ns - atomic_load_explicit(&executor->stats.wait_ns,
+      memory_order_relaxed);
+    atomic_store_explicit(&executor->stats.wait_ns, 0, memory_order_relaxed);
+    hemlock_executor_stats_sample(executor, now_ns, false);
+}
+
+// Release the runtime lock while `ioring` waits for completions, until
+// `hemlock_executor_unlocked_waits_end()`. Callers must register any OCaml values they use
+// afterwards as local roots, since other threads may run OCaml code, and therefore the garbage
+// collector, in the meantime.
+static void
+hemlock_executor_unlocked_waits_begin(hemlock_ioring_t *ioring) {
+    ioring->block = hemlock_executor_block;
+    ioring->unblock = hemlock_executor_unblock;
+}
+
+static void
+hemlock_executor_unlocked_waits_end(hemlock_ioring_t *ioring) {
+    ioring->block = NULL;
+    ioring->unblock = NULL;
 }
 
 CAMLprim value
@@ -38,10 +653,43 @@ hemlock_basis_executor_finalize_result(int result) {
     return caml_copy_int64(result);
 }
 
+// Decref user data whose decrefs were deferred while the executor ran actors without the runtime
+// lock.
+static void
+hemlock_executor_decrefs(hemlock_executor_t *executor) {
+    if (atomic_load_explicit(&executor->decrefs, memory_order_relaxed) == NULL) {
+        return;
+    }
+    hemlock_executor_decref_t *decref = atomic_exchange_explicit(&executor->decrefs, NULL,
+      memory_order_acquire);
+    while (decref != NULL) {
+        hemlock_executor_decref_t *next = decref->next;
+        hemlock_user_data_decref(decref->user_data, &executor->ioring);
+        free(decref);
+        decref = next;
+    }
+}
+
 // hemlock_basis_executor_user_data_decref: !&Basis.File.{Open|Close|Read|Write}.t >{os}-> unit
 CAMLprim value
 hemlock_basis_executor_user_data_decref(value a_user_data) {
-    hemlock_user_data_decref((hemlock_user_data_t *)Int64_val(a_user_data));
+    hemlock_user_data_t *user_data = (hemlock_user_data_t *)Int64_val(a_user_data);
+
+    // Finalizers run on whichever thread triggers collection, so decref via the owning executor. An
+    // executor that is running actors without the runtime lock may be using its user data slab, so
+    // the decref is deferred until it holds the lock again.
+    hemlock_executor_t *owner = hemlock_executor_of_slab(user_data->slab);
+    if (owner != hemlock_executor_get() && owner->unlocked) {
+        hemlock_executor_decref_t *decref =
+          (hemlock_executor_decref_t *)malloc(sizeof(hemlock_executor_decref_t));
+        assert(decref != NULL);
+        decref->user_data = user_data;
+        decref->next = atomic_load_explicit(&owner->decrefs, memory_order_relaxed);
+        while (!atomic_compare_exchange_weak_explicit(&owner->decrefs, &decref->next, decref,
+          memory_order_release, memory_order_relaxed));
+    } else {
+        hemlock_user_data_decref(user_data, &owner->ioring);
+    }
 
     return Val_unit;
 }
@@ -61,22 +709,149 @@ hemlock_basis_executor_user_data_pp(value a_fd, value a_user_data) {
 // hemlock_basis_executor_complete_inner: !&Basis.File.{Open|Close|Write}.t >{os}-> int
 CAMLprim value
 hemlock_basis_executor_complete_inner(value a_user_data) {
+    CAMLparam1(a_user_data);
+    hemlock_user_data_t *user_data = (hemlock_user_data_t *)Int64_val(a_user_data);
+    hemlock_ioring_t *ioring = &hemlock_executor_get()->ioring;
+
+    hemlock_executor_unlocked_waits_begin(ioring);
+    int64_t res = hemlock_ioring_user_data_complete(user_data, ioring);
+    hemlock_executor_unlocked_waits_end(ioring);
+
+    CAMLreturn(caml_copy_int64(res));
+}
+
+// hemlock_basis_executor_is_complete_inner: &Basis.File.{Open|Close|Read|Write}.t -> bool
+CAMLprim value
+hemlock_basis_executor_is_complete_inner(value a_user_data) {
     hemlock_user_data_t *user_data = (hemlock_user_data_t *)Int64_val(a_user_data);
 
-    int64_t res = hemlock_ioring_user_data_complete(user_data, &hemlock_executor_get()->ioring);
+    return Val_bool(hemlock_user_data_is_complete(user_data));
+}
+
+// Cancel `a_user_data`'s operation, if it is not yet complete. The operation still completes, with
+// `ECANCELED` if the cancellation took effect in time. Operations can only be cancelled via the
+// ioring they were submitted to, so `EINVAL` is returned if another executor owns `a_user_data`.
+//
+// hemlock_basis_executor_cancel_inner: &Basis.File.{Read|Pread|Write|Writev}.t >{os}-> int
+CAMLprim value
+hemlock_basis_executor_cancel_inner(value a_user_data) {
+    hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
+    hemlock_user_data_t *user_data = (hemlock_user_data_t *)Int64_val(a_user_data);
+    hemlock_executor_t *executor = hemlock_executor_get();
+
+    if (hemlock_executor_of_slab(user_data->slab) != executor) {
+        HEMLOCK_OE(oe, EINVAL);
+    }
+    HEMLOCK_OE(oe, hemlock_ioring_cancel_submit(user_data, &executor->ioring));
+
+LABEL_OUT:
+    return caml_copy_int64((uint64_t)oe);
+}
+
+// Reap CQEs until at least `n` of `a_user_datas` are complete, or until `timeout_ns` (if
+// non-negative) elapses. Expiry of the timeout is not an error; the caller distinguishes complete
+// from pending user data via `hemlock_basis_executor_is_complete_inner`.
+//
+// hemlock_basis_executor_wait_inner:
+    // uns -> sint -> &Basis.File.{Open|Close|Read|Write}.t array >{os}-> int
+CAMLprim value
+hemlock_basis_executor_wait_inner(value a_n, value a_timeout_ns, value a_user_datas) {
+    CAMLparam1(a_user_datas);
+    hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
+    hemlock_ioring_t *ioring = &hemlock_executor_get()->ioring;
+    uint64_t n = Int64_val(a_n);
+    int64_t timeout_ns = Int64_val(a_timeout_ns);
+    uint64_t n_user_datas = Wosize_val(a_user_datas);
+    int64_t deadline_ns = (timeout_ns < 0) ? -1 : hemlock_basis_executor_now_ns() + timeout_ns;
+
+    if (n > n_user_datas) {
+        n = n_user_datas;
+    }
+    while (true) {
+        uint64_t n_complete = 0;
+        for (uint64_t i = 0; i < n_user_datas; i++) {
+            hemlock_user_data_t *user_data =
+              (hemlock_user_data_t *)Int64_val(Field(a_user_datas, i));
+            if (hemlock_user_data_is_complete(user_data)) {
+                n_complete++;
+            }
+        }
+        if (n_complete >= n) {
+            break;
+        }
+
+        int64_t remaining_ns = -1;
+        if (deadline_ns >= 0) {
+            remaining_ns = deadline_ns - hemlock_basis_executor_now_ns();
+            if (remaining_ns <= 0) {
+                break;
+            }
+        }
+        // Unrelated CQEs may be reaped along the way, so wait for no more than the shortfall.
+        uint64_t min_complete = n - n_complete;
+        if (min_complete > UINT32_MAX) {
+            min_complete = UINT32_MAX;
+        }
+        hemlock_executor_unlocked_waits_begin(ioring);
+        oe = hemlock_ioring_reap((uint32_t)min_complete, remaining_ns, ioring);
+        hemlock_executor_unlocked_waits_end(ioring);
+        // Timeouts and interruptions merely end this wait; completion is rechecked above.
+        if (oe == HEMLOCK_OE_NONE || (int)oe == ETIME || (int)oe == EINTR) {
+            oe = HEMLOCK_OE_NONE;
+        } else {
+            goto LABEL_OUT;
+        }
+    }
 
-    return caml_copy_int64(res);
+LABEL_OUT:
+    CAMLreturn(caml_copy_int64((uint64_t)oe));
+}
+
+// hemlock_basis_executor_poll_inner: unit >{os}-> int
+CAMLprim value
+hemlock_basis_executor_poll_inner(value a_unit) {
+    hemlock_opt_error_t oe = hemlock_ioring_poll(&hemlock_executor_get()->ioring);
+
+    return caml_copy_int64((uint64_t)oe);
+}
+
+// Submission results are negated errnos, as for completions, so that callers can distinguish them
+// from non-negative results.
+static int64_t
+hemlock_basis_executor_submit_value(hemlock_opt_error_t oe) {
+    return (oe > 0) ? -(int64_t)oe : (int64_t)oe;
 }
 
 CAMLprim value
 hemlock_basis_executor_submit_out(hemlock_opt_error_t oe, hemlock_user_data_t *user_data) {
     value a_ret = caml_alloc_tuple(2);
-    Store_field(a_ret, 0, caml_copy_int64((uint64_t)oe));
+    Store_field(a_ret, 0, caml_copy_int64(hemlock_basis_executor_submit_value(oe)));
     Store_field(a_ret, 1, caml_copy_int64((uint64_t)user_data));
 
     return a_ret;
 }
 
+// Like `hemlock_basis_executor_submit_out`, but for the `n` user_data of a chain of operations.
+CAMLprim value
+hemlock_basis_executor_chain_submit_out(
+    hemlock_opt_error_t oe, hemlock_user_data_t **user_datas, size_t n
+) {
+    CAMLparam0();
+    CAMLlocal3(a_ret, a_user_datas, a_elm);
+
+    a_user_datas = caml_alloc_tuple(n);
+    for (size_t i = 0; i < n; i++) {
+        a_elm = caml_copy_int64((oe == HEMLOCK_OE_NONE) ? (uint64_t)user_datas[i] : 0);
+        Store_field(a_user_datas, i, a_elm);
+    }
+    a_ret = caml_alloc_tuple(2);
+    a_elm = caml_copy_int64(hemlock_basis_executor_submit_value(oe));
+    Store_field(a_ret, 0, a_elm);
+    Store_field(a_ret, 1, a_user_datas);
+
+    CAMLreturn(a_ret);
+}
+
 // hemlock_basis_executor_nop_submit_inner: unit >{os}-> (int * &Basis.File.Nop.t)
 CAMLprim value
 hemlock_basis_executor_nop_submit_inner(value a_unit) {
@@ -89,10 +864,82 @@ LABEL_OUT:
     return hemlock_basis_executor_submit_out(oe, user_data);
 }
 
-// hemlock_basis_executor_setup_inner: unit >{os}-> int
+// Modifications to Basis.Executor.Conf.t must be reflected here.
+static void
+hemlock_executor_conf_of_value(hemlock_ioring_conf_t *conf, value a_conf) {
+    *conf = hemlock_ioring_conf_default;
+    conf->sq_entries = Int64_val(Field(a_conf, 0));
+    conf->cq_entries = Int64_val(Field(a_conf, 1));
+    conf->flags = 0;
+    if (Is_block(Field(a_conf, 2))) {
+        conf->flags |= IORING_SETUP_SQPOLL;
+        conf->sq_thread_idle = Int64_val(Field(Field(a_conf, 2), 0));
+    }
+    if (Bool_val(Field(a_conf, 3))) {
+        conf->flags |= IORING_SETUP_COOP_TASKRUN;
+    }
+    if (Bool_val(Field(a_conf, 4))) {
+        conf->flags |= IORING_SETUP_SINGLE_ISSUER;
+    }
+    if (Bool_val(Field(a_conf, 5))) {
+        conf->flags |= IORING_SETUP_DEFER_TASKRUN;
+    }
+    if (Bool_val(Field(a_conf, 6))) {
+        conf->flags |= IORING_SETUP_ATTACH_WQ;
+    }
+    conf->iowq_max_workers[0] = Int64_val(Field(a_conf, 7));
+    conf->iowq_max_workers[1] = Int64_val(Field(a_conf, 8));
+}
+
+// hemlock_basis_executor_setup_inner: Basis.Executor.Conf.t >{os}-> int
 CAMLprim value
-hemlock_basis_executor_setup_inner(value a_unit) {
-    return caml_copy_int64(hemlock_executor_setup(hemlock_executor_get()));
+hemlock_basis_executor_setup_inner(value a_conf) {
+    hemlock_ioring_conf_t conf;
+    hemlock_executor_conf_of_value(&conf, a_conf);
+
+    hemlock_executor_t *executor = hemlock_executor_get();
+    if (executor->ioring.vm == NULL) {
+        return caml_copy_int64(hemlock_executor_setup(executor, &conf));
+    } else {
+        return caml_copy_int64(hemlock_executor_reconfigure(executor, &conf));
+    }
+}
+
+// hemlock_basis_executor_conf_inner: unit >{os}-> Basis.Executor.Conf.t
+CAMLprim value
+hemlock_basis_executor_conf_inner(value a_unit) {
+    CAMLparam1(a_unit);
+    CAMLlocal2(a_conf, a_sqpoll_idle);
+    hemlock_ioring_conf_t *conf = &hemlock_executor_get()->ioring.conf;
+
+    a_sqpoll_idle = Val_none;
+    if (conf->flags & IORING_SETUP_SQPOLL) {
+        a_sqpoll_idle = caml_alloc_tuple(1);
+        Store_field(a_sqpoll_idle, 0, caml_copy_int64(conf->sq_thread_idle));
+    }
+
+    a_conf = caml_alloc_tuple(9);
+    Store_field(a_conf, 0, caml_copy_int64(conf->sq_entries));
+    Store_field(a_conf, 1, caml_copy_int64(conf->cq_entries));
+    Store_field(a_conf, 2, a_sqpoll_idle);
+    Store_field(a_conf, 3, Val_bool(conf->flags & IORING_SETUP_COOP_TASKRUN));
+    Store_field(a_conf, 4, Val_bool(conf->flags & IORING_SETUP_SINGLE_ISSUER));
+    Store_field(a_conf, 5, Val_bool(conf->flags & IORING_SETUP_DEFER_TASKRUN));
+    Store_field(a_conf, 6, Val_bool(conf->flags & IORING_SETUP_ATTACH_WQ));
+    Store_field(a_conf, 7, caml_copy_int64(conf->iowq_max_workers[0]));
+    Store_field(a_conf, 8, caml_copy_int64(conf->iowq_max_workers[1]));
+
+    CAMLreturn(a_conf);
+}
+
+// hemlock_basis_executor_iowq_max_workers_inner: uns -> uns >{os}-> int
+CAMLprim value
+hemlock_basis_executor_iowq_max_workers_inner(value a_bounded, value a_unbounded) {
+    uint32_t max_workers[2] = {Int64_val(a_bounded), Int64_val(a_unbounded)};
+    hemlock_opt_error_t oe =
+      hemlock_ioring_iowq_max_workers(&hemlock_executor_get()->ioring, max_workers);
+
+    return caml_copy_int64((uint64_t)oe);
 }
 
 // hemlock_basis_executor_teardown_inner: unit >{os}-> unit
@@ -129,3 +976,1013 @@ hemlock_basis_executor_ioring_pp(value a_fd) {
 
     return Val_unit;
 }
+
+// hemlock_basis_executor_user_data_slab_pp: Basis.File.t >{os}-> unit
+CAMLprim value
+hemlock_basis_executor_user_data_slab_pp(value a_fd) {
+    int fd = Int64_val(a_fd);
+    hemlock_user_data_slab_pp(fd, 0, &hemlock_executor_get()->slab);
+
+    return Val_unit;
+}
+
+// hemlock_basis_executor_user_data_slab_inner: unit -> uns array
+//
+// Statistics of the current executor's user_data slab, in the order
+// `[|n_slabs; n_allocs; n_live; n_live_max|]`.
+CAMLprim value
+hemlock_basis_executor_user_data_slab_inner(value a_unit) {
+    CAMLparam1(a_unit);
+    CAMLlocal1(a_fields);
+    hemlock_user_data_slab_t const *slab = &hemlock_executor_get()->slab;
+
+    int64_t fields[] = {
+        slab->n_slabs,
+        slab->n_allocs,
+        slab->n_live,
+        slab->n_live_max,
+    };
+    size_t n_fields = sizeof(fields) / sizeof(fields[0]);
+    a_fields = caml_alloc(n_fields, 0);
+    for (size_t i = 0; i < n_fields; i++) {
+        Store_field(a_fields, i, caml_copy_int64(fields[i]));
+    }
+
+    CAMLreturn(a_fields);
+}
+
+// hemlock_basis_executor_ncpus_inner: unit >{os}-> uns
+CAMLprim value
+hemlock_basis_executor_ncpus_inner(value a_unit) {
+    cpu_set_t cpus;
+    if (sched_getaffinity(0, sizeof(cpu_set_t), &cpus) != 0) {
+        return caml_copy_int64(1);
+    }
+
+    return caml_copy_int64(CPU_COUNT(&cpus));
+}
+
+// hemlock_basis_executor_length_inner: unit -> uns
+CAMLprim value
+hemlock_basis_executor_length_inner(value a_unit) {
+    return caml_copy_int64(hemlock_executors_length());
+}
+
+// hemlock_basis_executor_id_inner: unit -> uns
+CAMLprim value
+hemlock_basis_executor_id_inner(value a_unit) {
+    return caml_copy_int64(hemlock_executor_get()->id);
+}
+
+// Wait in the executor's ioring for completions or a doorbell, unless `is_ready(executor, env)`
+// reports that there is already something to do. Waiting is limited to `timeout_ns` if it is
+// non-negative. `idle` is the idle state to advertise meanwhile. Must be called with the runtime
+// lock held, which is released while waiting.
+static void
+hemlock_executor_sleep(
+    hemlock_executor_t *executor,
+    uint8_t idle,
+    bool (*is_ready)(hemlock_executor_t *, void *),
+    void *env,
+    int64_t timeout_ns
+) {
+    hemlock_ioring_t *ioring = &executor->ioring;
+
+    atomic_store_explicit(&executor->idle, idle, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    if (!is_ready(executor, env)) {
+        // Errors (e.g. `EINTR`) amount to spurious wakeups, which callers tolerate by re-checking
+        // whether there is something to do.
+        hemlock_executor_unlocked_waits_begin(ioring);
+        hemlock_ioring_reap(1, timeout_ns, ioring);
+        hemlock_executor_unlocked_waits_end(ioring);
+    }
+    atomic_store_explicit(&executor->idle, HEMLOCK_EXECUTOR_BUSY, memory_order_relaxed);
+}
+
+// Run the executor's actors until none are runnable, and then reap the halted ones. Actors run no
+// OCaml code, so the runtime lock is released meanwhile, which lets actors on different executors
+// run in parallel. Must be called with the runtime lock held.
+static void
+hemlock_executor_actors_run(hemlock_executor_t *executor) {
+    hemlock_sched_t *sched = &executor->sched;
+
+    executor->unlocked = true;
+    caml_enter_blocking_section();
+    hemlock_sched_immigrate(sched);
+    hemlock_sched_run(sched);
+    hemlock_sched_reap(sched);
+    caml_leave_blocking_section();
+    executor->unlocked = false;
+    hemlock_executor_decrefs(executor);
+}
+
+static bool
+hemlock_executor_actors_is_ready(hemlock_executor_t *executor, void *env) {
+    return executor->sched.n_runnable > 0 || hemlock_sched_is_handed(&executor->sched);
+}
+
+// Run the executor's actors as for `hemlock_executor_actors_run`, and then wait until all actors it
+// spawned that were migrated to other executors have halted and been handed back.
+static void
+hemlock_executor_actors_join(hemlock_executor_t *executor) {
+    while (true) {
+        hemlock_executor_actors_run(executor);
+        if (executor->sched.n_abroad == 0 && !hemlock_executor_actors_is_ready(executor, NULL)) {
+            break;
+        }
+        hemlock_executor_sleep(executor, HEMLOCK_EXECUTOR_IDLE, hemlock_executor_actors_is_ready,
+          NULL, -1);
+    }
+}
+
+static uint64_t
+hemlock_executor_random(hemlock_executor_t *executor) {
+    // xorshift64.
+    uint64_t x = executor->rng;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    executor->rng = x;
+
+    return x;
+}
+
+// Wake an idle pool executor other than `waker` that would steal work, if any. The main executor
+// never steals, so it is not considered.
+static void
+hemlock_executor_wake_thief(hemlock_executor_t *waker) {
+    size_t n = hemlock_executors_length();
+    if (n <= 1) {
+        return;
+    }
+    size_t start = hemlock_executor_random(waker) % (n - 1);
+    for (size_t i = 0; i < n - 1; i++) {
+        hemlock_executor_t *thief = hemlock_executors_get(1 + (start + i) % (n - 1));
+        if (atomic_load_explicit(&thief->idle, memory_order_relaxed) ==
+          HEMLOCK_EXECUTOR_IDLE_THIEF && hemlock_executor_wake(thief)) {
+            break;
+        }
+    }
+}
+
+// Look for a task to steal, subject to quantum hysteresis: the oldest (i.e. most basal) task of a
+// victim selected at random becomes the steal candidate, which is stolen only if it is still the
+// victim's oldest task a full quantum later. This assures that in the common case, work is only
+// stolen if there is more than a quantum of it. Returns the stolen task, or NULL, in which case
+// `*timeout_ns` is set to how long to wait before looking again, or -1 if there is nothing to
+// steal.
+static hemlock_executor_task_t *
+hemlock_executor_steal(hemlock_executor_t *thief, int64_t *timeout_ns) {
+    int64_t now_ns = hemlock_basis_executor_now_ns();
+    *timeout_ns = -1;
+
+    hemlock_executor_t *victim = thief->victim;
+    if (victim != NULL) {
+        int64_t remaining_ns = thief->victim_ns + HEMLOCK_EXECUTOR_QUANTUM_NS - now_ns;
+        if (remaining_ns > 0) {
+            *timeout_ns = remaining_ns;
+            return NULL;
+        }
+        thief->victim = NULL;
+        if (hemlock_wsdeque_steal(&victim->deque, thief->victim_top, thief->victim_task)) {
+            thief->n_stolen++;
+            int64_t top;
+            if (hemlock_wsdeque_peek(&victim->deque, &top) != NULL) {
+                // Let another idle executor have a go at the victim's remaining tasks.
+                hemlock_executor_wake_thief(thief);
+            }
+            return (hemlock_executor_task_t *)thief->victim_task;
+        }
+    }
+
+    size_t n = hemlock_executors_length();
+    size_t start = hemlock_executor_random(thief) % n;
+    for (size_t i = 0; i < n; i++) {
+        victim = hemlock_executors_get((start + i) % n);
+        if (victim == thief) {
+            continue;
+        }
+        void *task = hemlock_wsdeque_peek(&victim->deque, &thief->victim_top);
+        if (task != NULL) {
+            thief->victim = victim;
+            thief->victim_task = task;
+            thief->victim_ns = now_ns;
+            *timeout_ns = HEMLOCK_EXECUTOR_QUANTUM_NS;
+            break;
+        }
+    }
+
+    return NULL;
+}
+
+// Run a stolen task and hand its result back to its owner. The task may be freed as soon as it is
+// marked done.
+static void
+hemlock_executor_task_run(hemlock_executor_task_t *task) {
+    hemlock_executor_t *owner = task->owner;
+    value a_result = caml_callback_exn(task->closure, Val_unit);
+    task->raised = Is_exception_result(a_result);
+    caml_modify_generational_global_root(&task->result,
+      task->raised ? Extract_exception(a_result) : a_result);
+    atomic_store_explicit(&task->state, HEMLOCK_EXECUTOR_TASK_DONE, memory_order_release);
+    hemlock_executor_wake(owner);
+}
+
+static bool
+hemlock_executor_task_is_done(hemlock_executor_t *executor, void *env) {
+    hemlock_executor_task_t *task = (hemlock_executor_task_t *)env;
+    return atomic_load_explicit(&task->state, memory_order_acquire) == HEMLOCK_EXECUTOR_TASK_DONE;
+}
+
+static bool
+hemlock_executor_jobs_is_ready(hemlock_executor_t *executor, void *env) {
+    if (hemlock_executor_actors_is_ready(executor, env)) {
+        return true;
+    }
+    pthread_mutex_lock(&executor->mutex);
+    bool is_ready = executor->jobs_head != NULL || executor->stopping;
+    pthread_mutex_unlock(&executor->mutex);
+
+    return is_ready;
+}
+
+// Pop the next queued closure, or return NULL if there is none. `*stopping` is set if the executor
+// has been asked to stop once its queue is empty.
+static hemlock_executor_job_t *
+hemlock_executor_job_pop(hemlock_executor_t *executor, bool *stopping) {
+    pthread_mutex_lock(&executor->mutex);
+    *stopping = executor->stopping;
+    hemlock_executor_job_t *job = executor->jobs_head;
+    if (job != NULL) {
+        executor->jobs_head = job->next;
+        if (executor->jobs_head == NULL) {
+            executor->jobs_tail = NULL;
+        }
+    }
+    pthread_mutex_unlock(&executor->mutex);
+
+    return job;
+}
+
+// Size of a pool executor record allocation, rounded up to whole pages so that the record can be
+// moved to its executor's NUMA node without moving unrelated data.
+static size_t
+hemlock_executor_pool_size(void) {
+    size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+
+    return (sizeof(hemlock_executor_t) + page_size - 1) & ~(page_size - 1);
+}
+
+static hemlock_opt_error_t
+hemlock_executor_thread_setup(hemlock_executor_t *executor, hemlock_ioring_conf_t const *conf) {
+    hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
+
+    if (executor->cpu >= 0) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(executor->cpu, &cpus);
+        if (sched_setaffinity(0, sizeof(cpu_set_t), &cpus) != 0) {
+            HEMLOCK_OE(oe, errno);
+        }
+        // Prefer the local node for memory allocated by this thread from here on, including the
+        // ioring, and move the executor record and mailbox ring, which the main executor allocated,
+        // to the local node.
+        hemlock_topology_t const *topology = hemlock_topology_get();
+        int node = topology->node[executor->cpu];
+        hemlock_topology_prefer(topology, node);
+        hemlock_topology_move(topology, node, executor, hemlock_executor_pool_size());
+        hemlock_topology_move(topology, node, executor->mailbox.slots,
+          sizeof(hemlock_mailbox_slot_t) * HEMLOCK_MAILBOX_RING_SIZE);
+    }
+    // The ioring is created by the executor thread, so that the kernel associates it with this
+    // thread, e.g. for `IORING_SETUP_SINGLE_ISSUER`, and so that its memory is local to the thread.
+    HEMLOCK_OE(oe, hemlock_executor_ioring_setup(executor, conf));
+    hemlock_executor_stats_setup(executor);
+
+LABEL_OUT:
+    return oe;
+}
+
+typedef struct {
+    hemlock_executor_t *executor;
+    hemlock_ioring_conf_t conf;
+} hemlock_executor_thread_arg_t;
+
+static void *
+hemlock_executor_thread(void *arg) {
+    hemlock_executor_thread_arg_t *thread_arg = (hemlock_executor_thread_arg_t *)arg;
+    hemlock_executor_t *executor = thread_arg->executor;
+    executor_pool = executor;
+
+    caml_c_thread_register();
+    hemlock_opt_error_t oe = hemlock_executor_thread_setup(executor, &thread_arg->conf);
+    free(thread_arg);
+    pthread_mutex_lock(&executor->mutex);
+    executor->setup_oe = oe;
+    executor->setup_done = true;
+    pthread_cond_broadcast(&executor->cond);
+    pthread_mutex_unlock(&executor->mutex);
+    if (oe != HEMLOCK_OE_NONE) {
+        caml_c_thread_unregister();
+        return NULL;
+    }
+
+    // The runtime lock is held throughout, except while sleeping or running actors. Reaping
+    // releases pins, which requires the lock.
+    caml_acquire_runtime_system();
+    while (true) {
+        bool stopping;
+        hemlock_executor_job_t *job = hemlock_executor_job_pop(executor, &stopping);
+        if (job != NULL) {
+            value a_result = caml_callback_exn(job->closure, Val_unit);
+            caml_remove_generational_global_root(&job->closure);
+            free(job);
+            if (Is_exception_result(a_result)) {
+                caml_fatal_uncaught_exception(Extract_exception(a_result));
+            }
+            hemlock_executor_stats_sample(executor, hemlock_basis_executor_now_ns(), false);
+        } else if (hemlock_executor_actors_is_ready(executor, NULL)) {
+            hemlock_executor_actors_run(executor);
+        } else if (stopping) {
+            break;
+        } else {
+            int64_t timeout_ns;
+            hemlock_executor_task_t *task = hemlock_executor_steal(executor, &timeout_ns);
+            if (task != NULL) {
+                hemlock_executor_task_run(task);
+            } else {
+                hemlock_executor_sleep(executor, HEMLOCK_EXECUTOR_IDLE_THIEF,
+                  hemlock_executor_jobs_is_ready, NULL, timeout_ns);
+            }
+        }
+    }
+
+    // Complete I/O left in flight by the closures, so that the ioring can be torn down. Teardown is
+    // left to `hemlock_executor_pool_join`, since other executor threads may still ring the
+    // doorbell until they have stopped too.
+    hemlock_ioring_t *ioring = &executor->ioring;
+    while (ioring->n_inflight > 0 && hemlock_ioring_reap(1, -1, ioring) == HEMLOCK_OE_NONE);
+    caml_release_runtime_system();
+    caml_c_thread_unregister();
+
+    return NULL;
+}
+
+static hemlock_executor_t *
+hemlock_executor_pool_get(size_t i) {
+    hemlock_executor_t *executor = hemlock_executor_pool[i];
+    if (executor == NULL) {
+        executor = (hemlock_executor_t *)aligned_alloc((size_t)sysconf(_SC_PAGESIZE),
+          hemlock_executor_pool_size());
+        assert(executor != NULL);
+        memset(executor, 0, sizeof(hemlock_executor_t));
+        hemlock_user_data_slab_setup(&executor->slab);
+        hemlock_mailbox_setup(&executor->mailbox);
+        hemlock_wsdeque_setup(&executor->deque);
+        hemlock_executor_sched_setup(executor);
+        // Distinct seeds keep thieves from probing victims in lockstep.
+        executor->rng = HEMLOCK_EXECUTOR_RNG_SEED * (i + 1);
+        pthread_mutex_init(&executor->mutex, NULL);
+        pthread_cond_init(&executor->cond, NULL);
+        hemlock_executor_pool[i] = executor;
+    }
+    executor->jobs_head = NULL;
+    executor->jobs_tail = NULL;
+    executor->stopping = false;
+    atomic_store_explicit(&executor->idle, HEMLOCK_EXECUTOR_BUSY, memory_order_relaxed);
+    executor->setup_done = false;
+    executor->setup_oe = HEMLOCK_OE_NONE;
+
+    return executor;
+}
+
+// Stop and join pool executors `[1,n]`, after they have run all queued closures, and then tear down
+// their iorings.
+static void
+hemlock_executor_pool_join(size_t n) {
+    for (size_t i = 1; i <= n; i++) {
+        hemlock_executor_t *executor = hemlock_executor_pool[i];
+        pthread_mutex_lock(&executor->mutex);
+        executor->stopping = true;
+        pthread_mutex_unlock(&executor->mutex);
+        hemlock_executor_wake(executor);
+    }
+    caml_enter_blocking_section();
+    for (size_t i = 1; i <= n; i++) {
+        pthread_join(hemlock_executor_pool[i]->thread, NULL);
+    }
+    caml_leave_blocking_section();
+    for (size_t i = 1; i <= n; i++) {
+        hemlock_executor_ioring_teardown(hemlock_executor_pool[i]);
+    }
+}
+
+// Start `n` pool executor threads, each with its own ioring configured according to `a_conf`. Pool
+// executors occupy indices `[1,n]` of the lookup array. Executors claim CPUs to pin their threads
+// on according to `a_placement`, starting with the main executor, which claims a CPU without being
+// pinned to it.
+//
+// hemlock_basis_executor_pool_start_inner: Basis.Executor.Conf.t -> Basis.Executor.Placement.t
+//   -> uns >{os}-> int
+CAMLprim value
+hemlock_basis_executor_pool_start_inner(value a_conf, value a_placement, value a_n) {
+    hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
+    hemlock_topology_placement_t placement = (hemlock_topology_placement_t)Int_val(a_placement);
+    size_t n = Int64_val(a_n);
+    size_t n_started = 0;
+
+    hemlock_ioring_conf_t conf;
+    hemlock_executor_conf_of_value(&conf, a_conf);
+    if (hemlock_executor_pool_n != 0) {
+        oe = EBUSY;
+        goto LABEL_OUT;
+    }
+    // The main executor must be live at index 0, and the pool must fit in the lookup array.
+    if (hemlock_executors_length() != 1 || n >= HEMLOCK_EXECUTORS_MAX) {
+        oe = EINVAL;
+        goto LABEL_OUT;
+    }
+
+    hemlock_topology_t const *topology = hemlock_topology_get();
+    hemlock_topology_claims_t claims;
+    hemlock_topology_claims_setup(&claims);
+    uint64_t rng = hemlock_executor_random(hemlock_executor_get());
+    (void)hemlock_topology_claim(topology, &claims, placement, &rng);
+
+    for (size_t i = 1; i <= n; i++) {
+        hemlock_executor_t *executor = hemlock_executor_pool_get(i);
+        executor->cpu = hemlock_topology_claim(topology, &claims, placement, &rng);
+
+        hemlock_executor_thread_arg_t *thread_arg =
+          (hemlock_executor_thread_arg_t *)malloc(sizeof(hemlock_executor_thread_arg_t));
+        assert(thread_arg != NULL);
+        thread_arg->executor = executor;
+        thread_arg->conf = conf;
+        int error = pthread_create(&executor->thread, NULL, hemlock_executor_thread, thread_arg);
+        if (error != 0) {
+            free(thread_arg);
+            HEMLOCK_OE(oe, error);
+        }
+        n_started++;
+
+        // The thread must acquire the runtime lock to register itself.
+        caml_enter_blocking_section();
+        pthread_mutex_lock(&executor->mutex);
+        while (!executor->setup_done) {
+            pthread_cond_wait(&executor->cond, &executor->mutex);
+        }
+        pthread_mutex_unlock(&executor->mutex);
+        caml_leave_blocking_section();
+        if (executor->setup_oe != HEMLOCK_OE_NONE) {
+            // The thread has already exited.
+            pthread_join(executor->thread, NULL);
+            n_started--;
+            HEMLOCK_OE(oe, executor->setup_oe);
+        }
+        hemlock_executors_push(executor);
+    }
+    hemlock_executor_pool_n = n;
+
+LABEL_OUT:
+    if (oe != HEMLOCK_OE_NONE && n_started > 0) {
+        hemlock_executors_truncate(1);
+        hemlock_executor_pool_join(n_started);
+    }
+    return caml_copy_int64((uint64_t)oe);
+}
+
+// hemlock_basis_executor_pool_stop_inner: unit >{os}-> unit
+CAMLprim value
+hemlock_basis_executor_pool_stop_inner(value a_unit) {
+    if (hemlock_executor_pool_n > 0) {
+        hemlock_executors_truncate(1);
+        hemlock_executor_pool_join(hemlock_executor_pool_n);
+        hemlock_executor_pool_n = 0;
+    }
+
+    return Val_unit;
+}
+
+// hemlock_basis_executor_pool_run_inner: uns -> (unit -> unit) >{os}-> unit
+CAMLprim value
+hemlock_basis_executor_pool_run_inner(value a_i, value a_closure) {
+    size_t i = Int64_val(a_i);
+    assert(i >= 1 && i <= hemlock_executor_pool_n);
+    hemlock_executor_t *executor = hemlock_executor_pool[i];
+
+    hemlock_executor_job_t *job = (hemlock_executor_job_t *)malloc(sizeof(hemlock_executor_job_t));
+    assert(job != NULL);
+    job->closure = a_closure;
+    job->next = NULL;
+    caml_register_generational_global_root(&job->closure);
+
+    pthread_mutex_lock(&executor->mutex);
+    if (executor->jobs_tail == NULL) {
+        executor->jobs_head = job;
+    } else {
+        executor->jobs_tail->next = job;
+    }
+    executor->jobs_tail = job;
+    pthread_mutex_unlock(&executor->mutex);
+    hemlock_executor_wake(executor);
+
+    return Val_unit;
+}
+
+static void
+hemlock_executor_mailbox_receive(hemlock_message_t *message, void *env) {
+    hemlock_executor_t *executor = (hemlock_executor_t *)env;
+    if (executor->n_received == executor->received_max) {
+        executor->received_max = (executor->received_max == 0) ? 64 : executor->received_max * 2;
+        executor->received = (hemlock_executor_received_t *)realloc(executor->received,
+          sizeof(hemlock_executor_received_t) * executor->received_max);
+        assert(executor->received != NULL);
+    }
+    hemlock_executor_received_t *received = &executor->received[executor->n_received];
+    received->payload = message->payload;
+    received->latency_ns = hemlock_basis_executor_now_ns() - message->sent_ns;
+    executor->n_received++;
+}
+
+static void
+hemlock_executor_mailbox_reclaim(hemlock_message_t *message, void *env) {
+    free(message);
+}
+
+static bool
+hemlock_executor_mailbox_is_ready(hemlock_executor_t *executor, void *env) {
+    return !hemlock_mailbox_is_empty(&executor->mailbox);
+}
+
+// Receive messages until at least `n` are pending consumption, or until all of this executor's sent
+// messages have been reclaimed if `n` is 0. Sleeps in the ioring whenever the mailbox is empty,
+// until another executor rings the doorbell upon sending to it.
+static void
+hemlock_executor_mailbox_spin(size_t n) {
+    hemlock_executor_t *executor = hemlock_executor_get();
+
+    while (true) {
+        hemlock_executor_receive(hemlock_executor_mailbox_receive, hemlock_executor_mailbox_reclaim,
+          executor);
+        if ((n == 0) ? (executor->n_unacked == 0) : (executor->n_received >= n)) {
+            break;
+        }
+        hemlock_executor_sleep(executor, HEMLOCK_EXECUTOR_IDLE, hemlock_executor_mailbox_is_ready,
+          NULL, -1);
+    }
+}
+
+// hemlock_basis_executor_mailbox_send_inner: uns -> uns -> uns >{os}-> unit
+CAMLprim value
+hemlock_basis_executor_mailbox_send_inner(value a_n, value a_i, value a_payload) {
+    uint64_t n = Int64_val(a_n);
+    hemlock_executor_t *receiver = hemlock_executors_get(Int64_val(a_i));
+    uint64_t payload = Int64_val(a_payload);
+
+    caml_enter_blocking_section();
+    for (uint64_t i = 0; i < n; i++) {
+        hemlock_message_t *message = (hemlock_message_t *)malloc(sizeof(hemlock_message_t));
+        assert(message != NULL);
+        message->payload = payload;
+        message->sent_ns = hemlock_basis_executor_now_ns();
+        hemlock_executor_send(receiver, message);
+    }
+    caml_leave_blocking_section();
+
+    return Val_unit;
+}
+
+// hemlock_basis_executor_mailbox_receive_inner: uns >{os}-> (uns array * uns array)
+CAMLprim value
+hemlock_basis_executor_mailbox_receive_inner(value a_n) {
+    CAMLparam1(a_n);
+    CAMLlocal3(a_payloads, a_latencies, a_ret);
+    size_t n = Int64_val(a_n);
+    hemlock_executor_t *executor = hemlock_executor_get();
+
+    if (n > 0) {
+        hemlock_executor_mailbox_spin(n);
+    }
+    a_payloads = caml_alloc_tuple(n);
+    a_latencies = caml_alloc_tuple(n);
+    for (size_t i = 0; i < n; i++) {
+        Store_field(a_payloads, i, caml_copy_int64(executor->received[i].payload));
+        Store_field(a_latencies, i, caml_copy_int64(executor->received[i].latency_ns));
+    }
+    executor->n_received -= n;
+    memmove(executor->received, &executor->received[n],
+      sizeof(hemlock_executor_received_t) * executor->n_received);
+    a_ret = caml_alloc_tuple(2);
+    Store_field(a_ret, 0, a_payloads);
+    Store_field(a_ret, 1, a_latencies);
+
+    CAMLreturn(a_ret);
+}
+
+// hemlock_basis_executor_mailbox_drain_inner: unit >{os}-> unit
+CAMLprim value
+hemlock_basis_executor_mailbox_drain_inner(value a_unit) {
+    hemlock_executor_mailbox_spin(0);
+
+    return Val_unit;
+}
+
+// hemlock_basis_executor_mailbox_pp: Basis.File.t >{os}-> unit
+CAMLprim value
+hemlock_basis_executor_mailbox_pp(value a_fd) {
+    int fd = Int64_val(a_fd);
+    hemlock_mailbox_pp(fd, 0, &hemlock_executor_get()->mailbox);
+
+    return Val_unit;
+}
+
+// Run `a_f` and `a_g`, potentially in parallel, and return both results. `a_g` is forked as the
+// right continuation: it is pushed onto the executor's deque while `a_f` runs, and then joined,
+// i.e. either popped and run by this executor, or awaited if an idle pool executor stole it in the
+// meantime. If either closure raises an exception, it is re-raised once both are done, preferring
+// that of `a_f`.
+//
+// hemlock_basis_executor_fork2_inner: (unit -> 'a) -> (unit -> 'b) >{os}-> ('a * 'b)
+CAMLprim value
+hemlock_basis_executor_fork2_inner(value a_f, value a_g) {
+    CAMLparam2(a_f, a_g);
+    CAMLlocal3(a_a, a_b, a_ret);
+    hemlock_executor_t *executor = hemlock_executor_get();
+
+    hemlock_executor_task_t *task =
+      (hemlock_executor_task_t *)malloc(sizeof(hemlock_executor_task_t));
+    assert(task != NULL);
+    task->closure = a_g;
+    task->result = Val_unit;
+    task->raised = false;
+    task->owner = executor;
+    atomic_init(&task->state, HEMLOCK_EXECUTOR_TASK_PENDING);
+    caml_register_generational_global_root(&task->closure);
+    caml_register_generational_global_root(&task->result);
+    if (hemlock_wsdeque_push(&executor->deque, task)) {
+        hemlock_executor_wake_thief(executor);
+    }
+
+    // Exception results must not be stored in roots, so extract exceptions immediately.
+    value a_result = caml_callback_exn(a_f, Val_unit);
+    bool f_raised = Is_exception_result(a_result);
+    a_a = f_raised ? Extract_exception(a_result) : a_result;
+
+    bool g_raised;
+    void *popped = hemlock_wsdeque_pop(&executor->deque);
+    if (popped != NULL) {
+        // Forks are joined in LIFO order, so the task is the newest in the deque unless stolen.
+        assert(popped == task);
+        if (f_raised) {
+            g_raised = false;
+            a_b = Val_unit;
+        } else {
+            a_result = caml_callback_exn(task->closure, Val_unit);
+            g_raised = Is_exception_result(a_result);
+            a_b = g_raised ? Extract_exception(a_result) : a_result;
+        }
+    } else {
+        while (!hemlock_executor_task_is_done(executor, task)) {
+            hemlock_executor_sleep(executor, HEMLOCK_EXECUTOR_IDLE, hemlock_executor_task_is_done,
+              task, -1);
+        }
+        g_raised = task->raised;
+        a_b = task->result;
+    }
+    caml_remove_generational_global_root(&task->closure);
+    caml_remove_generational_global_root(&task->result);
+    free(task);
+
+    if (f_raised) {
+        caml_raise(a_a);
+    }
+    if (g_raised) {
+        caml_raise(a_b);
+    }
+    a_ret = caml_alloc_tuple(2);
+    Store_field(a_ret, 0, a_a);
+    Store_field(a_ret, 1, a_b);
+
+    CAMLreturn(a_ret);
+}
+
+// hemlock_basis_executor_wsdeque_pp: Basis.File.t >{os}-> unit
+CAMLprim value
+hemlock_basis_executor_wsdeque_pp(value a_fd) {
+    int fd = Int64_val(a_fd);
+    hemlock_wsdeque_pp(fd, 0, &hemlock_executor_get()->deque);
+
+    return Val_unit;
+}
+
+// hemlock_basis_executor_alignpool_pp: Basis.File.t >{os}-> unit
+CAMLprim value
+hemlock_basis_executor_alignpool_pp(value a_fd) {
+    int fd = Int64_val(a_fd);
+    hemlock_executor_alignpool_pp(fd, 0, &hemlock_executor_get()->alignpool);
+
+    return Val_unit;
+}
+
+// Print the CPU topology and the CPU each live executor is pinned to.
+//
+// hemlock_basis_executor_topology_pp: Basis.File.t >{os}-> unit
+CAMLprim value
+hemlock_basis_executor_topology_pp(value a_fd) {
+    int fd = Int64_val(a_fd);
+    hemlock_topology_pp(fd, 0, hemlock_topology_get());
+    for (size_t i = 0; i < hemlock_executors_length(); i++) {
+        dprintf(fd, "executor %lu: cpu=%d\n", i, hemlock_executors_get(i)->cpu);
+    }
+
+    return Val_unit;
+}
+
+// hemlock_basis_executor_topology_inner: unit -> uns array array
+//
+// CPUs the process may run on, in ascending order, as `[|cpu; node; core|]` triples.
+CAMLprim value
+hemlock_basis_executor_topology_inner(value a_unit) {
+    CAMLparam1(a_unit);
+    CAMLlocal2(a_cpus, a_cpu);
+    hemlock_topology_t const *topology = hemlock_topology_get();
+
+    a_cpus = caml_alloc(topology->n_cpus, 0);
+    for (size_t i = 0; i < topology->n_cpus; i++) {
+        int cpu = topology->cpus[i];
+        a_cpu = caml_alloc(3, 0);
+        Store_field(a_cpu, 0, caml_copy_int64(cpu));
+        Store_field(a_cpu, 1, caml_copy_int64(topology->node[cpu]));
+        Store_field(a_cpu, 2, caml_copy_int64(topology->core[cpu]));
+        Store_field(a_cpus, i, a_cpu);
+    }
+
+    CAMLreturn(a_cpus);
+}
+
+// hemlock_basis_executor_cpu_inner: uns -> sint
+//
+// CPU the live executor with index `a_i` is pinned to, or -1 if it is not pinned.
+CAMLprim value
+hemlock_basis_executor_cpu_inner(value a_i) {
+    return caml_copy_int64(hemlock_executors_get(Int64_val(a_i))->cpu);
+}
+
+// Actor that forwards each message it receives to its partner (`actor->env`) with a payload one
+// less, until the payload reaches 1, and halts upon receiving 0.
+static void
+hemlock_executor_pingpong_actor(hemlock_actor_t *actor) {
+    uint64_t payload;
+    while ((payload = hemlock_actor_receive(actor)) != 0) {
+        if (payload > 1) {
+            hemlock_actor_send((hemlock_actor_t *)actor->env, payload - 1);
+        }
+    }
+}
+
+// Spawn `a_n` (rounded down to even) actors on the current executor, paired off, serve the first
+// `a_n_active` pairs a ball for `a_n_rounds` rounds of ping-pong, run the actors until all balls
+// are dead, and then halt all of them. Returns the number of messages sent.
+//
+// hemlock_basis_executor_actor_pingpong_inner: uns -> uns -> uns >{os}-> uns
+CAMLprim value
+hemlock_basis_executor_actor_pingpong_inner(value a_n, value a_n_active, value a_n_rounds) {
+    size_t n = Int64_val(a_n) & ~(uint64_t)1;
+    size_t n_active = Int64_val(a_n_active);
+    uint64_t n_rounds = Int64_val(a_n_rounds);
+    hemlock_executor_t *executor = hemlock_executor_get();
+    hemlock_sched_t *sched = &executor->sched;
+    uint64_t n_sent = sched->n_sent;
+
+    if (n_active > n / 2) {
+        n_active = n / 2;
+    }
+    hemlock_actor_t **actors = (hemlock_actor_t **)malloc(sizeof(hemlock_actor_t *) * n);
+    assert(n == 0 || actors != NULL);
+    for (size_t i = 0; i < n; i++) {
+        // Partners send to each other, so they must stay together.
+        actors[i] = hemlock_sched_spawn(sched, hemlock_executor_pingpong_actor, NULL);
+        actors[i]->flags |= HEMLOCK_ACTOR_PINNED;
+    }
+    for (size_t i = 0; i < n; i += 2) {
+        actors[i]->env = actors[i + 1];
+        actors[i + 1]->env = actors[i];
+    }
+    if (n_rounds > 0) {
+        for (size_t i = 0; i < n_active; i++) {
+            hemlock_actor_send(actors[2 * i], 2 * n_rounds);
+        }
+    }
+    hemlock_executor_actors_run(executor);
+    for (size_t i = 0; i < n; i++) {
+        hemlock_actor_send(actors[i], 0);
+    }
+    hemlock_executor_actors_run(executor);
+    free(actors);
+
+    return caml_copy_int64(sched->n_sent - n_sent);
+}
+
+// Work done by a spinning actor: the number of work units remaining, and the state of the
+// pseudo-random number generator that each unit advances.
+typedef struct {
+    uint64_t n_units;
+    uint64_t x;
+} hemlock_executor_spin_t;
+
+// Actor that does CPU-bound work, yielding between work units.
+static void
+hemlock_executor_spin_actor(hemlock_actor_t *actor) {
+    hemlock_executor_spin_t *spin = (hemlock_executor_spin_t *)actor->env;
+    for (; spin->n_units > 0; spin->n_units--) {
+        uint64_t x = spin->x;
+        for (size_t i = 0; i < 64; i++) {
+            x ^= x << 13;
+            x ^= x >> 7;
+            x ^= x << 17;
+        }
+        spin->x = x;
+        hemlock_actor_yield(actor);
+    }
+}
+
+// Spawn `a_n` unpinned actors on the current executor, each of which does `a_n_units` units of
+// CPU-bound work, and wait until all of them have halted, wherever they were migrated to. Returns a
+// checksum of the work, which does not depend on where it was done.
+//
+// hemlock_basis_executor_actor_spin_inner: uns -> uns >{os}-> uns
+CAMLprim value
+hemlock_basis_executor_actor_spin_inner(value a_n, value a_n_units) {
+    size_t n = Int64_val(a_n);
+    uint64_t n_units = Int64_val(a_n_units);
+    hemlock_executor_t *executor = hemlock_executor_get();
+
+    hemlock_executor_spin_t *spins =
+      (hemlock_executor_spin_t *)malloc(sizeof(hemlock_executor_spin_t) * n);
+    assert(n == 0 || spins != NULL);
+    for (size_t i = 0; i < n; i++) {
+        spins[i].n_units = n_units;
+        spins[i].x = HEMLOCK_EXECUTOR_RNG_SEED * (i + 1);
+        hemlock_sched_spawn(&executor->sched, hemlock_executor_spin_actor, &spins[i]);
+    }
+    hemlock_executor_actors_join(executor);
+    uint64_t checksum = 0;
+    for (size_t i = 0; i < n; i++) {
+        checksum += spins[i].x;
+    }
+    free(spins);
+
+    return caml_copy_int64(checksum);
+}
+
+// hemlock_basis_executor_sched_pp: Basis.File.t >{os}-> unit
+CAMLprim value
+hemlock_basis_executor_sched_pp(value a_fd) {
+    int fd = Int64_val(a_fd);
+    hemlock_sched_pp(fd, 0, &hemlock_executor_get()->sched);
+
+    return Val_unit;
+}
+
+// hemlock_basis_executor_stats_inner: uns -> Basis.Executor.Stats.t
+CAMLprim value
+hemlock_basis_executor_stats_inner(value a_i) {
+    CAMLparam1(a_i);
+    CAMLlocal1(a_ret);
+    size_t i = Int64_val(a_i);
+    hemlock_executor_t *executor = hemlock_executors_get(i);
+    hemlock_executor_stats_t *stats = &executor->stats;
+
+    if (executor == hemlock_executor_get()) {
+        hemlock_executor_stats_sample(executor, hemlock_basis_executor_now_ns(), true);
+    }
+    // Modifications to Basis.Executor.Stats.t must be reflected here.
+    int64_t sample_ns = atomic_load_explicit(&stats->sample_ns, memory_order_relaxed);
+    int64_t wait_ns = atomic_load_explicit(&stats->wait_ns, memory_order_relaxed);
+    double turn_rate = atomic_load_explicit(&stats->turn_rate, memory_order_relaxed);
+    double cqe_rate = atomic_load_explicit(&stats->cqe_rate, memory_order_relaxed);
+    double idle = atomic_load_explicit(&stats->idle, memory_order_relaxed);
+    uint64_t n_runnable = atomic_load_explicit(&stats->n_runnable, memory_order_relaxed);
+    uint64_t n_inflight = atomic_load_explicit(&stats->n_inflight, memory_order_relaxed);
+    uint64_t n_turns = atomic_load_explicit(&stats->n_turns, memory_order_relaxed);
+    uint64_t n_cqes = atomic_load_explicit(&stats->n_cqes, memory_order_relaxed);
+    uint64_t idle_ns = atomic_load_explicit(&stats->idle_ns, memory_order_relaxed);
+    uint64_t n_migrations = atomic_load_explicit(&stats->n_migrations, memory_order_relaxed);
+    uint64_t n_rejections = atomic_load_explicit(&stats->n_rejections, memory_order_relaxed);
+    a_ret = caml_alloc_tuple(12);
+    Store_field(a_ret, 0, caml_copy_int64(sample_ns));
+    Store_field(a_ret, 1, caml_copy_int64(wait_ns));
+    Store_field(a_ret, 2, caml_copy_double(turn_rate));
+    Store_field(a_ret, 3, caml_copy_double(cqe_rate));
+    Store_field(a_ret, 4, caml_copy_double(idle));
+    Store_field(a_ret, 5, caml_copy_int64(n_runnable));
+    Store_field(a_ret, 6, caml_copy_int64(n_inflight));
+    Store_field(a_ret, 7, caml_copy_int64(n_turns));
+    Store_field(a_ret, 8, caml_copy_int64(n_cqes));
+    Store_field(a_ret, 9, caml_copy_int64(idle_ns));
+    Store_field(a_ret, 10, caml_copy_int64(n_migrations));
+    Store_field(a_ret, 11, caml_copy_int64(n_rejections));
+
+    CAMLreturn(a_ret);
+}
+
+// Thread that periodically dumps the load statistics of all live executors, one line per executor,
+// until stopped. Its state is protected by `hemlock_executor_dumper_mutex`.
+static pthread_mutex_t hemlock_executor_dumper_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t hemlock_executor_dumper_cond = PTHREAD_COND_INITIALIZER;
+static pthread_t hemlock_executor_dumper;
+static bool hemlock_executor_dumper_running = false;
+static bool hemlock_executor_dumper_stopping = false;
+static int hemlock_executor_dumper_fd;
+static int64_t hemlock_executor_dumper_interval_ns;
+
+static void
+hemlock_executor_stats_dump(int fd) {
+    int64_t now_ns = hemlock_basis_executor_now_ns();
+    // The pool may be stopped meanwhile, so the lookup array is indexed directly rather than via
+    // `hemlock_executors_get`, which asserts that its index is live. Executor records are never
+    // freed, so slots stay valid even once truncated.
+    size_t n = hemlock_executors_length();
+    for (size_t i = 0; i < n && i < HEMLOCK_EXECUTORS_MAX; i++) {
+        hemlock_executor_t *executor = atomic_load_explicit(&hemlock_executors[i],
+          memory_order_relaxed);
+        if (executor == NULL) {
+            continue;
+        }
+        hemlock_executor_stats_t *stats = &executor->stats;
+        int64_t wait_ns = atomic_load_explicit(&stats->wait_ns, memory_order_relaxed);
+        dprintf(fd,
+            "t=%.3f executor=%zu age_ms=%.1f waiting_ms=%.1f turn_rate=%.1f runnable=%lu "
+            "inflight=%lu cqe_rate=%.1f idle=%.3f migrations=%lu rejections=%lu\n",
+            (double)now_ns / 1e9,
+            i,
+            (double)(now_ns - atomic_load_explicit(&stats->sample_ns, memory_order_relaxed)) / 1e6,
+            (wait_ns == 0) ? 0.0 : (double)(now_ns - wait_ns) / 1e6,
+            atomic_load_explicit(&stats->turn_rate, memory_order_relaxed),
+            atomic_load_explicit(&stats->n_runnable, memory_order_relaxed),
+            atomic_load_explicit(&stats->n_inflight, memory_order_relaxed),
+            atomic_load_explicit(&stats->cqe_rate, memory_order_relaxed),
+            atomic_load_explicit(&stats->idle, memory_order_relaxed),
+            atomic_load_explicit(&stats->n_migrations, memory_order_relaxed),
+            atomic_load_explicit(&stats->n_rejections, memory_order_relaxed)
+        );
+    }
+}
+
+static void *
+hemlock_executor_dumper_thread(void *arg) {
+    pthread_mutex_lock(&hemlock_executor_dumper_mutex);
+    while (true) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        int64_t deadline_ns = (int64_t)deadline.tv_nsec + hemlock_executor_dumper_interval_ns;
+        deadline.tv_sec += deadline_ns / 1000000000;
+        deadline.tv_nsec = deadline_ns % 1000000000;
+        while (!hemlock_executor_dumper_stopping &&
+          pthread_cond_timedwait(&hemlock_executor_dumper_cond, &hemlock_executor_dumper_mutex,
+          &deadline) == 0);
+        if (hemlock_executor_dumper_stopping) {
+            break;
+        }
+        hemlock_executor_stats_dump(hemlock_executor_dumper_fd);
+    }
+    pthread_mutex_unlock(&hemlock_executor_dumper_mutex);
+
+    return NULL;
+}
+
+// hemlock_basis_executor_stats_dump_stop_inner: unit >{os}-> unit
+CAMLprim value
+hemlock_basis_executor_stats_dump_stop_inner(value a_unit) {
+    pthread_mutex_lock(&hemlock_executor_dumper_mutex);
+    bool running = hemlock_executor_dumper_running;
+    hemlock_executor_dumper_stopping = true;
+    pthread_cond_broadcast(&hemlock_executor_dumper_cond);
+    pthread_mutex_unlock(&hemlock_executor_dumper_mutex);
+    if (running) {
+        caml_enter_blocking_section();
+        pthread_join(hemlock_executor_dumper, NULL);
+        caml_leave_blocking_section();
+    }
+    hemlock_executor_dumper_running = false;
+    hemlock_executor_dumper_stopping = false;
+
+    return Val_unit;
+}
+
+// Start dumping load statistics to `a_fd` every `a_interval_ms` milliseconds, replacing any dump
+// already in progress.
+//
+// hemlock_basis_executor_stats_dump_start_inner: uns -> uns >{os}-> unit
+CAMLprim value
+hemlock_basis_executor_stats_dump_start_inner(value a_interval_ms, value a_fd) {
+    hemlock_basis_executor_stats_dump_stop_inner(Val_unit);
+    hemlock_executor_dumper_fd = Int64_val(a_fd);
+    hemlock_executor_dumper_interval_ns = Int64_val(a_interval_ms) * 1000000;
+    if (pthread_create(&hemlock_executor_dumper, NULL, hemlock_executor_dumper_thread, NULL) == 0) {
+        hemlock_executor_dumper_running = true;
+    }
+
+    return Val_unit;
+}
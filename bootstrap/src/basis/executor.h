@@ -1,24 +1,284 @@
 #pragma once
+#include <pthread.h>
+
+#include "actor.h"
 #include "ioring.h"
+#include "mailbox.h"
+#include "wsdeque.h"
+
+// Closure queued to run on a pool executor.
+typedef struct hemlock_executor_job_s {
+    // OCaml `unit -> unit` closure, registered as a generational global root while queued.
+    value closure;
+    struct hemlock_executor_job_s *next;
+} hemlock_executor_job_t;
 
+// Right continuation forked by `Basis.Executor.fork2`, which is either joined by the executor that
+// forked it, or stolen and run by another executor.
 typedef struct {
+    // OCaml `unit -> 'b` closure, and its result or the exception it raised once `state` is
+    // `HEMLOCK_EXECUTOR_TASK_DONE`. Both are registered as generational global roots.
+    value closure;
+    value result;
+    bool raised;
+
+    // Executor that forked the task, which is woken once a thief completes it.
+    struct hemlock_executor_s *owner;
+
+    _Atomic uint8_t state;
+} hemlock_executor_task_t;
+#define HEMLOCK_EXECUTOR_TASK_PENDING 0
+#define HEMLOCK_EXECUTOR_TASK_DONE 1
+
+// Contents of a message received via `Basis.Executor.Mailbox`, pending consumption.
+typedef struct {
+    uint64_t payload;
+    uint64_t latency_ns;
+} hemlock_executor_received_t;
+
+// Load statistics of an executor, which only the executor itself writes, and which any thread may
+// read at any time via relaxed atomic loads. The statistics occupy cache lines of their own, so
+// that readers do not contend with the owner's other state. Rates and the idle fraction are
+// exponentially smoothed over sampling intervals, the latest of which ended at `sample_ns`. An
+// executor that is waiting does not sample, so while `wait_ns` is non-zero, it has been waiting
+// since then, and is idle.
+typedef struct {
+    _Alignas(HEMLOCK_CACHE_LINE_SIZE) _Atomic int64_t sample_ns;
+    _Atomic int64_t wait_ns;
+
+    // Scheduling wheel turns per second, measured in segments so as to include partial turns, and
+    // CQEs reaped per second.
+    _Atomic double turn_rate;
+    _Atomic double cqe_rate;
+
+    // Fraction of time spent waiting.
+    _Atomic double idle;
+
+    // Runnable actors and in-flight I/O operations, as of `sample_ns`.
+    _Atomic uint64_t n_runnable;
+    _Atomic uint64_t n_inflight;
+
+    // Cumulative wheel turns, reaped CQEs, and nanoseconds spent waiting, as of `sample_ns`.
+    _Atomic uint64_t n_turns;
+    _Atomic uint64_t n_cqes;
+    _Atomic uint64_t idle_ns;
+
+    // Cumulative actors migrated away, and migration opportunities declined because no sampled
+    // executor was sufficiently less loaded. Kept current rather than sampled.
+    _Atomic uint64_t n_migrations;
+    _Atomic uint64_t n_rejections;
+} hemlock_executor_stats_t;
+
+// User data whose decref has been deferred until its executor holds the runtime lock.
+typedef struct hemlock_executor_decref_s {
+    struct hemlock_executor_decref_s *next;
+    hemlock_user_data_t *user_data;
+} hemlock_executor_decref_t;
+
+// Alignment of `hemlock_executor_alignpool_t` buffers, and of the smallest size class. The
+// remaining size classes are successive powers of two, up to 16 MiB.
+#define HEMLOCK_EXECUTOR_ALIGNPOOL_ALIGN 4096
+#define HEMLOCK_EXECUTOR_ALIGNPOOL_CLASSES 13
+
+// Number of free buffers retained per size class.
+#define HEMLOCK_EXECUTOR_ALIGNPOOL_RETAIN 8
+
+// Size of the registered arena from which aligned buffers are preferentially carved, and the size
+// of the largest buffer carved from it.
+#define HEMLOCK_EXECUTOR_ARENA_SIZE (1 << 20)
+#define HEMLOCK_EXECUTOR_ARENA_BUF_MAX (128 << 10)
+
+// Pool of aligned buffers for direct I/O (`O_DIRECT`), which requires buffer addresses to be
+// aligned to the file's memory alignment, typically its logical block size. Buffers are aligned to
+// `HEMLOCK_EXECUTOR_ALIGNPOOL_ALIGN`, which satisfies the memory alignment of block sizes up to the
+// page size. Freed buffers are retained for reuse in power-of-two size classes; larger buffers, and
+// buffers freed to a full class, are returned to the system. Free buffers are linked through their
+// first bytes. A buffer may be freed to a different executor's pool than it was allocated from.
+// Small buffers are carved from the registered arena instead (see `executor.c`) while it has room.
+typedef struct {
+    void *free[HEMLOCK_EXECUTOR_ALIGNPOOL_CLASSES];
+    uint32_t n_free[HEMLOCK_EXECUTOR_ALIGNPOOL_CLASSES];
+
+    // Statistics: buffers allocated, allocations satisfied by retained buffers, and allocations
+    // satisfied by the registered arena.
+    uint64_t n_allocs;
+    uint64_t n_reuses;
+    uint64_t n_arena;
+} hemlock_executor_alignpool_t;
+void hemlock_executor_alignpool_pp(int fd, int indent, hemlock_executor_alignpool_t *alignpool);
+
+#define HEMLOCK_EXECUTOR_BUSY 0
+#define HEMLOCK_EXECUTOR_IDLE 1
+#define HEMLOCK_EXECUTOR_IDLE_THIEF 2
+
+typedef struct hemlock_executor_s {
+    hemlock_user_data_slab_t slab;
     hemlock_ioring_t ioring;
+
+    // Mailbox through which other executors send messages to this one, and the number of messages
+    // sent by this executor that have yet to be returned for reclamation.
+    hemlock_mailbox_t mailbox;
+    uint64_t n_unacked;
+
+    // Right continuations forked by this executor that have yet to be joined or stolen.
+    hemlock_wsdeque_t deque;
+
+    // Aligned buffers for direct I/O.
+    hemlock_executor_alignpool_t alignpool;
+
+    // Steal candidate: the oldest task in `victim`'s deque, at position `victim_top`, as of
+    // `victim_ns`. The task is stolen only if it is still the oldest a full quantum later.
+    struct hemlock_executor_s *victim;
+    int64_t victim_top;
+    void *victim_task;
+    int64_t victim_ns;
+
+    // State of the pseudo-random number generator used for victim selection, and the number of
+    // tasks this executor has stolen.
+    uint64_t rng;
+    uint64_t n_stolen;
+
+    // Scheduler of the actors run by this executor, and the time of the latest migration away from
+    // it.
+    hemlock_sched_t sched;
+    int64_t migrate_ns;
+
+    // Whether the executor is running actors without holding the runtime lock. Written only with
+    // the lock held, so any thread that holds the lock may read it. Decrefs of the executor's user
+    // data by other threads meanwhile are deferred via `decrefs`.
+    bool unlocked;
+    hemlock_executor_decref_t *_Atomic decrefs;
+
+    // Received `Basis.Executor.Mailbox` messages pending consumption, in order of receipt.
+    hemlock_executor_received_t *received;
+    size_t n_received;
+    size_t received_max;
+
+    // Index in the executor lookup array.
+    uint32_t id;
+
+    // Sampling state for `stats`: wheel segment and cumulative counts at the previous sample, and
+    // cumulative idle time.
+    uint64_t stats_segment;
+    uint64_t stats_cqes;
+    uint64_t stats_idle_ns;
+    uint64_t idle_ns;
+
+    // Non-zero while the executor is about to wait, or is waiting, for completions with nothing
+    // else to do, and `HEMLOCK_EXECUTOR_IDLE_THIEF` if it would steal work. Whoever gives an idle
+    // executor something to do clears the state and rings the executor's ioring doorbell.
+    _Atomic uint8_t idle;
+
+    // CPU the executor thread is pinned to, or -1 if it is not pinned (e.g. the main executor).
+    int cpu;
+
+    // Pool executors only: executor thread, and FIFO of closures queued for it to run, protected by
+    // `mutex`. The thread reports the outcome of its setup via `setup_oe` once `setup_done` is set,
+    // and signals `cond`.
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    hemlock_executor_job_t *jobs_head;
+    hemlock_executor_job_t *jobs_tail;
+    bool stopping;
+    bool setup_done;
+    hemlock_opt_error_t setup_oe;
+
+    hemlock_executor_stats_t stats;
 } hemlock_executor_t;
 
-hemlock_opt_error_t hemlock_executor_setup(hemlock_executor_t *executor);
+// Maximum number of executors, including the main executor.
+#define HEMLOCK_EXECUTORS_MAX 1024
+
+// Global lookup array of live executors. Executors `[0,n)` are live, where `n` is the result of
+// `hemlock_executors_length()`.
+size_t hemlock_executors_length(void);
+hemlock_executor_t *hemlock_executors_get(size_t i);
+
+// Send `message` from the current executor to `receiver`. Once `receiver` has received the message,
+// the message is returned to the current executor's mailbox, to be passed to `reclaim` by
+// `hemlock_executor_receive`.
+void hemlock_executor_send(hemlock_executor_t *receiver, hemlock_message_t *message);
+
+// Receive all messages in the current executor's mailbox. Messages from other executors are passed
+// to `receive` and then returned to their senders, and the current executor's own returned messages
+// are passed to `reclaim`. Returns the number of messages passed to `receive`.
+size_t hemlock_executor_receive(
+    void (*receive)(hemlock_message_t *message, void *env),
+    void (*reclaim)(hemlock_message_t *message, void *env),
+    void *env
+);
+
+hemlock_opt_error_t hemlock_executor_setup(
+    hemlock_executor_t *executor,
+    hemlock_ioring_conf_t const *conf
+);
+hemlock_opt_error_t hemlock_executor_reconfigure(
+    hemlock_executor_t *executor,
+    hemlock_ioring_conf_t const *conf
+);
 void hemlock_executor_teardown(hemlock_executor_t *executor);
 hemlock_executor_t *hemlock_executor_get();
+void hemlock_executor_user_data_pin(hemlock_user_data_t *user_data, value a_pin);
+
+// Allocate a buffer of `size` bytes from the current executor's pool of aligned buffers, or return
+// NULL if memory is exhausted. The buffer must be freed via `hemlock_executor_aligned_free` with
+// the same `size`.
+void *hemlock_executor_aligned_alloc(size_t size);
+void hemlock_executor_aligned_free(void *buf, size_t size);
+
+// Suspend `actor`, which must be run by the current executor, until `user_data`'s operation
+// completes.
+void hemlock_executor_actor_io_wait(hemlock_actor_t *actor, hemlock_user_data_t *user_data);
 
 CAMLprim value hemlock_basis_executor_finalize_result(int result);
 CAMLprim value hemlock_basis_executor_user_data_decref(value a_user_data);
 CAMLprim value hemlock_basis_executor_user_data_pp(value a_fd, value a_user_data);
 CAMLprim value hemlock_basis_executor_complete_inner(value a_user_data);
+CAMLprim value hemlock_basis_executor_is_complete_inner(value a_user_data);
+CAMLprim value hemlock_basis_executor_cancel_inner(value a_user_data);
+CAMLprim value hemlock_basis_executor_wait_inner(
+    value a_n, value a_timeout_ns, value a_user_datas
+);
+CAMLprim value hemlock_basis_executor_poll_inner(value a_unit);
 CAMLprim value hemlock_basis_executor_submit_out(
     hemlock_opt_error_t oe, hemlock_user_data_t *user_data
 );
+CAMLprim value hemlock_basis_executor_chain_submit_out(
+    hemlock_opt_error_t oe, hemlock_user_data_t **user_datas, size_t n
+);
 CAMLprim value hemlock_basis_executor_nop_submit_inner(value a_unit);
-CAMLprim value hemlock_basis_executor_setup_inner(value a_unit);
+CAMLprim value hemlock_basis_executor_setup_inner(value a_conf);
+CAMLprim value hemlock_basis_executor_conf_inner(value a_unit);
+CAMLprim value hemlock_basis_executor_iowq_max_workers_inner(value a_bounded, value a_unbounded);
 CAMLprim value hemlock_basis_executor_teardown_inner(value a_unit);
 CAMLprim value hemlock_basis_executor_cqring_pp(value a_fd);
 CAMLprim value hemlock_basis_executor_sqring_pp(value a_fd);
 CAMLprim value hemlock_basis_executor_ioring_pp(value a_fd);
+CAMLprim value hemlock_basis_executor_user_data_slab_pp(value a_fd);
+CAMLprim value hemlock_basis_executor_user_data_slab_inner(value a_unit);
+CAMLprim value hemlock_basis_executor_ncpus_inner(value a_unit);
+CAMLprim value hemlock_basis_executor_length_inner(value a_unit);
+CAMLprim value hemlock_basis_executor_id_inner(value a_unit);
+CAMLprim value hemlock_basis_executor_pool_start_inner(
+    value a_conf, value a_placement, value a_n
+);
+CAMLprim value hemlock_basis_executor_pool_stop_inner(value a_unit);
+CAMLprim value hemlock_basis_executor_pool_run_inner(value a_i, value a_closure);
+CAMLprim value hemlock_basis_executor_mailbox_send_inner(value a_n, value a_i, value a_payload);
+CAMLprim value hemlock_basis_executor_mailbox_receive_inner(value a_n);
+CAMLprim value hemlock_basis_executor_mailbox_drain_inner(value a_unit);
+CAMLprim value hemlock_basis_executor_mailbox_pp(value a_fd);
+CAMLprim value hemlock_basis_executor_fork2_inner(value a_f, value a_g);
+CAMLprim value hemlock_basis_executor_wsdeque_pp(value a_fd);
+CAMLprim value hemlock_basis_executor_topology_pp(value a_fd);
+CAMLprim value hemlock_basis_executor_topology_inner(value a_unit);
+CAMLprim value hemlock_basis_executor_cpu_inner(value a_i);
+CAMLprim value hemlock_basis_executor_actor_pingpong_inner(
+    value a_n, value a_n_active, value a_n_rounds
+);
+CAMLprim value hemlock_basis_executor_actor_spin_inner(value a_n, value a_n_units);
+CAMLprim value hemlock_basis_executor_sched_pp(value a_fd);
+CAMLprim value hemlock_basis_executor_stats_inner(value a_i);
+CAMLprim value hemlock_basis_executor_stats_dump_start_inner(value a_interval_ms, value a_fd);
+CAMLprim value hemlock_basis_executor_stats_dump_stop_inner(value a_unit);
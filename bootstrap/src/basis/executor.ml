@@ -0,0 +1,203 @@
+open Rudiments
+
+module Conf = struct
+  (* Modifications to Conf.t must be reflected in executor.c. *)
+  type t = {
+    sq_entries: uns;
+    cq_entries: uns;
+    sqpoll_idle: uns option;
+    coop_taskrun: bool;
+    single_issuer: bool;
+    defer_taskrun: bool;
+    attach_wq: bool;
+    iowq_max_bounded: uns;
+    iowq_max_unbounded: uns;
+  }
+
+  let default = {
+    sq_entries=32L;
+    cq_entries=0L;
+    sqpoll_idle=None;
+    coop_taskrun=false;
+    single_issuer=false;
+    defer_taskrun=false;
+    attach_wq=true;
+    iowq_max_bounded=0L;
+    iowq_max_unbounded=0L;
+  }
+end
+
+external setup_inner: Conf.t -> sint = "hemlock_basis_executor_setup_inner"
+
+let setup conf =
+  match setup_inner conf with
+  | 0L -> None
+  | -1L -> Some Errno.EIO
+  | errno -> Some (Errno.of_uns_hlt (Uns.bits_of_sint errno))
+
+let setup_hlt conf =
+  match setup conf with
+  | None -> ()
+  | Some error -> halt (Errno.to_string error)
+
+external conf: unit -> Conf.t = "hemlock_basis_executor_conf_inner"
+
+external iowq_max_workers_inner: uns -> uns -> sint =
+  "hemlock_basis_executor_iowq_max_workers_inner"
+
+let set_iowq_max_workers ?(bounded=0L) ?(unbounded=0L) () =
+  match iowq_max_workers_inner bounded unbounded with
+  | 0L -> None
+  | -1L -> Some Errno.EIO
+  | errno -> Some (Errno.of_uns_hlt (Uns.bits_of_sint errno))
+
+let set_iowq_max_workers_hlt ?bounded ?unbounded () =
+  match set_iowq_max_workers ?bounded ?unbounded () with
+  | None -> ()
+  | Some error -> halt (Errno.to_string error)
+
+external poll_inner: unit -> sint = "hemlock_basis_executor_poll_inner"
+
+let poll () =
+  match poll_inner () with
+  | 0L -> None
+  | errno -> Some (Errno.of_uns_hlt (Uns.bits_of_sint errno))
+
+let poll_hlt () =
+  match poll () with
+  | None -> ()
+  | Some error -> halt (Errno.to_string error)
+
+external ncpus: unit -> uns = "hemlock_basis_executor_ncpus_inner"
+
+module Placement = struct
+  (* Modifications to Placement.t must be reflected in topology.h. *)
+  type t =
+    | Depth_first
+    | Breadth_first
+    | Random
+
+  let pp t formatter =
+    formatter |> Fmt.fmt (match t with
+      | Depth_first -> "Depth_first"
+      | Breadth_first -> "Breadth_first"
+      | Random -> "Random"
+    )
+end
+
+external length: unit -> uns = "hemlock_basis_executor_length_inner"
+
+external id: unit -> uns = "hemlock_basis_executor_id_inner"
+
+external fork2: (unit -> 'a) -> (unit -> 'b) -> 'a * 'b = "hemlock_basis_executor_fork2_inner"
+
+module Pool = struct
+  external start_inner: Conf.t -> Placement.t -> uns -> sint =
+    "hemlock_basis_executor_pool_start_inner"
+
+  let start ?(conf=Conf.default) ?(placement=Placement.Depth_first) ?n () =
+    let n = match n with
+      | Some n -> n
+      | None -> Uns.max 1L (ncpus ()) - 1L
+    in
+    (* Executor threads run OCaml code via the systhreads runtime lock, which must be initialized
+       first. *)
+    let _ : Thread.t = Thread.self () in
+    match start_inner conf placement n with
+    | 0L -> None
+    | -1L -> Some Errno.EIO
+    | errno -> Some (Errno.of_uns_hlt (Uns.bits_of_sint errno))
+
+  let start_hlt ?conf ?placement ?n () =
+    match start ?conf ?placement ?n () with
+    | None -> ()
+    | Some error -> halt (Errno.to_string error)
+
+  external stop: unit -> unit = "hemlock_basis_executor_pool_stop_inner"
+
+  external run_inner: uns -> (unit -> unit) -> unit = "hemlock_basis_executor_pool_run_inner"
+
+  let run i f =
+    match i > 0L && i < length () with
+    | false -> halt "Executor.Pool.run: Not a pool executor"
+    | true -> run_inner i f
+end
+
+module Mailbox = struct
+  external send_inner: uns -> uns -> uns -> unit = "hemlock_basis_executor_mailbox_send_inner"
+
+  let send ?(n=1L) i payload =
+    match i < length () with
+    | false -> halt "Executor.Mailbox.send: Not a live executor"
+    | true -> send_inner n i payload
+
+  external receive: uns -> uns array * uns array = "hemlock_basis_executor_mailbox_receive_inner"
+
+  external drain: unit -> unit = "hemlock_basis_executor_mailbox_drain_inner"
+end
+
+module Actor = struct
+  external pingpong_inner: uns -> uns -> uns -> uns = "hemlock_basis_executor_actor_pingpong_inner"
+
+  let pingpong ~n ~active ~rounds =
+    pingpong_inner n active rounds
+
+  external spin_inner: uns -> uns -> uns = "hemlock_basis_executor_actor_spin_inner"
+
+  let spin ~n ~units =
+    spin_inner n units
+end
+
+module Stats = struct
+  (* Modifications to Stats.t must be reflected in executor.c. *)
+  type t = {
+    sample_ns: u64;
+    wait_ns: u64;
+    turn_rate: real;
+    cqe_rate: real;
+    idle: real;
+    runnable: uns;
+    inflight: uns;
+    turns: uns;
+    cqes: uns;
+    idle_ns: u64;
+    migrations: uns;
+    rejections: uns;
+  }
+
+  external get_inner: uns -> t = "hemlock_basis_executor_stats_inner"
+
+  let get i =
+    match i < length () with
+    | false -> halt "Executor.Stats.get: Not a live executor"
+    | true -> get_inner i
+
+  let load t =
+    match t.runnable, t.turn_rate with
+    | 0L, _ -> 0.
+    | _, 0. -> Real.inf
+    | _, turn_rate -> 1. /. turn_rate
+
+  let pp t formatter =
+    formatter
+    |> Fmt.fmt "{sample_ns=" |> U64.pp t.sample_ns
+    |> Fmt.fmt "; wait_ns=" |> U64.pp t.wait_ns
+    |> Fmt.fmt "; turn_rate=" |> Real.pp t.turn_rate
+    |> Fmt.fmt "; cqe_rate=" |> Real.pp t.cqe_rate
+    |> Fmt.fmt "; idle=" |> Real.pp t.idle
+    |> Fmt.fmt "; runnable=" |> Uns.pp t.runnable
+    |> Fmt.fmt "; inflight=" |> Uns.pp t.inflight
+    |> Fmt.fmt "; turns=" |> Uns.pp t.turns
+    |> Fmt.fmt "; cqes=" |> Uns.pp t.cqes
+    |> Fmt.fmt "; idle_ns=" |> U64.pp t.idle_ns
+    |> Fmt.fmt "; migrations=" |> Uns.pp t.migrations
+    |> Fmt.fmt "; rejections=" |> Uns.pp t.rejections
+    |> Fmt.fmt "}"
+
+  external dump_start_inner: uns -> uns -> unit = "hemlock_basis_executor_stats_dump_start_inner"
+
+  let dump_start ?(interval_ms=1000L) fd =
+    dump_start_inner (Uns.max 1L interval_ms) fd
+
+  external dump_stop: unit -> unit = "hemlock_basis_executor_stats_dump_stop_inner"
+end
@@ -0,0 +1,257 @@
+open Rudiments
+
+(** Executor runtime interfaces. Each executor drives its own io_uring instance, through which all
+    I/O submitted by the executor flows. *)
+
+(** io_uring configuration. *)
+module Conf : sig
+  type t = {
+    sq_entries: uns;
+    (** Submission queue size. Submissions are forced into the kernel every [sq_entries]
+        operations, so larger queues amortize system call overhead for I/O-heavy workloads. *)
+
+    cq_entries: uns;
+    (** Completion queue size, or 0 for the kernel default of twice [sq_entries]. *)
+
+    sqpoll_idle: uns option;
+    (** If [Some idle], a kernel thread polls the submission queue and sleeps after [idle]
+        milliseconds without submissions. *)
+
+    coop_taskrun: bool;
+    (** Defer kernel completion work until the next ioring system call rather than interrupting
+        the executor. *)
+
+    single_issuer: bool;
+    (** Declare that only the executor thread submits I/O, which enables kernel optimizations. *)
+
+    defer_taskrun: bool;
+    (** Defer all kernel completion work until the executor waits for completions. Implies
+        [single_issuer]. *)
+
+    attach_wq: bool;
+    (** Share the kernel async backend of the first executor rather than creating a new one. Has
+        no effect on the first executor. *)
+
+    iowq_max_bounded: uns;
+    (** Maximum number of kernel async workers for bounded work, e.g. regular file I/O, or 0 for the
+        kernel's limit. 0 if the kernel does not support limits. *)
+
+    iowq_max_unbounded: uns;
+    (** Maximum number of kernel async workers for unbounded work, e.g. socket I/O, or 0 for the
+        kernel's limit. 0 if the kernel does not support limits. *)
+  }
+
+  val default: t
+  (** Default configuration: 32 submission queue entries, default completion queue size, a kernel
+      async backend shared with the first executor, the kernel's async worker limits, and no other
+      optional features. *)
+end
+
+val setup: Conf.t -> Errno.t option
+(** [setup conf] replaces the current executor's io_uring instance with one configured according to
+    [conf]. Optional features which the kernel does not support are silently omitted; use [conf] to
+    determine the configuration actually in effect. Returns [None] or an [Errno.t] if the io_uring
+    instance could not be replaced, e.g. [EBUSY] if I/O is in flight. *)
+
+val setup_hlt: Conf.t -> unit
+(** [setup_hlt conf] replaces the current executor's io_uring instance with one configured according
+    to [conf], or halts if the io_uring instance could not be replaced. *)
+
+val conf: unit -> Conf.t
+(** [conf ()] returns the configuration in effect for the current executor's io_uring instance. *)
+
+val set_iowq_max_workers: ?bounded:uns -> ?unbounded:uns -> unit -> Errno.t option
+(** [set_iowq_max_workers ?bounded ?unbounded ()] limits the numbers of kernel async workers that
+    serve the current executor's io_uring instance to [bounded] and [unbounded], each of which
+    leaves the corresponding limit unchanged if 0 (the default). [conf] reflects the limits in
+    effect. Pool executors' limits may be changed at runtime via [Pool.run]. Returns [None] or an
+    [Errno.t] if the limits could not be set, e.g. [EINVAL] if the kernel does not support
+    limits. *)
+
+val set_iowq_max_workers_hlt: ?bounded:uns -> ?unbounded:uns -> unit -> unit
+(** [set_iowq_max_workers_hlt ?bounded ?unbounded ()] limits the numbers of kernel async workers as
+    for [set_iowq_max_workers], or halts if the limits could not be set. *)
+
+val poll: unit -> Errno.t option
+(** [poll ()] submits pending I/O and reaps all available completions without blocking. Returns
+    [None] or an [Errno.t] if completions could not be reaped. *)
+
+val poll_hlt: unit -> unit
+(** [poll_hlt ()] submits pending I/O and reaps all available completions without blocking, or halts
+    if completions could not be reaped. *)
+
+(** CPU placement policies for pool executors, which are each pinned to a CPU. The CPU topology is
+    read from [/sys/devices/system/node] and [/sys/devices/system/cpu] when the pool is first
+    started. Each pool executor also prefers memory on its CPU's NUMA node, for its io_uring
+    instance, mailbox, and allocations by its thread. *)
+module Placement : sig
+  type t =
+    | Depth_first
+    (** Pack executors onto as few NUMA nodes as possible, starting with the main executor's node,
+        so that they share caches and local memory. *)
+    | Breadth_first
+    (** Spread executors across NUMA nodes, and within each node across physical cores, so that
+        they share as little memory bandwidth and as few SMT siblings as possible. *)
+    | Random
+    (** Pin executors to random distinct CPUs. *)
+
+  val pp: t -> (module Fmt.Formatter) -> (module Fmt.Formatter)
+  (** [pp t formatter] formats [t] to [formatter]. *)
+end
+
+val ncpus: unit -> uns
+(** [ncpus ()] returns the number of CPUs the process may run on. *)
+
+val length: unit -> uns
+(** [length ()] returns the number of live executors, i.e. the main executor plus any pool
+    executors. Live executors have indices in [\[0, length ())], and the main executor's index is
+    0. *)
+
+val id: unit -> uns
+(** [id ()] returns the index of the current executor. *)
+
+val fork2: (unit -> 'a) -> (unit -> 'b) -> 'a * 'b
+(** [fork2 f g] forks [g], runs [f], then joins [g], and returns [(f (), g ())]. Forked closures
+    wait in the current executor's work-stealing deque, from which idle pool executors may steal
+    the oldest once it has waited for a scheduling quantum; otherwise [g] runs on the current
+    executor after [f]. If [f] raises, [g] is not run unless already stolen, and the exception is
+    re-raised once [g] has completed. If only [g] raises, its exception is re-raised. Note that
+    OCaml code is serialized by the runtime lock, so stolen closures run in parallel only insofar
+    as they wait for I/O. *)
+
+(** Pool of executors, each on its own thread with its own io_uring instance. I/O must be completed
+    on the executor that submitted it. OCaml code on all executors is serialized by the OCaml
+    runtime lock, which each executor releases while idle or waiting for I/O completions, so that
+    I/O on different executors proceeds in parallel. Idle executors wait in their io_uring
+    instances, and are woken by a doorbell completion (posted via [IORING_OP_MSG_RING], or via an
+    eventfd on kernels that lack it) when queued a closure or sent a message. *)
+module Pool : sig
+  val start: ?conf:Conf.t -> ?placement:Placement.t -> ?n:uns -> unit -> Errno.t option
+  (** [start ?conf ?placement ?n ()] starts [n] (default [ncpus () - 1]) pool executors with
+      indices [\[1, n\]], each with an io_uring instance configured according to [conf] (default
+      [Conf.default]) and pinned to a distinct CPU chosen according to [placement] (default
+      [Depth_first]), if there are enough CPUs. One CPU is left to the main executor. Returns
+      [None] or an [Errno.t] if the pool could not be started, e.g. [EBUSY] if the pool is already
+      running. *)
+
+  val start_hlt: ?conf:Conf.t -> ?placement:Placement.t -> ?n:uns -> unit -> unit
+  (** [start_hlt ?conf ?placement ?n ()] starts [n] (default [ncpus () - 1]) pool executors as for
+      [start], or halts if the pool could not be started. *)
+
+  val stop: unit -> unit
+  (** [stop ()] stops the pool, if running, once each pool executor has run all closures queued to
+      it and completed its in-flight I/O. *)
+
+  val run: uns -> (unit -> unit) -> unit
+  (** [run i f] queues [f] to be run by the pool executor with index [i], and halts if there is no
+      such pool executor. Closures queued to an executor run in order. An exception that escapes
+      [f] terminates the process. *)
+end
+
+(** Inter-executor mailboxes. Each executor has a lock-free multi-producer, single-consumer mailbox.
+    Messages are allocated by their sender, received exactly once by their receiver, and then
+    returned to the sender's mailbox, upon which the sender reclaims them. *)
+module Mailbox : sig
+  val send: ?n:uns -> uns -> uns -> unit
+  (** [send ?n i payload] sends [n] (default 1) messages carrying [payload] from the current
+      executor to the live executor with index [i], and halts if there is no such executor. Sending
+      never blocks. *)
+
+  val receive: uns -> uns array * uns array
+  (** [receive n] blocks until the current executor has received at least [n] messages not yet
+      returned by [receive], and returns [(payloads, latencies)] for the first [n] of them, in order
+      of receipt, where latencies are nanoseconds from send to receipt. *)
+
+  val drain: unit -> unit
+  (** [drain ()] blocks until all messages sent by the current executor have been returned to it and
+      reclaimed. Messages received meanwhile remain pending for [receive]. *)
+end
+
+(** Actors: green threads, each with its own stack, initially run by the executor that spawned them.
+    Each executor schedules its actors with a scheduling wheel, and reaps I/O completions between
+    time slices, activating the actors that await them. Executors run actors without holding the
+    OCaml runtime lock, so actors on different executors run in parallel. Unpinned actors that have
+    just used up their quantum, or that have just become runnable after idling, may be migrated to
+    the least loaded of a few randomly sampled pool executors, if that evens out the load. Actors
+    that are waiting for messages or I/O are never migrated. Actors are currently implemented in the
+    runtime only, because OCaml code cannot run on actor stacks. *)
+module Actor : sig
+  val pingpong: n:uns -> active:uns -> rounds:uns -> uns
+  (** [pingpong ~n ~active ~rounds] spawns [n] (rounded down to even) actors on the current
+      executor, paired off. [active] of the pairs play [rounds] rounds of ping-pong, i.e. exchange
+      [2 * rounds] messages, while the rest wait idle. Once all pairs are done, every actor is sent
+      a message that halts it. Returns the total number of messages sent. Partners are pinned to
+      the current executor. *)
+
+  val spin: n:uns -> units:uns -> uns
+  (** [spin ~n ~units] spawns [n] unpinned actors on the current executor, each of which does
+      [units] units of CPU-bound work, yielding between units, and waits until all of them have
+      halted, wherever they were migrated to. Returns a checksum of the work, which does not depend
+      on where it was done. *)
+end
+
+(** Per-executor load statistics. Each executor samples its own statistics at most every 10
+    milliseconds while busy, and any executor may read any executor's latest sample without
+    synchronization. Rates and the idle fraction are exponentially smoothed with a time constant of
+    100 milliseconds. *)
+module Stats : sig
+  type t = {
+    sample_ns: u64;
+    (** Monotonic time at which the sample was taken. *)
+
+    wait_ns: u64;
+    (** Monotonic time since which the executor has been waiting, or 0 if it is busy. An executor
+        does not sample while it waits, so a non-zero [wait_ns] supersedes the rates. *)
+
+    turn_rate: real;
+    (** Actor scheduling wheel turns per second during the sampling interval. *)
+
+    cqe_rate: real;
+    (** I/O completions reaped per second during the sampling interval. *)
+
+    idle: real;
+    (** Fraction of the sampling interval spent waiting, in [\[0, 1\]]. *)
+
+    runnable: uns;
+    (** Number of runnable actors. *)
+
+    inflight: uns;
+    (** Number of in-flight I/O operations. *)
+
+    turns: uns;
+    (** Cumulative actor scheduling wheel turns. *)
+
+    cqes: uns;
+    (** Cumulative I/O completions reaped. *)
+
+    idle_ns: u64;
+    (** Cumulative nanoseconds spent waiting. *)
+
+    migrations: uns;
+    (** Cumulative actors migrated away from the executor. *)
+
+    rejections: uns;
+    (** Cumulative migration opportunities declined because no sampled executor was sufficiently
+        less loaded. *)
+  }
+
+  val get: uns -> t
+  (** [get i] returns the latest statistics sample of the live executor with index [i], and halts
+      if there is no such executor. The current executor samples its own statistics first. *)
+
+  val load: t -> real
+  (** [load t] returns a load estimate for comparing executors: the mean time in seconds for a
+      runnable actor to wait for its next time slice, i.e. [1 / turn_rate], or 0 if there are no
+      runnable actors. *)
+
+  val pp: t -> (module Fmt.Formatter) -> (module Fmt.Formatter)
+  (** [pp t formatter] formats a syntactically valid record representation of [t]. *)
+
+  val dump_start: ?interval_ms:uns -> uns -> unit
+  (** [dump_start ?interval_ms fd] starts a background thread that writes one line of statistics
+      per live executor to file descriptor [fd] (e.g. [File.(fd stderr)]) every [interval_ms]
+      (default 1000) milliseconds, replacing any dump already in progress. *)
+
+  val dump_stop: unit -> unit
+  (** [dump_stop ()] stops the dump started by [dump_start], if any. *)
+end
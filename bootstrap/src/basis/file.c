@@ -1,8 +1,11 @@
+#define _GNU_SOURCE
 #include <assert.h>
 #include <errno.h>
 #include <fcntl.h>
 #include <stddef.h>
+#include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
@@ -11,11 +14,19 @@
 #include <caml/memory.h>
 #include <caml/mlvalues.h>
 #include <caml/alloc.h>
+#include <caml/bigarray.h>
+#include <caml/fail.h>
+#include <caml/signals.h>
 
 #include "common.h"
 #include "executor.h"
 #include "ioring.h"
 
+// Requested capacity of the pipes that splices between non-pipe files go through. Larger pipes mean
+// fewer splices, but unprivileged processes are limited to `/proc/sys/fs/pipe-max-size`, 1 MiB by
+// default.
+#define HEMLOCK_FILE_SPLICE_PIPE_SIZE (1 << 20)
+
 int flags_of_hemlock_file_flag[] = {
     /* R_O   */ O_RDONLY,
     /* W     */ O_WRONLY | O_CREAT | O_TRUNC,
@@ -57,6 +68,81 @@ hemlock_basis_file_write_inner(value a_bytes, value a_fd) {
     return hemlock_basis_executor_finalize_result(result);
 }
 
+// hemlock_basis_file_size_hint_inner: Basis.File.t >{os}-> sint
+CAMLprim value
+hemlock_basis_file_size_hint_inner(value a_fd) {
+    int fd = Int64_val(a_fd);
+    struct stat statbuf;
+
+    // Only regular files have meaningful sizes and support positional reads.
+    if (fstat(fd, &statbuf) == -1 || !S_ISREG(statbuf.st_mode)) {
+        return caml_copy_int64(-1);
+    }
+    return caml_copy_int64(statbuf.st_size);
+}
+
+// Data of empty mappings, since zero-length mappings are invalid.
+static uint8_t hemlock_basis_file_mmap_empty;
+
+// Map the entirety of regular file `a_fd` read-only and return it as an external bigarray, or
+// return a negative errno. The mapping is independent of `a_fd`, and must be unmapped via
+// `hemlock_basis_file_munmap_inner` once the bigarray is unreachable.
+//
+// hemlock_basis_file_mmap_inner: bool -> Basis.File.t >{os}-> (sint * Basis.Bytes.t)
+CAMLprim value
+hemlock_basis_file_mmap_inner(value a_populate, value a_fd) {
+    CAMLparam2(a_populate, a_fd);
+    CAMLlocal2(a_ret, a_bytes);
+    bool populate = Bool_val(a_populate);
+    int fd = Int64_val(a_fd);
+
+    int64_t res = 0;
+    uint8_t *data = &hemlock_basis_file_mmap_empty;
+    size_t n = 0;
+    struct stat statbuf;
+    if (fstat(fd, &statbuf) == -1) {
+        res = -errno;
+    } else if (!S_ISREG(statbuf.st_mode)) {
+        // Only regular files have a size to map.
+        res = -ENODEV;
+    } else if (statbuf.st_size > 0) {
+        void *vm = mmap(NULL, statbuf.st_size, PROT_READ,
+          MAP_PRIVATE | (populate ? MAP_POPULATE : 0), fd, 0);
+        if (vm == MAP_FAILED) {
+            res = -errno;
+        } else {
+            data = (uint8_t *)vm;
+            n = statbuf.st_size;
+            // Inputs are typically scanned front to back, so read ahead aggressively and drop pages
+            // behind the scan. Advice is only a hint, so failure is ignored.
+            (void)madvise(vm, n, MADV_SEQUENTIAL);
+            if (!populate) {
+                (void)madvise(vm, n, MADV_WILLNEED);
+            }
+        }
+    }
+
+    a_bytes = caml_ba_alloc_dims(CAML_BA_UINT8 | CAML_BA_C_LAYOUT | CAML_BA_EXTERNAL, 1, data,
+      (intnat)n);
+    a_ret = caml_alloc_tuple(2);
+    Store_field(a_ret, 0, caml_copy_int64(res));
+    Store_field(a_ret, 1, a_bytes);
+
+    CAMLreturn(a_ret);
+}
+
+// hemlock_basis_file_munmap_inner: Basis.Bytes.t -> unit
+CAMLprim value
+hemlock_basis_file_munmap_inner(value a_bytes) {
+    struct caml_ba_array *ba = Caml_ba_array_val(a_bytes);
+
+    if (ba->dim[0] > 0 && munmap(ba->data, ba->dim[0]) != 0) {
+        abort();
+    }
+
+    return Val_unit;
+}
+
 CAMLprim value
 hemlock_basis_file_seek_inner(value a_i, value a_fd) {
     size_t i = Int64_val(a_i);
@@ -81,19 +167,240 @@ hemlock_basis_file_seek_tl_inner(value a_i, value a_fd) {
     return hemlock_basis_executor_finalize_result(lseek(fd, i, SEEK_END));
 }
 
-// hemlock_basis_file_read_complete_inner: !&Stdlib.Bytes.t -> Basis.File.Read.inner >{os}-> int
+// Address of the byte at index `a_base` of the `Basis.Bytes.t` bigarray `a_bytes`.
+static uint8_t *
+hemlock_basis_file_bytes_data(value a_bytes, value a_base) {
+    return (uint8_t *)Caml_ba_data_val(a_bytes) + Int64_val(a_base);
+}
+
+// Direct I/O alignment of a file opened with `O_DIRECT`: required alignment of buffer addresses,
+// and of file offsets and lengths. Both are 0 for files that perform buffered I/O.
+typedef struct {
+    uint32_t mem_align;
+    uint32_t off_align;
+} hemlock_file_direct_t;
+
+// Conservative alignment for direct I/O files whose alignment cannot be queried.
+#define HEMLOCK_FILE_DIRECT_ALIGN_DEFAULT 4096
+
+// Direct I/O alignments, indexed by file descriptor and grown on demand. Files are recorded once
+// opened, and forgotten once closed or reopened. Access is serialized by the runtime lock.
+static hemlock_file_direct_t *hemlock_file_directs = NULL;
+static size_t hemlock_file_directs_n = 0;
+
+static hemlock_file_direct_t const *
+hemlock_basis_file_direct_get(int fd) {
+    if (fd < 0 || (size_t)fd >= hemlock_file_directs_n || hemlock_file_directs[fd].off_align == 0) {
+        return NULL;
+    }
+    return &hemlock_file_directs[fd];
+}
+
+static void
+hemlock_basis_file_direct_set(int fd, uint32_t mem_align, uint32_t off_align) {
+    assert(fd >= 0);
+    if ((size_t)fd >= hemlock_file_directs_n) {
+        size_t n = (hemlock_file_directs_n == 0) ? 64 : hemlock_file_directs_n;
+        while (n <= (size_t)fd) {
+            n *= 2;
+        }
+        hemlock_file_directs = (hemlock_file_direct_t *)realloc(hemlock_file_directs,
+          sizeof(hemlock_file_direct_t) * n);
+        assert(hemlock_file_directs != NULL);
+        memset(&hemlock_file_directs[hemlock_file_directs_n], 0,
+          sizeof(hemlock_file_direct_t) * (n - hemlock_file_directs_n));
+        hemlock_file_directs_n = n;
+    }
+    hemlock_file_directs[fd].mem_align = mem_align;
+    hemlock_file_directs[fd].off_align = off_align;
+}
+
+// Forget any direct I/O alignment recorded for `fd`, whose descriptor may be reused by a file that
+// performs buffered I/O.
+static void
+hemlock_basis_file_direct_forget(int fd) {
+    if (fd >= 0 && (size_t)fd < hemlock_file_directs_n) {
+        memset(&hemlock_file_directs[fd], 0, sizeof(hemlock_file_direct_t));
+    }
+}
+
+// Validate the alignment of an operation on `fd` at `off` which scatters/gathers via `iovecs`.
+// Returns `EINVAL` without reporting it if `fd` performs direct I/O and the operation is
+// misaligned, just as the kernel would fail it. `O_DIRECT` is a property of the open file
+// description, which may be shared, so misaligned operations are never quietly reverted to
+// buffered I/O. The current file position of `HEMLOCK_IORING_OFF_CUR` operations is left to the
+// kernel to validate.
+static hemlock_opt_error_t
+hemlock_basis_file_direct_validate(int fd, struct iovec const *iovecs, uint32_t n_iovecs,
+  uint64_t off) {
+    hemlock_file_direct_t const *direct = hemlock_basis_file_direct_get(fd);
+    if (direct == NULL) {
+        return HEMLOCK_OE_NONE;
+    }
+
+    bool aligned = off == HEMLOCK_IORING_OFF_CUR || (off % direct->off_align) == 0;
+    for (uint32_t i = 0; aligned && i < n_iovecs; i++) {
+        aligned = ((uintptr_t)iovecs[i].iov_base % direct->mem_align) == 0
+          && (iovecs[i].iov_len % direct->off_align) == 0;
+    }
+    return aligned ? HEMLOCK_OE_NONE : EINVAL;
+}
+
+// Enable direct I/O for the open file `a_fd` by setting `O_DIRECT`. Fails with `EINVAL` if the
+// filesystem does not support direct I/O. Returns 0 or a negated errno.
+//
+// hemlock_basis_file_direct_enable_inner: Basis.File.t >{os}-> sint
 CAMLprim value
-hemlock_basis_file_read_complete_inner(value a_bytes, value a_user_data) {
-    hemlock_user_data_t *user_data = (hemlock_user_data_t *)Int64_val(a_user_data);
+hemlock_basis_file_direct_enable_inner(value a_fd) {
+    int fd = Int64_val(a_fd);
+
+    int flags = fcntl(fd, F_GETFL);
+    if (flags == -1 || fcntl(fd, F_SETFL, flags | O_DIRECT) == -1) {
+        return caml_copy_int64(-errno);
+    }
+
+    return caml_copy_int64(0);
+}
+
+// Record the direct I/O alignment of `a_fd`, for which direct I/O is enabled.
+//
+// hemlock_basis_file_direct_setup_inner: Basis.File.t >{os}-> unit
+CAMLprim value
+hemlock_basis_file_direct_setup_inner(value a_fd) {
+    int fd = Int64_val(a_fd);
+
+    uint32_t mem_align = 0;
+    uint32_t off_align = 0;
+    struct statx statxbuf;
+    if (statx(fd, "", AT_EMPTY_PATH, STATX_BASIC_STATS | STATX_DIOALIGN, &statxbuf) == 0) {
+        if ((statxbuf.stx_mask & STATX_DIOALIGN) != 0) {
+            mem_align = statxbuf.stx_dio_mem_align;
+            off_align = statxbuf.stx_dio_offset_align;
+        } else {
+            // Prior to Linux 6.1, alignment is not reported. The preferred I/O block size is a
+            // multiple of the logical block size, and is thus a conservative alignment.
+            mem_align = statxbuf.stx_blksize;
+            off_align = statxbuf.stx_blksize;
+        }
+    }
+    if (mem_align == 0 || off_align == 0) {
+        mem_align = HEMLOCK_FILE_DIRECT_ALIGN_DEFAULT;
+        off_align = HEMLOCK_FILE_DIRECT_ALIGN_DEFAULT;
+    }
+    hemlock_basis_file_direct_set(fd, mem_align, off_align);
+
+    return Val_unit;
+}
+
+// hemlock_basis_file_direct_forget_inner: Basis.File.t >{os}-> unit
+CAMLprim value
+hemlock_basis_file_direct_forget_inner(value a_fd) {
+    hemlock_basis_file_direct_forget(Int64_val(a_fd));
+
+    return Val_unit;
+}
+
+// hemlock_basis_file_direct_align_inner: Basis.File.t -> uns
+CAMLprim value
+hemlock_basis_file_direct_align_inner(value a_fd) {
+    int fd = Int64_val(a_fd);
+
+    hemlock_file_direct_t const *direct = hemlock_basis_file_direct_get(fd);
+    return caml_copy_int64((direct == NULL) ? 0 : direct->off_align);
+}
+
+// Allocate an `a_n`-byte bigarray from the current executor's pool of aligned buffers. The caller
+// must free it via `hemlock_basis_file_direct_buffer_free_inner` once it is unreachable.
+//
+// hemlock_basis_file_direct_buffer_inner: uns >{os}-> Basis.Bytes.t
+CAMLprim value
+hemlock_basis_file_direct_buffer_inner(value a_n) {
+    intnat n = Int64_val(a_n);
+
+    uint8_t *buf = (uint8_t *)hemlock_executor_aligned_alloc(n);
+    if (buf == NULL) {
+        caml_raise_out_of_memory();
+    }
+
+    return caml_ba_alloc_dims(CAML_BA_UINT8 | CAML_BA_C_LAYOUT | CAML_BA_EXTERNAL, 1, buf, n);
+}
+
+// hemlock_basis_file_direct_buffer_free_inner: Basis.Bytes.t >{os}-> unit
+CAMLprim value
+hemlock_basis_file_direct_buffer_free_inner(value a_bytes) {
+    hemlock_executor_aligned_free(Caml_ba_data_val(a_bytes), Caml_ba_array_val(a_bytes)->dim[0]);
+
+    return Val_unit;
+}
+
+// hemlock_basis_file_pread_submit_inner: uns -> !&Basis.Bytes.t array -> uns array -> uns array ->
+//   sint -> Basis.File.t >{os}-> (int * &Basis.File.Pread.inner)
+CAMLprim value
+hemlock_basis_file_pread_submit_inner(
+    value a_off,
+    value a_bytess,
+    value a_bases,
+    value a_lengths,
+    value a_timeout_ns,
+    value a_fd
+) {
+    uint64_t off = Int64_val(a_off);
+    uint32_t n_iovecs = Wosize_val(a_lengths);
+    int64_t timeout_ns = Int64_val(a_timeout_ns);
+    int fd = Int64_val(a_fd);
+    hemlock_ioring_t *ioring = &hemlock_executor_get()->ioring;
+
+    hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
 
-    int64_t res = hemlock_ioring_user_data_complete(user_data, &hemlock_executor_get()->ioring);
+    // The iovecs scatter directly into the buffers. One extra byte assures a non-NULL allocation
+    // even if there are no buffers.
+    struct iovec *iovecs = (struct iovec *)malloc(sizeof(struct iovec) * n_iovecs + 1);
+    assert(iovecs != NULL);
+    for (uint32_t i = 0; i < n_iovecs; i++) {
+        iovecs[i].iov_base = hemlock_basis_file_bytes_data(Field(a_bytess, i), Field(a_bases, i));
+        iovecs[i].iov_len = Int64_val(Field(a_lengths, i));
+    }
+    oe = hemlock_basis_file_direct_validate(fd, iovecs, n_iovecs, off);
+    if (oe != HEMLOCK_OE_NONE) {
+        goto LABEL_OUT;
+    }
+
+    hemlock_user_data_t *user_data = NULL;
+    HEMLOCK_OE(
+        oe,
+        hemlock_ioring_readv_submit(&user_data, fd, (uint8_t *)iovecs, iovecs, n_iovecs, off,
+          timeout_ns, ioring)
+    );
+    hemlock_executor_user_data_pin(user_data, a_bytess);
 
-    if (res >= 0) {
-        uint8_t *bytes = (uint8_t *)Bytes_val(a_bytes);
-        memcpy(bytes, user_data->buffer, res);
+LABEL_OUT:
+    if (oe != HEMLOCK_OE_NONE) {
+        free(iovecs);
     }
+    return hemlock_basis_executor_submit_out(oe, user_data);
+}
+
+// Bytecode entry point, since the native entry point takes more than five arguments.
+CAMLprim value
+hemlock_basis_file_pread_submit_inner_byte(value *argv, int argn) {
+    assert(argn == 6);
+    return hemlock_basis_file_pread_submit_inner(
+        argv[0], argv[1], argv[2], argv[3], argv[4], argv[5]
+    );
+}
+
+// Copy an OCaml path into a malloc()ed nul-terminated pathname, which must outlive the operation.
+static uint8_t *
+hemlock_basis_file_pathname_of_bytes(value a_bytes) {
+    uint8_t *bytes = (uint8_t *)Bytes_val(a_bytes);
+    size_t n = caml_string_length(a_bytes);
+
+    uint8_t *pathname = (uint8_t *)malloc(sizeof(uint8_t) * (n + 1));
+    assert(pathname != NULL);
+    memcpy(pathname, bytes, sizeof(uint8_t) * n);
+    pathname[n] = '\0';
 
-    return caml_copy_int64(res);
+    return pathname;
 }
 
 // hemlock_basis_file_open_submit_inner: Basis.File.Flag.t -> uns -> Stdlib.Bytes.t >{os}->
@@ -102,15 +409,10 @@ CAMLprim value
 hemlock_basis_file_open_submit_inner(value a_flag, value a_mode, value a_bytes) {
     size_t flag = Long_val(a_flag);
     size_t mode = Int64_val(a_mode);
-    uint8_t *bytes = (uint8_t *)Bytes_val(a_bytes);
-    size_t n = caml_string_length(a_bytes);
 
     int flags = flags_of_hemlock_file_flag[flag];
 
-    uint8_t *pathname = (uint8_t *)malloc(sizeof(uint8_t) * (n + 1));
-    assert(pathname != NULL);
-    memcpy(pathname, bytes, sizeof(uint8_t) * n);
-    pathname[n] = '\0';
+    uint8_t *pathname = hemlock_basis_file_pathname_of_bytes(a_bytes);
 
     hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
 
@@ -133,6 +435,7 @@ hemlock_basis_file_close_submit_inner(value a_fd) {
 
     hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
 
+    hemlock_basis_file_direct_forget(fd);
     hemlock_user_data_t *user_data = NULL;
     HEMLOCK_OE(oe, hemlock_ioring_close_submit(&user_data, fd, &hemlock_executor_get()->ioring));
 
@@ -140,48 +443,429 @@ LABEL_OUT:
     return hemlock_basis_executor_submit_out(oe, user_data);
 }
 
-// hemlock_basis_file_read_submit_inner: uns -> Basis.File.t >{os}-> (int * &Basis.File.Read.inner)
+// hemlock_basis_file_fsync_submit_inner: bool -> Basis.File.t >{os}-> (int * &Basis.File.Fsync.t)
+CAMLprim value
+hemlock_basis_file_fsync_submit_inner(value a_datasync, value a_fd) {
+    unsigned flags = Bool_val(a_datasync) ? IORING_FSYNC_DATASYNC : 0;
+    int fd = Int64_val(a_fd);
+
+    hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
+
+    hemlock_user_data_t *user_data = NULL;
+    HEMLOCK_OE(
+        oe,
+        hemlock_ioring_fsync_submit(&user_data, fd, flags, &hemlock_executor_get()->ioring)
+    );
+
+LABEL_OUT:
+    return hemlock_basis_executor_submit_out(oe, user_data);
+}
+
+// hemlock_basis_file_fallocate_submit_inner: bool -> uns -> uns -> Basis.File.t >{os}->
+//   (int * &Basis.File.Fallocate.t)
+CAMLprim value
+hemlock_basis_file_fallocate_submit_inner(value a_keep_size, value a_off, value a_n, value a_fd) {
+    int mode = Bool_val(a_keep_size) ? FALLOC_FL_KEEP_SIZE : 0;
+    uint64_t off = Int64_val(a_off);
+    uint64_t n = Int64_val(a_n);
+    int fd = Int64_val(a_fd);
+
+    hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
+
+    hemlock_user_data_t *user_data = NULL;
+    HEMLOCK_OE(
+        oe,
+        hemlock_ioring_fallocate_submit(&user_data, fd, mode, off, n,
+          &hemlock_executor_get()->ioring)
+    );
+
+LABEL_OUT:
+    return hemlock_basis_executor_submit_out(oe, user_data);
+}
+
+// hemlock_basis_file_read_submit_inner: !&Basis.Bytes.t -> uns -> uns -> sint -> sint ->
+//   Basis.File.t >{os}-> (int * &Basis.File.Read.inner)
+CAMLprim value
+hemlock_basis_file_read_submit_inner(
+    value a_bytes,
+    value a_base,
+    value a_n,
+    value a_off,
+    value a_timeout_ns,
+    value a_fd
+) {
+    uint8_t *buffer = hemlock_basis_file_bytes_data(a_bytes, a_base);
+    uint64_t n = Int64_val(a_n);
+    uint64_t off = Int64_val(a_off);
+    int64_t timeout_ns = Int64_val(a_timeout_ns);
+    int fd = Int64_val(a_fd);
+    hemlock_ioring_t *ioring = &hemlock_executor_get()->ioring;
+
+    hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
+
+    struct iovec iovec = {.iov_base = buffer, .iov_len = n};
+    oe = hemlock_basis_file_direct_validate(fd, &iovec, 1, off);
+    if (oe != HEMLOCK_OE_NONE) {
+        goto LABEL_OUT;
+    }
+
+    // The kernel reads directly into the bytes, which stay pinned until the read completes.
+    hemlock_user_data_t *user_data = NULL;
+    HEMLOCK_OE(
+        oe,
+        hemlock_ioring_read_submit(&user_data, fd, buffer, n, off, timeout_ns, ioring)
+    );
+    hemlock_executor_user_data_pin(user_data, a_bytes);
+
+LABEL_OUT:
+    return hemlock_basis_executor_submit_out(oe, user_data);
+}
+
+// Bytecode entry point, since the native entry point takes more than five arguments.
+CAMLprim value
+hemlock_basis_file_read_submit_inner_byte(value *argv, int argn) {
+    assert(argn == 6);
+    return hemlock_basis_file_read_submit_inner(
+        argv[0], argv[1], argv[2], argv[3], argv[4], argv[5]
+    );
+}
+
+// hemlock_basis_file_read_select_submit_inner: uns -> sint -> sint -> Basis.File.t >{os}->
+//   (int * &Basis.File.Read.inner)
 CAMLprim value
-hemlock_basis_file_read_submit_inner(value a_n, value a_fd) {
+hemlock_basis_file_read_select_submit_inner(
+    value a_n,
+    value a_off,
+    value a_timeout_ns,
+    value a_fd
+) {
     uint64_t n = Int64_val(a_n);
+    uint64_t off = Int64_val(a_off);
+    int64_t timeout_ns = Int64_val(a_timeout_ns);
     int fd = Int64_val(a_fd);
+    hemlock_ioring_t *ioring = &hemlock_executor_get()->ioring;
+
+    hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
+
+    // The kernel selects a provided buffer once data are available, so there is nothing to pin.
+    hemlock_user_data_t *user_data = NULL;
+    HEMLOCK_OE(
+        oe,
+        hemlock_ioring_read_select_submit(&user_data, fd, n, off, timeout_ns, ioring)
+    );
+
+LABEL_OUT:
+    return hemlock_basis_executor_submit_out(oe, user_data);
+}
 
-    uint8_t *buffer = (uint8_t *)malloc(sizeof(uint8_t) * n);
-    assert(buffer != NULL);
+// Data of completed buffer-selecting reads that consumed no provided buffer.
+static uint8_t hemlock_basis_file_read_select_empty;
+
+// Wrap the first `a_n` bytes of the provided buffer consumed by the completed buffer-selecting read
+// `a_user_data` in a bigarray, without copying. The buffer returns to the ring once the read's last
+// ref is dropped, so the caller must keep the read reachable for as long as the bigarray is.
+//
+// hemlock_basis_file_read_select_buffer_inner: &Basis.File.Read.inner -> uns -> Basis.Bytes.t
+CAMLprim value
+hemlock_basis_file_read_select_buffer_inner(value a_user_data, value a_n) {
+    hemlock_user_data_t *user_data = (hemlock_user_data_t *)Int64_val(a_user_data);
+    intnat n = Int64_val(a_n);
+
+    assert(hemlock_user_data_is_complete(user_data) && user_data->buffer_select);
+    uint8_t *data = user_data->buffer;
+    if (data == NULL) {
+        assert(n == 0);
+        data = &hemlock_basis_file_read_select_empty;
+    }
+
+    return caml_ba_alloc_dims(CAML_BA_UINT8 | CAML_BA_C_LAYOUT | CAML_BA_EXTERNAL, 1, data, n);
+}
+
+// hemlock_basis_file_write_submit_inner: &Basis.Bytes.t -> uns -> uns -> sint -> sint ->
+//   Basis.File.t >{os}-> (int * &Basis.File.Write.inner)
+CAMLprim value
+hemlock_basis_file_write_submit_inner(
+    value a_bytes,
+    value a_base,
+    value a_n,
+    value a_off,
+    value a_timeout_ns,
+    value a_fd
+) {
+    uint8_t *buffer = hemlock_basis_file_bytes_data(a_bytes, a_base);
+    uint64_t n = Int64_val(a_n);
+    uint64_t off = Int64_val(a_off);
+    int64_t timeout_ns = Int64_val(a_timeout_ns);
+    int fd = Int64_val(a_fd);
+    hemlock_ioring_t *ioring = &hemlock_executor_get()->ioring;
 
     hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
 
+    struct iovec iovec = {.iov_base = buffer, .iov_len = n};
+    oe = hemlock_basis_file_direct_validate(fd, &iovec, 1, off);
+    if (oe != HEMLOCK_OE_NONE) {
+        goto LABEL_OUT;
+    }
+
+    // The kernel writes directly from the bytes, which stay pinned until the write completes.
     hemlock_user_data_t *user_data = NULL;
     HEMLOCK_OE(
-        oe, hemlock_ioring_read_submit(&user_data, fd, buffer, n, &hemlock_executor_get()->ioring)
+        oe,
+        hemlock_ioring_write_submit(&user_data, fd, buffer, n, off, timeout_ns, ioring)
     );
+    hemlock_executor_user_data_pin(user_data, a_bytes);
 
 LABEL_OUT:
     return hemlock_basis_executor_submit_out(oe, user_data);
 }
 
-// hemlock_basis_file_write_submit_inner: Stdlib.Bytes.t -> Basis.File.t >{os}->
-//   (int * &Basis.File.Write.inner)
+// Bytecode entry point, since the native entry point takes more than five arguments.
+CAMLprim value
+hemlock_basis_file_write_submit_inner_byte(value *argv, int argn) {
+    assert(argn == 6);
+    return hemlock_basis_file_write_submit_inner(
+        argv[0], argv[1], argv[2], argv[3], argv[4], argv[5]
+    );
+}
+
+// hemlock_basis_file_writev_submit_inner: !&Basis.Bytes.t array -> uns array -> uns array -> sint
+//   -> sint -> Basis.File.t >{os}-> (int * &Basis.File.Writev.inner)
 CAMLprim value
-hemlock_basis_file_write_submit_inner(value a_bytes, value a_fd) {
+hemlock_basis_file_writev_submit_inner(
+    value a_bytess,
+    value a_bases,
+    value a_lengths,
+    value a_off,
+    value a_timeout_ns,
+    value a_fd
+) {
+    uint32_t n_iovecs = Wosize_val(a_lengths);
+    uint64_t off = Int64_val(a_off);
+    int64_t timeout_ns = Int64_val(a_timeout_ns);
+    int fd = Int64_val(a_fd);
+    hemlock_ioring_t *ioring = &hemlock_executor_get()->ioring;
+
     hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
-    uint8_t *bytes = (uint8_t *)Bytes_val(a_bytes);
-    size_t n = caml_string_length(a_bytes);
+
+    // The iovecs gather directly from the buffers. One extra byte assures a non-NULL allocation
+    // even if there are no buffers.
+    struct iovec *iovecs = (struct iovec *)malloc(sizeof(struct iovec) * n_iovecs + 1);
+    assert(iovecs != NULL);
+    for (uint32_t i = 0; i < n_iovecs; i++) {
+        iovecs[i].iov_base = hemlock_basis_file_bytes_data(Field(a_bytess, i), Field(a_bases, i));
+        iovecs[i].iov_len = Int64_val(Field(a_lengths, i));
+    }
+    oe = hemlock_basis_file_direct_validate(fd, iovecs, n_iovecs, off);
+    if (oe != HEMLOCK_OE_NONE) {
+        goto LABEL_OUT;
+    }
+
+    hemlock_user_data_t *user_data = NULL;
+    HEMLOCK_OE(
+        oe,
+        hemlock_ioring_writev_submit(&user_data, fd, (uint8_t *)iovecs, iovecs, n_iovecs, off,
+          timeout_ns, ioring)
+    );
+    hemlock_executor_user_data_pin(user_data, a_bytess);
+
+LABEL_OUT:
+    if (oe != HEMLOCK_OE_NONE) {
+        free(iovecs);
+    }
+    return hemlock_basis_executor_submit_out(oe, user_data);
+}
+
+// Bytecode entry point, since the native entry point takes more than five arguments.
+CAMLprim value
+hemlock_basis_file_writev_submit_inner_byte(value *argv, int argn) {
+    assert(argn == 6);
+    return hemlock_basis_file_writev_submit_inner(
+        argv[0], argv[1], argv[2], argv[3], argv[4], argv[5]
+    );
+}
+
+// hemlock_basis_file_read_chain_submit_inner: !&Basis.Bytes.t -> uns -> uns -> Stdlib.Bytes.t
+//   >{os}-> (int * &Basis.File.Chain.Read.inner array)
+CAMLprim value
+hemlock_basis_file_read_chain_submit_inner(value a_bytes, value a_base, value a_n, value a_path) {
+    uint8_t *buffer = hemlock_basis_file_bytes_data(a_bytes, a_base);
+    uint64_t n = Int64_val(a_n);
+    hemlock_ioring_t *ioring = &hemlock_executor_get()->ioring;
+
+    hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
+
+    uint8_t *pathname = hemlock_basis_file_pathname_of_bytes(a_path);
+    hemlock_user_data_t *user_datas[3] = {NULL};
+    // `EOPNOTSUPP` is not reported, since `Basis.File.Chain` falls back to unchained operations.
+    oe = hemlock_ioring_read_chain_submit(user_datas, pathname, O_RDONLY, buffer, n, ioring);
+    if (oe != HEMLOCK_OE_NONE) {
+        goto LABEL_OUT;
+    }
+    hemlock_executor_user_data_pin(user_datas[1], a_bytes);
+
+LABEL_OUT:
+    if (oe != HEMLOCK_OE_NONE) {
+        free(pathname);
+    }
+    return hemlock_basis_executor_chain_submit_out(oe, user_datas, 3);
+}
+
+// hemlock_basis_file_write_chain_submit_inner: Basis.File.Flag.t -> uns -> &Basis.Bytes.t -> uns ->
+//   uns -> Stdlib.Bytes.t >{os}-> (int * &Basis.File.Chain.Write.inner array)
+CAMLprim value
+hemlock_basis_file_write_chain_submit_inner(
+    value a_flag,
+    value a_mode,
+    value a_bytes,
+    value a_base,
+    value a_n,
+    value a_path
+) {
+    size_t flag = Long_val(a_flag);
+    size_t mode = Int64_val(a_mode);
+    uint8_t *buffer = hemlock_basis_file_bytes_data(a_bytes, a_base);
+    uint64_t n = Int64_val(a_n);
+    hemlock_ioring_t *ioring = &hemlock_executor_get()->ioring;
+
+    hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
+
+    uint8_t *pathname = hemlock_basis_file_pathname_of_bytes(a_path);
+    hemlock_user_data_t *user_datas[4] = {NULL};
+    // See `hemlock_basis_file_read_chain_submit_inner` regarding `EOPNOTSUPP`.
+    oe = hemlock_ioring_write_chain_submit(user_datas, pathname, flags_of_hemlock_file_flag[flag],
+      mode, buffer, n, ioring);
+    if (oe != HEMLOCK_OE_NONE) {
+        goto LABEL_OUT;
+    }
+    hemlock_executor_user_data_pin(user_datas[1], a_bytes);
+
+LABEL_OUT:
+    if (oe != HEMLOCK_OE_NONE) {
+        free(pathname);
+    }
+    return hemlock_basis_executor_chain_submit_out(oe, user_datas, 4);
+}
+
+// Bytecode entry point, since the native entry point takes more than five arguments.
+CAMLprim value
+hemlock_basis_file_write_chain_submit_inner_byte(value *argv, int argn) {
+    assert(argn == 6);
+    return hemlock_basis_file_write_chain_submit_inner(
+        argv[0], argv[1], argv[2], argv[3], argv[4], argv[5]
+    );
+}
+
+// hemlock_basis_file_is_pipe_inner: Basis.File.t -> bool
+CAMLprim value
+hemlock_basis_file_is_pipe_inner(value a_fd) {
     int fd = Int64_val(a_fd);
+    struct stat statbuf;
+
+    return Val_bool(fstat(fd, &statbuf) == 0 && S_ISFIFO(statbuf.st_mode));
+}
+
+// Create a pipe for splicing between non-pipe files. Returns the pipe's capacity, or a negative
+// errno, along with its read and write ends.
+//
+// hemlock_basis_file_pipe_inner: unit >{os}-> (sint * Basis.File.t * Basis.File.t)
+CAMLprim value
+hemlock_basis_file_pipe_inner(value a_unit) {
+    CAMLparam1(a_unit);
+    CAMLlocal2(a_ret, a_elm);
+
+    int fds[2] = {-1, -1};
+    int64_t res;
+    if (pipe2(fds, O_CLOEXEC) == -1) {
+        res = -errno;
+    } else {
+        hemlock_basis_file_direct_forget(fds[0]);
+        hemlock_basis_file_direct_forget(fds[1]);
+        // The capacity is merely a hint, so keep the default if it cannot be raised.
+        (void)fcntl(fds[1], F_SETPIPE_SZ, HEMLOCK_FILE_SPLICE_PIPE_SIZE);
+        res = fcntl(fds[1], F_GETPIPE_SZ);
+        if (res == -1) {
+            res = -errno;
+            close(fds[0]);
+            close(fds[1]);
+        }
+    }
 
-    uint8_t *buffer = (uint8_t *)malloc(sizeof(uint8_t) * n);
-    assert(buffer != NULL);
-    memcpy(buffer, bytes, n);
+    a_ret = caml_alloc_tuple(3);
+    a_elm = caml_copy_int64(res);
+    Store_field(a_ret, 0, a_elm);
+    a_elm = caml_copy_int64(fds[0]);
+    Store_field(a_ret, 1, a_elm);
+    a_elm = caml_copy_int64(fds[1]);
+    Store_field(a_ret, 2, a_elm);
+
+    CAMLreturn(a_ret);
+}
+
+// hemlock_basis_file_splice_submit_inner: uns -> Basis.File.t -> Basis.File.t >{os}->
+//   (int * &Basis.File.Splice.inner)
+CAMLprim value
+hemlock_basis_file_splice_submit_inner(value a_n, value a_fd_in, value a_fd_out) {
+    uint64_t n = Int64_val(a_n);
+    int fd_in = Int64_val(a_fd_in);
+    int fd_out = Int64_val(a_fd_out);
+
+    hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
 
     hemlock_user_data_t *user_data = NULL;
     HEMLOCK_OE(
-        oe, hemlock_ioring_write_submit(&user_data, fd, buffer, n, &hemlock_executor_get()->ioring)
+        oe,
+        hemlock_ioring_splice_submit(&user_data, fd_in, fd_out, n, &hemlock_executor_get()->ioring)
+    );
+
+LABEL_OUT:
+    return hemlock_basis_executor_submit_out(oe, user_data);
+}
+
+// hemlock_basis_file_splice_chain_submit_inner: uns -> Basis.File.t -> Basis.File.t ->
+//   Basis.File.t -> Basis.File.t >{os}-> (int * &Basis.File.Splice.inner array)
+CAMLprim value
+hemlock_basis_file_splice_chain_submit_inner(
+    value a_n,
+    value a_fd_in,
+    value a_pipe_in,
+    value a_pipe_out,
+    value a_fd_out
+) {
+    uint64_t n = Int64_val(a_n);
+    int fd_in = Int64_val(a_fd_in);
+    int pipe_in = Int64_val(a_pipe_in);
+    int pipe_out = Int64_val(a_pipe_out);
+    int fd_out = Int64_val(a_fd_out);
+
+    hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
+
+    hemlock_user_data_t *user_datas[2] = {NULL};
+    HEMLOCK_OE(
+        oe,
+        hemlock_ioring_splice_chain_submit(user_datas, fd_in, pipe_in, pipe_out, fd_out, n,
+          &hemlock_executor_get()->ioring)
     );
 
 LABEL_OUT:
-    value a_ret = caml_alloc_tuple(2);
-    Store_field(a_ret, 0, caml_copy_int64((uint64_t)oe));
-    Store_field(a_ret, 1, caml_copy_int64((uint64_t)user_data));
+    return hemlock_basis_executor_chain_submit_out(oe, user_datas, 2);
+}
 
-    return a_ret;
+// Copy up to `a_n` bytes from `a_fd_in` to `a_fd_out` at their current file positions, entirely
+// within the kernel. Filesystems that support reflinks share the extents rather than copying data.
+// Returns the number of bytes copied, 0 at end of file, or a negative errno.
+//
+// hemlock_basis_file_copy_file_range_inner: uns -> Basis.File.t -> Basis.File.t >{os}-> sint
+CAMLprim value
+hemlock_basis_file_copy_file_range_inner(value a_n, value a_fd_in, value a_fd_out) {
+    size_t n = Int64_val(a_n);
+    int fd_in = Int64_val(a_fd_in);
+    int fd_out = Int64_val(a_fd_out);
+
+    // io_uring has no copy_file_range operation, and copying may take a while, so let other
+    // executors run meanwhile.
+    caml_enter_blocking_section();
+    ssize_t result = copy_file_range(fd_in, NULL, fd_out, NULL, n, 0);
+    caml_leave_blocking_section();
+
+    return hemlock_basis_executor_finalize_result(result);
 }
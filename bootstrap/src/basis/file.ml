@@ -1,7 +1,5 @@
 open Rudiments
-
-let error_of_neg_errno neg_errno =
-  Errno.of_uns_hlt (Uns.bits_of_sint (Sint.neg neg_errno))
+open IoOp
 
 module Flag = struct
   (* Modifications to Flag.t must be reflected in file.c. *)
@@ -21,13 +19,6 @@ end
 
 type t = uns
 
-let bytes_of_slice slice =
-  let base = (Bytes.Cursor.index (Bytes.Slice.base slice)) in
-  let container = (Bytes.Slice.container slice) in
-  Stdlib.Bytes.init (Int64.to_int (Bytes.Slice.length slice)) (fun i ->
-    Char.chr (Uns.trunc_to_int (U8.extend_to_uns (Array.get (base + (Int64.of_int i)) container)))
-  )
-
 external stdin_inner: unit -> t = "hemlock_basis_file_stdin_inner"
 
 let stdin =
@@ -46,16 +37,35 @@ let stderr =
 let fd t =
   t
 
-external user_data_decref: uns -> unit = "hemlock_basis_executor_user_data_decref"
-external complete_inner: uns -> sint = "hemlock_basis_executor_complete_inner"
+external cancel_inner: uns -> sint = "hemlock_basis_executor_cancel_inner"
 
-let register_user_data_finalizer user_data =
-  match user_data = 0L with
-  | true -> user_data
-  | false -> begin
-      let () = Stdlib.Gc.finalise user_data_decref user_data in
-      user_data
-    end
+let cancel_base inner =
+  match cancel_inner inner with
+  | 0L -> None
+  | -1L -> Some Errno.EIO
+  | errno -> Some (Errno.of_uns_hlt (Uns.bits_of_sint errno))
+
+let cancel_base_hlt inner =
+  match cancel_base inner with
+  | None -> ()
+  | Some error -> halt (Errno.to_string error)
+
+(* The current file position is selected by offset -1. *)
+let off_inner = function
+  | None -> -1L
+  | Some off -> Uns.bits_to_sint off
+
+(* Reads and writes transfer directly to/from the container underlying a slice, which the executor
+   pins until the operation completes. *)
+let base_index slice =
+  Bytes.Cursor.index (Bytes.Slice.base slice)
+
+(* Return the prefix of [slice] comprising its first [n] bytes. *)
+let slice_prefix n slice =
+  let base = Bytes.Slice.base slice in
+  Bytes.Slice.of_cursors ~base ~past:(Bytes.Cursor.seek (Uns.bits_to_sint n) base)
+
+external direct_forget_inner: t -> unit = "hemlock_basis_file_direct_forget_inner"
 
 module Open = struct
   type file = t
@@ -65,7 +75,7 @@ module Open = struct
     "hemlock_basis_file_open_submit_inner"
 
   let submit ?(flag=Flag.R_O) ?(mode=0o660L) path =
-    let path_bytes = bytes_of_slice (Path.to_bytes path) in
+    let path_bytes = bytes_of_path path in
     let value, t = submit_inner flag mode path_bytes in
     let t = register_user_data_finalizer t in
     match Sint.(value < kv 0L) with
@@ -81,21 +91,33 @@ module Open = struct
     let value = complete_inner t in
     match Sint.(value < 0L) with
     | true -> Error (error_of_neg_errno value)
-    | false -> Ok (Uns.bits_of_sint value)
+    | false -> begin
+        (* The file descriptor may have been reused since a direct I/O file was closed. *)
+        let file = Uns.bits_of_sint value in
+        direct_forget_inner file;
+        Ok file
+      end
 
   let complete_hlt t =
     match complete t with
     | Ok t -> t
     | Error error -> halt (Errno.to_string error)
-end
 
-let of_path ?flag ?mode path =
-  match Open.submit ?flag ?mode path with
-  | Error error -> Error error
-  | Ok open' -> Open.complete open'
+  let is_complete t =
+    is_complete_inner t
 
-let of_path_hlt ?flag ?mode path =
-  Open.(submit_hlt ?flag ?mode path |> complete_hlt)
+  let wait_any ?timeout ts =
+    wait_base ~inner_of:(fun t -> t) ?timeout 1L ts
+
+  let wait_any_hlt ?timeout ts =
+    wait_base_hlt ~inner_of:(fun t -> t) ?timeout 1L ts
+
+  let wait_n ?timeout n ts =
+    wait_base ~inner_of:(fun t -> t) ?timeout n ts
+
+  let wait_n_hlt ?timeout n ts =
+    wait_base_hlt ~inner_of:(fun t -> t) ?timeout n ts
+end
 
 module Close = struct
   type file = t
@@ -125,6 +147,21 @@ module Close = struct
     match complete t with
     | None -> ()
     | Some error -> halt (Errno.to_string error)
+
+  let is_complete t =
+    is_complete_inner t
+
+  let wait_any ?timeout ts =
+    wait_base ~inner_of:(fun t -> t) ?timeout 1L ts
+
+  let wait_any_hlt ?timeout ts =
+    wait_base_hlt ~inner_of:(fun t -> t) ?timeout 1L ts
+
+  let wait_n ?timeout n ts =
+    wait_base ~inner_of:(fun t -> t) ?timeout n ts
+
+  let wait_n_hlt ?timeout n ts =
+    wait_base_hlt ~inner_of:(fun t -> t) ?timeout n ts
 end
 
 let close t =
@@ -135,67 +172,276 @@ let close t =
 let close_hlt t =
   Close.(submit_hlt t |> complete_hlt)
 
+external direct_enable_inner: t -> sint = "hemlock_basis_file_direct_enable_inner"
+external direct_setup_inner: t -> unit = "hemlock_basis_file_direct_setup_inner"
+
+(* Direct I/O is enabled once the file is open rather than via O_DIRECT at open, because the kernel
+   rejects O_DIRECT only after O_CREAT has created the file. *)
+let of_path ?flag ?mode ?(direct=false) path =
+  match Open.submit ?flag ?mode path with
+  | Error error -> Error error
+  | Ok open' -> begin
+      match Open.complete open', direct with
+      | Error error, _ -> Error error
+      | Ok t, false -> Ok t
+      | Ok t, true -> begin
+          let value = direct_enable_inner t in
+          match Sint.(value < kv 0L) with
+          | false -> begin
+              direct_setup_inner t;
+              Ok t
+            end
+          | true -> begin
+              match error_of_neg_errno value with
+              (* The filesystem does not support direct I/O. *)
+              | Errno.EINVAL -> Ok t
+              | error -> begin
+                  let _ = close t in
+                  Error error
+                end
+            end
+        end
+    end
+
+let of_path_hlt ?flag ?mode ?direct path =
+  match of_path ?flag ?mode ?direct path with
+  | Ok t -> t
+  | Error error -> halt (Errno.to_string error)
+
+module Fsync = struct
+  type file = t
+  type t = uns
+
+  external submit_inner: bool -> file -> (sint * t) = "hemlock_basis_file_fsync_submit_inner"
+
+  let submit ?(datasync=false) file =
+    let value, t = submit_inner datasync file in
+    let t = register_user_data_finalizer t in
+    match Sint.(value < kv 0L) with
+    | true -> Error (error_of_neg_errno value)
+    | false -> Ok t
+
+  let submit_hlt ?datasync file =
+    match submit ?datasync file with
+    | Error error -> halt (Errno.to_string error)
+    | Ok t -> t
+
+  let complete t =
+    let value = complete_inner t in
+    match Sint.(value < kv 0L) with
+    | true -> Some (error_of_neg_errno value)
+    | false -> None
+
+  let complete_hlt t =
+    match complete t with
+    | None -> ()
+    | Some error -> halt (Errno.to_string error)
+
+  let is_complete t =
+    is_complete_inner t
+
+  let wait_any ?timeout ts =
+    wait_base ~inner_of:(fun t -> t) ?timeout 1L ts
+
+  let wait_any_hlt ?timeout ts =
+    wait_base_hlt ~inner_of:(fun t -> t) ?timeout 1L ts
+
+  let wait_n ?timeout n ts =
+    wait_base ~inner_of:(fun t -> t) ?timeout n ts
+
+  let wait_n_hlt ?timeout n ts =
+    wait_base_hlt ~inner_of:(fun t -> t) ?timeout n ts
+end
+
+let fsync ?datasync t =
+  match Fsync.submit ?datasync t with
+  | Error error -> Some error
+  | Ok fsync -> Fsync.complete fsync
+
+let fsync_hlt ?datasync t =
+  Fsync.(submit_hlt ?datasync t |> complete_hlt)
+
+module Fallocate = struct
+  type file = t
+  type t = uns
+
+  external submit_inner: bool -> uns -> uns -> file -> (sint * t) =
+    "hemlock_basis_file_fallocate_submit_inner"
+
+  let submit ?(keep_size=false) ~off ~n file =
+    let value, t = submit_inner keep_size off n file in
+    let t = register_user_data_finalizer t in
+    match Sint.(value < kv 0L) with
+    | true -> Error (error_of_neg_errno value)
+    | false -> Ok t
+
+  let submit_hlt ?keep_size ~off ~n file =
+    match submit ?keep_size ~off ~n file with
+    | Error error -> halt (Errno.to_string error)
+    | Ok t -> t
+
+  let complete t =
+    let value = complete_inner t in
+    match Sint.(value < kv 0L) with
+    | true -> Some (error_of_neg_errno value)
+    | false -> None
+
+  let complete_hlt t =
+    match complete t with
+    | None -> ()
+    | Some error -> halt (Errno.to_string error)
+
+  let is_complete t =
+    is_complete_inner t
+
+  let wait_any ?timeout ts =
+    wait_base ~inner_of:(fun t -> t) ?timeout 1L ts
+
+  let wait_any_hlt ?timeout ts =
+    wait_base_hlt ~inner_of:(fun t -> t) ?timeout 1L ts
+
+  let wait_n ?timeout n ts =
+    wait_base ~inner_of:(fun t -> t) ?timeout n ts
+
+  let wait_n_hlt ?timeout n ts =
+    wait_base_hlt ~inner_of:(fun t -> t) ?timeout n ts
+end
+
+let fallocate ?keep_size ~off ~n t =
+  match Fallocate.submit ?keep_size ~off ~n t with
+  | Error error -> Some error
+  | Ok fallocate -> Fallocate.complete fallocate
+
+let fallocate_hlt ?keep_size ~off ~n t =
+  Fallocate.(submit_hlt ?keep_size ~off ~n t |> complete_hlt)
+
+module Direct = struct
+  type file = t
+
+  external align_inner: file -> uns = "hemlock_basis_file_direct_align_inner"
+  external buffer_inner: uns -> Bytes.t = "hemlock_basis_file_direct_buffer_inner"
+  external buffer_free_inner: Bytes.t -> unit = "hemlock_basis_file_direct_buffer_free_inner"
+
+  let align file =
+    align_inner file
+
+  let round_up align n =
+    match align with
+    | 0L -> n
+    | _ -> (n + align - 1L) / align * align
+
+  let buffer n file =
+    let bytes = buffer_inner (round_up (align file) n) in
+    let () = Stdlib.Gc.finalise buffer_free_inner bytes in
+    Bytes.Slice.init bytes
+end
+
 module Read = struct
   type file = t
   type inner = uns
   type t = {
     inner: inner;
-    buffer: Bytes.Slice.t;
+    (* None if the kernel selects a provided buffer. *)
+    buffer: Bytes.Slice.t option;
   }
 
   let default_n = 1024L
 
-  external submit_inner: uns -> file -> (sint * inner) = "hemlock_basis_file_read_submit_inner"
+  let n_buffer ?n ?buffer () =
+    match n with
+    | None -> begin
+        match buffer with
+        | None -> default_n, Bytes.(Slice.init (create default_n))
+        | Some buffer -> Bytes.Slice.length buffer, buffer
+      end
+    | Some n -> begin
+        match buffer with
+        | None -> n, Bytes.(Slice.init (create n))
+        | Some buffer -> (Uns.min n (Bytes.Slice.length buffer)), buffer
+      end
 
-  let submit ?n ?buffer file =
-    let n, buffer = begin
-      match n with
-      | None -> begin
-          match buffer with
-          | None -> default_n, Bytes.Slice.init (Array.init (0L =:< default_n)
-            ~f:(fun _ -> Byte.kv 0L))
-          | Some buffer -> Bytes.Slice.length buffer, buffer
-        end
-      | Some n -> begin
-          match buffer with
-          | None -> n, Bytes.Slice.init (Array.init (0L =:< n) ~f:(fun _ -> Byte.kv 0L))
-          | Some buffer -> (Uns.min n (Bytes.Slice.length buffer)), buffer
-        end
-    end in
-    let value, inner = submit_inner n file in
+  external submit_inner: Bytes.t -> uns -> uns -> sint -> sint -> file -> (sint * inner) =
+    "hemlock_basis_file_read_submit_inner_byte" "hemlock_basis_file_read_submit_inner"
+
+  let submit ?n ?buffer ?off ?timeout file =
+    let n, buffer = n_buffer ?n ?buffer () in
+    let value, inner = submit_inner (Bytes.Slice.container buffer) (base_index buffer) n
+        (off_inner off) (timeout_inner timeout) file in
     let inner = register_user_data_finalizer inner in
     match Sint.(value < kv 0L) with
     | true -> Error (error_of_neg_errno value)
-    | false -> Ok {inner; buffer}
+    | false -> Ok {inner; buffer=Some buffer}
 
-  let submit_hlt ?n ?buffer file =
-    match submit ?n ?buffer file with
+  let submit_hlt ?n ?buffer ?off ?timeout file =
+    match submit ?n ?buffer ?off ?timeout file with
     | Error error -> halt (Errno.to_string error)
     | Ok t -> t
 
-  external complete_inner: Stdlib.Bytes.t -> inner -> sint =
-    "hemlock_basis_file_read_complete_inner"
+  external select_submit_inner: uns -> sint -> sint -> file -> (sint * inner) =
+    "hemlock_basis_file_read_select_submit_inner"
+
+  let submit_select ?(n=default_n) ?off ?timeout file =
+    let value, inner = select_submit_inner n (off_inner off) (timeout_inner timeout) file in
+    let inner = register_user_data_finalizer inner in
+    match Sint.(value < kv 0L) with
+    | true -> begin
+        match error_of_neg_errno value with
+        | Errno.EOPNOTSUPP -> submit ~n ?off ?timeout file
+        | error -> Error error
+      end
+    | false -> Ok {inner; buffer=None}
+
+  let submit_select_hlt ?n ?off ?timeout file =
+    match submit_select ?n ?off ?timeout file with
+    | Error error -> halt (Errno.to_string error)
+    | Ok t -> t
+
+  external select_buffer_inner: inner -> uns -> Bytes.t =
+    "hemlock_basis_file_read_select_buffer_inner"
 
   let complete t =
-    let base = Bytes.(Cursor.index (Slice.base t.buffer)) in
-    let bytes = Stdlib.Bytes.create (Int64.to_int (Bytes.Slice.length t.buffer)) in
-    let value = complete_inner bytes t.inner in
+    let value = complete_inner t.inner in
     match Sint.(value < kv 0L) with
     | true -> Error (error_of_neg_errno value)
     | false -> begin
-        let range = (base =:< (base + (Uns.bits_of_sint value))) in
-        let container = Bytes.Slice.container t.buffer in
-        Range.Uns.iter range ~f:(fun i ->
-          Array.set_inplace i (U8.of_char (Stdlib.Bytes.get bytes (Int64.to_int (i - base))))
-            container
-        );
-        Ok (Bytes.Slice.init ~range (Bytes.Slice.container t.buffer))
+        let n = Uns.bits_of_sint value in
+        match t.buffer with
+        | Some buffer -> Ok (slice_prefix n buffer)
+        | None -> begin
+            (* The provided buffer returns to the ring once the read is unreachable, so the bytes
+               keep the read reachable. *)
+            let bytes = select_buffer_inner t.inner n in
+            let () = Stdlib.Gc.finalise (fun _ -> Stdlib.ignore (Stdlib.Sys.opaque_identity t))
+                bytes in
+            Ok (Bytes.Slice.init bytes)
+          end
       end
 
   let complete_hlt t =
     match complete t with
     | Ok buffer -> buffer
     | Error error -> halt (Errno.to_string error)
+
+  let is_complete t =
+    is_complete_inner t.inner
+
+  let cancel t =
+    cancel_base t.inner
+
+  let cancel_hlt t =
+    cancel_base_hlt t.inner
+
+  let wait_any ?timeout ts =
+    wait_base ~inner_of:(fun t -> t.inner) ?timeout 1L ts
+
+  let wait_any_hlt ?timeout ts =
+    wait_base_hlt ~inner_of:(fun t -> t.inner) ?timeout 1L ts
+
+  let wait_n ?timeout n ts =
+    wait_base ~inner_of:(fun t -> t.inner) ?timeout n ts
+
+  let wait_n_hlt ?timeout n ts =
+    wait_base_hlt ~inner_of:(fun t -> t.inner) ?timeout n ts
 end
 
 let read ?n ?buffer t =
@@ -206,6 +452,75 @@ let read ?n ?buffer t =
 let read_hlt ?n ?buffer t =
   Read.(submit_hlt ?n ?buffer t |> complete_hlt)
 
+module Pread = struct
+  type file = t
+  type inner = uns
+  type t = {
+    inner: inner;
+    buffers: Bytes.Slice.t list;
+  }
+
+  external submit_inner: sint -> Bytes.t array -> uns array -> uns array -> sint -> file ->
+    (sint * inner) = "hemlock_basis_file_pread_submit_inner_byte"
+      "hemlock_basis_file_pread_submit_inner"
+
+  let submit ~off ?timeout buffers file =
+    let containers = Array.of_list (List.map buffers ~f:Bytes.Slice.container) in
+    let bases = Array.of_list (List.map buffers ~f:base_index) in
+    let lengths = Array.of_list (List.map buffers ~f:Bytes.Slice.length) in
+    let value, inner = submit_inner (Uns.bits_to_sint off) containers bases lengths
+        (timeout_inner timeout) file in
+    let inner = register_user_data_finalizer inner in
+    match Sint.(value < kv 0L) with
+    | true -> Error (error_of_neg_errno value)
+    | false -> Ok {inner; buffers}
+
+  let submit_hlt ~off ?timeout buffers file =
+    match submit ~off ?timeout buffers file with
+    | Error error -> halt (Errno.to_string error)
+    | Ok t -> t
+
+  let complete t =
+    let value = complete_inner t.inner in
+    match Sint.(value < kv 0L) with
+    | true -> Error (error_of_neg_errno value)
+    | false -> begin
+        let n_read = Uns.bits_of_sint value in
+        let _, buffers_rev = List.fold t.buffers ~init:(0L, [])
+            ~f:(fun (off, buffers_rev) buffer ->
+              let n = Uns.min (Bytes.Slice.length buffer) (n_read - off) in
+              off + n, (slice_prefix n buffer) :: buffers_rev
+            ) in
+        Ok (List.rev buffers_rev)
+      end
+
+  let complete_hlt t =
+    match complete t with
+    | Ok buffers -> buffers
+    | Error error -> halt (Errno.to_string error)
+
+  let is_complete t =
+    is_complete_inner t.inner
+
+  let cancel t =
+    cancel_base t.inner
+
+  let cancel_hlt t =
+    cancel_base_hlt t.inner
+
+  let wait_any ?timeout ts =
+    wait_base ~inner_of:(fun t -> t.inner) ?timeout 1L ts
+
+  let wait_any_hlt ?timeout ts =
+    wait_base_hlt ~inner_of:(fun t -> t.inner) ?timeout 1L ts
+
+  let wait_n ?timeout n ts =
+    wait_base ~inner_of:(fun t -> t.inner) ?timeout n ts
+
+  let wait_n_hlt ?timeout n ts =
+    wait_base_hlt ~inner_of:(fun t -> t.inner) ?timeout n ts
+end
+
 module Write = struct
   type file = t
   type inner = uns
@@ -214,19 +529,19 @@ module Write = struct
     buffer: Bytes.Slice.t;
   }
 
-  external submit_inner: Stdlib.Bytes.t -> file -> (sint * inner) =
-    "hemlock_basis_file_write_submit_inner"
+  external submit_inner: Bytes.t -> uns -> uns -> sint -> sint -> file -> (sint * inner) =
+    "hemlock_basis_file_write_submit_inner_byte" "hemlock_basis_file_write_submit_inner"
 
-  let submit buffer file =
-    let bytes = bytes_of_slice buffer in
-    let value, inner = submit_inner bytes file in
+  let submit ?off ?timeout buffer file =
+    let value, inner = submit_inner (Bytes.Slice.container buffer) (base_index buffer)
+        (Bytes.Slice.length buffer) (off_inner off) (timeout_inner timeout) file in
     let inner = register_user_data_finalizer inner in
     match Sint.(value < kv 0L) with
     | true -> Error (error_of_neg_errno value)
     | false -> Ok {inner; buffer}
 
-  let submit_hlt buffer file =
-    match submit buffer file with
+  let submit_hlt ?off ?timeout buffer file =
+    match submit ?off ?timeout buffer file with
     | Error error -> halt (Errno.to_string error)
     | Ok t -> t
 
@@ -245,6 +560,98 @@ module Write = struct
     match complete t with
     | Ok buffer -> buffer
     | Error error -> halt (Errno.to_string error)
+
+  let is_complete t =
+    is_complete_inner t.inner
+
+  let cancel t =
+    cancel_base t.inner
+
+  let cancel_hlt t =
+    cancel_base_hlt t.inner
+
+  let wait_any ?timeout ts =
+    wait_base ~inner_of:(fun t -> t.inner) ?timeout 1L ts
+
+  let wait_any_hlt ?timeout ts =
+    wait_base_hlt ~inner_of:(fun t -> t.inner) ?timeout 1L ts
+
+  let wait_n ?timeout n ts =
+    wait_base ~inner_of:(fun t -> t.inner) ?timeout n ts
+
+  let wait_n_hlt ?timeout n ts =
+    wait_base_hlt ~inner_of:(fun t -> t.inner) ?timeout n ts
+end
+
+module Writev = struct
+  type file = t
+  type inner = uns
+  type t = {
+    inner: inner;
+    buffers: Bytes.Slice.t list;
+  }
+
+  external submit_inner: Bytes.t array -> uns array -> uns array -> sint -> sint -> file ->
+    (sint * inner) = "hemlock_basis_file_writev_submit_inner_byte"
+      "hemlock_basis_file_writev_submit_inner"
+
+  let submit ?off ?timeout buffers file =
+    let containers = Array.of_list (List.map buffers ~f:Bytes.Slice.container) in
+    let bases = Array.of_list (List.map buffers ~f:base_index) in
+    let lengths = Array.of_list (List.map buffers ~f:Bytes.Slice.length) in
+    let value, inner =
+      submit_inner containers bases lengths (off_inner off) (timeout_inner timeout) file in
+    let inner = register_user_data_finalizer inner in
+    match Sint.(value < kv 0L) with
+    | true -> Error (error_of_neg_errno value)
+    | false -> Ok {inner; buffers}
+
+  let submit_hlt ?off ?timeout buffers file =
+    match submit ?off ?timeout buffers file with
+    | Error error -> halt (Errno.to_string error)
+    | Ok t -> t
+
+  let complete t =
+    let value = complete_inner t.inner in
+    match Sint.(value < kv 0L) with
+    | true -> Error (error_of_neg_errno value)
+    | false -> begin
+        let n_written = Uns.bits_of_sint value in
+        let _, buffers_rev = List.fold t.buffers ~init:(0L, [])
+            ~f:(fun (off, buffers_rev) buffer ->
+              let n = Uns.min (Bytes.Slice.length buffer) (n_written - off) in
+              let base = Bytes.Cursor.seek (Uns.bits_to_sint n) (Bytes.Slice.base buffer) in
+              let buffer' = Bytes.Slice.of_cursors ~base ~past:(Bytes.Slice.past buffer) in
+              off + n, buffer' :: buffers_rev
+            ) in
+        Ok (List.rev buffers_rev)
+      end
+
+  let complete_hlt t =
+    match complete t with
+    | Ok buffers -> buffers
+    | Error error -> halt (Errno.to_string error)
+
+  let is_complete t =
+    is_complete_inner t.inner
+
+  let cancel t =
+    cancel_base t.inner
+
+  let cancel_hlt t =
+    cancel_base_hlt t.inner
+
+  let wait_any ?timeout ts =
+    wait_base ~inner_of:(fun t -> t.inner) ?timeout 1L ts
+
+  let wait_any_hlt ?timeout ts =
+    wait_base_hlt ~inner_of:(fun t -> t.inner) ?timeout 1L ts
+
+  let wait_n ?timeout n ts =
+    wait_base ~inner_of:(fun t -> t.inner) ?timeout n ts
+
+  let wait_n_hlt ?timeout n ts =
+    wait_base_hlt ~inner_of:(fun t -> t.inner) ?timeout n ts
 end
 
 let write buffer t =
@@ -271,6 +678,374 @@ let write_hlt buffer t =
   end in
   f buffer t
 
+module Chain = struct
+  let read_n_buffer = Read.n_buffer
+  let read_complete inner buffer = Read.(complete {inner; buffer=Some buffer})
+  let write_complete inner buffer = Write.(complete {inner; buffer})
+
+  let submit_out (value, inners) =
+    let inners = Array.map inners ~f:register_user_data_finalizer in
+    match Sint.(value < kv 0L) with
+    | true -> Error (error_of_neg_errno value)
+    | false -> Ok inners
+
+  (* Reap the entire chain at once, after which completing each operation does not block. *)
+  let wait inners =
+    match wait_inner (Array.length inners) (-1L) inners with
+    | 0L -> None
+    | errno -> Some (Errno.of_uns_hlt (Uns.bits_of_sint errno))
+
+  let error_of_inner inner =
+    let value = complete_inner inner in
+    match Sint.(value < kv 0L) with
+    | true -> Some (error_of_neg_errno value)
+    | false -> None
+
+  let is_complete inners =
+    Array.for_all inners ~f:is_complete_inner
+
+  (* Chains require a fixed file table, without which submission fails with [EOPNOTSUPP]. The
+     operations are then instead submitted one at a time, each once the previous has completed. The
+     file is closed regardless of whether the operations on it succeed. *)
+  let read_unchained n buffer path =
+    match of_path path with
+    | Error error -> Error error
+    | Ok file -> begin
+        let read = match Read.submit ~n ~buffer ~off:0L file with
+          | Error error -> Error error
+          | Ok read -> Read.complete read
+        in
+        match read, close file with
+        | Error error, _
+        | Ok _, Some error -> Error error
+        | Ok buffer, None -> Ok buffer
+      end
+
+  let write_unchained flag mode buffer path =
+    match of_path ~flag ~mode path with
+    | Error error -> Error error
+    | Ok file -> begin
+        let write = match Write.submit ~off:0L buffer file with
+          | Error error -> Error error
+          | Ok write -> Write.complete write
+        in
+        let fsync = match write with
+          | Error _ -> None
+          | Ok _ -> fsync file
+        in
+        match write, fsync, close file with
+        | Error error, _, _
+        | Ok _, Some error, _
+        | Ok _, None, Some error -> Error error
+        | Ok buffer, None, None -> Ok buffer
+      end
+
+  module Read = struct
+    type inner = uns
+    type t =
+      | Chained of inner array * Bytes.Slice.t
+      | Unchained of (Bytes.Slice.t, Errno.t) result
+
+    external submit_inner: Bytes.t -> uns -> uns -> Stdlib.Bytes.t -> (sint * inner array) =
+      "hemlock_basis_file_read_chain_submit_inner"
+
+    let submit ?n ?buffer path =
+      let n, buffer = read_n_buffer ?n ?buffer () in
+      let path_bytes = bytes_of_path path in
+      match submit_out (submit_inner (Bytes.Slice.container buffer) (base_index buffer) n
+          path_bytes) with
+      | Error Errno.EOPNOTSUPP -> Ok (Unchained (read_unchained n buffer path))
+      | Error error -> Error error
+      | Ok inners -> Ok (Chained (inners, buffer))
+
+    let submit_hlt ?n ?buffer path =
+      match submit ?n ?buffer path with
+      | Error error -> halt (Errno.to_string error)
+      | Ok t -> t
+
+    let is_complete = function
+      | Chained (inners, _) -> is_complete inners
+      | Unchained _ -> true
+
+    let complete = function
+      | Unchained result -> result
+      | Chained (inners, buffer) -> begin
+          match wait inners with
+          | Some error -> Error error
+          | None -> begin
+              match error_of_inner (Array.get 0L inners) with
+              | Some error -> Error error
+              | None -> begin
+                  let read = read_complete (Array.get 1L inners) buffer in
+                  match read, error_of_inner (Array.get 2L inners) with
+                  | Error error, _
+                  | Ok _, Some error -> Error error
+                  | Ok buffer, None -> Ok buffer
+                end
+            end
+        end
+
+    let complete_hlt t =
+      match complete t with
+      | Ok buffer -> buffer
+      | Error error -> halt (Errno.to_string error)
+  end
+
+  module Write = struct
+    type inner = uns
+    type t =
+      | Chained of inner array * Bytes.Slice.t
+      | Unchained of (Bytes.Slice.t, Errno.t) result
+
+    external submit_inner: Flag.t -> uns -> Bytes.t -> uns -> uns -> Stdlib.Bytes.t ->
+      (sint * inner array) = "hemlock_basis_file_write_chain_submit_inner_byte"
+        "hemlock_basis_file_write_chain_submit_inner"
+
+    let submit ?(flag=Flag.W) ?(mode=0o660L) buffer path =
+      let path_bytes = bytes_of_path path in
+      match submit_out (submit_inner flag mode (Bytes.Slice.container buffer) (base_index buffer)
+          (Bytes.Slice.length buffer) path_bytes) with
+      | Error Errno.EOPNOTSUPP -> Ok (Unchained (write_unchained flag mode buffer path))
+      | Error error -> Error error
+      | Ok inners -> Ok (Chained (inners, buffer))
+
+    let submit_hlt ?(flag=Flag.W) ?(mode=0o660L) buffer path =
+      match submit ~flag ~mode buffer path with
+      | Error error -> halt (Errno.to_string error)
+      | Ok t -> t
+
+    let is_complete = function
+      | Chained (inners, _) -> is_complete inners
+      | Unchained _ -> true
+
+    let complete = function
+      | Unchained result -> result
+      | Chained (inners, buffer) -> begin
+          match wait inners with
+          | Some error -> Error error
+          | None -> begin
+              match error_of_inner (Array.get 0L inners) with
+              | Some error -> Error error
+              | None -> begin
+                  let write = write_complete (Array.get 1L inners) buffer in
+                  match write, error_of_inner (Array.get 2L inners),
+                    error_of_inner (Array.get 3L inners) with
+                  | Error error, _, _
+                  | Ok _, Some error, _
+                  | Ok _, None, Some error -> Error error
+                  | Ok buffer, None, None -> Ok buffer
+                end
+            end
+        end
+
+    let complete_hlt t =
+      match complete t with
+      | Ok buffer -> buffer
+      | Error error -> halt (Errno.to_string error)
+  end
+end
+
+module Splice = struct
+  type file = t
+  type inner = uns
+
+  external is_pipe_inner: file -> bool = "hemlock_basis_file_is_pipe_inner"
+  external pipe_inner: unit -> (sint * file * file) = "hemlock_basis_file_pipe_inner"
+  external submit_inner: uns -> file -> file -> (sint * inner) =
+    "hemlock_basis_file_splice_submit_inner"
+  external chain_submit_inner: uns -> file -> file -> file -> file -> (sint * inner array) =
+    "hemlock_basis_file_splice_chain_submit_inner"
+  external copy_file_range_inner: uns -> file -> file -> sint =
+    "hemlock_basis_file_copy_file_range_inner"
+
+  (* Bytes moved per splice(2) when one end is a pipe, and per copy_file_range(2). io_uring has no
+     copy_file_range operation, so each call blocks the executor thread, and is kept short. *)
+  let chunk_pipe = 1_048_576L
+  let chunk_copy = 1_048_576L
+
+  (* Bytes per buffer of the read/write loop. *)
+  let chunk_read_write = 65_536L
+
+  let result_of_value value =
+    match Sint.(value < kv 0L) with
+    | true -> Error (error_of_neg_errno value)
+    | false -> Ok (Uns.bits_of_sint value)
+
+  let splice n fd_in fd_out =
+    let value, inner = submit_inner n fd_in fd_out in
+    let inner = register_user_data_finalizer inner in
+    match Sint.(value < kv 0L) with
+    | true -> Error (error_of_neg_errno value)
+    | false -> result_of_value (complete_inner inner)
+
+  (* The loops below return the number of bytes moved, or the number of bytes moved before an
+     error, so that callers can tell whether it is safe to fall back to another method. *)
+
+  (* Splice directly when either end is a pipe. *)
+  let direct n src dst =
+    let rec f total = begin
+      match total = n with
+      | true -> Ok total
+      | false -> begin
+          match splice (Uns.min chunk_pipe (n - total)) src dst with
+          | Error error -> Error (total, error)
+          (* Some files, e.g. in procfs, sysfs, and FUSE filesystems, report 0 bytes copied even
+             though they are not at end of file. Treat that as unsupported, so that the copy falls
+             back to another method, which also handles empty files. *)
+          | Ok 0L when total = 0L -> Error (total, Errno.EOPNOTSUPP)
+          | Ok 0L -> Ok total
+          | Ok m -> f (total + m)
+        end
+    end in
+    f 0L
+
+  (* Splice through an intermediate pipe, as a linked pair of splices per chunk. If the first
+     splice is short, the second is canceled and the bytes left in the pipe are drained before the
+     next chunk. *)
+  let via_pipe n src dst =
+    match pipe_inner () with
+    | value, _, _ when Sint.(value < kv 0L) -> Error (0L, error_of_neg_errno value)
+    | capacity, pipe_in, pipe_out -> begin
+        let capacity = Uns.bits_of_sint capacity in
+        let rec drain total pending = begin
+          match pending = 0L with
+          | true -> None
+          | false -> begin
+              match splice pending pipe_in dst with
+              | Error error -> Some (total, error)
+              | Ok 0L -> Some (total, Errno.EIO)
+              | Ok m -> drain (total + m) (pending - m)
+            end
+        end in
+        let rec f total = begin
+          match total = n with
+          | true -> Ok total
+          | false -> begin
+              let chunk = Uns.min capacity (n - total) in
+              let value, inners = chain_submit_inner chunk src pipe_in pipe_out dst in
+              let inners = Array.map inners ~f:register_user_data_finalizer in
+              match Sint.(value < kv 0L) with
+              | true -> Error (total, error_of_neg_errno value)
+              | false -> begin
+                  let spliced_in = result_of_value (complete_inner (Array.get 0L inners)) in
+                  let spliced_out = result_of_value (complete_inner (Array.get 1L inners)) in
+                  match spliced_in, spliced_out with
+                  | Error error, _ -> Error (total, error)
+                  | Ok 0L, _ -> Ok total
+                  | Ok m, Ok m' -> begin
+                      match drain (total + m') (m - m') with
+                      | Some (total, error) -> Error (total, error)
+                      | None -> f (total + m)
+                    end
+                  | Ok m, Error Errno.ECANCELED -> begin
+                      match drain total m with
+                      | Some (total, error) -> Error (total, error)
+                      | None -> f (total + m)
+                    end
+                  | Ok _, Error error -> Error (total, error)
+                end
+            end
+        end in
+        let result = f 0L in
+        let _ = close pipe_in in
+        let _ = close pipe_out in
+        result
+      end
+
+  let splice_loop n src dst =
+    match is_pipe_inner src || is_pipe_inner dst with
+    | true -> direct n src dst
+    | false -> via_pipe n src dst
+
+  let copy_file_range n src dst =
+    let rec f total = begin
+      match total = n with
+      | true -> Ok total
+      | false -> begin
+          match result_of_value (copy_file_range_inner (Uns.min chunk_copy (n - total)) src
+              dst) with
+          | Error error -> Error (total, error)
+          (* Some files, e.g. in procfs, sysfs, and FUSE filesystems, report 0 bytes copied even
+             though they are not at end of file. Treat that as unsupported, so that the copy falls
+             back to another method, which also handles empty files. *)
+          | Ok 0L when total = 0L -> Error (total, Errno.EOPNOTSUPP)
+          | Ok 0L -> Ok total
+          | Ok m -> f (total + m)
+        end
+    end in
+    f 0L
+
+  (* Read each chunk into one buffer while writing the previous chunk from the other. *)
+  let read_write n src dst =
+    let submit_read total buffer =
+      Read.submit ~n:(Uns.min chunk_read_write (n - total)) ~buffer src in
+    let rec f total read spare = begin
+      match Read.complete read with
+      | Error error -> Error (total, error)
+      | Ok bytes when Bytes.Slice.length bytes = 0L -> Ok total
+      | Ok bytes -> begin
+          let total' = total + Bytes.Slice.length bytes in
+          let next = match total' < n with
+            | false -> None
+            | true -> Some (submit_read total' spare)
+          in
+          match write bytes dst, next with
+          | Some error, _ -> Error (total, error)
+          | None, None -> Ok total'
+          | None, Some (Error error) -> Error (total', error)
+          | None, Some (Ok read) -> f total' read (Bytes.Slice.init (Bytes.Slice.container bytes))
+        end
+    end in
+    match n = 0L with
+    | true -> Ok 0L
+    | false -> begin
+        let buffer = Bytes.(Slice.init (create chunk_read_write)) in
+        let spare = Bytes.(Slice.init (create chunk_read_write)) in
+        match submit_read 0L buffer with
+        | Error error -> Error (0L, error)
+        | Ok read -> f 0L read spare
+      end
+
+  (* Errors with which copy_file_range(2) and splice(2) reject files they do not support. *)
+  let is_unsupported = function
+    | Errno.EXDEV
+    | Errno.EINVAL
+    | Errno.ENOSYS
+    | Errno.EOPNOTSUPP
+    | Errno.EBADF -> true
+    | _ -> false
+
+  (* Fall back to [g] if [f] fails as unsupported before moving any bytes. *)
+  let fallback f g n src dst =
+    match f n src dst with
+    | Error (0L, error) when is_unsupported error -> g n src dst
+    | result -> result
+
+  let result_of_loop = function
+    | Ok total -> Ok total
+    | Error (_, error) -> Error error
+end
+
+let splice ?(n=Uns.max_value) src dst =
+  Splice.(result_of_loop (splice_loop n src dst))
+
+let splice_hlt ?n src dst =
+  match splice ?n src dst with
+  | Ok total -> total
+  | Error error -> halt (Errno.to_string error)
+
+let copy ?(n=Uns.max_value) ?(kernel=true) src dst =
+  Splice.(result_of_loop (
+    match kernel with
+    | false -> read_write n src dst
+    | true -> fallback copy_file_range (fallback splice_loop read_write) n src dst
+  ))
+
+let copy_hlt ?n ?kernel src dst =
+  match copy ?n ?kernel src dst with
+  | Ok total -> total
+  | Error error -> halt (Errno.to_string error)
+
 let seek_base inner rel_off t =
   let value = inner rel_off t in
   match Sint.(value < kv 0L) with
@@ -307,9 +1082,35 @@ module Stream = struct
   type file = t
   type t = Bytes.Slice.t Stream.t
 
-  let of_file file =
+  let chunk_default = 16384L
+  let window_default = 4L
+
+  external size_hint_inner: file -> sint = "hemlock_basis_file_size_hint_inner"
+
+  type pending = {
+    base: uns;
+    n: uns;
+    read: Read.t;
+  }
+
+  type state = {
+    file: file;
+    chunk: uns;
+    window: uns;
+    (* Expected file size, initially per fstat(2), but revised upward if the file grows. *)
+    size: uns;
+    (* Offset of the next read to submit. *)
+    off: uns;
+    (* Direct I/O alignment of reads, or 0 for buffered I/O. *)
+    align: uns;
+    (* In-flight reads, in offset order. *)
+    pendings: pending list;
+  }
+
+  (* Sequential reads, for files that do not support positional reads, e.g. pipes. *)
+  let of_file_sequential chunk file =
     let f file = begin
-      match read file with
+      match read ~n:chunk file with
       | Error _ -> None
       | Ok buffer -> begin
           match (Bytes.Slice.length buffer) > 0L with
@@ -322,6 +1123,81 @@ module Stream = struct
     end in
     Stream.init_indef file ~f
 
+  (* Keep up to [window] positional reads in flight. Reads are trimmed such that the last one ends
+     at [size], followed by a single read at [size] that confirms end of file. For direct I/O, reads
+     are instead rounded up to the alignment, into aligned buffers, and a short read ends the
+     stream, since end of file is not necessarily aligned. *)
+  let rec fill ({file; chunk; window; size; off; align; pendings} as state) =
+    match (List.length pendings) < window && off <= size with
+    | false -> state
+    | true -> begin
+        let n = match off < size with
+          | true -> Direct.round_up align (Uns.min chunk (size - off))
+          | false -> chunk
+        in
+        let buffer = match align with
+          | 0L -> None
+          | _ -> Some (Direct.buffer n file)
+        in
+        match Read.submit ~n ?buffer ~off file with
+        | Error _ -> state
+        | Ok read -> fill {state with off=(off + n); pendings=(pendings @ [{base=off; n; read}])}
+      end
+
+  let of_file_positional ~chunk ~window ~size ~off file =
+    let f state = begin
+      let state = fill state in
+      match state.pendings with
+      | [] -> begin
+          let _ = close state.file in
+          None
+        end
+      | {base; n; read} :: pendings -> begin
+          match Read.complete read with
+          | Error _ -> begin
+              let _ = close state.file in
+              None
+            end
+          | Ok buffer -> begin
+              let n_read = Bytes.Slice.length buffer in
+              match n_read = 0L, n_read < n with
+              | true, _ -> begin
+                  let _ = close state.file in
+                  None
+                end
+              | false, true -> begin
+                  let off = base + n_read in
+                  match state.align > 0L || off >= state.size with
+                  | true ->
+                    (* The read reached end of file. Submit no further reads, rather than
+                       confirming end of file at an offset that may be misaligned for direct
+                       I/O. *)
+                    Some (buffer, {state with size=off; off; window=0L; pendings=[]})
+                  | false ->
+                    (* The file shrank, so subsequent in-flight reads are misaligned. Abandon them
+                       and resume at the end of this read. *)
+                    Some (buffer, {state with size=off; off; pendings=[]})
+                end
+              | false, false ->
+                Some (buffer, {state with size=(Uns.max state.size (base + n_read)); pendings})
+            end
+        end
+    end in
+    let align = Direct.align file in
+    let chunk = Direct.round_up align chunk in
+    Stream.init_indef {file; chunk; window; size; off; align; pendings=[]} ~f
+
+  let of_file ?(chunk=chunk_default) ?(window=window_default) file =
+    let size_hint = size_hint_inner file in
+    match Sint.(size_hint < kv 0L) with
+    | true -> of_file_sequential chunk file
+    | false -> begin
+        match seek (Sint.kv 0L) file with
+        | Error _ -> of_file_sequential chunk file
+        | Ok off -> of_file_positional ~chunk ~window:(Uns.max 1L window)
+            ~size:(Uns.bits_of_sint size_hint) ~off file
+      end
+
   let write file t =
     let rec fn file t = begin
       match Lazy.force t with
@@ -346,10 +1222,47 @@ module Stream = struct
     fn file t
 end
 
+module Mmap = struct
+  type file = t
+
+  external mmap_inner: bool -> file -> (sint * Bytes.t) = "hemlock_basis_file_mmap_inner"
+  external munmap_inner: Bytes.t -> unit = "hemlock_basis_file_munmap_inner"
+
+  let of_file ?(populate=false) file =
+    let value, bytes = mmap_inner populate file in
+    match Sint.(value < kv 0L) with
+    | true -> Error (error_of_neg_errno value)
+    | false -> begin
+        let () = Stdlib.Gc.finalise munmap_inner bytes in
+        Ok (Bytes.Slice.init bytes)
+      end
+
+  let of_file_hlt ?populate file =
+    match of_file ?populate file with
+    | Error error -> halt (Errno.to_string error)
+    | Ok bytes -> bytes
+
+  let of_path ?populate path =
+    match of_path path with
+    | Error error -> Error error
+    | Ok file -> begin
+        let result = of_file ?populate file in
+        match close file, result with
+        | Some error, Ok _ -> Error error
+        | _, result -> result
+      end
+
+  let of_path_hlt ?populate path =
+    match of_path ?populate path with
+    | Error error -> halt (Errno.to_string error)
+    | Ok bytes -> bytes
+end
+
 module Fmt = struct
   let bufsize_default = 4096L
+  let nbufs_default = 1L
 
-  let of_t ?(bufsize=bufsize_default) t : (module Fmt.Formatter) =
+  let of_t_sync bufsize t : (module Fmt.Formatter) =
     (module struct
       type nonrec t = {
         file: t;
@@ -366,63 +1279,52 @@ module Fmt = struct
       }
 
       let fmt s t =
-        let slice = Bytes.Slice.of_string_slice (String.C.Slice.of_string s) in
-        match Bytes.Slice.length slice, t.bufsize with
+        let n = String.B.length s in
+        match n, t.bufsize with
         | 0L, _ -> t (* No-op. *)
         | _, 0L -> begin
             (* Unbuffered. *)
-            write_hlt slice t.file;
+            write_hlt (Bytes.Slice.of_string_slice (String.C.Slice.of_string s)) t.file;
             t
           end
         | _ -> begin
             (* Initialize buf/pos if this is the first write. *)
             let () = match t.buf with
               | None -> begin
-                  let buf = Array.init (0L =:< bufsize) ~f:(fun _ -> U8.zero) in
+                  let buf = Bytes.create bufsize in
                   t.buf <- Some buf;
                   t.pos <- Some (Bytes.Cursor.hd buf)
                 end
               | Some _ -> ()
             in
 
-            (* Fill/flush buf repeatedly until it is not full. *)
-            let rec fn t slice = begin
+            (* Fill/flush buf repeatedly until [s] is consumed. Bytes are copied straight from [s]
+               into buf, and buf is written without further copying. *)
+            let rec fn t i = begin
               match t.buf, t.pos with
               | Some buf, Some pos -> begin
                   let pos_index = Bytes.Cursor.index pos in
-                  let buf_avail = t.bufsize - pos_index in
-                  let slice_length = Bytes.Slice.length slice in
-                  match (Bytes.Slice.length slice) < buf_avail with
+                  let m = Uns.min (t.bufsize - pos_index) (n - i) in
+                  Bytes.Slice.blit_of_string i s
+                    (Bytes.Slice.init ~range:(pos_index =:< (pos_index + m)) buf);
+                  match (pos_index + m) < t.bufsize with
                   | true -> begin
                       (* Partial fill. *)
-                      let buf_range = (pos_index =:< (pos_index + slice_length)) in
-                      Array.Slice.blit (Array.Slice.init ~range:(Bytes.Slice.range slice)
-                        (Bytes.Slice.container slice)) (Array.Slice.init ~range:buf_range buf);
-                      t.pos <- Some (Bytes.Cursor.seek (Uns.bits_to_sint slice_length) pos);
+                      t.pos <- Some (Bytes.Cursor.seek (Uns.bits_to_sint m) pos);
                       t
                     end
                   | false -> begin
                       (* Complete fill. *)
-                      let slice_base = Bytes.Slice.base slice in
-                      let slice_mid = Bytes.Cursor.seek (Uns.bits_to_sint buf_avail) slice_base in
-                      let slice_range =
-                        (Bytes.Cursor.index slice_base =:< Bytes.Cursor.index slice_mid) in
-                      let buf_range = (pos_index =:< t.bufsize) in
-                      Array.Slice.blit
-                        (Array.Slice.init ~range:slice_range (Bytes.Slice.container slice))
-                        (Array.Slice.init ~range:buf_range buf);
-                      (* Flush. *)
-                      write_hlt (Bytes.Slice.init ~range:(0L =:< t.bufsize) buf) t.file;
-
-                      let slice' = Bytes.Slice.of_cursors ~base:slice_mid
-                          ~past:(Bytes.Slice.past slice) in
+                      write_hlt (Bytes.Slice.init buf) t.file;
                       t.pos <- Some (Bytes.Cursor.hd buf);
-                      fn t slice'
+                      match (i + m) < n with
+                      | true -> fn t (i + m)
+                      | false -> t
                     end
                 end
               | _ -> not_reached ()
             end in
-            fn t slice
+            fn t 0L
           end
 
       let sync t =
@@ -439,6 +1341,150 @@ module Fmt = struct
         Fmt.Synced t
     end)
 
+  let of_t_async bufsize nbufs t : (module Fmt.Formatter) =
+    (module struct
+      (* Each buffer is at any time either being filled, free, queued for writing, or in flight. At
+         most one write is in flight so that writes at the current file position cannot be
+         reordered; all buffers queued while it is in flight are coalesced into the next write. *)
+      type nonrec t = {
+        file: t;
+        bufsize: uns;
+        nbufs: uns;
+        mutable n_allocated: uns;
+        mutable cur: Bytes.t option;
+        mutable pos: uns;
+        mutable free: Bytes.t list;
+        mutable queued_rev: (Bytes.t * Bytes.Slice.t) list;
+        mutable inflight: (Writev.t * (Bytes.t * Bytes.Slice.t) list) option;
+      }
+
+      let state = {
+        file=t;
+        bufsize;
+        nbufs;
+        n_allocated=0L;
+        cur=None;
+        pos=0L;
+        free=[];
+        queued_rev=[];
+        inflight=None;
+      }
+
+      (* Block until the in-flight write (if any) completes. Fully written buffers are freed, and
+         the unwritten suffixes of any short write are requeued ahead of all other queued buffers.
+      *)
+      let reap t =
+        match t.inflight with
+        | None -> ()
+        | Some (writev, pairs) -> begin
+            let remainders = Writev.complete_hlt writev in
+            let unfinished_rev = List.fold2 ~init:[] pairs remainders
+                ~f:(fun unfinished_rev (buf, _) remainder ->
+                  match Bytes.Slice.length remainder with
+                  | 0L -> begin
+                      t.free <- buf :: t.free;
+                      unfinished_rev
+                    end
+                  | _ -> (buf, remainder) :: unfinished_rev
+                ) in
+            t.inflight <- None;
+            t.queued_rev <- t.queued_rev @ unfinished_rev
+          end
+
+      (* Submit all queued buffers as a single write, unless a write is already in flight. *)
+      let submit t =
+        match t.inflight, t.queued_rev with
+        | Some _, _
+        | None, [] -> ()
+        | None, _ -> begin
+            let pairs = List.rev t.queued_rev in
+            let writev = Writev.submit_hlt (List.map pairs ~f:(fun (_, slice) -> slice)) t.file in
+            t.inflight <- Some (writev, pairs);
+            t.queued_rev <- []
+          end
+
+      (* Make progress without blocking. *)
+      let progress t =
+        let () = match t.inflight with
+          | Some (writev, _) when Writev.is_complete writev -> reap t
+          | _ -> ()
+        in
+        submit t
+
+      (* Acquire a buffer to fill, blocking only if all buffers are queued or in flight. *)
+      let rec acquire t =
+        match t.free with
+        | buf :: free' -> begin
+            t.free <- free';
+            buf
+          end
+        | [] when t.n_allocated < t.nbufs -> begin
+            t.n_allocated <- Uns.succ t.n_allocated;
+            Bytes.create t.bufsize
+          end
+        | [] -> begin
+            reap t;
+            submit t;
+            acquire t
+          end
+
+      let enqueue buf t =
+        t.queued_rev <- (buf, Bytes.Slice.init ~range:(0L =:< t.pos) buf) :: t.queued_rev;
+        t.cur <- None;
+        t.pos <- 0L
+
+      let fmt s t =
+        let n = String.B.length s in
+        let rec fn t i = begin
+          match i < n with
+          | false -> t
+          | true -> begin
+              let buf = match t.cur with
+                | Some buf -> buf
+                | None -> begin
+                    let buf = acquire t in
+                    t.cur <- Some buf;
+                    buf
+                  end
+              in
+              let m = Uns.min (t.bufsize - t.pos) (n - i) in
+              Bytes.Slice.blit_of_string i s (Bytes.Slice.init ~range:(t.pos =:< (t.pos + m)) buf);
+              t.pos <- t.pos + m;
+              if t.pos = t.bufsize then begin
+                (* Complete fill. *)
+                enqueue buf t;
+                progress t
+              end;
+              fn t (i + m)
+            end
+        end in
+        fn t 0L
+
+      let sync t =
+        let () = match t.cur with
+          | Some buf when t.pos > 0L -> enqueue buf t
+          | _ -> ()
+        in
+        let rec drain t = begin
+          match t.inflight, t.queued_rev with
+          | None, [] -> ()
+          | _ -> begin
+              reap t;
+              submit t;
+              drain t
+            end
+        end in
+        drain t;
+        Fmt.Synced t
+    end)
+
+  let of_t ?(bufsize=bufsize_default) ?(nbufs=nbufs_default) t =
+    match bufsize, nbufs with
+    | 0L, _
+    | _, 0L
+    | _, 1L -> of_t_sync bufsize t
+    | _ -> of_t_async bufsize nbufs t
+
   let stdout = of_t stdout
 
   let stderr = of_t ~bufsize:0L stderr
@@ -458,17 +1504,16 @@ module Fmt = struct
     ()
 end
 
-external setup_inner: unit -> sint = "hemlock_basis_executor_setup_inner"
-
 let () = begin
-  match setup_inner () = 0L with
-  | false -> halt "Setup failure"
-  | true -> ()
+  match Executor.setup Executor.Conf.default with
+  | Some _ -> halt "Setup failure"
+  | None -> ()
 end
 
 external teardown_inner: unit -> unit = "hemlock_basis_executor_teardown_inner"
 
 let () = Stdlib.at_exit (fun () ->
+  let _ = Executor.Pool.stop () in
   let _ = Fmt.teardown () in
   let _ = teardown_inner () in
   ()
@@ -53,17 +53,46 @@ module Open: sig
   val complete_hlt: t -> file
   (** [complete_hlt t] blocks until given [t] is complete. Returns a [file] or halts if the file
       could not be opened. *)
+
+  val is_complete: t -> bool
+  (** [is_complete t] returns true if the given [t] is complete, i.e. [complete t] would not block.
+  *)
+
+  val wait_any: ?timeout:uns -> t list -> (t list * t list, Errno.t) result
+  (** [wait_any ?timeout ts] blocks until at least one of the given [ts] is complete, or until
+      [timeout] nanoseconds elapse. Returns the [(complete, pending)] partition of [ts], where
+      [complete] is empty if the timeout elapsed first, or an [Errno.t] if completions could not be
+      reaped. *)
+
+  val wait_any_hlt: ?timeout:uns -> t list -> t list * t list
+  (** [wait_any_hlt ?timeout ts] blocks until at least one of the given [ts] is complete, or until
+      [timeout] nanoseconds elapse. Returns the [(complete, pending)] partition of [ts] or halts if
+      completions could not be reaped. *)
+
+  val wait_n: ?timeout:uns -> uns -> t list -> (t list * t list, Errno.t) result
+  (** [wait_n ?timeout n ts] blocks until at least [n] of the given [ts] are complete, or until
+      [timeout] nanoseconds elapse. All completions available to the executor are reaped with as few
+      system calls as possible. Returns the [(complete, pending)] partition of [ts], where
+      [complete] may contain fewer than [n] elements if the timeout elapsed first, or an [Errno.t]
+      if completions could not be reaped. *)
+
+  val wait_n_hlt: ?timeout:uns -> uns -> t list -> t list * t list
+  (** [wait_n_hlt ?timeout n ts] blocks until at least [n] of the given [ts] are complete, or until
+      [timeout] nanoseconds elapse. Returns the [(complete, pending)] partition of [ts] or halts if
+      completions could not be reaped. *)
 end
 
-val of_path: ?flag:Flag.t -> ?mode:uns -> Path.t -> (t, Errno.t) result
-(** [of_path ~flag ~mode path] opens or creates the file at [path] with [flag] (default Flag.R_O)
-    Unix file permissions and [mode] (default 0o660) Unix file permissions and and returns the
-    resulting [t] or an [Errno.t] if the file could not be opened. *)
+val of_path: ?flag:Flag.t -> ?mode:uns -> ?direct:bool -> Path.t -> (t, Errno.t) result
+(** [of_path ~flag ~mode ~direct path] opens or creates the file at [path] with [flag] (default
+    Flag.R_O) Unix file permissions and [mode] (default 0o660) Unix file permissions, for direct I/O
+    if [direct] is true (default false; see [Direct]), and returns the resulting [t] or an [Errno.t]
+    if the file could not be opened. *)
 
-val of_path_hlt: ?flag:Flag.t -> ?mode:uns -> Path.t -> t
-(** [of_path_hlt ~flag ~mode path] opens or creates the file at [path] with [flag] (default
-    Flag.R_O) Unix file permissions and [mode] (default 0o660) Unix file permissions and and returns
-    the resulting [t] or halts if the file could not be opened. *)
+val of_path_hlt: ?flag:Flag.t -> ?mode:uns -> ?direct:bool -> Path.t -> t
+(** [of_path_hlt ~flag ~mode ~direct path] opens or creates the file at [path] with [flag] (default
+    Flag.R_O) Unix file permissions and [mode] (default 0o660) Unix file permissions, for direct I/O
+    if [direct] is true (default false), and returns the resulting [t] or halts if the file could
+    not be opened. *)
 
 module Close: sig
   type file = t
@@ -85,6 +114,33 @@ module Close: sig
   val complete_hlt: t -> unit
   (** [complete_hlt t] blocks until the given [t] is complete. Returns a [unit] or halts if file
       could not be closed. *)
+
+  val is_complete: t -> bool
+  (** [is_complete t] returns true if the given [t] is complete, i.e. [complete t] would not block.
+  *)
+
+  val wait_any: ?timeout:uns -> t list -> (t list * t list, Errno.t) result
+  (** [wait_any ?timeout ts] blocks until at least one of the given [ts] is complete, or until
+      [timeout] nanoseconds elapse. Returns the [(complete, pending)] partition of [ts], where
+      [complete] is empty if the timeout elapsed first, or an [Errno.t] if completions could not be
+      reaped. *)
+
+  val wait_any_hlt: ?timeout:uns -> t list -> t list * t list
+  (** [wait_any_hlt ?timeout ts] blocks until at least one of the given [ts] is complete, or until
+      [timeout] nanoseconds elapse. Returns the [(complete, pending)] partition of [ts] or halts if
+      completions could not be reaped. *)
+
+  val wait_n: ?timeout:uns -> uns -> t list -> (t list * t list, Errno.t) result
+  (** [wait_n ?timeout n ts] blocks until at least [n] of the given [ts] are complete, or until
+      [timeout] nanoseconds elapse. All completions available to the executor are reaped with as few
+      system calls as possible. Returns the [(complete, pending)] partition of [ts], where
+      [complete] may contain fewer than [n] elements if the timeout elapsed first, or an [Errno.t]
+      if completions could not be reaped. *)
+
+  val wait_n_hlt: ?timeout:uns -> uns -> t list -> t list * t list
+  (** [wait_n_hlt ?timeout n ts] blocks until at least [n] of the given [ts] are complete, or until
+      [timeout] nanoseconds elapse. Returns the [(complete, pending)] partition of [ts] or halts if
+      completions could not be reaped. *)
 end
 
 val close: t -> Errno.t option
@@ -95,24 +151,170 @@ val close_hlt: t -> unit
 (** [close_hlt t] closes the external mutable Unix file descriptor associated with [t] and returns a
     [unit] or halts if it could not be closed. *)
 
+module Fsync: sig
+  type file = t
+  type t
+  (* An internally immutable token backed by an external I/O fsync completion data structure. *)
+
+  val submit: ?datasync:bool -> file -> (t, Errno.t) result
+  (** [submit ~datasync file] submits a flush of [file]'s data and metadata to storage, or only of
+      the metadata needed to read the data back if [datasync] is true (default false). This
+      operation does not block. Returns a [t] to the fsync submission or an [Errno.t] if the fsync
+      could not be submitted. *)
+
+  val submit_hlt: ?datasync:bool -> file -> t
+  (** [submit_hlt ~datasync file] is like [submit], but halts if the fsync could not be submitted.
+  *)
+
+  val complete: t -> Errno.t option
+  (** [complete t] blocks until the given [t] is complete. Returns [None] or an [Errno.t] if the
+      file could not be flushed. *)
+
+  val complete_hlt: t -> unit
+  (** [complete_hlt t] blocks until the given [t] is complete. Returns a [unit] or halts if the file
+      could not be flushed. *)
+
+  val is_complete: t -> bool
+  (** [is_complete t] returns true if the given [t] is complete, i.e. [complete t] would not block.
+  *)
+
+  val wait_any: ?timeout:uns -> t list -> (t list * t list, Errno.t) result
+  (** [wait_any ?timeout ts] is like [Close.wait_any]. *)
+
+  val wait_any_hlt: ?timeout:uns -> t list -> t list * t list
+  (** [wait_any_hlt ?timeout ts] is like [Close.wait_any_hlt]. *)
+
+  val wait_n: ?timeout:uns -> uns -> t list -> (t list * t list, Errno.t) result
+  (** [wait_n ?timeout n ts] is like [Close.wait_n]. *)
+
+  val wait_n_hlt: ?timeout:uns -> uns -> t list -> t list * t list
+  (** [wait_n_hlt ?timeout n ts] is like [Close.wait_n_hlt]. *)
+end
+
+val fsync: ?datasync:bool -> t -> Errno.t option
+(** [fsync ~datasync t] flushes [t] to storage as for [Fsync.submit], and returns [None] or an
+    [Errno.t] if it could not be flushed. *)
+
+val fsync_hlt: ?datasync:bool -> t -> unit
+(** [fsync_hlt ~datasync t] flushes [t] to storage as for [Fsync.submit], and returns a [unit] or
+    halts if it could not be flushed. *)
+
+module Fallocate: sig
+  type file = t
+  type t
+  (* An internally immutable token backed by an external I/O fallocate completion data structure. *)
+
+  val submit: ?keep_size:bool -> off:uns -> n:uns -> file -> (t, Errno.t) result
+  (** [submit ~keep_size ~off ~n file] submits allocation of storage for the [n] bytes of [file]
+      starting at offset [off]. The file size grows to cover the range unless [keep_size] is true
+      (default false). This operation does not block. Returns a [t] to the fallocate submission or
+      an [Errno.t] if the fallocate could not be submitted. *)
+
+  val submit_hlt: ?keep_size:bool -> off:uns -> n:uns -> file -> t
+  (** [submit_hlt ~keep_size ~off ~n file] is like [submit], but halts if the fallocate could not
+      be submitted. *)
+
+  val complete: t -> Errno.t option
+  (** [complete t] blocks until the given [t] is complete. Returns [None] or an [Errno.t] if
+      storage could not be allocated. *)
+
+  val complete_hlt: t -> unit
+  (** [complete_hlt t] blocks until the given [t] is complete. Returns a [unit] or halts if storage
+      could not be allocated. *)
+
+  val is_complete: t -> bool
+  (** [is_complete t] returns true if the given [t] is complete, i.e. [complete t] would not block.
+  *)
+
+  val wait_any: ?timeout:uns -> t list -> (t list * t list, Errno.t) result
+  (** [wait_any ?timeout ts] is like [Close.wait_any]. *)
+
+  val wait_any_hlt: ?timeout:uns -> t list -> t list * t list
+  (** [wait_any_hlt ?timeout ts] is like [Close.wait_any_hlt]. *)
+
+  val wait_n: ?timeout:uns -> uns -> t list -> (t list * t list, Errno.t) result
+  (** [wait_n ?timeout n ts] is like [Close.wait_n]. *)
+
+  val wait_n_hlt: ?timeout:uns -> uns -> t list -> t list * t list
+  (** [wait_n_hlt ?timeout n ts] is like [Close.wait_n_hlt]. *)
+end
+
+val fallocate: ?keep_size:bool -> off:uns -> n:uns -> t -> Errno.t option
+(** [fallocate ~keep_size ~off ~n t] allocates storage as for [Fallocate.submit], and returns [None]
+    or an [Errno.t] if storage could not be allocated. *)
+
+val fallocate_hlt: ?keep_size:bool -> off:uns -> n:uns -> t -> unit
+(** [fallocate_hlt ~keep_size ~off ~n t] allocates storage as for [Fallocate.submit], and returns a
+    [unit] or halts if storage could not be allocated. *)
+
+(** Direct I/O, i.e. files opened with [O_DIRECT], which transfer data between buffers and storage
+    without going through the page cache, so that e.g. large sequential scans do not evict other
+    cached data. Direct I/O requires buffer addresses, file offsets, and lengths to be aligned,
+    typically to the logical block size of the underlying device. Reads and writes of a file opened
+    for direct I/O validate their alignment, and a misaligned read or write fails with
+    [Errno.EINVAL]. Files on filesystems that do not support direct I/O perform buffered I/O
+    instead. *)
+module Direct: sig
+  type file = t
+
+  val align: file -> uns
+  (** [align file] returns the alignment of offsets and lengths of reads and writes for which
+      [file] performs direct I/O, or 0 if [file] performs buffered I/O. *)
+
+  val buffer: uns -> file -> Bytes.Slice.t
+  (** [buffer n file] returns a buffer of at least [n] bytes, rounded up to a multiple of
+      [align file], whose address is aligned for direct I/O. Buffers of up to 128 KiB are carved
+      from memory registered with every executor's I/O ring while it lasts, so that [Read] and
+      [Write] within them use fixed-buffer operations, which skip per-operation page pinning. Other
+      buffers are allocated from a pool of the current executor. Buffers return once unreachable.
+      *)
+end
+
 module Read: sig
   type file = t
   type t
   (* An internally immutable token backed by an external I/O read completion data structure. *)
 
-  val submit: ?n:uns -> ?buffer:Bytes.Slice.t -> file -> (t, Errno.t) result
-  (** [submit ?n ?buffer file] submits a read for given [file]. If given, [n] is the maximum read
-      size and 1024 otherwise. If given, [buffer] is where read bytes are stored and the maximum
-      read size is the minumum of [n] and the size of [buffer]. If [buffer] is not given, one will
-      be created with size [n]. This operation does not block. Returns a [t] to the read submission
-      or an [Errno.t] if the read could not be submitted. *)
+  val submit: ?n:uns -> ?buffer:Bytes.Slice.t -> ?off:uns -> ?timeout:uns -> file
+    -> (t, Errno.t) result
+  (** [submit ?n ?buffer ?off ?timeout file] submits a read for given [file]. If given, [n] is the
+      maximum read size and 1024 otherwise. If given, [buffer] is where read bytes are stored and
+      the maximum read size is the minumum of [n] and the size of [buffer]. If [buffer] is not
+      given, one will be created with size [n]. If given, [off] is the file offset to read from, in
+      which case the file position is neither used nor updated, and concurrent reads do not
+      interfere with each other; otherwise the read is from the current file position. If given,
+      the read is cancelled unless it completes within [timeout] nanoseconds, e.g. on a stalled pipe
+      or network mount, in which case it completes with [Errno.ECANCELED]. Bytes are read directly
+      into [buffer], the contents of which are unspecified until the read completes. This operation
+      does not block. Returns a [t] to the read submission or an [Errno.t] if the read could not be
+      submitted. *)
+
+  val submit_hlt: ?n:uns -> ?buffer:Bytes.Slice.t -> ?off:uns -> ?timeout:uns -> file -> t
+  (** [submit n buffer off timeout file] submits a read for given [file]. If given, [n] is the
+      maximum read size and 1024 otherwise. If given, [buffer] is where read bytes are stored and
+      the maximum read size is the minumum of [n] and the size of [buffer]. If [buffer] is not
+      given, one will be created with size [n]. If given, [off] is the file offset to read from
+      rather than the current file position. If given, the read is cancelled unless it completes
+      within [timeout] nanoseconds. This operation does not block. Returns a [t] to the read
+      submission or halts if the read could not be submitted. *)
+
+  val submit_select: ?n:uns -> ?off:uns -> ?timeout:uns -> file -> (t, Errno.t) result
+  (** [submit_select ?n ?off ?timeout file] submits a read for given [file] like [submit], except
+      that rather than reading into a buffer allocated up front, the executor selects a buffer from
+      its ring of provided buffers once data are available, so that many concurrent reads of e.g.
+      pipes can be outstanding without each tying up a buffer. The maximum read size is the minimum
+      of [n] (1024 if not given) and the executor's provided buffer size. The buffer is returned to
+      the ring once both [t] and the slice returned by [complete t] are unreachable. The read
+      completes with [Errno.ENOBUFS] if all provided buffers are in use. If the kernel does not
+      support provided buffer rings, this is equivalent to [submit ?n ?off ?timeout file]. This
+      operation does not block. Returns a [t] to the read submission or an [Errno.t] if the read
+      could not be submitted. *)
 
-  val submit_hlt: ?n:uns -> ?buffer:Bytes.Slice.t -> file -> t
-  (** [submit n buffer file] submits a read for given [file]. If given, [n] is the maximum read size
-      and 1024 otherwise. If given, [buffer] is where read bytes are stored and the maximum read
-      size is the minumum of [n] and the size of [buffer]. If [buffer] is not given, one will be
-      created with size [n]. This operation does not block. Returns a [t] to the read submission or
-      halts if the read could not be submitted. *)
+  val submit_select_hlt: ?n:uns -> ?off:uns -> ?timeout:uns -> file -> t
+  (** [submit_select_hlt ?n ?off ?timeout file] submits a read for given [file] like [submit_hlt],
+      except that the executor selects a buffer from its ring of provided buffers once data are
+      available. This operation does not block. Returns a [t] to the read submission or halts if the
+      read could not be submitted. *)
 
   val complete: t -> (Bytes.Slice.t, Errno.t) result
   (** [complete t] blocks until the given [t] is complete. Returns the buffer into which bytes were
@@ -121,6 +323,45 @@ module Read: sig
   val complete_hlt: t -> Bytes.Slice.t
   (** [complete_hlt t] blocks until the given [t] is complete. Returns the buffer into which bytes
       were read or halts if bytes could not be read. *)
+
+  val is_complete: t -> bool
+  (** [is_complete t] returns true if the given [t] is complete, i.e. [complete t] would not block.
+  *)
+
+  val cancel: t -> Errno.t option
+  (** [cancel t] requests cancellation of the given [t], if it is not yet complete. The read still
+      completes, with [Errno.ECANCELED] if it was cancelled before transferring any bytes, or as
+      usual otherwise. Cancellation does not block, and only takes effect once the executor next
+      submits I/O, e.g. upon [complete t]. Returns an [Errno.t] if cancellation could not be
+      requested, e.g. [Errno.EINVAL] if [t] was submitted by another executor. *)
+
+  val cancel_hlt: t -> unit
+  (** [cancel_hlt t] requests cancellation of the given [t], if it is not yet complete. The read
+      still completes, with [Errno.ECANCELED] if it was cancelled in time. Halts if cancellation
+      could not be requested. *)
+
+  val wait_any: ?timeout:uns -> t list -> (t list * t list, Errno.t) result
+  (** [wait_any ?timeout ts] blocks until at least one of the given [ts] is complete, or until
+      [timeout] nanoseconds elapse. Returns the [(complete, pending)] partition of [ts], where
+      [complete] is empty if the timeout elapsed first, or an [Errno.t] if completions could not be
+      reaped. *)
+
+  val wait_any_hlt: ?timeout:uns -> t list -> t list * t list
+  (** [wait_any_hlt ?timeout ts] blocks until at least one of the given [ts] is complete, or until
+      [timeout] nanoseconds elapse. Returns the [(complete, pending)] partition of [ts] or halts if
+      completions could not be reaped. *)
+
+  val wait_n: ?timeout:uns -> uns -> t list -> (t list * t list, Errno.t) result
+  (** [wait_n ?timeout n ts] blocks until at least [n] of the given [ts] are complete, or until
+      [timeout] nanoseconds elapse. All completions available to the executor are reaped with as few
+      system calls as possible. Returns the [(complete, pending)] partition of [ts], where
+      [complete] may contain fewer than [n] elements if the timeout elapsed first, or an [Errno.t]
+      if completions could not be reaped. *)
+
+  val wait_n_hlt: ?timeout:uns -> uns -> t list -> t list * t list
+  (** [wait_n_hlt ?timeout n ts] blocks until at least [n] of the given [ts] are complete, or until
+      [timeout] nanoseconds elapse. Returns the [(complete, pending)] partition of [ts] or halts if
+      completions could not be reaped. *)
 end
 
 val read: ?n:uns -> ?buffer:Bytes.Slice.t -> t -> (Bytes.Slice.t, Errno.t) result
@@ -137,20 +378,96 @@ val read_hlt: ?n:uns -> ?buffer:Bytes.Slice.t -> t -> Bytes.Slice.t
     [n]. Returns the [Bytes.Slice.t] into which bytes were read or halts if bytes could not be read.
 *)
 
+(** Positional vectored reads. A single read at a given file offset fills a sequence of buffers, and
+    the file position is neither used nor updated. Any number of positional reads may be in flight
+    on the same file at once, e.g. to read independent chunks of a large file concurrently. *)
+module Pread: sig
+  type file = t
+  type t
+  (* An internally immutable token backed by an external I/O readv completion data structure. *)
+
+  val submit: off:uns -> ?timeout:uns -> Bytes.Slice.t list -> file -> (t, Errno.t) result
+  (** [submit ~off ?timeout buffers file] submits a read of given [file] at offset [off] that fills
+      [buffers] in order, directly rather than via intermediate buffers. If given, the read is
+      cancelled unless it completes within [timeout] nanoseconds, in which case it completes with
+      [Errno.ECANCELED]. This operation does not block. Returns a [t] to the read submission or an
+      [Errno.t] if the read could not be submitted. *)
+
+  val submit_hlt: off:uns -> ?timeout:uns -> Bytes.Slice.t list -> file -> t
+  (** [submit_hlt ~off ?timeout buffers file] submits a read of given [file] at offset [off] that
+      fills [buffers] in order. If given, the read is cancelled unless it completes within [timeout]
+      nanoseconds. This operation does not block. Returns a [t] to the read submission or halts if
+      the read could not be submitted. *)
+
+  val complete: t -> (Bytes.Slice.t list, Errno.t) result
+  (** [complete t] blocks until the given [t] is complete. Returns the read-filled prefixes of the
+      submitted buffers, which are shorter than the buffers (possibly empty) if the read was short,
+      or an [Errno.t] if bytes could not be read. *)
+
+  val complete_hlt: t -> Bytes.Slice.t list
+  (** [complete_hlt t] blocks until the given [t] is complete. Returns the read-filled prefixes of
+      the submitted buffers or halts if bytes could not be read. *)
+
+  val is_complete: t -> bool
+  (** [is_complete t] returns true if the given [t] is complete, i.e. [complete t] would not block.
+  *)
+
+  val cancel: t -> Errno.t option
+  (** [cancel t] requests cancellation of the given [t], if it is not yet complete. The read still
+      completes, with [Errno.ECANCELED] if it was cancelled before transferring any bytes, or as
+      usual otherwise. Cancellation does not block, and only takes effect once the executor next
+      submits I/O, e.g. upon [complete t]. Returns an [Errno.t] if cancellation could not be
+      requested, e.g. [Errno.EINVAL] if [t] was submitted by another executor. *)
+
+  val cancel_hlt: t -> unit
+  (** [cancel_hlt t] requests cancellation of the given [t], if it is not yet complete. The read
+      still completes, with [Errno.ECANCELED] if it was cancelled in time. Halts if cancellation
+      could not be requested. *)
+
+  val wait_any: ?timeout:uns -> t list -> (t list * t list, Errno.t) result
+  (** [wait_any ?timeout ts] blocks until at least one of the given [ts] is complete, or until
+      [timeout] nanoseconds elapse. Returns the [(complete, pending)] partition of [ts], where
+      [complete] is empty if the timeout elapsed first, or an [Errno.t] if completions could not be
+      reaped. *)
+
+  val wait_any_hlt: ?timeout:uns -> t list -> t list * t list
+  (** [wait_any_hlt ?timeout ts] blocks until at least one of the given [ts] is complete, or until
+      [timeout] nanoseconds elapse. Returns the [(complete, pending)] partition of [ts] or halts if
+      completions could not be reaped. *)
+
+  val wait_n: ?timeout:uns -> uns -> t list -> (t list * t list, Errno.t) result
+  (** [wait_n ?timeout n ts] blocks until at least [n] of the given [ts] are complete, or until
+      [timeout] nanoseconds elapse. All completions available to the executor are reaped with as few
+      system calls as possible. Returns the [(complete, pending)] partition of [ts], where
+      [complete] may contain fewer than [n] elements if the timeout elapsed first, or an [Errno.t]
+      if completions could not be reaped. *)
+
+  val wait_n_hlt: ?timeout:uns -> uns -> t list -> t list * t list
+  (** [wait_n_hlt ?timeout n ts] blocks until at least [n] of the given [ts] are complete, or until
+      [timeout] nanoseconds elapse. Returns the [(complete, pending)] partition of [ts] or halts if
+      completions could not be reaped. *)
+end
+
 module Write: sig
   type file = t
   type t
   (* An internally immutable token backed by an external I/O write completion data structure. *)
 
-  val submit: Bytes.Slice.t -> file -> (t, Errno.t) result
-  (** [submit bytes file] submits a write for of given [bytes] to given [file]. This operation does
-      not block. Returns a [t] to the write submission or an [Errno.t] if the write could not be
-      submitted. *)
-
-  val submit_hlt: Bytes.Slice.t -> file -> t
-  (** [submit bytes file] submits a write for of given [bytes] to given [file]. This operation
-      does not block. Returns a [t] to the write submission or halts if the write could not be
-      submitted. *)
+  val submit: ?off:uns -> ?timeout:uns -> Bytes.Slice.t -> file -> (t, Errno.t) result
+  (** [submit ?off ?timeout bytes file] submits a write for of given [bytes] to given [file]. If
+      given, [off] is the file offset to write at, in which case the file position is neither used
+      nor updated; otherwise the write is at the current file position. If given, the write is
+      cancelled unless it completes within [timeout] nanoseconds, in which case it completes with
+      [Errno.ECANCELED]. Bytes are written directly from [bytes], which must not be modified until
+      the write completes. This operation does not block. Returns a [t] to the write submission or
+      an [Errno.t] if the write could not be submitted. *)
+
+  val submit_hlt: ?off:uns -> ?timeout:uns -> Bytes.Slice.t -> file -> t
+  (** [submit ?off ?timeout bytes file] submits a write for of given [bytes] to given [file]. If
+      given, [off] is the file offset to write at rather than the current file position. If given,
+      the write is cancelled unless it completes within [timeout] nanoseconds. This operation does
+      not block. Returns a [t] to the write submission or halts if the write could not be submitted.
+  *)
 
   val complete: t ->  (Bytes.Slice.t, Errno.t) result
   (** [complete t] blocks until the given [t] is complete. Returns a [Bytes.Slice.t] of remaining
@@ -161,6 +478,115 @@ module Write: sig
   (** [complete_hlt t] blocks until the given [t] is complete. Returns a [Bytes.Slice.t] of
       remaining bytes that were not written (typically empty) or halts if bytes could not be
       written. *)
+
+  val is_complete: t -> bool
+  (** [is_complete t] returns true if the given [t] is complete, i.e. [complete t] would not block.
+  *)
+
+  val cancel: t -> Errno.t option
+  (** [cancel t] requests cancellation of the given [t], if it is not yet complete. The write still
+      completes, with [Errno.ECANCELED] if it was cancelled before transferring any bytes, or as
+      usual otherwise. Cancellation does not block, and only takes effect once the executor next
+      submits I/O, e.g. upon [complete t]. Returns an [Errno.t] if cancellation could not be
+      requested, e.g. [Errno.EINVAL] if [t] was submitted by another executor. *)
+
+  val cancel_hlt: t -> unit
+  (** [cancel_hlt t] requests cancellation of the given [t], if it is not yet complete. The write
+      still completes, with [Errno.ECANCELED] if it was cancelled in time. Halts if cancellation
+      could not be requested. *)
+
+  val wait_any: ?timeout:uns -> t list -> (t list * t list, Errno.t) result
+  (** [wait_any ?timeout ts] blocks until at least one of the given [ts] is complete, or until
+      [timeout] nanoseconds elapse. Returns the [(complete, pending)] partition of [ts], where
+      [complete] is empty if the timeout elapsed first, or an [Errno.t] if completions could not be
+      reaped. *)
+
+  val wait_any_hlt: ?timeout:uns -> t list -> t list * t list
+  (** [wait_any_hlt ?timeout ts] blocks until at least one of the given [ts] is complete, or until
+      [timeout] nanoseconds elapse. Returns the [(complete, pending)] partition of [ts] or halts if
+      completions could not be reaped. *)
+
+  val wait_n: ?timeout:uns -> uns -> t list -> (t list * t list, Errno.t) result
+  (** [wait_n ?timeout n ts] blocks until at least [n] of the given [ts] are complete, or until
+      [timeout] nanoseconds elapse. All completions available to the executor are reaped with as few
+      system calls as possible. Returns the [(complete, pending)] partition of [ts], where
+      [complete] may contain fewer than [n] elements if the timeout elapsed first, or an [Errno.t]
+      if completions could not be reaped. *)
+
+  val wait_n_hlt: ?timeout:uns -> uns -> t list -> t list * t list
+  (** [wait_n_hlt ?timeout n ts] blocks until at least [n] of the given [ts] are complete, or until
+      [timeout] nanoseconds elapse. Returns the [(complete, pending)] partition of [ts] or halts if
+      completions could not be reaped. *)
+end
+
+module Writev: sig
+  type file = t
+  type t
+  (* An internally immutable token backed by an external I/O writev completion data structure. *)
+
+  val submit: ?off:uns -> ?timeout:uns -> Bytes.Slice.t list -> file -> (t, Errno.t) result
+  (** [submit ?off ?timeout buffers file] submits a single write to given [file] that gathers
+      [buffers] in order, directly rather than via intermediate buffers. If given, [off] is the file
+      offset to write at, in which case the file position is neither used nor updated; otherwise the
+      write is at the current file position. If given, the write is cancelled unless it completes
+      within [timeout] nanoseconds, in which case it completes with [Errno.ECANCELED]. [buffers]
+      must not be modified until the write completes. This operation does not block. Returns a [t]
+      to the write submission or an [Errno.t] if the write could not be submitted. *)
+
+  val submit_hlt: ?off:uns -> ?timeout:uns -> Bytes.Slice.t list -> file -> t
+  (** [submit_hlt ?off ?timeout buffers file] submits a single write to given [file] that gathers
+      [buffers] in order. If given, [off] is the file offset to write at rather than the current
+      file position. If given, the write is cancelled unless it completes within [timeout]
+      nanoseconds. This operation does not block. Returns a [t] to the write submission or halts if
+      the write could not be submitted. *)
+
+  val complete: t -> (Bytes.Slice.t list, Errno.t) result
+  (** [complete t] blocks until the given [t] is complete. Returns the unwritten suffixes of the
+      submitted buffers, which are non-empty only if the write was short, or an [Errno.t] if bytes
+      could not be written. *)
+
+  val complete_hlt: t -> Bytes.Slice.t list
+  (** [complete_hlt t] blocks until the given [t] is complete. Returns the unwritten suffixes of the
+      submitted buffers or halts if bytes could not be written. *)
+
+  val is_complete: t -> bool
+  (** [is_complete t] returns true if the given [t] is complete, i.e. [complete t] would not block.
+  *)
+
+  val cancel: t -> Errno.t option
+  (** [cancel t] requests cancellation of the given [t], if it is not yet complete. The write still
+      completes, with [Errno.ECANCELED] if it was cancelled before transferring any bytes, or as
+      usual otherwise. Cancellation does not block, and only takes effect once the executor next
+      submits I/O, e.g. upon [complete t]. Returns an [Errno.t] if cancellation could not be
+      requested, e.g. [Errno.EINVAL] if [t] was submitted by another executor. *)
+
+  val cancel_hlt: t -> unit
+  (** [cancel_hlt t] requests cancellation of the given [t], if it is not yet complete. The write
+      still completes, with [Errno.ECANCELED] if it was cancelled in time. Halts if cancellation
+      could not be requested. *)
+
+  val wait_any: ?timeout:uns -> t list -> (t list * t list, Errno.t) result
+  (** [wait_any ?timeout ts] blocks until at least one of the given [ts] is complete, or until
+      [timeout] nanoseconds elapse. Returns the [(complete, pending)] partition of [ts], where
+      [complete] is empty if the timeout elapsed first, or an [Errno.t] if completions could not be
+      reaped. *)
+
+  val wait_any_hlt: ?timeout:uns -> t list -> t list * t list
+  (** [wait_any_hlt ?timeout ts] blocks until at least one of the given [ts] is complete, or until
+      [timeout] nanoseconds elapse. Returns the [(complete, pending)] partition of [ts] or halts if
+      completions could not be reaped. *)
+
+  val wait_n: ?timeout:uns -> uns -> t list -> (t list * t list, Errno.t) result
+  (** [wait_n ?timeout n ts] blocks until at least [n] of the given [ts] are complete, or until
+      [timeout] nanoseconds elapse. All completions available to the executor are reaped with as few
+      system calls as possible. Returns the [(complete, pending)] partition of [ts], where
+      [complete] may contain fewer than [n] elements if the timeout elapsed first, or an [Errno.t]
+      if completions could not be reaped. *)
+
+  val wait_n_hlt: ?timeout:uns -> uns -> t list -> t list * t list
+  (** [wait_n_hlt ?timeout n ts] blocks until at least [n] of the given [ts] are complete, or until
+      [timeout] nanoseconds elapse. Returns the [(complete, pending)] partition of [ts] or halts if
+      completions could not be reaped. *)
 end
 
 val write: Bytes.Slice.t -> t -> Errno.t option
@@ -171,6 +597,104 @@ val write_hlt: Bytes.Slice.t -> t -> unit
 (** [write_hlt bytes t] writes [bytes] to [t] and returns a [unit] or halts if bytes could not be
     written. *)
 
+(** Whole-file operations submitted as single chains of linked operations. Each chain opens its file
+    into an executor-private fixed file table rather than the process file descriptor table, and
+    closes it once done. Submitting a chain and reaping its completions each require at most one
+    system call. *)
+module Chain: sig
+  module Read: sig
+    type t
+    (* An internally immutable token backed by external I/O open, read, and close completion data
+       structures. *)
+
+    val submit: ?n:uns -> ?buffer:Bytes.Slice.t -> Path.t -> (t, Errno.t) result
+    (** [submit ?n ?buffer path] submits a chain that opens the file at [path], reads from the
+        beginning of the file, and closes the file. [n] and [buffer] are interpreted as for
+        [Read.submit]. This operation does not block, unless the kernel does not support sparse
+        fixed file tables, in which case the operations are instead submitted one at a time, each
+        once the previous has completed. Returns a [t] to the chain submission or an [Errno.t] if
+        the chain could not be submitted. *)
+
+    val submit_hlt: ?n:uns -> ?buffer:Bytes.Slice.t -> Path.t -> t
+    (** [submit_hlt ?n ?buffer path] submits a chain that opens the file at [path], reads from the
+        beginning of the file, and closes the file. [n] and [buffer] are interpreted as for
+        [Read.submit]. This operation does not block, except as for [submit]. Returns a [t] to the
+        chain submission or halts if the chain could not be submitted. *)
+
+    val is_complete: t -> bool
+    (** [is_complete t] returns true if all operations in the given [t] are complete, i.e.
+        [complete t] would not block. *)
+
+    val complete: t -> (Bytes.Slice.t, Errno.t) result
+    (** [complete t] blocks until the given [t] is complete. Returns the buffer into which bytes
+        were read or the [Errno.t] of the first operation in the chain that failed. *)
+
+    val complete_hlt: t -> Bytes.Slice.t
+    (** [complete_hlt t] blocks until the given [t] is complete. Returns the buffer into which bytes
+        were read or halts if any operation in the chain failed. *)
+  end
+
+  module Write: sig
+    type t
+    (* An internally immutable token backed by external I/O open, write, fsync, and close
+       completion data structures. *)
+
+    val submit: ?flag:Flag.t -> ?mode:uns -> Bytes.Slice.t -> Path.t -> (t, Errno.t) result
+    (** [submit ~flag ~mode bytes path] submits a chain that opens the file at [path] with [flag]
+        (default Flag.W) and [mode] (default 0o660) Unix file permissions, writes [bytes] at the
+        beginning of the file, syncs the file to storage, and closes the file. This operation does
+        not block, unless the operations must be submitted one at a time as for [Read.submit].
+        Returns a [t] to the chain submission or an [Errno.t] if the chain could not be submitted.
+    *)
+
+    val submit_hlt: ?flag:Flag.t -> ?mode:uns -> Bytes.Slice.t -> Path.t -> t
+    (** [submit_hlt ~flag ~mode bytes path] submits a chain that opens the file at [path] with
+        [flag] (default Flag.W) and [mode] (default 0o660) Unix file permissions, writes [bytes] at
+        the beginning of the file, syncs the file to storage, and closes the file. This operation
+        does not block, except as for [submit]. Returns a [t] to the chain submission or halts if
+        the chain could not be submitted. *)
+
+    val is_complete: t -> bool
+    (** [is_complete t] returns true if all operations in the given [t] are complete, i.e.
+        [complete t] would not block. *)
+
+    val complete: t -> (Bytes.Slice.t, Errno.t) result
+    (** [complete t] blocks until the given [t] is complete. Returns a [Bytes.Slice.t] of remaining
+        bytes that were not written (typically empty) or the [Errno.t] of the first operation in the
+        chain that failed. *)
+
+    val complete_hlt: t -> Bytes.Slice.t
+    (** [complete_hlt t] blocks until the given [t] is complete. Returns a [Bytes.Slice.t] of
+        remaining bytes that were not written (typically empty) or halts if any operation in the
+        chain failed. *)
+  end
+end
+
+val splice: ?n:uns -> t -> t -> (uns, Errno.t) result
+(** [splice ?n src dst] moves up to [n] bytes (all remaining bytes by default) from the current
+    offset of [src] to the current offset of [dst] within the kernel, without copying through user
+    memory. If neither file is a pipe, each chunk is spliced through an internal pipe by a linked
+    pair of operations. Returns the number of bytes moved, which is less than [n] only at end of
+    file, or an [Errno.t] if bytes could not be moved, e.g. [EINVAL] if either file does not support
+    splicing. *)
+
+val splice_hlt: ?n:uns -> t -> t -> uns
+(** [splice_hlt ?n src dst] moves up to [n] bytes from [src] to [dst] as for [splice]. Returns the
+    number of bytes moved or halts if bytes could not be moved. *)
+
+val copy: ?n:uns -> ?kernel:bool -> t -> t -> (uns, Errno.t) result
+(** [copy ?n ?kernel src dst] copies up to [n] bytes (all remaining bytes by default) from the
+    current offset of [src] to the current offset of [dst]. If [kernel] is true (the default), the
+    copy is made by copy_file_range(2), which shares extents where the filesystem supports reflinks;
+    failing that by [splice]; and failing that by a loop that reads each chunk while writing the
+    previous one. Otherwise, the copy is made by the read/write loop. Returns the number of bytes
+    copied, which is less than [n] only at end of file, or an [Errno.t] if bytes could not be
+    copied. *)
+
+val copy_hlt: ?n:uns -> ?kernel:bool -> t -> t -> uns
+(** [copy_hlt ?n ?kernel src dst] copies up to [n] bytes from [src] to [dst] as for [copy]. Returns
+    the number of bytes copied or halts if bytes could not be copied. *)
+
 val seek: sint -> t -> (uns, Errno.t) result
 (** [seek i t] seeks the external mutable Unix file descriptor associated with [t] to point to the
     [i]th byte relative to the current byte position of the file. Returns an [uns] of the new byte
@@ -206,9 +730,21 @@ module Stream : sig
 
   type t = Bytes.Slice.t Stream.t
 
-  val of_file: file -> t
-  (** [of_file file] takes a [file] and returns a [t], a lazily initialized buffer stream that reads
-      subsequent chunks of [file] into buffers when forced. *)
+  val chunk_default: uns
+  (** Default maximum size of each buffer read by [of_file]. *)
+
+  val window_default: uns
+  (** Default number of reads kept in flight by [of_file]. *)
+
+  val of_file: ?chunk:uns -> ?window:uns -> file -> t
+  (** [of_file ?chunk ?window file] takes a [file] and returns a [t], a lazily initialized buffer
+      stream that reads subsequent chunks of at most [chunk] bytes (default [chunk_default]) from
+      [file] into buffers, starting at the current file position, and closes [file] at end of file.
+      For regular files, up to [window] (default [window_default]) positional reads are kept in
+      flight ahead of the chunk being forced, guided by the file size at the time of the call, and
+      the file position is not updated. Other files, e.g. pipes, are read sequentially. If [file]
+      performs direct I/O, [chunk] is rounded up to [Direct.align file] and reads are into
+      [Direct.buffer]s. *)
 
   val write: file -> t -> Errno.t option
   (** [write file t] takes an open [file] with write permissions and writes, in order, all buffers
@@ -219,14 +755,51 @@ module Stream : sig
       buffers from [t] to it. Halts if not all bytes could be written. *)
 end
 
+(** Read-only memory mappings of whole files. *)
+module Mmap : sig
+  type file = t
+
+  val of_file: ?populate:bool -> file -> (Bytes.Slice.t, Errno.t) result
+  (** [of_file ?populate file] maps the entirety of regular [file] into memory read-only and returns
+      a slice that views the mapping directly, without copying. If [populate] is true (default
+      false), the mapping is populated up front rather than paged in as it is accessed. The mapping
+      is independent of [file], which may be closed, and is unmapped once the slice and all slices
+      derived from it are unreachable. The slice must not be mutated, and its contents are
+      unspecified if the file is modified while mapped. If the file is truncated while mapped,
+      accessing the slice beyond the new end of file terminates the process with [SIGBUS], so files
+      that may be truncated concurrently should be read via [Stream] instead. Returns the slice or
+      an [Errno.t] if [file] could not be mapped, e.g. [Errno.ENODEV] if [file] is not a regular
+      file. *)
+
+  val of_file_hlt: ?populate:bool -> file -> Bytes.Slice.t
+  (** [of_file_hlt ?populate file] maps the entirety of regular [file] into memory read-only and
+      returns a slice that views the mapping directly, as for [of_file]. Halts if [file] could not
+      be mapped. *)
+
+  val of_path: ?populate:bool -> Path.t -> (Bytes.Slice.t, Errno.t) result
+  (** [of_path ?populate path] opens the file at [path], maps it as for [of_file], and closes it.
+      Returns the slice or an [Errno.t] if the file could not be opened, mapped, or closed. *)
+
+  val of_path_hlt: ?populate:bool -> Path.t -> Bytes.Slice.t
+  (** [of_path_hlt ?populate path] opens the file at [path], maps it as for [of_file], and closes
+      it. Halts if the file could not be opened, mapped, or closed. *)
+end
+
 (** Formatters. *)
 module Fmt : sig
   val bufsize_default: uns
   (** Default buffer size used by formatters created via [of_t]. *)
 
-  val of_t: ?bufsize:uns -> t -> (module Fmt.Formatter)
-  (** [of_t ~bufsize t] returns a buffered formatter which outputs to [t]. To disable buffering,
-      specify [~bufsize:0]. *)
+  val nbufs_default: uns
+  (** Default number of buffers used by formatters created via [of_t]. *)
+
+  val of_t: ?bufsize:uns -> ?nbufs:uns -> t -> (module Fmt.Formatter)
+  (** [of_t ~bufsize ~nbufs t] returns a buffered formatter which outputs to [t]. To disable
+      buffering, specify [~bufsize:0]. With a single buffer (the default), each full buffer is
+      written synchronously. With [nbufs] greater than one, the formatter rotates among up to
+      [nbufs] buffers: full buffers are written asynchronously while formatting continues into the
+      next free buffer, and buffers that fill while a write is in flight are coalesced into a single
+      vectored write. Formatting blocks only if all buffers are queued or in flight, or on sync. *)
 
   val stdout: (module Fmt.Formatter)
   (** Buffered formatter which outputs to [stdout]. *)
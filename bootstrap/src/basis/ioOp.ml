@@ -0,0 +1,45 @@
+open Rudiments
+
+let error_of_neg_errno neg_errno =
+  Errno.of_uns_hlt (Uns.bits_of_sint (Sint.neg neg_errno))
+
+let bytes_of_slice slice =
+  let base = Uns.trunc_to_int (Bytes.Cursor.index (Bytes.Slice.base slice)) in
+  let container = Bytes.Slice.container slice in
+  Stdlib.Bytes.init (Int64.to_int (Bytes.Slice.length slice)) (fun i ->
+    Stdlib.Bigarray.Array1.get container (base + i)
+  )
+
+let bytes_of_path path =
+  bytes_of_slice (Path.to_bytes path)
+
+external user_data_decref: uns -> unit = "hemlock_basis_executor_user_data_decref"
+external complete_inner: uns -> sint = "hemlock_basis_executor_complete_inner"
+
+let register_user_data_finalizer user_data =
+  match user_data = 0L with
+  | true -> user_data
+  | false -> begin
+      let () = Stdlib.Gc.finalise user_data_decref user_data in
+      user_data
+    end
+
+external is_complete_inner: uns -> bool = "hemlock_basis_executor_is_complete_inner"
+external wait_inner: uns -> sint -> uns array -> sint = "hemlock_basis_executor_wait_inner"
+
+(* No timeout is selected by timeout -1. *)
+let timeout_inner = function
+  | None -> -1L
+  | Some timeout -> Uns.bits_to_sint timeout
+
+let wait_base ~inner_of ?timeout n ts =
+  let timeout = timeout_inner timeout in
+  let inners = Array.of_list (List.map ts ~f:inner_of) in
+  match wait_inner n timeout inners with
+  | 0L -> Ok (List.partition_tf ts ~f:(fun t -> is_complete_inner (inner_of t)))
+  | errno -> Error (Errno.of_uns_hlt (Uns.bits_of_sint errno))
+
+let wait_base_hlt ~inner_of ?timeout n ts =
+  match wait_base ~inner_of ?timeout n ts with
+  | Ok partition -> partition
+  | Error error -> halt (Errno.to_string error)
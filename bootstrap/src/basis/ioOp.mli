@@ -0,0 +1,43 @@
+(* Helpers shared by modules, e.g. File and Os, whose operations are submitted to the executor's I/O
+   ring. Operations are referred to by their external user_data. *)
+
+open Rudiments
+
+val error_of_neg_errno: sint -> Errno.t
+(** [error_of_neg_errno neg_errno] returns the [Errno.t] corresponding to the negated errno
+    [neg_errno], as returned by submissions and completions. *)
+
+val bytes_of_slice: Bytes.Slice.t -> Stdlib.Bytes.t
+(** [bytes_of_slice slice] copies [slice] to OCaml bytes, e.g. to be copied to the C heap by a
+    submission, since OCaml values may move while operations are in flight. *)
+
+val bytes_of_path: Path.t -> Stdlib.Bytes.t
+(** [bytes_of_path path] copies [path] as for [bytes_of_slice]. *)
+
+val register_user_data_finalizer: uns -> uns
+(** [register_user_data_finalizer user_data] arranges for the OCaml ref on [user_data] to be dropped
+    once [user_data] is unreachable, and returns [user_data]. A NULL [user_data] is returned as is.
+*)
+
+val complete_inner: uns -> sint
+(** [complete_inner user_data] blocks until the operation is complete, and returns its result. *)
+
+val is_complete_inner: uns -> bool
+(** [is_complete_inner user_data] returns true if the operation is complete. *)
+
+val wait_inner: uns -> sint -> uns array -> sint
+(** [wait_inner n timeout user_datas] blocks until at least [n] of [user_datas] are complete, or
+    until [timeout] nanoseconds elapse (no timeout if -1). Returns 0 or an errno. *)
+
+val timeout_inner: uns option -> sint
+(** [timeout_inner timeout] returns the timeout in nanoseconds, or -1 for no timeout. *)
+
+val wait_base: inner_of:('a -> uns) -> ?timeout:uns -> uns -> 'a list ->
+  ('a list * 'a list, Errno.t) result
+(** [wait_base ~inner_of ?timeout n ts] blocks until at least [n] of the operations of [ts], as
+    mapped by [inner_of], are complete, or until [timeout] nanoseconds elapse. Returns the
+    [(complete, pending)] partition of [ts] or an [Errno.t] if completions could not be reaped. *)
+
+val wait_base_hlt: inner_of:('a -> uns) -> ?timeout:uns -> uns -> 'a list -> 'a list * 'a list
+(** [wait_base_hlt ~inner_of ?timeout n ts] is like [wait_base], but halts if completions could not
+    be reaped. *)
@@ -2,15 +2,18 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <linux/io_uring.h>
+#include <linux/stat.h>
 #include <stdatomic.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <sys/eventfd.h>
 #include <sys/mman.h>
 #include <sys/syscall.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 #include "common.h"
@@ -62,9 +65,57 @@
 // Pretty-printer formatting.
 #define HEMLOCK_INDENT_SIZE 4
 
-// io_uring queue size must be a power of two.
+// Default io_uring queue size. The kernel rounds non-powers of two up.
 #define HEMLOCK_IORING_ENTRIES 32
 
+hemlock_ioring_conf_t const hemlock_ioring_conf_default = {
+    .sq_entries = HEMLOCK_IORING_ENTRIES,
+    .cq_entries = 0,
+    .flags = 0,
+    .sq_thread_idle = 0,
+    .wq_fd = -1,
+    .iowq_max_workers = {0, 0},
+};
+
+// Setup flags in the order they are dropped if `io_uring_setup(2)` rejects them, i.e. the most
+// recently introduced (and least essential) first.
+static uint32_t const hemlock_ioring_setup_flags_optional[] = {
+    IORING_SETUP_DEFER_TASKRUN,
+    IORING_SETUP_SINGLE_ISSUER,
+    IORING_SETUP_COOP_TASKRUN,
+    IORING_SETUP_ATTACH_WQ,
+    IORING_SETUP_SQPOLL,
+};
+
+// Setup flags that may be specified via `hemlock_ioring_conf_t`.
+#define HEMLOCK_IORING_SETUP_FLAGS_CONF (IORING_SETUP_SQPOLL | IORING_SETUP_COOP_TASKRUN | \
+  IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_DEFER_TASKRUN | IORING_SETUP_ATTACH_WQ)
+
+// Size of each user_data slab. Must be a multiple of `HEMLOCK_CACHE_LINE_SIZE`.
+#define HEMLOCK_USER_DATA_SLAB_SIZE 4096
+
+// Provided buffer ring geometry. Buffers are only consumed by reads that have data to deliver,
+// so a modest ring serves many concurrent idle reads. The number of buffers must be a power of two.
+#define HEMLOCK_BUFRING_N 256
+#define HEMLOCK_BUFRING_BUF_SIZE 4096
+
+// Buffer group ID of the provided buffer ring. Each ioring has only the one group.
+#define HEMLOCK_BUFRING_BGID 0
+
+// Fixed file table size, i.e. the maximum number of chained operations with files open at once.
+#define HEMLOCK_FILETAB_N 64
+
+// User_data slab record. The alignment is the smallest power of two that fits a user_data, which
+// assures that records pack densely into cache lines without straddling them.
+typedef union hemlock_user_data_slot_u {
+    hemlock_user_data_t user_data;
+    union hemlock_user_data_slot_u *next;
+} __attribute__((aligned(64))) hemlock_user_data_slot_t;
+_Static_assert(
+    HEMLOCK_CACHE_LINE_SIZE % sizeof(hemlock_user_data_slot_t) == 0,
+    "user_data slot size must evenly divide cache line size"
+);
+
 static int
 io_uring_setup(uint32_t entries, struct io_uring_params *p) {
     return syscall(__NR_io_uring_setup, entries, p);
@@ -75,6 +126,53 @@ io_uring_enter(unsigned int fd, uint32_t to_submit, uint32_t min_complete, uint3
     return syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, (size_t) NULL);
 }
 
+static int
+io_uring_enter_timeout(
+    unsigned int fd,
+    uint32_t to_submit,
+    uint32_t min_complete,
+    uint32_t flags,
+    struct __kernel_timespec *ts
+) {
+    struct io_uring_getevents_arg arg = {
+        .sigmask = 0,
+        .sigmask_sz = 0,
+        .ts = (uint64_t)(uintptr_t)ts,
+    };
+    return syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags | IORING_ENTER_EXT_ARG,
+      &arg, sizeof(arg));
+}
+
+static int
+io_uring_register(unsigned int fd, unsigned int opcode, void *arg, unsigned int nr_args) {
+    return syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+void
+hemlock_ioring_conf_pp(int fd, int indent, hemlock_ioring_conf_t const *conf) {
+    if (conf == NULL) {
+        dprintf(fd, "%*sconf: NULL\n", indent, "");
+    } else {
+        dprintf(fd, "%*sconf:\n", indent, "");
+        indent += HEMLOCK_INDENT_SIZE;
+        dprintf(fd,
+            "%*ssq_entries: %u\n"
+            "%*scq_entries: %u\n"
+            "%*sflags: 0x%x\n"
+            "%*ssq_thread_idle: %u\n"
+            "%*swq_fd: %i\n"
+            "%*siowq_max_workers: [%u, %u]\n"
+            ,
+            indent, "", conf->sq_entries,
+            indent, "", conf->cq_entries,
+            indent, "", conf->flags,
+            indent, "", conf->sq_thread_idle,
+            indent, "", conf->wq_fd,
+            indent, "", conf->iowq_max_workers[0], conf->iowq_max_workers[1]
+        );
+    }
+}
+
 static void
 hemlock_opcode_pp(int fd, int indent, unsigned opcode) {
     switch (opcode) {
@@ -93,6 +191,51 @@ hemlock_opcode_pp(int fd, int indent, unsigned opcode) {
     case IORING_OP_WRITE:
       dprintf(fd, "%*sopcode: IORING_OP_WRITE\n", indent, "");
       break;
+    case IORING_OP_READ_FIXED:
+      dprintf(fd, "%*sopcode: IORING_OP_READ_FIXED\n", indent, "");
+      break;
+    case IORING_OP_WRITE_FIXED:
+      dprintf(fd, "%*sopcode: IORING_OP_WRITE_FIXED\n", indent, "");
+      break;
+    case IORING_OP_FSYNC:
+      dprintf(fd, "%*sopcode: IORING_OP_FSYNC\n", indent, "");
+      break;
+    case IORING_OP_FALLOCATE:
+      dprintf(fd, "%*sopcode: IORING_OP_FALLOCATE\n", indent, "");
+      break;
+    case IORING_OP_STATX:
+      dprintf(fd, "%*sopcode: IORING_OP_STATX\n", indent, "");
+      break;
+    case IORING_OP_RENAMEAT:
+      dprintf(fd, "%*sopcode: IORING_OP_RENAMEAT\n", indent, "");
+      break;
+    case IORING_OP_UNLINKAT:
+      dprintf(fd, "%*sopcode: IORING_OP_UNLINKAT\n", indent, "");
+      break;
+    case IORING_OP_MKDIRAT:
+      dprintf(fd, "%*sopcode: IORING_OP_MKDIRAT\n", indent, "");
+      break;
+    case IORING_OP_READV:
+      dprintf(fd, "%*sopcode: IORING_OP_READV\n", indent, "");
+      break;
+    case IORING_OP_WRITEV:
+      dprintf(fd, "%*sopcode: IORING_OP_WRITEV\n", indent, "");
+      break;
+    case IORING_OP_SPLICE:
+      dprintf(fd, "%*sopcode: IORING_OP_SPLICE\n", indent, "");
+      break;
+    case IORING_OP_MSG_RING:
+      dprintf(fd, "%*sopcode: IORING_OP_MSG_RING\n", indent, "");
+      break;
+    case IORING_OP_TIMEOUT:
+      dprintf(fd, "%*sopcode: IORING_OP_TIMEOUT\n", indent, "");
+      break;
+    case IORING_OP_LINK_TIMEOUT:
+      dprintf(fd, "%*sopcode: IORING_OP_LINK_TIMEOUT\n", indent, "");
+      break;
+    case IORING_OP_ASYNC_CANCEL:
+      dprintf(fd, "%*sopcode: IORING_OP_ASYNC_CANCEL\n", indent, "");
+      break;
     default:
       dprintf(fd, "%*sopcode: %i\n", indent, "", opcode);
       break;
@@ -143,7 +286,7 @@ hemlock_cqe_pp(int fd, int indent, struct io_uring_cqe *cqe) {
             indent, "", cqe->res,
             indent, "", cqe->flags
         );
-        if (cqe->user_data != 0 &&
+        if (cqe->user_data > HEMLOCK_IORING_USER_DATA_DOORBELL &&
           cqe->user_data == ((hemlock_user_data_t *)cqe->user_data)->cqe.user_data) {
             dprintf(fd, "%*suser_data: <same as parent>\n", indent, "");
         } else {
@@ -152,7 +295,7 @@ hemlock_cqe_pp(int fd, int indent, struct io_uring_cqe *cqe) {
     }
 }
 
-static bool
+bool
 hemlock_user_data_is_complete(hemlock_user_data_t *user_data) {
     // When the cqe is copied out of the completion queue into this user_data, the cqe's user_data
     // field is a valid pointer (i.e. non-zero).
@@ -163,6 +306,8 @@ void
 hemlock_user_data_pp(int fd, int indent, hemlock_user_data_t *user_data) {
     if (user_data == NULL) {
         dprintf(fd, "%*suser_data: NULL\n", indent, "");
+    } else if ((uintptr_t)user_data == HEMLOCK_IORING_USER_DATA_DOORBELL) {
+        dprintf(fd, "%*suser_data: DOORBELL\n", indent, "");
     } else {
         dprintf(fd, "%*suser_data:\n", indent, "");
         indent += HEMLOCK_INDENT_SIZE;
@@ -172,24 +317,41 @@ hemlock_user_data_pp(int fd, int indent, hemlock_user_data_t *user_data) {
         );
         switch (user_data->opcode) {
         case IORING_OP_OPENAT:
+        case IORING_OP_MKDIRAT:
+        case IORING_OP_UNLINKAT:
+        case IORING_OP_RENAMEAT:
             hemlock_pathname_pp(fd, indent, user_data->pathname);
             break;
+        case IORING_OP_READ:
+            if (user_data->buffer_select) {
+                dprintf(fd, "%*sbuffer_select: true\n", indent, "");
+            }
+            break;
+        case IORING_OP_ASYNC_CANCEL:
+            dprintf(fd, "%*starget: %p\n", indent, "", (void *)user_data->target);
+            break;
+        case IORING_OP_TIMEOUT:
+        case IORING_OP_LINK_TIMEOUT:
+            dprintf(fd, "%*stimeout: %lld.%09lld\n", indent, "", user_data->timeout.tv_sec,
+              user_data->timeout.tv_nsec);
+            break;
         default:
             break;
         }
+        if (user_data->file_index != 0) {
+            dprintf(fd, "%*sfile_index: %u\n", indent, "", user_data->file_index - 1);
+        }
+        if (user_data->pin != 0) {
+            dprintf(fd, "%*spin: %#lx\n", indent, "", user_data->pin);
+        }
+        if (user_data->waiter != NULL) {
+            dprintf(fd, "%*swaiter: %p\n", indent, "", user_data->waiter);
+        }
         hemlock_opcode_pp(fd, indent, user_data->opcode);
         hemlock_cqe_pp(fd, indent, &user_data->cqe);
     }
 }
 
-void
-hemlock_user_data_decref(hemlock_user_data_t *user_data) {
-    user_data->refcount--;
-    if (user_data->refcount == 0) {
-        free(user_data);
-    }
-}
-
 void
 hemlock_sqring_pp(int fd, int indent, hemlock_sqring_t *sqring) {
     if (sqring == NULL) {
@@ -255,6 +417,61 @@ hemlock_cqring_pp(int fd, int indent, hemlock_cqring_t *cqring) {
     }
 }
 
+void
+hemlock_bufring_pp(int fd, int indent, hemlock_bufring_t *bufring) {
+    if (bufring == NULL) {
+        dprintf(fd, "%*sbufring: NULL\n", indent, "");
+    } else {
+        dprintf(fd, "%*sbufring:\n", indent, "");
+        indent += HEMLOCK_INDENT_SIZE;
+        dprintf(fd,
+            "%*sbuf_size: %zu\n"
+            "%*sn: %u\n"
+            "%*sn_out: %u\n"
+            "%*stail: %u\n"
+            ,
+            indent, "", bufring->buf_size,
+            indent, "", bufring->n,
+            indent, "", bufring->n_out,
+            indent, "", bufring->tail
+        );
+    }
+}
+
+void
+hemlock_filetab_pp(int fd, int indent, hemlock_filetab_t *filetab) {
+    if (filetab == NULL) {
+        dprintf(fd, "%*sfiletab: NULL\n", indent, "");
+    } else {
+        dprintf(fd, "%*sfiletab:\n", indent, "");
+        indent += HEMLOCK_INDENT_SIZE;
+        dprintf(fd,
+            "%*sn: %u\n"
+            "%*sn_free: %u\n"
+            ,
+            indent, "", filetab->n,
+            indent, "", filetab->n_free
+        );
+    }
+}
+
+void
+hemlock_regbuf_pp(int fd, int indent, hemlock_regbuf_t *regbuf) {
+    if (regbuf == NULL) {
+        dprintf(fd, "%*sregbuf: NULL\n", indent, "");
+    } else {
+        dprintf(fd, "%*sregbuf:\n", indent, "");
+        indent += HEMLOCK_INDENT_SIZE;
+        dprintf(fd,
+            "%*sbase: %p\n"
+            "%*ssize: %zu\n"
+            ,
+            indent, "", (void *)regbuf->base,
+            indent, "", regbuf->size
+        );
+    }
+}
+
 void
 hemlock_ioring_pp(int fd, int indent, hemlock_ioring_t *ioring) {
     if (ioring == NULL) {
@@ -263,22 +480,257 @@ hemlock_ioring_pp(int fd, int indent, hemlock_ioring_t *ioring) {
         dprintf(fd, "%*sioring:\n", indent, "");
         indent += HEMLOCK_INDENT_SIZE;
         dprintf(fd, "%*sfd: %i\n" , indent, "", ioring->fd);
+        hemlock_ioring_conf_pp(fd, indent, &ioring->conf);
+        dprintf(fd, "%*sn_inflight: %lu\n" , indent, "", ioring->n_inflight);
+        dprintf(fd, "%*sn_reaped: %lu\n" , indent, "", ioring->n_reaped);
+        dprintf(fd,
+            "%*sdoorbell: %s\n"
+            "%*sn_doorbells: %lu\n"
+            ,
+            indent, "", ioring->msg_ring ? "IORING_OP_MSG_RING" : "eventfd",
+            indent, "", ioring->n_doorbells
+        );
         hemlock_cqring_pp(fd, indent, &ioring->cqring);
         hemlock_sqring_pp(fd, indent, &ioring->sqring);
+        hemlock_bufring_pp(fd, indent, &ioring->bufring);
+        hemlock_filetab_pp(fd, indent, &ioring->filetab);
+        hemlock_regbuf_pp(fd, indent, &ioring->regbuf);
+    }
+}
+
+// Make provided buffer `bid` available to the kernel again.
+static void
+hemlock_bufring_put(uint16_t bid, hemlock_bufring_t *bufring) {
+    struct io_uring_buf *buf = &bufring->br->bufs[bufring->tail & (bufring->n - 1)];
+    buf->addr = (uint64_t)&bufring->bufs[bid * bufring->buf_size];
+    buf->len = bufring->buf_size;
+    buf->bid = bid;
+    bufring->tail++;
+    HEMLOCK_ATOMIC_STORE_RELEASE(&bufring->br->tail, bufring->tail);
+}
+
+static void
+hemlock_ioring_file_release(uint16_t file_index, hemlock_ioring_t *ioring) {
+    hemlock_filetab_t *filetab = &ioring->filetab;
+
+    assert(filetab->n_free < filetab->n);
+    filetab->free[filetab->n_free] = file_index;
+    filetab->n_free++;
+}
+
+// Provided buffer rings that were torn down while some of their buffers were still referenced, e.g.
+// by OCaml bytes that outlive a stopped pool executor. Each orphan stays mapped until its last
+// outstanding buffer is released. Only accessed while holding the runtime lock.
+typedef struct hemlock_bufring_orphan_s {
+    struct hemlock_bufring_orphan_s *next;
+    hemlock_bufring_t bufring;
+} hemlock_bufring_orphan_t;
+
+static hemlock_bufring_orphan_t *hemlock_bufring_orphans = NULL;
+
+static size_t
+hemlock_bufring_get_br_size(hemlock_bufring_t *bufring) {
+    return bufring->n * sizeof(struct io_uring_buf);
+}
+
+static size_t
+hemlock_bufring_get_vm_size(hemlock_bufring_t *bufring) {
+    return hemlock_bufring_get_br_size(bufring) + bufring->n * bufring->buf_size;
+}
+
+static bool
+hemlock_bufring_contains(uint8_t const *buf, hemlock_bufring_t const *bufring) {
+    return bufring->n != 0 && buf >= bufring->bufs &&
+      buf < &bufring->bufs[bufring->n * bufring->buf_size];
+}
+
+// Release a buffer of an orphaned ring, and unmap the ring once it has no outstanding buffers. The
+// buffer is never handed back to the kernel, since the ring it belonged to is no longer registered.
+static void
+hemlock_bufring_orphan_release(uint8_t const *buf) {
+    for (hemlock_bufring_orphan_t **p = &hemlock_bufring_orphans; *p != NULL; p = &(*p)->next) {
+        hemlock_bufring_orphan_t *orphan = *p;
+        if (hemlock_bufring_contains(buf, &orphan->bufring)) {
+            assert(orphan->bufring.n_out > 0);
+            orphan->bufring.n_out--;
+            if (orphan->bufring.n_out == 0) {
+                *p = orphan->next;
+                if (munmap(orphan->bufring.vm, hemlock_bufring_get_vm_size(&orphan->bufring)) != 0)
+                {
+                    abort();
+                }
+                free(orphan);
+            }
+            return;
+        }
+    }
+    // Every outstanding buffer belongs either to a live ring or to an orphan.
+    abort();
+}
+
+void
+hemlock_user_data_buffer_release(hemlock_user_data_t *user_data, hemlock_ioring_t *ioring) {
+    switch (user_data->opcode) {
+    case IORING_OP_READ:
+        if (user_data->buffer_select) {
+            if (user_data->buffer == NULL) {
+                break;
+            }
+            // The ring the buffer was selected from may have been torn down, and even replaced by
+            // a new ring, since the read completed.
+            if (hemlock_bufring_contains(user_data->buffer, &ioring->bufring)) {
+                assert(ioring->bufring.n_out > 0);
+                hemlock_bufring_put(user_data->buf_index, &ioring->bufring);
+                ioring->bufring.n_out--;
+            } else {
+                hemlock_bufring_orphan_release(user_data->buffer);
+            }
+            break;
+        }
+        // Fall through.
+    case IORING_OP_OPENAT:
+    case IORING_OP_MKDIRAT:
+    case IORING_OP_UNLINKAT:
+    case IORING_OP_RENAMEAT:
+    case IORING_OP_STATX:
+    case IORING_OP_WRITE:
+    case IORING_OP_READ_FIXED:
+    case IORING_OP_WRITE_FIXED:
+    case IORING_OP_READV:
+    case IORING_OP_WRITEV:
+        // `pathname` and `buffer` share storage. Vectored operations' iovecs are allocated along
+        // with `buffer`.
+        free(user_data->buffer);
+        break;
+    default:
+        break;
+    };
+    user_data->buffer = NULL;
+}
+
+void
+hemlock_user_data_pin(hemlock_user_data_t *user_data, uintptr_t pin) {
+    switch (user_data->opcode) {
+    case IORING_OP_READV:
+    case IORING_OP_WRITEV:
+        break;
+    default:
+        user_data->buffer = NULL;
+        break;
+    };
+    user_data->pin = pin;
+}
+
+void
+hemlock_user_data_slab_pp(int fd, int indent, hemlock_user_data_slab_t *slab) {
+    if (slab == NULL) {
+        dprintf(fd, "%*sslab: NULL\n", indent, "");
+    } else {
+        dprintf(fd, "%*sslab:\n", indent, "");
+        indent += HEMLOCK_INDENT_SIZE;
+        dprintf(fd,
+            "%*sn_slabs: %zu\n"
+            "%*sn_allocs: %lu\n"
+            "%*sn_live: %lu\n"
+            "%*sn_live_max: %lu\n"
+            ,
+            indent, "", slab->n_slabs,
+            indent, "", slab->n_allocs,
+            indent, "", slab->n_live,
+            indent, "", slab->n_live_max
+        );
     }
 }
 
-hemlock_user_data_t *
-hemlock_user_data_create() {
-    hemlock_user_data_t *user_data = (hemlock_user_data_t *)calloc(1, sizeof(hemlock_user_data_t));
-    assert(user_data != NULL);
+void
+hemlock_user_data_slab_setup(hemlock_user_data_slab_t *slab) {
+    memset(slab, 0, sizeof(hemlock_user_data_slab_t));
+}
+
+void
+hemlock_user_data_slab_teardown(hemlock_user_data_slab_t *slab) {
+    for (size_t i = 0; i < slab->n_slabs; i++) {
+        free(slab->slabs[i]);
+    }
+    free(slab->slabs);
+
+    memset(slab, 0, sizeof(hemlock_user_data_slab_t));
+}
+
+static void
+hemlock_user_data_slab_grow(hemlock_user_data_slab_t *slab) {
+    if (slab->n_slabs == slab->slabs_max) {
+        slab->slabs_max = (slab->slabs_max == 0) ? 1 : slab->slabs_max * 2;
+        slab->slabs = (void **)realloc(slab->slabs, sizeof(void *) * slab->slabs_max);
+        assert(slab->slabs != NULL);
+    }
+
+    hemlock_user_data_slot_t *slots = (hemlock_user_data_slot_t *)aligned_alloc(
+        HEMLOCK_CACHE_LINE_SIZE, HEMLOCK_USER_DATA_SLAB_SIZE
+    );
+    assert(slots != NULL);
+    slab->slabs[slab->n_slabs] = slots;
+    slab->n_slabs++;
+
+    // Thread the new slots onto the free list such that they are allocated in address order.
+    size_t n = HEMLOCK_USER_DATA_SLAB_SIZE / sizeof(hemlock_user_data_slot_t);
+    for (size_t i = 0; i < n - 1; i++) {
+        slots[i].next = &slots[i + 1];
+    }
+    slots[n - 1].next = slab->free;
+    slab->free = slots;
+}
+
+static hemlock_user_data_t *
+hemlock_user_data_slab_alloc(hemlock_user_data_slab_t *slab) {
+    if (slab->free == NULL) {
+        hemlock_user_data_slab_grow(slab);
+    }
+    hemlock_user_data_slot_t *slot = (hemlock_user_data_slot_t *)slab->free;
+    slab->free = slot->next;
+
+    slab->n_allocs++;
+    slab->n_live++;
+    if (slab->n_live > slab->n_live_max) {
+        slab->n_live_max = slab->n_live;
+    }
+
+    return &slot->user_data;
+}
+
+static void
+hemlock_user_data_slab_free(hemlock_user_data_t *user_data, hemlock_user_data_slab_t *slab) {
+    hemlock_user_data_slot_t *slot = (hemlock_user_data_slot_t *)user_data;
+    slot->next = slab->free;
+    slab->free = slot;
+
+    assert(slab->n_live > 0);
+    slab->n_live--;
+}
+
+static hemlock_user_data_t *
+hemlock_user_data_create(hemlock_ioring_t *ioring) {
+    hemlock_user_data_t *user_data = hemlock_user_data_slab_alloc(ioring->slab);
+    memset(user_data, 0, sizeof(hemlock_user_data_t));
 
     // Refs from kernel and ocaml.
     user_data->refcount = 2;
+    user_data->slab = ioring->slab;
 
     return user_data;
 }
 
+void
+hemlock_user_data_decref(hemlock_user_data_t *user_data, hemlock_ioring_t *ioring) {
+    user_data->refcount--;
+    if (user_data->refcount == 0) {
+        // Read buffers are normally released once their contents are consumed, but the OCaml side
+        // may have dropped its reference without consuming them.
+        hemlock_user_data_buffer_release(user_data, ioring);
+        hemlock_user_data_slab_free(user_data, user_data->slab);
+    }
+}
+
 static void
 hemlock_sqring_setup(void *vm, struct io_sqring_offsets const *offsets, hemlock_sqring_t *sqring) {
     sqring->head = vm + offsets->head;
@@ -311,14 +763,212 @@ hemlock_ioring_get_sqes_size(hemlock_ioring_t *ioring) {
     return ioring->params.sq_entries * sizeof(struct io_uring_sqe);
 }
 
+static void
+hemlock_bufring_setup(hemlock_ioring_t *ioring) {
+    hemlock_bufring_t *bufring = &ioring->bufring;
+
+    bufring->n = HEMLOCK_BUFRING_N;
+    bufring->buf_size = HEMLOCK_BUFRING_BUF_SIZE;
+    // The ring must be page-aligned, which mmap assures. Buffers only become resident once the
+    // kernel first reads into them.
+    bufring->vm = mmap(
+        0,
+        hemlock_bufring_get_vm_size(bufring),
+        PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS,
+        -1,
+        0
+    );
+    if (bufring->vm == (void*) -1) {
+        abort();
+    }
+    bufring->br = (struct io_uring_buf_ring *)bufring->vm;
+    bufring->bufs = &bufring->vm[hemlock_bufring_get_br_size(bufring)];
+
+    struct io_uring_buf_reg buf_reg = {
+        .ring_addr = (uint64_t)bufring->br,
+        .ring_entries = bufring->n,
+        .bgid = HEMLOCK_BUFRING_BGID,
+    };
+    if (io_uring_register(ioring->fd, IORING_REGISTER_PBUF_RING, &buf_reg, 1) != 0) {
+        // Provided buffer rings require Linux 5.19. Buffer-selecting reads are unsupported without
+        // one.
+        munmap(bufring->vm, hemlock_bufring_get_vm_size(bufring));
+        memset(bufring, 0, sizeof(hemlock_bufring_t));
+        return;
+    }
+
+    for (uint16_t bid = 0; bid < bufring->n; bid++) {
+        hemlock_bufring_put(bid, bufring);
+    }
+}
+
+static void
+hemlock_bufring_teardown(hemlock_bufring_t *bufring) {
+    if (bufring->vm != NULL && bufring->n_out > 0) {
+        // Outstanding buffers may still be referenced (e.g. by OCaml bytes), so unmapping is
+        // deferred until the last of them is released. Keeping the ring mapped also assures that a
+        // subsequently set up ring cannot alias its buffers.
+        hemlock_bufring_orphan_t *orphan =
+          (hemlock_bufring_orphan_t *)malloc(sizeof(hemlock_bufring_orphan_t));
+        assert(orphan != NULL);
+        orphan->bufring = *bufring;
+        orphan->next = hemlock_bufring_orphans;
+        hemlock_bufring_orphans = orphan;
+    } else if (bufring->vm != NULL) {
+        // The ring is implicitly unregistered when the io_uring fd is closed.
+        if (munmap(bufring->vm, hemlock_bufring_get_vm_size(bufring)) != 0) {
+            abort();
+        }
+    }
+
+    memset(bufring, 0, sizeof(hemlock_bufring_t));
+}
+
+static void
+hemlock_filetab_setup(hemlock_ioring_t *ioring) {
+    hemlock_filetab_t *filetab = &ioring->filetab;
+
+    struct io_uring_rsrc_register rsrc_register = {
+        .nr = HEMLOCK_FILETAB_N,
+        .flags = IORING_RSRC_REGISTER_SPARSE,
+    };
+    if (io_uring_register(ioring->fd, IORING_REGISTER_FILES2, &rsrc_register,
+      sizeof(rsrc_register)) != 0) {
+        // Sparse file tables require Linux 5.19. Chained operations are unsupported without one.
+        memset(filetab, 0, sizeof(hemlock_filetab_t));
+        return;
+    }
+
+    filetab->n = HEMLOCK_FILETAB_N;
+    filetab->free = (uint16_t *)malloc(sizeof(uint16_t) * filetab->n);
+    assert(filetab->free != NULL);
+    for (size_t i = 0; i < filetab->n; i++) {
+        filetab->free[i] = filetab->n - 1 - i;
+    }
+    filetab->n_free = filetab->n;
+}
+
+static void
+hemlock_filetab_teardown(hemlock_filetab_t *filetab) {
+    // Files are implicitly unregistered when the io_uring fd is closed.
+    free(filetab->free);
+
+    memset(filetab, 0, sizeof(hemlock_filetab_t));
+}
+
+// Whether the kernel supports `opcode`, per `IORING_REGISTER_PROBE`. Probing requires Linux 5.6,
+// and opcodes are conservatively assumed to be unsupported on older kernels.
+static bool
+hemlock_ioring_op_is_supported(hemlock_ioring_t *ioring, uint8_t opcode) {
+    size_t n_ops = UINT8_MAX + 1;
+    struct io_uring_probe *probe = (struct io_uring_probe *)calloc(1,
+      sizeof(struct io_uring_probe) + sizeof(struct io_uring_probe_op) * n_ops);
+    assert(probe != NULL);
+    int result = io_uring_register(ioring->fd, IORING_REGISTER_PROBE, probe, n_ops);
+    bool is_supported = result == 0 && opcode <= probe->last_op &&
+      (probe->ops[opcode].flags & IO_URING_OP_SUPPORTED);
+    free(probe);
+
+    return is_supported;
+}
+
+static hemlock_opt_error_t hemlock_ioring_doorbell_arm(hemlock_ioring_t *ioring);
+
+static hemlock_opt_error_t
+hemlock_ioring_doorbell_setup(hemlock_ioring_t *ioring) {
+    hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
+
+    // `IORING_OP_MSG_RING` requires Linux 5.18.
+    ioring->msg_ring = hemlock_ioring_op_is_supported(ioring, IORING_OP_MSG_RING);
+    ioring->doorbell_fd = -1;
+    if (!ioring->msg_ring) {
+        // Non-blocking, so that the kernel polls the eventfd rather than parking an async worker
+        // thread in `read(2)`.
+        HEMLOCK_OE_ERRNO_RESULT(oe, ioring->doorbell_fd, eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK));
+        HEMLOCK_OE(oe, hemlock_ioring_doorbell_arm(ioring));
+    }
+
+LABEL_OUT:
+    return oe;
+}
+
+// Call `io_uring_setup(2)` with as much of `conf` as the kernel supports, dropping optional flags
+// one by one until the kernel accepts the configuration. On success, `ioring->conf` reflects the
+// configuration actually in effect.
+static int
+hemlock_ioring_setup_probe(hemlock_ioring_t *ioring, hemlock_ioring_conf_t const *conf) {
+    hemlock_ioring_conf_t *effective = &ioring->conf;
+    *effective = *conf;
+    effective->flags &= HEMLOCK_IORING_SETUP_FLAGS_CONF;
+    if (effective->flags & IORING_SETUP_DEFER_TASKRUN) {
+        // `IORING_SETUP_DEFER_TASKRUN` requires `IORING_SETUP_SINGLE_ISSUER`.
+        effective->flags |= IORING_SETUP_SINGLE_ISSUER;
+    }
+    if (effective->wq_fd < 0) {
+        effective->flags &= ~IORING_SETUP_ATTACH_WQ;
+    }
+
+    size_t i = 0;
+    while (true) {
+        memset(&ioring->params, 0, sizeof(struct io_uring_params));
+        ioring->params.flags = effective->flags;
+        if (effective->cq_entries != 0) {
+            ioring->params.flags |= IORING_SETUP_CQSIZE | IORING_SETUP_CLAMP;
+            ioring->params.cq_entries = effective->cq_entries;
+        }
+        if (effective->flags & IORING_SETUP_SQPOLL) {
+            ioring->params.sq_thread_idle = effective->sq_thread_idle;
+        }
+        if (effective->flags & IORING_SETUP_ATTACH_WQ) {
+            ioring->params.wq_fd = effective->wq_fd;
+        }
+
+        int fd = io_uring_setup(effective->sq_entries, &ioring->params);
+        if (fd >= 0) {
+            effective->sq_entries = ioring->params.sq_entries;
+            effective->cq_entries = ioring->params.cq_entries;
+            if ((effective->flags & IORING_SETUP_SQPOLL) == 0) {
+                effective->sq_thread_idle = 0;
+            }
+            if ((effective->flags & IORING_SETUP_ATTACH_WQ) == 0) {
+                effective->wq_fd = -1;
+            }
+            return fd;
+        }
+
+        // Unsupported flags manifest as `EINVAL`, and `IORING_SETUP_SQPOLL` may fail with `EPERM`
+        // on older kernels for unprivileged users. Any other error is fatal.
+        if (errno != EINVAL && errno != EPERM) {
+            return -1;
+        }
+        for (; i < sizeof(hemlock_ioring_setup_flags_optional) / sizeof(uint32_t); i++) {
+            if (effective->flags & hemlock_ioring_setup_flags_optional[i]) {
+                break;
+            }
+        }
+        if (i == sizeof(hemlock_ioring_setup_flags_optional) / sizeof(uint32_t)) {
+            return -1;
+        }
+        effective->flags &= ~hemlock_ioring_setup_flags_optional[i];
+        if (hemlock_ioring_setup_flags_optional[i] == IORING_SETUP_SINGLE_ISSUER) {
+            effective->flags &= ~IORING_SETUP_DEFER_TASKRUN;
+        }
+        i++;
+    }
+}
+
 hemlock_opt_error_t
-hemlock_ioring_setup(hemlock_ioring_t *ioring) {
+hemlock_ioring_setup(
+    hemlock_ioring_t *ioring,
+    hemlock_ioring_conf_t const *conf,
+    hemlock_user_data_slab_t *slab
+) {
     hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
 
     memset(ioring, 0, sizeof(*ioring));
-    HEMLOCK_OE_ERRNO_RESULT(
-        oe, ioring->fd, io_uring_setup(HEMLOCK_IORING_ENTRIES, &ioring->params)
-    );
+    ioring->slab = slab;
+    HEMLOCK_OE_ERRNO_RESULT(oe, ioring->fd, hemlock_ioring_setup_probe(ioring, conf));
 
     assert(ioring->params.features & IORING_FEAT_SINGLE_MMAP);
     assert(ioring->params.features & IORING_FEAT_RW_CUR_POS);
@@ -348,25 +998,111 @@ hemlock_ioring_setup(hemlock_ioring_t *ioring) {
 
     hemlock_sqring_setup(ioring->vm, &ioring->params.sq_off, &ioring->sqring);
     hemlock_cqring_setup(ioring->vm, &ioring->params.cq_off, &ioring->cqring);
+    hemlock_bufring_setup(ioring);
+    hemlock_filetab_setup(ioring);
+    // Worker limits are optional, like setup flags that the kernel does not support.
+    uint32_t iowq_max_workers[2] = {conf->iowq_max_workers[0], conf->iowq_max_workers[1]};
+    if (hemlock_ioring_iowq_max_workers(ioring, iowq_max_workers) != HEMLOCK_OE_NONE) {
+        ioring->conf.iowq_max_workers[0] = 0;
+        ioring->conf.iowq_max_workers[1] = 0;
+    }
+    oe = hemlock_ioring_doorbell_setup(ioring);
+    if (oe != HEMLOCK_OE_NONE) {
+        hemlock_ioring_teardown(ioring);
+    }
 
 LABEL_OUT:
     return oe;
 }
 
+hemlock_opt_error_t
+hemlock_ioring_iowq_max_workers(hemlock_ioring_t *ioring, uint32_t const max_workers[2]) {
+    if (max_workers[0] == 0 && max_workers[1] == 0) {
+        return HEMLOCK_OE_NONE;
+    }
+    // The kernel overwrites `counts` with the previous limits.
+    uint32_t counts[2] = {max_workers[0], max_workers[1]};
+    if (io_uring_register(ioring->fd, IORING_REGISTER_IOWQ_MAX_WORKERS, counts, 2) != 0) {
+        return errno;
+    }
+    for (size_t i = 0; i < 2; i++) {
+        if (max_workers[i] != 0) {
+            ioring->conf.iowq_max_workers[i] = max_workers[i];
+        }
+    }
+
+    return HEMLOCK_OE_NONE;
+}
+
 void
 hemlock_ioring_teardown(hemlock_ioring_t *ioring) {
+    hemlock_filetab_teardown(&ioring->filetab);
     if (munmap(ioring->sqring.sqes, hemlock_ioring_get_sqes_size(ioring)) != 0 ||
       munmap(ioring->vm, hemlock_ioring_get_vm_size(ioring)) != 0 ||
       close(ioring->fd) != 0) {
         abort();
     }
+    // Provided buffers are only unmapped once the kernel can no longer read into them.
+    hemlock_bufring_teardown(&ioring->bufring);
+    // Closing the io_uring fd cancels the outstanding doorbell `read`, if any.
+    if (ioring->doorbell_fd >= 0 && close(ioring->doorbell_fd) != 0) {
+        abort();
+    }
 
     memset(ioring, 0, sizeof(hemlock_ioring_t));
 }
 
+void
+hemlock_ioring_regbuf_register(uint8_t *base, size_t size, hemlock_ioring_t *ioring) {
+    hemlock_regbuf_t *regbuf = &ioring->regbuf;
+
+    struct iovec iovec = {.iov_base = base, .iov_len = size};
+    if (io_uring_register(ioring->fd, IORING_REGISTER_BUFFERS, &iovec, 1) != 0) {
+        // Most likely `RLIMIT_MEMLOCK` is too low, since each ioring's registration counts against
+        // it. Fixed buffers are an optimization, so leave the ioring without one rather than fail.
+        memset(regbuf, 0, sizeof(hemlock_regbuf_t));
+        return;
+    }
+    // The buffer is implicitly unregistered when the io_uring fd is closed.
+    regbuf->base = base;
+    regbuf->size = size;
+}
+
+bool
+hemlock_ioring_is_quiescent(hemlock_ioring_t *ioring) {
+    return ioring->n_inflight == 0 && ioring->sqe_tail == *ioring->sqring.tail &&
+      ioring->bufring.n_out == 0 &&
+      ioring->filetab.n_free == ioring->filetab.n;
+}
+
 static hemlock_opt_error_t
-hemlock_ioring_flush_cqes(uint32_t min_complete, hemlock_ioring_t *ioring) {
+hemlock_ioring_enter_timeout(
+    uint32_t *n_complete,
+    uint32_t min_complete,
+    struct __kernel_timespec *ts,
+    hemlock_ioring_t *ioring
+);
+
+static struct __kernel_timespec
+hemlock_timespec_of_ns(int64_t ns) {
+    struct __kernel_timespec ts = {
+        .tv_sec = ns / 1000000000,
+        .tv_nsec = ns % 1000000000,
+    };
+    return ts;
+}
+
+// Reap all CQEs in the completion queue, first waiting for at least `min_complete` of them to be
+// available. If `ts` is non-NULL, waiting is limited to `ts`, and fewer than `min_complete` CQEs
+// may be reaped; `ETIME` is returned if the kernel reports that the timeout expired.
+static hemlock_opt_error_t
+hemlock_ioring_flush_cqes_timeout(
+    uint32_t min_complete,
+    struct __kernel_timespec *ts,
+    hemlock_ioring_t *ioring
+) {
     hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
+    hemlock_opt_error_t oe_enter = HEMLOCK_OE_NONE;
     hemlock_cqring_t *cqring = &ioring->cqring;
 
     assert(min_complete <= *cqring->ring_entries);
@@ -375,33 +1111,91 @@ hemlock_ioring_flush_cqes(uint32_t min_complete, hemlock_ioring_t *ioring) {
     uint32_t head = *cqring->head;
     if (tail - head < min_complete) {
         uint32_t n_complete;
-        HEMLOCK_OE(oe, hemlock_ioring_enter(&n_complete, min_complete, ioring));
+        oe_enter = hemlock_ioring_enter_timeout(&n_complete, min_complete, ts, ioring);
+        if (oe_enter != ETIME) {
+            HEMLOCK_OE(oe, oe_enter);
+        }
         tail = HEMLOCK_ATOMIC_LOAD_ACQUIRE(cqring->tail);
     }
     for (; head < tail; head++) {
         struct io_uring_cqe *cqe = &cqring->cqes[head & *cqring->ring_mask];
+        switch (cqe->user_data) {
+        case HEMLOCK_IORING_USER_DATA_NONE:
+            continue;
+        case HEMLOCK_IORING_USER_DATA_DOORBELL:
+            // The doorbell's only effect is to have woken this thread. In eventfd mode, the
+            // completed `read` reset the eventfd, and is re-armed once the queue head is released.
+            ioring->n_doorbells++;
+            ioring->doorbell_armed = false;
+            continue;
+        default:
+            break;
+        }
         hemlock_user_data_t *user_data = (hemlock_user_data_t *)cqe->user_data;
         memcpy(&user_data->cqe, cqe, sizeof(struct io_uring_cqe));
+        if (user_data->buffer_select && (cqe->flags & IORING_CQE_F_BUFFER) != 0) {
+            // The kernel selected a provided buffer, which the operation holds until its last ref
+            // is dropped.
+            hemlock_bufring_t *bufring = &ioring->bufring;
+            user_data->buf_index = cqe->flags >> IORING_CQE_BUFFER_SHIFT;
+            user_data->buffer = &bufring->bufs[user_data->buf_index * bufring->buf_size];
+            bufring->n_out++;
+        }
+        if (user_data->pin != 0) {
+            // The kernel is done with the pinned buffer.
+            ioring->unpin(user_data);
+            user_data->pin = 0;
+        }
+        if (user_data->waiter != NULL) {
+            ioring->complete(user_data);
+            user_data->waiter = NULL;
+        }
         switch (user_data->opcode) {
         case IORING_OP_OPENAT:
-            free(user_data->pathname);
-            user_data->pathname = NULL;
-            break;
+        case IORING_OP_MKDIRAT:
+        case IORING_OP_UNLINKAT:
+        case IORING_OP_RENAMEAT:
         case IORING_OP_WRITE:
-            free(user_data->buffer);
-            user_data->buffer = NULL;
+        case IORING_OP_WRITE_FIXED:
+        case IORING_OP_WRITEV:
+            // Free buffers as soon as the kernel is done with them. Read buffers are released after
+            // their contents are consumed.
+            hemlock_user_data_buffer_release(user_data, ioring);
+            break;
+        case IORING_OP_CLOSE:
+            // The slot is empty once the chain's close has run, or if it was cancelled because the
+            // open failed.
+            if (user_data->file_index != 0) {
+                hemlock_ioring_file_release(user_data->file_index - 1, ioring);
+            }
+            break;
+        case IORING_OP_ASYNC_CANCEL:
+            // The kernel no longer looks up the target, which may have completed long ago.
+            hemlock_user_data_decref(user_data->target, ioring);
+            user_data->target = NULL;
             break;
         default:
             break;
         };
-        hemlock_user_data_decref(user_data);
+        hemlock_user_data_decref(user_data, ioring);
+        ioring->n_inflight--;
+        ioring->n_reaped++;
     }
     HEMLOCK_ATOMIC_STORE_RELEASE(cqring->head, head);
+    if (ioring->doorbell_fd >= 0 && !ioring->doorbell_armed) {
+        HEMLOCK_OE(oe, hemlock_ioring_doorbell_arm(ioring));
+    }
+    oe = oe_enter;
 
 LABEL_OUT:
     return oe;
 }
 
+static hemlock_opt_error_t
+hemlock_ioring_flush_cqes(uint32_t min_complete, hemlock_ioring_t *ioring) {
+    return hemlock_ioring_flush_cqes_timeout(min_complete, NULL, ioring);
+}
+
 static hemlock_opt_error_t
 hemlock_ioring_flush_sqes(hemlock_ioring_t *ioring) {
     hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
@@ -416,25 +1210,88 @@ LABEL_OUT:
     return oe;
 }
 
+static bool
+hemlock_ioring_sq_is_full(hemlock_ioring_t *ioring) {
+    hemlock_sqring_t *sqring = &ioring->sqring;
+    return ioring->sqe_tail - HEMLOCK_ATOMIC_LOAD_ACQUIRE(sqring->head) == *sqring->ring_entries;
+}
+
 static hemlock_opt_error_t
 hemlock_ioring_get_sqe(struct io_uring_sqe **sqe, hemlock_ioring_t *ioring) {
     hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
 
     hemlock_sqring_t *sqring = &ioring->sqring;
-    if (*sqring->tail - HEMLOCK_ATOMIC_LOAD_ACQUIRE(sqring->head) == *sqring->ring_entries) {
+    while (hemlock_ioring_sq_is_full(ioring)) {
+        // Without `IORING_SETUP_SQPOLL` one flush suffices, but the polling thread may take a while
+        // to consume SQEs.
         HEMLOCK_OE(oe, hemlock_ioring_flush_sqes(ioring));
     }
 
-    *sqe = &sqring->sqes[*sqring->tail & *sqring->ring_mask];
-    HEMLOCK_ATOMIC_STORE_RELEASE(sqring->tail, *sqring->tail + 1);
+    *sqe = &sqring->sqes[ioring->sqe_tail & *sqring->ring_mask];
+    ioring->sqe_tail++;
+    ioring->n_inflight++;
     memset(*sqe, 0, sizeof(struct io_uring_sqe));
 
 LABEL_OUT:
     return oe;
 }
 
-hemlock_opt_error_t
-hemlock_ioring_enter(uint32_t *n_complete, uint32_t min_complete, hemlock_ioring_t *ioring) {
+// Like `hemlock_ioring_get_sqe`, but for internal operations, which complete with reserved
+// `user_data` and are not counted as in flight. If the submission queue is full, room is made by
+// submitting rather than by reaping CQEs.
+static hemlock_opt_error_t
+hemlock_ioring_get_sqe_internal(struct io_uring_sqe **sqe, hemlock_ioring_t *ioring) {
+    hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
+
+    hemlock_sqring_t *sqring = &ioring->sqring;
+    while (hemlock_ioring_sq_is_full(ioring)) {
+        uint32_t n_complete;
+        HEMLOCK_OE(oe, hemlock_ioring_enter(&n_complete, 0, ioring));
+    }
+
+    *sqe = &sqring->sqes[ioring->sqe_tail & *sqring->ring_mask];
+    ioring->sqe_tail++;
+    memset(*sqe, 0, sizeof(struct io_uring_sqe));
+
+LABEL_OUT:
+    return oe;
+}
+
+// Make all acquired SQEs visible to the kernel.
+static void
+hemlock_ioring_sqes_publish(hemlock_ioring_t *ioring) {
+    HEMLOCK_ATOMIC_STORE_RELEASE(ioring->sqring.tail, ioring->sqe_tail);
+}
+
+// Queue a `read` of the doorbell eventfd, which completes the next time the doorbell is rung. The
+// `read` is submitted along with the next batch of SQEs, at the latest when this ioring's thread
+// next waits for completions.
+static hemlock_opt_error_t
+hemlock_ioring_doorbell_arm(hemlock_ioring_t *ioring) {
+    hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
+    struct io_uring_sqe *sqe;
+    HEMLOCK_OE(oe, hemlock_ioring_get_sqe_internal(&sqe, ioring));
+
+    sqe->user_data = HEMLOCK_IORING_USER_DATA_DOORBELL;
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = ioring->doorbell_fd;
+    sqe->addr = (uint64_t)&ioring->doorbell_buf;
+    sqe->len = sizeof(ioring->doorbell_buf);
+    sqe->off = HEMLOCK_IORING_OFF_CUR;
+    hemlock_ioring_sqes_publish(ioring);
+    ioring->doorbell_armed = true;
+
+LABEL_OUT:
+    return oe;
+}
+
+static hemlock_opt_error_t
+hemlock_ioring_enter_timeout(
+    uint32_t *n_complete,
+    uint32_t min_complete,
+    struct __kernel_timespec *ts,
+    hemlock_ioring_t *ioring
+) {
     hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
 LABEL_OUT:
     switch (oe) {
@@ -443,14 +1300,60 @@ LABEL_OUT:
         // reap CQEs. If the final SQE has IOSQE_IO_LINK set, no other actors may submit I/O on this
         // ioring until the current actor finishes submitting its chain of SQEs.
         HEMLOCK_OE(oe, hemlock_ioring_flush_cqes(1, ioring));
-    case HEMLOCK_OE_NONE:
-        HEMLOCK_OE_ERRNO_RESULT(
-          oe,
-          *n_complete,
-          io_uring_enter(ioring->fd, *ioring->sqring.tail -
-            HEMLOCK_ATOMIC_LOAD_ACQUIRE(ioring->sqring.head), min_complete, IORING_ENTER_GETEVENTS)
-        );
+    case HEMLOCK_OE_NONE: {
+        hemlock_ioring_sqes_publish(ioring);
+        uint32_t flags = IORING_ENTER_GETEVENTS;
+        if (ioring->conf.flags & IORING_SETUP_SQPOLL) {
+            // The polling thread consumes SQEs on its own, but it must be woken if it has gone
+            // idle. The full barrier orders the preceding tail store before the flags load, per
+            // `io_uring(7)`.
+            atomic_thread_fence(memory_order_seq_cst);
+            if (HEMLOCK_ATOMIC_LOAD_ACQUIRE(ioring->sqring.flags) & IORING_SQ_NEED_WAKEUP) {
+                flags |= IORING_ENTER_SQ_WAKEUP;
+            }
+            if (hemlock_ioring_sq_is_full(ioring)) {
+                flags |= IORING_ENTER_SQ_WAIT;
+            }
+        }
+        uint32_t to_submit = ioring->sqe_tail - HEMLOCK_ATOMIC_LOAD_ACQUIRE(ioring->sqring.head);
+        // The result is captured as a signed int so that -1 is recognized as failure.
+        int result;
+        bool block = min_complete > 0 && ioring->block != NULL;
+        if (ts == NULL) {
+            if (block) {
+                ioring->block();
+            }
+            result = io_uring_enter(ioring->fd, to_submit, min_complete, flags);
+            int enter_errno = errno;
+            if (block) {
+                ioring->unblock();
+            }
+            errno = enter_errno;
+            HEMLOCK_OE_ERRNO_RESULT(oe, result, result);
+        } else {
+            if ((ioring->params.features & IORING_FEAT_EXT_ARG) == 0) {
+                HEMLOCK_OE(oe, EOPNOTSUPP);
+            }
+            if (block) {
+                ioring->block();
+            }
+            result = io_uring_enter_timeout(ioring->fd, to_submit, min_complete, flags, ts);
+            int enter_errno = errno;
+            if (block) {
+                ioring->unblock();
+            }
+            errno = enter_errno;
+            if (result == -1 && errno == ETIME) {
+                // Timeout expiry is an expected outcome, not an error worth reporting.
+                oe = ETIME;
+                result = 0;
+            } else {
+                HEMLOCK_OE_ERRNO_RESULT(oe, result, result);
+            }
+        }
+        *n_complete = result;
         break;
+    }
     default:
         break;
     }
@@ -458,6 +1361,78 @@ LABEL_OUT:
     return oe;
 }
 
+hemlock_opt_error_t
+hemlock_ioring_enter(uint32_t *n_complete, uint32_t min_complete, hemlock_ioring_t *ioring) {
+    return hemlock_ioring_enter_timeout(n_complete, min_complete, NULL, ioring);
+}
+
+hemlock_opt_error_t
+hemlock_ioring_poll(hemlock_ioring_t *ioring) {
+    hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
+    uint32_t n_complete;
+    HEMLOCK_OE(oe, hemlock_ioring_enter(&n_complete, 0, ioring));
+    HEMLOCK_OE(oe, hemlock_ioring_flush_cqes(0, ioring));
+
+LABEL_OUT:
+    return oe;
+}
+
+hemlock_opt_error_t
+hemlock_ioring_poll_lazy(hemlock_ioring_t *ioring) {
+    hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
+    if (ioring->sqe_tail != HEMLOCK_ATOMIC_LOAD_ACQUIRE(ioring->sqring.head) ||
+      ((ioring->conf.flags & IORING_SETUP_DEFER_TASKRUN) && ioring->n_inflight > 0)) {
+        uint32_t n_complete;
+        HEMLOCK_OE(oe, hemlock_ioring_enter(&n_complete, 0, ioring));
+    }
+    HEMLOCK_OE(oe, hemlock_ioring_flush_cqes(0, ioring));
+
+LABEL_OUT:
+    return oe;
+}
+
+hemlock_opt_error_t
+hemlock_ioring_doorbell_ring(hemlock_ioring_t *target, hemlock_ioring_t *ioring) {
+    hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
+
+    if (target->msg_ring) {
+        // Post a CQE with `HEMLOCK_IORING_USER_DATA_DOORBELL` to `target`. The sender side CQE is
+        // only posted on failure, in which case the doorbell is lost anyway.
+        struct io_uring_sqe *sqe;
+        HEMLOCK_OE(oe, hemlock_ioring_get_sqe_internal(&sqe, ioring));
+        sqe->user_data = HEMLOCK_IORING_USER_DATA_NONE;
+        sqe->opcode = IORING_OP_MSG_RING;
+        sqe->flags = IOSQE_CQE_SKIP_SUCCESS;
+        sqe->fd = target->fd;
+        sqe->addr = IORING_MSG_DATA;
+        sqe->off = HEMLOCK_IORING_USER_DATA_DOORBELL;
+        // Submit immediately rather than leaving the SQE for this ioring's next submission, which
+        // may be arbitrarily far off.
+        uint32_t n_complete;
+        HEMLOCK_OE(oe, hemlock_ioring_enter(&n_complete, 0, ioring));
+    } else {
+        uint64_t one = 1;
+        ssize_t result;
+        HEMLOCK_OE_ERRNO_RESULT(oe, result, write(target->doorbell_fd, &one, sizeof(one)));
+    }
+
+LABEL_OUT:
+    return oe;
+}
+
+hemlock_opt_error_t
+hemlock_ioring_reap(uint32_t min_complete, int64_t timeout_ns, hemlock_ioring_t *ioring) {
+    if (min_complete > *ioring->cqring.ring_entries) {
+        min_complete = *ioring->cqring.ring_entries;
+    }
+    if (timeout_ns < 0) {
+        return hemlock_ioring_flush_cqes(min_complete, ioring);
+    } else {
+        struct __kernel_timespec ts = hemlock_timespec_of_ns(timeout_ns);
+        return hemlock_ioring_flush_cqes_timeout(min_complete, &ts, ioring);
+    }
+}
+
 int
 hemlock_ioring_user_data_complete(hemlock_user_data_t *user_data, hemlock_ioring_t *ioring) {
     hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
@@ -480,17 +1455,147 @@ LABEL_OUT:
     }
 }
 
+// Ensure that `n` SQEs can be acquired without an intervening `io_uring_enter(2)`, so that a chain
+// is never split across submissions (see the `EBUSY` edge case above).
+static hemlock_opt_error_t
+hemlock_ioring_chain_reserve(uint32_t n, hemlock_ioring_t *ioring) {
+    hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
+    hemlock_sqring_t *sqring = &ioring->sqring;
+
+    if (n > *sqring->ring_entries) {
+        HEMLOCK_OE(oe, EINVAL);
+    }
+    while (*sqring->ring_entries - (ioring->sqe_tail - HEMLOCK_ATOMIC_LOAD_ACQUIRE(sqring->head)) <
+      n) {
+        HEMLOCK_OE(oe, hemlock_ioring_flush_sqes(ioring));
+    }
+
+LABEL_OUT:
+    return oe;
+}
+
+// Create user_data for an unexposed operation, to which only the kernel holds a ref.
+static hemlock_user_data_t *
+hemlock_user_data_create_unexposed(hemlock_ioring_t *ioring) {
+    hemlock_user_data_t *user_data = hemlock_user_data_create(ioring);
+    user_data->refcount = 1;
+
+    return user_data;
+}
+
+// Acquire the SQE of an operation, along with room for a linked timeout if `timeout_ns` is
+// non-negative.
+static hemlock_opt_error_t
+hemlock_ioring_get_sqe_timeout(
+    struct io_uring_sqe **sqe,
+    int64_t timeout_ns,
+    hemlock_ioring_t *ioring
+) {
+    hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
+    if (timeout_ns >= 0) {
+        HEMLOCK_OE(oe, hemlock_ioring_chain_reserve(2, ioring));
+    }
+    HEMLOCK_OE(oe, hemlock_ioring_get_sqe(sqe, ioring));
+
+LABEL_OUT:
+    return oe;
+}
+
+// Link a timeout to the operation prepared in `sqe`, if `timeout_ns` is non-negative. Must follow
+// `hemlock_ioring_get_sqe_timeout`, before the operation is published. The timeout completes with
+// `ETIME` if it cancelled the operation, and with `ECANCELED` otherwise.
+static void
+hemlock_ioring_link_timeout(
+    struct io_uring_sqe *sqe,
+    int64_t timeout_ns,
+    hemlock_ioring_t *ioring
+) {
+    if (timeout_ns < 0) {
+        return;
+    }
+    // Room was reserved, so acquisition neither fails nor submits the operation without its
+    // timeout.
+    struct io_uring_sqe *timeout_sqe;
+    hemlock_opt_error_t oe = hemlock_ioring_get_sqe(&timeout_sqe, ioring);
+    assert(oe == HEMLOCK_OE_NONE);
+    (void)oe;
+
+    hemlock_user_data_t *user_data = hemlock_user_data_create_unexposed(ioring);
+    user_data->opcode = IORING_OP_LINK_TIMEOUT;
+    user_data->timeout = hemlock_timespec_of_ns(timeout_ns);
+
+    sqe->flags |= IOSQE_IO_LINK;
+    timeout_sqe->user_data = (uint64_t)user_data;
+    timeout_sqe->opcode = IORING_OP_LINK_TIMEOUT;
+    timeout_sqe->addr = (uint64_t)&user_data->timeout;
+    timeout_sqe->len = 1;
+}
+
+hemlock_opt_error_t
+hemlock_ioring_cancel_submit(hemlock_user_data_t *target, hemlock_ioring_t *ioring) {
+    hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
+    struct io_uring_sqe *sqe;
+    HEMLOCK_OE(oe, hemlock_ioring_get_sqe(&sqe, ioring));
+    if (hemlock_user_data_is_complete(target)) {
+        // Nothing to cancel, possibly because acquiring the SQE reaped the target's CQE. The SQE
+        // has not been published, so it can simply be given back.
+        ioring->sqe_tail--;
+        ioring->n_inflight--;
+        return oe;
+    }
+
+    hemlock_user_data_t *user_data = hemlock_user_data_create_unexposed(ioring);
+    user_data->opcode = IORING_OP_ASYNC_CANCEL;
+    user_data->target = target;
+    target->refcount++;
+
+    sqe->user_data = (uint64_t)user_data;
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->addr = (uint64_t)target;
+    hemlock_ioring_sqes_publish(ioring);
+
+LABEL_OUT:
+    return oe;
+}
+
+hemlock_opt_error_t
+hemlock_ioring_timeout_submit(
+    hemlock_user_data_t **user_data,
+    int64_t timeout_ns,
+    hemlock_ioring_t *ioring
+) {
+    hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
+    struct io_uring_sqe *sqe;
+    HEMLOCK_OE(oe, hemlock_ioring_get_sqe(&sqe, ioring));
+
+    *user_data = hemlock_user_data_create(ioring);
+    (*user_data)->opcode = IORING_OP_TIMEOUT;
+    (*user_data)->timeout = hemlock_timespec_of_ns(timeout_ns);
+
+    sqe->user_data = (uint64_t)(*user_data);
+    sqe->opcode = IORING_OP_TIMEOUT;
+    sqe->addr = (uint64_t)&(*user_data)->timeout;
+    sqe->len = 1;
+    // Expire on time alone, rather than after some number of other completions.
+    sqe->off = 0;
+    hemlock_ioring_sqes_publish(ioring);
+
+LABEL_OUT:
+    return oe;
+}
+
 hemlock_opt_error_t
 hemlock_ioring_nop_submit(hemlock_user_data_t **user_data, hemlock_ioring_t *ioring) {
     hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
     struct io_uring_sqe *sqe;
     HEMLOCK_OE(oe, hemlock_ioring_get_sqe(&sqe, ioring));
 
-    *user_data = hemlock_user_data_create();
+    *user_data = hemlock_user_data_create(ioring);
     (*user_data)->opcode = IORING_OP_NOP;
 
     sqe->user_data = (uint64_t)(*user_data);
     sqe->opcode = IORING_OP_NOP;
+    hemlock_ioring_sqes_publish(ioring);
 
 LABEL_OUT:
     return oe;
@@ -508,7 +1613,7 @@ hemlock_ioring_open_submit(
     struct io_uring_sqe *sqe;
     HEMLOCK_OE(oe, hemlock_ioring_get_sqe(&sqe, ioring));
 
-    *user_data = hemlock_user_data_create();
+    *user_data = hemlock_user_data_create(ioring);
     (*user_data)->opcode = IORING_OP_OPENAT;
     (*user_data)->pathname = pathname;
 
@@ -518,6 +1623,7 @@ hemlock_ioring_open_submit(
     sqe->addr = (uint64_t)pathname;
     sqe->open_flags = flags;
     sqe->len = mode;
+    hemlock_ioring_sqes_publish(ioring);
 
 LABEL_OUT:
     return oe;
@@ -529,39 +1635,264 @@ hemlock_ioring_close_submit(hemlock_user_data_t **user_data, int fd, hemlock_ior
     struct io_uring_sqe *sqe;
     HEMLOCK_OE(oe, hemlock_ioring_get_sqe(&sqe, ioring));
 
-    *user_data = hemlock_user_data_create();
+    *user_data = hemlock_user_data_create(ioring);
     (*user_data)->opcode = IORING_OP_CLOSE;
 
     sqe->user_data = (uint64_t)(*user_data);
     sqe->opcode = IORING_OP_CLOSE;
     sqe->fd = fd;
+    hemlock_ioring_sqes_publish(ioring);
+
+LABEL_OUT:
+    return oe;
+}
+
+hemlock_opt_error_t
+hemlock_ioring_mkdirat_submit(
+    hemlock_user_data_t **user_data,
+    int dirfd,
+    uint8_t *pathname,
+    mode_t mode,
+    hemlock_ioring_t *ioring
+) {
+    hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
+    struct io_uring_sqe *sqe;
+    HEMLOCK_OE(oe, hemlock_ioring_get_sqe(&sqe, ioring));
+
+    *user_data = hemlock_user_data_create(ioring);
+    (*user_data)->opcode = IORING_OP_MKDIRAT;
+    (*user_data)->pathname = pathname;
+
+    sqe->user_data = (uint64_t)(*user_data);
+    sqe->opcode = IORING_OP_MKDIRAT;
+    sqe->fd = dirfd;
+    sqe->addr = (uint64_t)pathname;
+    sqe->len = mode;
+    hemlock_ioring_sqes_publish(ioring);
+
+LABEL_OUT:
+    return oe;
+}
+
+hemlock_opt_error_t
+hemlock_ioring_unlinkat_submit(
+    hemlock_user_data_t **user_data,
+    int dirfd,
+    uint8_t *pathname,
+    int flags,
+    hemlock_ioring_t *ioring
+) {
+    hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
+    struct io_uring_sqe *sqe;
+    HEMLOCK_OE(oe, hemlock_ioring_get_sqe(&sqe, ioring));
+
+    *user_data = hemlock_user_data_create(ioring);
+    (*user_data)->opcode = IORING_OP_UNLINKAT;
+    (*user_data)->pathname = pathname;
+
+    sqe->user_data = (uint64_t)(*user_data);
+    sqe->opcode = IORING_OP_UNLINKAT;
+    sqe->fd = dirfd;
+    sqe->addr = (uint64_t)pathname;
+    sqe->unlink_flags = flags;
+    hemlock_ioring_sqes_publish(ioring);
+
+LABEL_OUT:
+    return oe;
+}
+
+hemlock_opt_error_t
+hemlock_ioring_renameat_submit(
+    hemlock_user_data_t **user_data,
+    int olddirfd,
+    int newdirfd,
+    uint8_t *pathnames,
+    hemlock_ioring_t *ioring
+) {
+    hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
+    struct io_uring_sqe *sqe;
+    HEMLOCK_OE(oe, hemlock_ioring_get_sqe(&sqe, ioring));
+
+    *user_data = hemlock_user_data_create(ioring);
+    (*user_data)->opcode = IORING_OP_RENAMEAT;
+    (*user_data)->pathname = pathnames;
+
+    sqe->user_data = (uint64_t)(*user_data);
+    sqe->opcode = IORING_OP_RENAMEAT;
+    sqe->fd = olddirfd;
+    sqe->addr = (uint64_t)pathnames;
+    sqe->len = newdirfd;
+    sqe->addr2 = (uint64_t)(pathnames + strlen((char *)pathnames) + 1);
+    hemlock_ioring_sqes_publish(ioring);
+
+LABEL_OUT:
+    return oe;
+}
+
+hemlock_opt_error_t
+hemlock_ioring_statx_submit(
+    hemlock_user_data_t **user_data,
+    int dirfd,
+    uint8_t *statxbuf,
+    int flags,
+    unsigned mask,
+    hemlock_ioring_t *ioring
+) {
+    hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
+    struct io_uring_sqe *sqe;
+    HEMLOCK_OE(oe, hemlock_ioring_get_sqe(&sqe, ioring));
+
+    *user_data = hemlock_user_data_create(ioring);
+    (*user_data)->opcode = IORING_OP_STATX;
+    (*user_data)->buffer = statxbuf;
+
+    sqe->user_data = (uint64_t)(*user_data);
+    sqe->opcode = IORING_OP_STATX;
+    sqe->fd = dirfd;
+    sqe->addr = (uint64_t)(statxbuf + sizeof(struct statx));
+    sqe->len = mask;
+    sqe->statx_flags = flags;
+    sqe->addr2 = (uint64_t)statxbuf;
+    hemlock_ioring_sqes_publish(ioring);
+
+LABEL_OUT:
+    return oe;
+}
+
+hemlock_opt_error_t
+hemlock_ioring_fsync_submit(
+    hemlock_user_data_t **user_data,
+    int fd,
+    unsigned flags,
+    hemlock_ioring_t *ioring
+) {
+    hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
+    struct io_uring_sqe *sqe;
+    HEMLOCK_OE(oe, hemlock_ioring_get_sqe(&sqe, ioring));
+
+    *user_data = hemlock_user_data_create(ioring);
+    (*user_data)->opcode = IORING_OP_FSYNC;
+
+    sqe->user_data = (uint64_t)(*user_data);
+    sqe->opcode = IORING_OP_FSYNC;
+    sqe->fd = fd;
+    sqe->fsync_flags = flags;
+    hemlock_ioring_sqes_publish(ioring);
 
 LABEL_OUT:
     return oe;
 }
 
+hemlock_opt_error_t
+hemlock_ioring_fallocate_submit(
+    hemlock_user_data_t **user_data,
+    int fd,
+    int mode,
+    uint64_t off,
+    uint64_t n,
+    hemlock_ioring_t *ioring
+) {
+    hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
+    struct io_uring_sqe *sqe;
+    HEMLOCK_OE(oe, hemlock_ioring_get_sqe(&sqe, ioring));
+
+    *user_data = hemlock_user_data_create(ioring);
+    (*user_data)->opcode = IORING_OP_FALLOCATE;
+
+    sqe->user_data = (uint64_t)(*user_data);
+    sqe->opcode = IORING_OP_FALLOCATE;
+    sqe->fd = fd;
+    sqe->off = off;
+    // The length is passed via `addr`, and the mode via `len`.
+    sqe->addr = n;
+    sqe->len = mode;
+    hemlock_ioring_sqes_publish(ioring);
+
+LABEL_OUT:
+    return oe;
+}
+
+// The fixed variant of `opcode` (`IORING_OP_READ` or `IORING_OP_WRITE`) if the `n` bytes at
+// `buffer` lie entirely within the registered buffer, and `opcode` otherwise.
+static uint8_t
+hemlock_ioring_rw_opcode(uint8_t opcode, uint8_t const *buffer, uint64_t n,
+  hemlock_ioring_t const *ioring) {
+    hemlock_regbuf_t const *regbuf = &ioring->regbuf;
+    uintptr_t base = (uintptr_t)regbuf->base;
+    uintptr_t addr = (uintptr_t)buffer;
+    if (regbuf->size == 0 || addr < base || addr - base > regbuf->size
+      || n > regbuf->size - (addr - base)) {
+        return opcode;
+    }
+    return (opcode == IORING_OP_READ) ? IORING_OP_READ_FIXED : IORING_OP_WRITE_FIXED;
+}
+
 hemlock_opt_error_t
 hemlock_ioring_read_submit(
     hemlock_user_data_t **user_data,
     int fd,
     uint8_t *buffer,
     uint64_t n,
+    uint64_t off,
+    int64_t timeout_ns,
     hemlock_ioring_t *ioring
 ) {
     hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
     struct io_uring_sqe *sqe;
-    HEMLOCK_OE(oe, hemlock_ioring_get_sqe(&sqe, ioring));
+    HEMLOCK_OE(oe, hemlock_ioring_get_sqe_timeout(&sqe, timeout_ns, ioring));
 
-    *user_data = hemlock_user_data_create();
-    (*user_data)->opcode = IORING_OP_READ;
+    // Fixed buffer 0 is the only one registered, and `buf_index` is already 0.
+    uint8_t opcode = hemlock_ioring_rw_opcode(IORING_OP_READ, buffer, n, ioring);
+    *user_data = hemlock_user_data_create(ioring);
+    (*user_data)->opcode = opcode;
     (*user_data)->buffer = buffer;
 
     sqe->user_data = (uint64_t)(*user_data);
-    sqe->opcode = IORING_OP_READ;
-    sqe->off = -1;  // Use current file position.
+    sqe->opcode = opcode;
+    sqe->off = off;
     sqe->fd = fd;
     sqe->addr = (uint64_t)buffer;
     sqe->len = n;
+    hemlock_ioring_link_timeout(sqe, timeout_ns, ioring);
+    hemlock_ioring_sqes_publish(ioring);
+
+LABEL_OUT:
+    return oe;
+}
+
+hemlock_opt_error_t
+hemlock_ioring_read_select_submit(
+    hemlock_user_data_t **user_data,
+    int fd,
+    uint64_t n,
+    uint64_t off,
+    int64_t timeout_ns,
+    hemlock_ioring_t *ioring
+) {
+    hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
+    hemlock_bufring_t *bufring = &ioring->bufring;
+    if (bufring->n == 0) {
+        // Expected prior to Linux 5.19, and callers fall back to reading into their own buffers, so
+        // this is not worth reporting.
+        oe = EOPNOTSUPP;
+        goto LABEL_OUT;
+    }
+    struct io_uring_sqe *sqe;
+    HEMLOCK_OE(oe, hemlock_ioring_get_sqe_timeout(&sqe, timeout_ns, ioring));
+
+    *user_data = hemlock_user_data_create(ioring);
+    (*user_data)->opcode = IORING_OP_READ;
+    (*user_data)->buffer_select = true;
+
+    sqe->user_data = (uint64_t)(*user_data);
+    sqe->opcode = IORING_OP_READ;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = HEMLOCK_BUFRING_BGID;
+    sqe->off = off;
+    sqe->fd = fd;
+    sqe->len = (n < bufring->buf_size) ? n : bufring->buf_size;
+    hemlock_ioring_link_timeout(sqe, timeout_ns, ioring);
+    hemlock_ioring_sqes_publish(ioring);
 
 LABEL_OUT:
     return oe;
@@ -573,22 +1904,326 @@ hemlock_ioring_write_submit(
     int fd,
     uint8_t *buffer,
     uint64_t n,
+    uint64_t off,
+    int64_t timeout_ns,
     hemlock_ioring_t *ioring
 ) {
     hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
     struct io_uring_sqe *sqe;
-    HEMLOCK_OE(oe, hemlock_ioring_get_sqe(&sqe, ioring));
+    HEMLOCK_OE(oe, hemlock_ioring_get_sqe_timeout(&sqe, timeout_ns, ioring));
 
-    *user_data = hemlock_user_data_create();
-    (*user_data)->opcode = IORING_OP_WRITE;
+    // Fixed buffer 0 is the only one registered, and `buf_index` is already 0.
+    uint8_t opcode = hemlock_ioring_rw_opcode(IORING_OP_WRITE, buffer, n, ioring);
+    *user_data = hemlock_user_data_create(ioring);
+    (*user_data)->opcode = opcode;
     (*user_data)->buffer = buffer;
 
     sqe->user_data = (uint64_t)(*user_data);
-    sqe->opcode = IORING_OP_WRITE;
-    sqe->off = -1;  // Use current file position.
+    sqe->opcode = opcode;
+    sqe->off = off;
     sqe->fd = fd;
     sqe->addr = (uint64_t)buffer;
     sqe->len = n;
+    hemlock_ioring_link_timeout(sqe, timeout_ns, ioring);
+    hemlock_ioring_sqes_publish(ioring);
+
+LABEL_OUT:
+    return oe;
+}
+
+// Acquire a fixed file table slot, waiting for in-flight chains to close theirs if necessary.
+static hemlock_opt_error_t
+hemlock_ioring_file_acquire(uint16_t *file_index, hemlock_ioring_t *ioring) {
+    hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
+    hemlock_filetab_t *filetab = &ioring->filetab;
+
+    if (filetab->n == 0) {
+        // Expected prior to Linux 5.19, so this is not worth reporting.
+        oe = EOPNOTSUPP;
+        goto LABEL_OUT;
+    }
+    while (filetab->n_free == 0) {
+        HEMLOCK_OE(oe, hemlock_ioring_flush_cqes(1, ioring));
+    }
+    filetab->n_free--;
+    *file_index = filetab->free[filetab->n_free];
+
+LABEL_OUT:
+    return oe;
+}
+
+static void
+hemlock_ioring_chain_open_prep(
+    struct io_uring_sqe *sqe,
+    hemlock_user_data_t *user_data,
+    uint8_t *pathname,
+    int flags,
+    mode_t mode,
+    uint16_t file_index
+) {
+    user_data->opcode = IORING_OP_OPENAT;
+    user_data->pathname = pathname;
+
+    sqe->user_data = (uint64_t)user_data;
+    sqe->opcode = IORING_OP_OPENAT;
+    // Failure to open cancels the rest of the chain, including the close.
+    sqe->flags = IOSQE_IO_LINK;
+    sqe->fd = AT_FDCWD;
+    sqe->addr = (uint64_t)pathname;
+    sqe->open_flags = flags;
+    sqe->len = mode;
+    sqe->file_index = file_index + 1;
+}
+
+static void
+hemlock_ioring_chain_rw_prep(
+    struct io_uring_sqe *sqe,
+    hemlock_user_data_t *user_data,
+    uint8_t opcode,
+    uint8_t *buffer,
+    uint64_t n,
+    uint16_t file_index
+) {
+    user_data->opcode = opcode;
+    user_data->buffer = buffer;
+
+    sqe->user_data = (uint64_t)user_data;
+    sqe->opcode = opcode;
+    // Short reads/writes fail the link, but the file must be closed regardless.
+    sqe->flags = IOSQE_FIXED_FILE | IOSQE_IO_HARDLINK;
+    sqe->off = 0;
+    sqe->fd = file_index;
+    sqe->addr = (uint64_t)buffer;
+    sqe->len = n;
+}
+
+static void
+hemlock_ioring_chain_close_prep(
+    struct io_uring_sqe *sqe,
+    hemlock_user_data_t *user_data,
+    uint16_t file_index
+) {
+    user_data->opcode = IORING_OP_CLOSE;
+    user_data->file_index = file_index + 1;
+
+    sqe->user_data = (uint64_t)user_data;
+    sqe->opcode = IORING_OP_CLOSE;
+    sqe->file_index = file_index + 1;
+}
+
+// Submit a linked open->read->close chain, reading up to `n` bytes from the beginning of the file
+// at `pathname` into `buffer`. The file is opened directly into a fixed file table slot, so the
+// whole chain is submitted at once and no fd is exposed to userspace. On success, `user_datas`
+// contains the open, read, and close user_data in order.
+hemlock_opt_error_t
+hemlock_ioring_read_chain_submit(
+    hemlock_user_data_t *user_datas[3],
+    uint8_t *pathname,
+    int flags,
+    uint8_t *buffer,
+    uint64_t n,
+    hemlock_ioring_t *ioring
+) {
+    hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
+    struct io_uring_sqe *sqes[3];
+    uint16_t file_index;
+
+    HEMLOCK_OE(oe, hemlock_ioring_chain_reserve(3, ioring));
+    // Reaping CQEs while waiting for a slot does not consume the reserved SQEs. Failure is not
+    // reported, since callers fall back to unchained operations without a fixed file table.
+    oe = hemlock_ioring_file_acquire(&file_index, ioring);
+    if (oe != HEMLOCK_OE_NONE) {
+        goto LABEL_OUT;
+    }
+    for (size_t i = 0; i < 3; i++) {
+        HEMLOCK_OE(oe, hemlock_ioring_get_sqe(&sqes[i], ioring));
+        user_datas[i] = hemlock_user_data_create(ioring);
+    }
+
+    hemlock_ioring_chain_open_prep(sqes[0], user_datas[0], pathname, flags, 0, file_index);
+    hemlock_ioring_chain_rw_prep(sqes[1], user_datas[1],
+      hemlock_ioring_rw_opcode(IORING_OP_READ, buffer, n, ioring), buffer, n, file_index);
+    hemlock_ioring_chain_close_prep(sqes[2], user_datas[2], file_index);
+    hemlock_ioring_sqes_publish(ioring);
+
+LABEL_OUT:
+    return oe;
+}
+
+// Submit a linked open->write->fsync->close chain, writing `n` bytes from `buffer` to the beginning
+// of the file at `pathname`. See `hemlock_ioring_read_chain_submit` regarding the fixed file
+// table. On success, `user_datas` contains the open, write, fsync, and close user_data
+// in order.
+hemlock_opt_error_t
+hemlock_ioring_write_chain_submit(
+    hemlock_user_data_t *user_datas[4],
+    uint8_t *pathname,
+    int flags,
+    mode_t mode,
+    uint8_t *buffer,
+    uint64_t n,
+    hemlock_ioring_t *ioring
+) {
+    hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
+    struct io_uring_sqe *sqes[4];
+    uint16_t file_index;
+
+    HEMLOCK_OE(oe, hemlock_ioring_chain_reserve(4, ioring));
+    // Reaping CQEs while waiting for a slot does not consume the reserved SQEs. Failure is not
+    // reported, since callers fall back to unchained operations without a fixed file table.
+    oe = hemlock_ioring_file_acquire(&file_index, ioring);
+    if (oe != HEMLOCK_OE_NONE) {
+        goto LABEL_OUT;
+    }
+    for (size_t i = 0; i < 4; i++) {
+        HEMLOCK_OE(oe, hemlock_ioring_get_sqe(&sqes[i], ioring));
+        user_datas[i] = hemlock_user_data_create(ioring);
+    }
+
+    hemlock_ioring_chain_open_prep(sqes[0], user_datas[0], pathname, flags, mode, file_index);
+    hemlock_ioring_chain_rw_prep(sqes[1], user_datas[1],
+      hemlock_ioring_rw_opcode(IORING_OP_WRITE, buffer, n, ioring), buffer, n, file_index);
+    user_datas[2]->opcode = IORING_OP_FSYNC;
+    sqes[2]->user_data = (uint64_t)user_datas[2];
+    sqes[2]->opcode = IORING_OP_FSYNC;
+    sqes[2]->flags = IOSQE_FIXED_FILE | IOSQE_IO_HARDLINK;
+    sqes[2]->fd = file_index;
+    hemlock_ioring_chain_close_prep(sqes[3], user_datas[3], file_index);
+    hemlock_ioring_sqes_publish(ioring);
+
+LABEL_OUT:
+    return oe;
+}
+
+hemlock_opt_error_t
+hemlock_ioring_readv_submit(
+    hemlock_user_data_t **user_data,
+    int fd,
+    uint8_t *buffer,
+    struct iovec const *iovecs,
+    uint32_t n_iovecs,
+    uint64_t off,
+    int64_t timeout_ns,
+    hemlock_ioring_t *ioring
+) {
+    hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
+    struct io_uring_sqe *sqe;
+    HEMLOCK_OE(oe, hemlock_ioring_get_sqe_timeout(&sqe, timeout_ns, ioring));
+
+    *user_data = hemlock_user_data_create(ioring);
+    (*user_data)->opcode = IORING_OP_READV;
+    (*user_data)->buffer = buffer;
+
+    sqe->user_data = (uint64_t)(*user_data);
+    sqe->opcode = IORING_OP_READV;
+    sqe->off = off;
+    sqe->fd = fd;
+    sqe->addr = (uint64_t)iovecs;
+    sqe->len = n_iovecs;
+    hemlock_ioring_link_timeout(sqe, timeout_ns, ioring);
+    hemlock_ioring_sqes_publish(ioring);
+
+LABEL_OUT:
+    return oe;
+}
+
+hemlock_opt_error_t
+hemlock_ioring_writev_submit(
+    hemlock_user_data_t **user_data,
+    int fd,
+    uint8_t *buffer,
+    struct iovec const *iovecs,
+    uint32_t n_iovecs,
+    uint64_t off,
+    int64_t timeout_ns,
+    hemlock_ioring_t *ioring
+) {
+    hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
+    struct io_uring_sqe *sqe;
+    HEMLOCK_OE(oe, hemlock_ioring_get_sqe_timeout(&sqe, timeout_ns, ioring));
+
+    *user_data = hemlock_user_data_create(ioring);
+    (*user_data)->opcode = IORING_OP_WRITEV;
+    (*user_data)->buffer = buffer;
+
+    sqe->user_data = (uint64_t)(*user_data);
+    sqe->opcode = IORING_OP_WRITEV;
+    sqe->off = off;
+    sqe->fd = fd;
+    sqe->addr = (uint64_t)iovecs;
+    sqe->len = n_iovecs;
+    hemlock_ioring_link_timeout(sqe, timeout_ns, ioring);
+    hemlock_ioring_sqes_publish(ioring);
+
+LABEL_OUT:
+    return oe;
+}
+
+static void
+hemlock_ioring_splice_prep(
+    struct io_uring_sqe *sqe,
+    hemlock_user_data_t *user_data,
+    int fd_in,
+    int fd_out,
+    uint64_t n
+) {
+    user_data->opcode = IORING_OP_SPLICE;
+
+    sqe->user_data = (uint64_t)user_data;
+    sqe->opcode = IORING_OP_SPLICE;
+    // Offsets of -1 select the current file positions, as for `splice(2)` with NULL offsets.
+    sqe->splice_fd_in = fd_in;
+    sqe->splice_off_in = -1;
+    sqe->fd = fd_out;
+    sqe->off = -1;
+    sqe->len = n;
+}
+
+hemlock_opt_error_t
+hemlock_ioring_splice_submit(
+    hemlock_user_data_t **user_data,
+    int fd_in,
+    int fd_out,
+    uint64_t n,
+    hemlock_ioring_t *ioring
+) {
+    hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
+    struct io_uring_sqe *sqe;
+    HEMLOCK_OE(oe, hemlock_ioring_get_sqe(&sqe, ioring));
+
+    *user_data = hemlock_user_data_create(ioring);
+    hemlock_ioring_splice_prep(sqe, *user_data, fd_in, fd_out, n);
+    hemlock_ioring_sqes_publish(ioring);
+
+LABEL_OUT:
+    return oe;
+}
+
+hemlock_opt_error_t
+hemlock_ioring_splice_chain_submit(
+    hemlock_user_data_t *user_datas[2],
+    int fd_in,
+    int pipe_in,
+    int pipe_out,
+    int fd_out,
+    uint64_t n,
+    hemlock_ioring_t *ioring
+) {
+    hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
+    struct io_uring_sqe *sqes[2];
+
+    HEMLOCK_OE(oe, hemlock_ioring_chain_reserve(2, ioring));
+    for (size_t i = 0; i < 2; i++) {
+        HEMLOCK_OE(oe, hemlock_ioring_get_sqe(&sqes[i], ioring));
+        user_datas[i] = hemlock_user_data_create(ioring);
+    }
+
+    hemlock_ioring_splice_prep(sqes[0], user_datas[0], fd_in, pipe_out, n);
+    // Splices that transfer fewer than `len` bytes fail the link, so the second splice only runs if
+    // the pipe holds all `n` bytes.
+    sqes[0]->flags = IOSQE_IO_LINK;
+    hemlock_ioring_splice_prep(sqes[1], user_datas[1], pipe_in, fd_out, n);
+    hemlock_ioring_sqes_publish(ioring);
 
 LABEL_OUT:
     return oe;
@@ -1,10 +1,12 @@
 #pragma once
 #include <linux/io_uring.h>
+#include <stdint.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 
 // User_data structure to be used in the `user_data` field of a `struct io_uring_sqe` submission and
 // returned in the `user_data` field of the associated `struct io_uring_cqe`.
-typedef struct {
+typedef struct hemlock_user_data_s {
     // We aggressively copy CQEs from the kernel to here to avoid blocking completions.
     struct io_uring_cqe cqe;
     union {
@@ -13,17 +15,75 @@ typedef struct {
 
         // For `open` operation.
         uint8_t *pathname;
+
+        // For `async_cancel` operations. The operation to be cancelled, on which a ref is held
+        // until the cancellation completes, so that the record cannot be recycled for an unrelated
+        // operation while the kernel may still look it up.
+        struct hemlock_user_data_s *target;
+
+        // For `timeout` and `link_timeout` operations. The kernel reads the timeout when it
+        // consumes the SQE, which may be long after submission if `IORING_SETUP_SQPOLL` is in
+        // effect.
+        struct __kernel_timespec timeout;
     };
 
     // Keeping track of the associated opcode preserves enough information to safely free buffers
     // upon completion of some operations.
     uint8_t opcode;
 
-    // Maximum of two refs. One from OCaml and one from the kernel.
+    // Whether a `read` operation selects its buffer from the ioring's provided buffer ring. If the
+    // kernel consumed a buffer, `buffer` and `buf_index` are set once the CQE is reaped, and the
+    // buffer returns to the ring once the last ref is dropped.
+    bool buffer_select;
+
+    // Index of the provided buffer in use by `buffer_select` operations.
+    uint16_t buf_index;
+
+    // One ref from OCaml (if exposed), one from the kernel, and one from each in-flight
+    // `async_cancel` operation that targets this one.
     uint8_t refcount;
+
+    // Fixed file table slot plus one for chained operations on a direct descriptor, or 0. The slot
+    // is released when the chain's `close` operation completes.
+    uint16_t file_index;
+
+    // Opaque caller-owned reference (e.g. an OCaml value) that owns the operation's data buffer, or
+    // 0. The reference must be kept alive until the kernel completes the operation, at which point
+    // the ioring's `unpin` hook releases it.
+    uintptr_t pin;
+
+    // Opaque reference to whoever awaits completion (e.g. an actor), or NULL. Upon completion, the
+    // ioring's `complete` hook is called on records with a waiter.
+    void *waiter;
+
+    // Slab the record was allocated from, to which it is returned once the last ref is dropped,
+    // even if that happens after the ioring it was submitted to has been torn down.
+    struct hemlock_user_data_slab_s *slab;
 } hemlock_user_data_t;
 void hemlock_user_data_pp(int fd, int indent, hemlock_user_data_t *user_data);
-void hemlock_user_data_decref(hemlock_user_data_t *user_data);
+bool hemlock_user_data_is_complete(hemlock_user_data_t *user_data);
+
+// Free-list allocator for `hemlock_user_data_t` records, which are allocated and freed for every
+// I/O operation. Records are carved out of cache-line-aligned slabs such that no record straddles a
+// cache line. Freed records are recycled via an intrusive free list, and slabs are only returned to
+// the system at teardown.
+typedef struct hemlock_user_data_slab_s {
+    // Free record list, threaded through the free records themselves.
+    void *free;
+
+    // Slabs allocated thus far.
+    void **slabs;
+    size_t n_slabs;
+    size_t slabs_max;
+
+    // Statistics.
+    uint64_t n_allocs;
+    uint64_t n_live;
+    uint64_t n_live_max;
+} hemlock_user_data_slab_t;
+void hemlock_user_data_slab_pp(int fd, int indent, hemlock_user_data_slab_t *slab);
+void hemlock_user_data_slab_setup(hemlock_user_data_slab_t *slab);
+void hemlock_user_data_slab_teardown(hemlock_user_data_slab_t *slab);
 
 // Utility type for tracking submission queue mmapped data structure fields.
 typedef struct {
@@ -47,8 +107,97 @@ typedef struct {
 } hemlock_cqring_t;
 void hemlock_cqring_pp(int fd, int indent, hemlock_cqring_t *cqring);
 
+// Ring of buffers provided to the kernel via `IORING_REGISTER_PBUF_RING`. A `read` with
+// `IOSQE_BUFFER_SELECT` takes a buffer from the ring only once data are available, so that idle
+// reads (e.g. of pipes or sockets) tie up no buffer memory at all. Provided buffers are not pinned,
+// so they do not count against `RLIMIT_MEMLOCK`. The ring is empty (`n` is 0) if registration
+// failed, e.g. prior to Linux 5.19, in which case buffer-selecting reads are unsupported.
+typedef struct {
+    // mmapped memory comprising the shared ring of buffer descriptors, followed by all buffers.
+    uint8_t *vm;
+    struct io_uring_buf_ring *br;
+    uint8_t *bufs;
+
+    // Size of each buffer.
+    size_t buf_size;
+
+    // Total number of buffers in the ring, a power of two, and number of buffers consumed by the
+    // kernel but not yet returned.
+    uint16_t n;
+    uint16_t n_out;
+
+    // Tail of buffer descriptors made available to the kernel.
+    uint16_t tail;
+} hemlock_bufring_t;
+void hemlock_bufring_pp(int fd, int indent, hemlock_bufring_t *bufring);
+
+// Offset for `read`/`write` operations that selects the current file position rather than a
+// positional (`pread(2)`/`pwrite(2)`-like) operation.
+#define HEMLOCK_IORING_OFF_CUR UINT64_MAX
+
+// Sparse fixed file table registered via `IORING_REGISTER_FILES2`. Chained operations open files
+// directly into table slots, so that subsequent operations in the chain can refer to the file
+// before the open has completed, and the fd is never installed in the process fd table. The table
+// is empty (`n` is 0) if registration failed, in which case chained operations are unsupported.
+typedef struct {
+    // Total number of slots in the table.
+    uint16_t n;
+
+    // Stack of indices of slots that are not in use.
+    uint16_t n_free;
+    uint16_t *free;
+} hemlock_filetab_t;
+void hemlock_filetab_pp(int fd, int indent, hemlock_filetab_t *filetab);
+
+// Caller-owned memory registered via `IORING_REGISTER_BUFFERS` as fixed buffer 0. Reads and writes
+// that lie entirely within it are submitted as `IORING_OP_{READ,WRITE}_FIXED`, which use the pages
+// pinned at registration rather than pinning them anew for each operation. Empty (`size` is 0)
+// unless registration succeeded.
+typedef struct {
+    uint8_t *base;
+    size_t size;
+} hemlock_regbuf_t;
+void hemlock_regbuf_pp(int fd, int indent, hemlock_regbuf_t *regbuf);
+
+// io_uring instance configuration.
+typedef struct {
+    // Submission queue size. The kernel rounds up to a power of two.
+    uint32_t sq_entries;
+
+    // Completion queue size, or 0 for the kernel default (twice `sq_entries`). Non-zero values
+    // imply `IORING_SETUP_CQSIZE`.
+    uint32_t cq_entries;
+
+    // Subset of `IORING_SETUP_{SQPOLL,COOP_TASKRUN,SINGLE_ISSUER,DEFER_TASKRUN,ATTACH_WQ}`. Flags
+    // that the kernel does not support are dropped during setup, and the ioring's copy of the
+    // configuration reflects only the flags actually in effect.
+    uint32_t flags;
+
+    // Milliseconds of submission queue inactivity before the `IORING_SETUP_SQPOLL` thread sleeps.
+    uint32_t sq_thread_idle;
+
+    // io_uring fd whose async worker pool is shared via `IORING_SETUP_ATTACH_WQ`.
+    int wq_fd;
+
+    // Maximum numbers of bounded (e.g. regular file I/O) and unbounded (e.g. socket I/O) async
+    // workers, per `IORING_REGISTER_IOWQ_MAX_WORKERS`, or 0 for the kernel's limit. Both are 0 if
+    // the kernel does not support limits.
+    uint32_t iowq_max_workers[2];
+} hemlock_ioring_conf_t;
+extern hemlock_ioring_conf_t const hemlock_ioring_conf_default;
+void hemlock_ioring_conf_pp(int fd, int indent, hemlock_ioring_conf_t const *conf);
+
+// Reserved CQE `user_data` values, which are never valid `hemlock_user_data_t` pointers. Internal
+// operations (e.g. the sender side of a doorbell) complete with `HEMLOCK_IORING_USER_DATA_NONE`,
+// and doorbells complete with `HEMLOCK_IORING_USER_DATA_DOORBELL`. Neither counts as in flight.
+#define HEMLOCK_IORING_USER_DATA_NONE 0
+#define HEMLOCK_IORING_USER_DATA_DOORBELL 1
+
 // Utility type for tracking io_uring fd and mmapped data structure fields.
 typedef struct {
+    // Configuration in effect.
+    hemlock_ioring_conf_t conf;
+
     // Parameters for constructing io_uring instance.
     struct io_uring_params params;
 
@@ -60,15 +209,94 @@ typedef struct {
 
     hemlock_sqring_t sqring;
     hemlock_cqring_t cqring;
+    hemlock_bufring_t bufring;
+    hemlock_filetab_t filetab;
+    hemlock_regbuf_t regbuf;
+
+    // Tail of SQEs that have been acquired and possibly filled in, but not yet published to the
+    // kernel via `sqring.tail`. SQEs must be fully initialized before they are published, lest an
+    // `IORING_SETUP_SQPOLL` thread consume them prematurely.
+    unsigned sqe_tail;
+
+    // Number of operations submitted for which CQEs have not yet been reaped, and number of CQEs
+    // reaped for submitted operations.
+    uint64_t n_inflight;
+    uint64_t n_reaped;
+
+    // Doorbell via which other threads wake this ioring's thread while it waits for completions,
+    // such that a single `io_uring_enter(2)` waits for both I/O and wakeups. If the kernel supports
+    // `IORING_OP_MSG_RING`, ringing posts a CQE directly into this ioring's completion queue.
+    // Otherwise ringing writes to the eventfd `doorbell_fd`, which this ioring keeps a `read`
+    // outstanding on, and re-arms upon each completion.
+    bool msg_ring;
+    int doorbell_fd;
+    bool doorbell_armed;
+    uint64_t doorbell_buf;
+    uint64_t n_doorbells;
+
+    // Allocator for user_data of operations submitted via this ioring. Owned by the executor.
+    hemlock_user_data_slab_t *slab;
+
+    // Hook that releases the `pin` of each completed operation. Set by the executor.
+    void (*unpin)(hemlock_user_data_t *user_data);
+
+    // Hook that notifies the `waiter` of each completed operation that has one. Set by the
+    // executor.
+    void (*complete)(hemlock_user_data_t *user_data);
+
+    // Optional hooks called immediately before and after each system call that waits for
+    // completions, e.g. to let other threads run while this one waits. Nothing else in the ioring
+    // is accessed in between.
+    void (*block)(void);
+    void (*unblock)(void);
 } hemlock_ioring_t;
 void hemlock_ioring_pp(int fd, int indent, hemlock_ioring_t *ioring);
-hemlock_opt_error_t hemlock_ioring_setup(hemlock_ioring_t *ioring);
+void hemlock_user_data_decref(hemlock_user_data_t *user_data, hemlock_ioring_t *ioring);
+void hemlock_user_data_buffer_release(hemlock_user_data_t *user_data, hemlock_ioring_t *ioring);
+// Transfer ownership of the data buffer of a just-submitted operation to `pin`. Vectored operations
+// retain ownership of their iovecs. Must be called before CQEs are next reaped.
+void hemlock_user_data_pin(hemlock_user_data_t *user_data, uintptr_t pin);
+hemlock_opt_error_t hemlock_ioring_setup(
+    hemlock_ioring_t *ioring,
+    hemlock_ioring_conf_t const *conf,
+    hemlock_user_data_slab_t *slab
+);
+bool hemlock_ioring_is_quiescent(hemlock_ioring_t *ioring);
+// Register the `size` bytes at `base` as the fixed buffer of `ioring`. The memory must remain mapped
+// for as long as `ioring` is set up. Registration counts against `RLIMIT_MEMLOCK`, and reads and
+// writes remain unfixed if it fails.
+void hemlock_ioring_regbuf_register(uint8_t *base, size_t size, hemlock_ioring_t *ioring);
 void hemlock_ioring_teardown(hemlock_ioring_t *ioring);
+// Limit the numbers of bounded and unbounded async workers that serve `ioring`, as for
+// `hemlock_ioring_conf_t.iowq_max_workers`, except that 0 leaves a limit unchanged, and record the
+// limits in `ioring->conf`. Must be called by the thread that submits to `ioring`. Returns `EINVAL`
+// if the kernel does not support limits.
+hemlock_opt_error_t hemlock_ioring_iowq_max_workers(
+    hemlock_ioring_t *ioring,
+    uint32_t const max_workers[2]
+);
 hemlock_opt_error_t hemlock_ioring_enter(
     uint32_t *n_complete,
     uint32_t min_complete,
     hemlock_ioring_t *ioring
 );
+hemlock_opt_error_t hemlock_ioring_poll(hemlock_ioring_t *ioring);
+// Like `hemlock_ioring_poll`, but only makes a system call if there are SQEs to submit, or kernel
+// completion work that is deferred until the next call. Cheap enough to call between actor time
+// slices.
+hemlock_opt_error_t hemlock_ioring_poll_lazy(hemlock_ioring_t *ioring);
+// Ring `target`'s doorbell from the thread that owns `ioring`, waking `target`'s thread if it is
+// waiting for completions. No CQEs are reaped from `ioring`, so this is safe to call from contexts
+// that must not run the `unpin` hook.
+hemlock_opt_error_t hemlock_ioring_doorbell_ring(
+    hemlock_ioring_t *target,
+    hemlock_ioring_t *ioring
+);
+hemlock_opt_error_t hemlock_ioring_reap(
+    uint32_t min_complete,
+    int64_t timeout_ns,
+    hemlock_ioring_t *ioring
+);
 int hemlock_ioring_user_data_complete(hemlock_user_data_t *user_data, hemlock_ioring_t *ioring);
 hemlock_opt_error_t hemlock_ioring_nop_submit(
     hemlock_user_data_t **user_data,
@@ -86,11 +314,93 @@ hemlock_opt_error_t hemlock_ioring_close_submit(
     int fd,
     hemlock_ioring_t *ioring
 );
+// Filesystem operations. Pathnames are malloc()ed, nul-terminated, and owned by the operation once
+// submitted. `mkdirat`, `unlinkat`, and `renameat` free them upon completion.
+hemlock_opt_error_t hemlock_ioring_mkdirat_submit(
+    hemlock_user_data_t **user_data,
+    int dirfd,
+    uint8_t *pathname,
+    mode_t mode,
+    hemlock_ioring_t *ioring
+);
+hemlock_opt_error_t hemlock_ioring_unlinkat_submit(
+    hemlock_user_data_t **user_data,
+    int dirfd,
+    uint8_t *pathname,
+    int flags,
+    hemlock_ioring_t *ioring
+);
+// `pathnames` comprises the old pathname followed by the new pathname, each nul-terminated.
+hemlock_opt_error_t hemlock_ioring_renameat_submit(
+    hemlock_user_data_t **user_data,
+    int olddirfd,
+    int newdirfd,
+    uint8_t *pathnames,
+    hemlock_ioring_t *ioring
+);
+// `statxbuf` is a `struct statx` followed by the nul-terminated pathname, all of which is freed
+// once the last ref is dropped, so that the result can be read after completion.
+hemlock_opt_error_t hemlock_ioring_statx_submit(
+    hemlock_user_data_t **user_data,
+    int dirfd,
+    uint8_t *statxbuf,
+    int flags,
+    unsigned mask,
+    hemlock_ioring_t *ioring
+);
+hemlock_opt_error_t hemlock_ioring_fsync_submit(
+    hemlock_user_data_t **user_data,
+    int fd,
+    unsigned flags,
+    hemlock_ioring_t *ioring
+);
+hemlock_opt_error_t hemlock_ioring_fallocate_submit(
+    hemlock_user_data_t **user_data,
+    int fd,
+    int mode,
+    uint64_t off,
+    uint64_t n,
+    hemlock_ioring_t *ioring
+);
+// Cancel the in-flight operation `target`, which must have been submitted via `ioring`. A no-op if
+// `target` is already complete. The cancellation is itself an operation, whose completion is reaped
+// like any other, but which is not exposed. If cancellation succeeds, `target` completes with
+// `ECANCELED`; otherwise, e.g. if the kernel is already midway through it, `target` completes as
+// usual. Either way `target` still completes, and its kernel ref is dropped only then.
+hemlock_opt_error_t hemlock_ioring_cancel_submit(
+    hemlock_user_data_t *target,
+    hemlock_ioring_t *ioring
+);
+// Submit a timer that completes with `ETIME` once `timeout_ns` nanoseconds elapse, or with
+// `ECANCELED` if cancelled beforehand.
+hemlock_opt_error_t hemlock_ioring_timeout_submit(
+    hemlock_user_data_t **user_data,
+    int64_t timeout_ns,
+    hemlock_ioring_t *ioring
+);
+// `read`/`write` operations, and their vectored variants below, take an optional `timeout_ns`. If
+// non-negative, a linked timeout cancels the operation unless it completes within `timeout_ns`
+// nanoseconds of being started, in which case the operation completes with `ECANCELED`. The linked
+// timeout is an unexposed operation, like those of `hemlock_ioring_cancel_submit`. Non-vectored
+// reads and writes of buffers within the ioring's `regbuf` are submitted as their fixed variants.
 hemlock_opt_error_t hemlock_ioring_read_submit(
     hemlock_user_data_t **user_data,
     int fd,
     uint8_t *buffer,
     uint64_t n,
+    uint64_t off,
+    int64_t timeout_ns,
+    hemlock_ioring_t *ioring
+);
+// Like `hemlock_ioring_read_submit`, but the kernel selects a buffer from the provided buffer ring
+// once data are available, and reads at most the ring's buffer size. Completes with `ENOBUFS` if
+// the ring is empty. Returns `EOPNOTSUPP` if the ioring has no provided buffer ring.
+hemlock_opt_error_t hemlock_ioring_read_select_submit(
+    hemlock_user_data_t **user_data,
+    int fd,
+    uint64_t n,
+    uint64_t off,
+    int64_t timeout_ns,
     hemlock_ioring_t *ioring
 );
 hemlock_opt_error_t hemlock_ioring_write_submit(
@@ -98,5 +408,69 @@ hemlock_opt_error_t hemlock_ioring_write_submit(
     int fd,
     uint8_t *buffer,
     uint64_t n,
+    uint64_t off,
+    int64_t timeout_ns,
+    hemlock_ioring_t *ioring
+);
+hemlock_opt_error_t hemlock_ioring_read_chain_submit(
+    hemlock_user_data_t *user_datas[3],
+    uint8_t *pathname,
+    int flags,
+    uint8_t *buffer,
+    uint64_t n,
+    hemlock_ioring_t *ioring
+);
+hemlock_opt_error_t hemlock_ioring_write_chain_submit(
+    hemlock_user_data_t *user_datas[4],
+    uint8_t *pathname,
+    int flags,
+    mode_t mode,
+    uint8_t *buffer,
+    uint64_t n,
+    hemlock_ioring_t *ioring
+);
+// Submit a splice of up to `n` bytes from `fd_in` to `fd_out`, at least one of which must be a
+// pipe. Files other than pipes are read/written at their current file positions.
+hemlock_opt_error_t hemlock_ioring_splice_submit(
+    hemlock_user_data_t **user_data,
+    int fd_in,
+    int fd_out,
+    uint64_t n,
+    hemlock_ioring_t *ioring
+);
+// Submit a linked pair of splices that moves up to `n` bytes from `fd_in` to `fd_out` by way of
+// the pipe with read end `pipe_in` and write end `pipe_out`. A short first splice cancels the
+// second, in which case the pipe retains the bytes spliced into it. On success, `user_datas`
+// contains the two splices' user_data in order.
+hemlock_opt_error_t hemlock_ioring_splice_chain_submit(
+    hemlock_user_data_t *user_datas[2],
+    int fd_in,
+    int pipe_in,
+    int pipe_out,
+    int fd_out,
+    uint64_t n,
+    hemlock_ioring_t *ioring
+);
+// Vectored variants of `read` and `write`. `buffer` is owned by the operation and freed upon
+// release; `iovecs` must remain valid until the operation completes, and typically reside in
+// `buffer`.
+hemlock_opt_error_t hemlock_ioring_readv_submit(
+    hemlock_user_data_t **user_data,
+    int fd,
+    uint8_t *buffer,
+    struct iovec const *iovecs,
+    uint32_t n_iovecs,
+    uint64_t off,
+    int64_t timeout_ns,
+    hemlock_ioring_t *ioring
+);
+hemlock_opt_error_t hemlock_ioring_writev_submit(
+    hemlock_user_data_t **user_data,
+    int fd,
+    uint8_t *buffer,
+    struct iovec const *iovecs,
+    uint32_t n_iovecs,
+    uint64_t off,
+    int64_t timeout_ns,
     hemlock_ioring_t *ioring
 );
@@ -0,0 +1,147 @@
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+#include "mailbox.h"
+
+/*
+ * The ring follows the bounded MPMC queue design by Dmitry Vyukov, specialized for a single
+ * consumer. Each slot carries a sequence number that encodes which lap of the ring it is ready
+ * for:
+ *   - `seq == pos`: empty, and may be claimed by the producer that claims ring position `pos`.
+ *   - `seq == pos + 1`: full, and may be received by the consumer at ring position `pos`.
+ * Producers claim positions by CAS on `tail`, fill the slot, and then publish it by advancing its
+ * sequence number. The consumer alone advances `head`, so it needs no atomic read-modify-write
+ * operations. A producer that finds its slot still occupied from the previous lap (the ring is
+ * full) pushes onto the overflow stack instead, which the consumer takes in its entirety once the
+ * ring is empty.
+ */
+
+#define HEMLOCK_INDENT_SIZE 4
+
+void
+hemlock_mailbox_pp(int fd, int indent, hemlock_mailbox_t *mailbox) {
+    dprintf(fd, "%*smailbox:\n", indent, "");
+    indent += HEMLOCK_INDENT_SIZE;
+    dprintf(fd,
+        "%*stail: %lu\n"
+        "%*shead: %lu\n"
+        "%*sn_received: %lu\n"
+        "%*sn_overflowed: %lu\n"
+        ,
+        indent, "", atomic_load_explicit(&mailbox->tail, memory_order_relaxed),
+        indent, "", mailbox->head,
+        indent, "", mailbox->n_received,
+        indent, "", mailbox->n_overflowed
+    );
+}
+
+void
+hemlock_mailbox_setup(hemlock_mailbox_t *mailbox) {
+    atomic_init(&mailbox->tail, 0);
+    atomic_init(&mailbox->overflow, NULL);
+    mailbox->head = 0;
+    mailbox->overflow_fifo = NULL;
+    mailbox->slots = (hemlock_mailbox_slot_t *)aligned_alloc(
+        HEMLOCK_CACHE_LINE_SIZE, sizeof(hemlock_mailbox_slot_t) * HEMLOCK_MAILBOX_RING_SIZE
+    );
+    assert(mailbox->slots != NULL);
+    for (uint64_t i = 0; i < HEMLOCK_MAILBOX_RING_SIZE; i++) {
+        atomic_init(&mailbox->slots[i].seq, i);
+        mailbox->slots[i].message = NULL;
+    }
+    mailbox->n_received = 0;
+    mailbox->n_overflowed = 0;
+}
+
+void
+hemlock_mailbox_teardown(hemlock_mailbox_t *mailbox) {
+    free(mailbox->slots);
+    memset(mailbox, 0, sizeof(hemlock_mailbox_t));
+}
+
+static void
+hemlock_mailbox_overflow_push(hemlock_mailbox_t *mailbox, hemlock_message_t *message) {
+    hemlock_message_t *next = atomic_load_explicit(&mailbox->overflow, memory_order_relaxed);
+    do {
+        message->next = next;
+    } while (!atomic_compare_exchange_weak_explicit(&mailbox->overflow, &next, message,
+      memory_order_release, memory_order_relaxed));
+}
+
+void
+hemlock_mailbox_send(hemlock_mailbox_t *mailbox, hemlock_message_t *message) {
+    uint64_t pos = atomic_load_explicit(&mailbox->tail, memory_order_relaxed);
+    while (true) {
+        hemlock_mailbox_slot_t *slot = &mailbox->slots[pos & (HEMLOCK_MAILBOX_RING_SIZE - 1)];
+        uint64_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        int64_t diff = (int64_t)(seq - pos);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&mailbox->tail, &pos, pos + 1,
+              memory_order_relaxed, memory_order_relaxed)) {
+                slot->message = message;
+                atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+                return;
+            }
+            // `pos` was reloaded by the failed CAS.
+        } else if (diff < 0) {
+            // The slot has not been received since the previous lap, i.e. the ring is full.
+            hemlock_mailbox_overflow_push(mailbox, message);
+            return;
+        } else {
+            // Another producer claimed `pos`.
+            pos = atomic_load_explicit(&mailbox->tail, memory_order_relaxed);
+        }
+    }
+}
+
+hemlock_message_t *
+hemlock_mailbox_receive(hemlock_mailbox_t *mailbox) {
+    hemlock_mailbox_slot_t *slot = &mailbox->slots[mailbox->head & (HEMLOCK_MAILBOX_RING_SIZE - 1)];
+    uint64_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+    if (seq == mailbox->head + 1) {
+        hemlock_message_t *message = slot->message;
+        // Make the slot available to producers on the next lap.
+        atomic_store_explicit(&slot->seq, mailbox->head + HEMLOCK_MAILBOX_RING_SIZE,
+          memory_order_release);
+        mailbox->head++;
+        mailbox->n_received++;
+        return message;
+    }
+
+    // The ring is empty, or the producer that claimed the head slot has yet to fill it. Either way,
+    // fall back to overflowed messages.
+    if (mailbox->overflow_fifo == NULL &&
+      atomic_load_explicit(&mailbox->overflow, memory_order_relaxed) != NULL) {
+        // Take the whole stack and reverse it into send order.
+        hemlock_message_t *message = atomic_exchange_explicit(&mailbox->overflow, NULL,
+          memory_order_acquire);
+        while (message != NULL) {
+            hemlock_message_t *next = message->next;
+            message->next = mailbox->overflow_fifo;
+            mailbox->overflow_fifo = message;
+            message = next;
+        }
+    }
+    hemlock_message_t *message = mailbox->overflow_fifo;
+    if (message != NULL) {
+        mailbox->overflow_fifo = message->next;
+        message->next = NULL;
+        mailbox->n_received++;
+        mailbox->n_overflowed++;
+    }
+    return message;
+}
+
+bool
+hemlock_mailbox_is_empty(hemlock_mailbox_t *mailbox) {
+    hemlock_mailbox_slot_t *slot = &mailbox->slots[mailbox->head & (HEMLOCK_MAILBOX_RING_SIZE - 1)];
+    return atomic_load_explicit(&slot->seq, memory_order_acquire) != mailbox->head + 1 &&
+      mailbox->overflow_fifo == NULL &&
+      atomic_load_explicit(&mailbox->overflow, memory_order_relaxed) == NULL;
+}
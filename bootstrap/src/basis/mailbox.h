@@ -0,0 +1,73 @@
+#pragma once
+#include <stdatomic.h>
+#include <stddef.h>
+
+#include "common.h"
+
+// Inter-executor message header. Messages are allocated by their sender and passed by pointer: the
+// receiver copies out the contents it needs and then returns the message to the sender's mailbox,
+// upon which the sender reclaims the message's memory.
+typedef struct hemlock_message_s {
+    // Overflow list link.
+    struct hemlock_message_s *next;
+
+    // Index of the sending executor.
+    uint32_t sender;
+
+    // `HEMLOCK_MESSAGE_SENT` while in transit to the receiver, `HEMLOCK_MESSAGE_ACKED` while in
+    // transit back to the sender.
+    uint8_t state;
+
+    // Monotonic send time, for latency measurement.
+    uint64_t sent_ns;
+
+    uint64_t payload;
+} hemlock_message_t;
+#define HEMLOCK_MESSAGE_SENT 0
+#define HEMLOCK_MESSAGE_ACKED 1
+
+// Number of ring slots in each mailbox. Must be a power of two.
+#define HEMLOCK_MAILBOX_RING_SIZE 1024
+
+typedef struct {
+    _Atomic uint64_t seq;
+    hemlock_message_t *message;
+} hemlock_mailbox_slot_t;
+
+// Lock-free multi-producer, single-consumer mailbox: a bounded ring with per-slot sequence numbers,
+// backed by an unbounded overflow list for messages sent while the ring is full. Sending never
+// blocks or fails. Messages are received in the order they were sent, except that messages which
+// overflowed are received after the ring is emptied. The producer and consumer ends are on separate
+// cache lines so that senders do not contend with the receiver.
+typedef struct {
+    // Producer end. Next ring position to claim.
+    _Alignas(HEMLOCK_CACHE_LINE_SIZE) _Atomic uint64_t tail;
+
+    // Producer end. Stack of overflowed messages, most recent first.
+    _Alignas(HEMLOCK_CACHE_LINE_SIZE) hemlock_message_t *_Atomic overflow;
+
+    // Consumer end. Next ring position to receive, and overflowed messages taken from `overflow`,
+    // in send order.
+    _Alignas(HEMLOCK_CACHE_LINE_SIZE) uint64_t head;
+    hemlock_message_t *overflow_fifo;
+
+    hemlock_mailbox_slot_t *slots;
+
+    // Statistics, maintained by the consumer.
+    uint64_t n_received;
+    uint64_t n_overflowed;
+} hemlock_mailbox_t;
+void hemlock_mailbox_pp(int fd, int indent, hemlock_mailbox_t *mailbox);
+void hemlock_mailbox_setup(hemlock_mailbox_t *mailbox);
+void hemlock_mailbox_teardown(hemlock_mailbox_t *mailbox);
+
+// Send `message` to `mailbox`. Safe to call concurrently from any number of threads.
+void hemlock_mailbox_send(hemlock_mailbox_t *mailbox, hemlock_message_t *message);
+
+// Receive the next message from `mailbox`, or return NULL if there is none. Only the mailbox's
+// owner may call this.
+hemlock_message_t *hemlock_mailbox_receive(hemlock_mailbox_t *mailbox);
+
+// Whether `mailbox` has no messages to receive. Messages that are being sent concurrently may or
+// may not be observed. Only the mailbox's owner may call this.
+bool hemlock_mailbox_is_empty(hemlock_mailbox_t *mailbox);
@@ -1,30 +1,179 @@
+#include <assert.h>
 #include <errno.h>
 #include <fcntl.h>
-#include <sys/stat.h>
+#include <linux/stat.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
 
 #define CAML_NAME_SPACE
 #include <caml/memory.h>
 #include <caml/mlvalues.h>
 #include <caml/alloc.h>
 
+#include "common.h"
+#include "executor.h"
+#include "ioring.h"
+
 CAMLprim value
 hm_basis_os_at_fdcwd_inner(value a_unit) {
     return caml_copy_int64(AT_FDCWD);
 }
 
+// Copy OCaml paths into a malloc()ed buffer comprising `prefix` uninitialized bytes followed by
+// each path, nul-terminated. The buffer must outlive the operation, since the OCaml paths may move
+// during GCs while the operation is in flight.
+static uint8_t *
+hm_basis_os_pathnames_of_bytes(size_t prefix, size_t n_paths, value *a_paths) {
+    size_t size = prefix;
+    for (size_t i = 0; i < n_paths; i++) {
+        size += caml_string_length(a_paths[i]) + 1;
+    }
+
+    uint8_t *buffer = (uint8_t *)malloc(sizeof(uint8_t) * size);
+    assert(buffer != NULL);
+    uint8_t *p = buffer + prefix;
+    for (size_t i = 0; i < n_paths; i++) {
+        size_t n = caml_string_length(a_paths[i]);
+        memcpy(p, Bytes_val(a_paths[i]), sizeof(uint8_t) * n);
+        p[n] = '\0';
+        p += n + 1;
+    }
+
+    return buffer;
+}
+
+// hm_basis_os_mkdirat_submit_inner: uns -> uns -> Stdlib.Bytes.t >{os}->
+//   (int * &Basis.Os.Mkdirat.t)
+CAMLprim value
+hm_basis_os_mkdirat_submit_inner(value a_dirfd, value a_mode, value a_path) {
+    int dirfd = Int64_val(a_dirfd);
+    mode_t mode = Int64_val(a_mode);
+    uint8_t *pathname = hm_basis_os_pathnames_of_bytes(0, 1, &a_path);
+
+    hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
+
+    hemlock_user_data_t *user_data = NULL;
+    HEMLOCK_OE(
+        oe,
+        hemlock_ioring_mkdirat_submit(&user_data, dirfd, pathname, mode,
+          &hemlock_executor_get()->ioring)
+    );
+
+LABEL_OUT:
+    if (user_data == NULL) {
+        free(pathname);
+    }
+    return hemlock_basis_executor_submit_out(oe, user_data);
+}
+
+// hm_basis_os_unlinkat_submit_inner: uns -> bool -> Stdlib.Bytes.t >{os}->
+//   (int * &Basis.Os.Unlinkat.t)
+CAMLprim value
+hm_basis_os_unlinkat_submit_inner(value a_dirfd, value a_is_dir, value a_path) {
+    int dirfd = Int64_val(a_dirfd);
+    int flags = Bool_val(a_is_dir) ? AT_REMOVEDIR : 0;
+    uint8_t *pathname = hm_basis_os_pathnames_of_bytes(0, 1, &a_path);
+
+    hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
+
+    hemlock_user_data_t *user_data = NULL;
+    HEMLOCK_OE(
+        oe,
+        hemlock_ioring_unlinkat_submit(&user_data, dirfd, pathname, flags,
+          &hemlock_executor_get()->ioring)
+    );
+
+LABEL_OUT:
+    if (user_data == NULL) {
+        free(pathname);
+    }
+    return hemlock_basis_executor_submit_out(oe, user_data);
+}
+
+// hm_basis_os_renameat_submit_inner: uns -> Stdlib.Bytes.t -> uns -> Stdlib.Bytes.t >{os}->
+//   (int * &Basis.Os.Renameat.t)
+CAMLprim value
+hm_basis_os_renameat_submit_inner(value a_dirfd, value a_path, value a_new_dirfd,
+  value a_new_path) {
+    int olddirfd = Int64_val(a_dirfd);
+    int newdirfd = Int64_val(a_new_dirfd);
+    value a_paths[] = {a_path, a_new_path};
+    uint8_t *pathnames = hm_basis_os_pathnames_of_bytes(0, 2, a_paths);
+
+    hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
+
+    hemlock_user_data_t *user_data = NULL;
+    HEMLOCK_OE(
+        oe,
+        hemlock_ioring_renameat_submit(&user_data, olddirfd, newdirfd, pathnames,
+          &hemlock_executor_get()->ioring)
+    );
+
+LABEL_OUT:
+    if (user_data == NULL) {
+        free(pathnames);
+    }
+    return hemlock_basis_executor_submit_out(oe, user_data);
+}
+
+// hm_basis_os_statx_submit_inner: uns -> bool -> Stdlib.Bytes.t >{os}->
+//   (int * &Basis.Os.Statx.t)
 CAMLprim value
-hm_basis_os_mkdirat_inner(value a_dirfd, value a_pathname, value a_mode) {
+hm_basis_os_statx_submit_inner(value a_dirfd, value a_follow, value a_path) {
     int dirfd = Int64_val(a_dirfd);
-    // XXX Allocate a copy when transitioning to io_uring, since the I/O may be in flight during
-    // subsequent GCs.
-    const char *pathname = String_val(a_pathname);
-    size_t mode = Int64_val(a_mode);
-
-    // XXX Use io_uring once Linux 5.15 is in use.
-    int result = 0;
-    if (mkdirat(dirfd, pathname, mode) != 0) {
-        result = errno;
+    int flags = Bool_val(a_follow) ? 0 : AT_SYMLINK_NOFOLLOW;
+    uint8_t *statxbuf = hm_basis_os_pathnames_of_bytes(sizeof(struct statx), 1, &a_path);
+
+    hemlock_opt_error_t oe = HEMLOCK_OE_NONE;
+
+    hemlock_user_data_t *user_data = NULL;
+    HEMLOCK_OE(
+        oe,
+        hemlock_ioring_statx_submit(&user_data, dirfd, statxbuf, flags, STATX_BASIC_STATS,
+          &hemlock_executor_get()->ioring)
+    );
+
+LABEL_OUT:
+    if (user_data == NULL) {
+        free(statxbuf);
+    }
+    return hemlock_basis_executor_submit_out(oe, user_data);
+}
+
+static int64_t
+hm_basis_os_ns_of_timestamp(struct statx_timestamp const *timestamp) {
+    return timestamp->tv_sec * 1000000000L + timestamp->tv_nsec;
+}
+
+// hm_basis_os_statx_fields_inner: &Basis.Os.Statx.t -> uns array
+//
+// Fields of a successfully completed statx, in the order of `Basis.Os.Stat.t`'s fields.
+CAMLprim value
+hm_basis_os_statx_fields_inner(value a_user_data) {
+    CAMLparam1(a_user_data);
+    CAMLlocal1(a_fields);
+    hemlock_user_data_t *user_data = (hemlock_user_data_t *)Int64_val(a_user_data);
+    struct statx const *statx = (struct statx const *)user_data->buffer;
+
+    int64_t fields[] = {
+        statx->stx_mode,
+        statx->stx_nlink,
+        statx->stx_uid,
+        statx->stx_gid,
+        statx->stx_ino,
+        statx->stx_size,
+        statx->stx_blocks,
+        statx->stx_blksize,
+        hm_basis_os_ns_of_timestamp(&statx->stx_atime),
+        hm_basis_os_ns_of_timestamp(&statx->stx_mtime),
+        hm_basis_os_ns_of_timestamp(&statx->stx_ctime),
+    };
+    size_t n_fields = sizeof(fields) / sizeof(fields[0]);
+    a_fields = caml_alloc(n_fields, 0);
+    for (size_t i = 0; i < n_fields; i++) {
+        Store_field(a_fields, i, caml_copy_int64(fields[i]));
     }
 
-    return caml_copy_int64(result);
+    CAMLreturn(a_fields);
 }
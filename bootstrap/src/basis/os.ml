@@ -1,4 +1,5 @@
 open Rudiments
+open IoOp
 
 let argv = Array.map Stdlib.Sys.argv ~f:(fun arg ->
   Bytes.of_string_slice (String.C.Slice.of_string arg))
@@ -8,13 +9,232 @@ external at_fdcwd_inner: unit -> uns = "hm_basis_os_at_fdcwd_inner"
 let at_fdcwd =
   at_fdcwd_inner ()
 
-external mkdirat_inner: uns -> string -> uns -> sint = "hm_basis_os_mkdirat_inner"
+let dirfd_of_dir = function
+  | None -> at_fdcwd
+  | Some dir -> File.fd dir
 
-let mkdirat ?dir ?(mode=0o755L) path =
-  let dirfd = match dir with
-    | None -> at_fdcwd
-    | Some dir -> File.fd dir
-  in
-  match mkdirat_inner dirfd (Path.to_string_replace path) mode with
-  | 0L -> None
-  | errno -> Some (Errno.of_uns_hlt (Uns.bits_of_sint errno))
+let submit_out (value, t) =
+  let t = register_user_data_finalizer t in
+  match Sint.(value < kv 0L) with
+  | true -> Error (error_of_neg_errno value)
+  | false -> Ok t
+
+let complete_base t =
+  let value = complete_inner t in
+  match Sint.(value < kv 0L) with
+  | true -> Some (error_of_neg_errno value)
+  | false -> None
+
+let hlt = function
+  | Ok t -> t
+  | Error error -> halt (Errno.to_string error)
+
+let complete_hlt = function
+  | None -> ()
+  | Some error -> halt (Errno.to_string error)
+
+module Mkdirat = struct
+  type t = uns
+
+  external submit_inner: uns -> uns -> Stdlib.Bytes.t -> (sint * t) =
+    "hm_basis_os_mkdirat_submit_inner"
+
+  let submit ?dir ?(mode=0o755L) path =
+    submit_out (submit_inner (dirfd_of_dir dir) mode (bytes_of_path path))
+
+  let submit_hlt ?dir ?mode path =
+    hlt (submit ?dir ?mode path)
+
+  let complete t =
+    complete_base t
+
+  let complete_hlt t =
+    complete_hlt (complete t)
+
+  let is_complete t =
+    is_complete_inner t
+
+  let wait_any ?timeout ts =
+    wait_base ~inner_of:(fun t -> t) ?timeout 1L ts
+
+  let wait_any_hlt ?timeout ts =
+    wait_base_hlt ~inner_of:(fun t -> t) ?timeout 1L ts
+
+  let wait_n ?timeout n ts =
+    wait_base ~inner_of:(fun t -> t) ?timeout n ts
+
+  let wait_n_hlt ?timeout n ts =
+    wait_base_hlt ~inner_of:(fun t -> t) ?timeout n ts
+end
+
+let mkdirat ?dir ?mode path =
+  match Mkdirat.submit ?dir ?mode path with
+  | Error error -> Some error
+  | Ok mkdirat -> Mkdirat.complete mkdirat
+
+let mkdirat_hlt ?dir ?mode path =
+  Mkdirat.(submit_hlt ?dir ?mode path |> complete_hlt)
+
+module Unlinkat = struct
+  type t = uns
+
+  external submit_inner: uns -> bool -> Stdlib.Bytes.t -> (sint * t) =
+    "hm_basis_os_unlinkat_submit_inner"
+
+  let submit ?dir ?(is_dir=false) path =
+    submit_out (submit_inner (dirfd_of_dir dir) is_dir (bytes_of_path path))
+
+  let submit_hlt ?dir ?is_dir path =
+    hlt (submit ?dir ?is_dir path)
+
+  let complete t =
+    complete_base t
+
+  let complete_hlt t =
+    complete_hlt (complete t)
+
+  let is_complete t =
+    is_complete_inner t
+
+  let wait_any ?timeout ts =
+    wait_base ~inner_of:(fun t -> t) ?timeout 1L ts
+
+  let wait_any_hlt ?timeout ts =
+    wait_base_hlt ~inner_of:(fun t -> t) ?timeout 1L ts
+
+  let wait_n ?timeout n ts =
+    wait_base ~inner_of:(fun t -> t) ?timeout n ts
+
+  let wait_n_hlt ?timeout n ts =
+    wait_base_hlt ~inner_of:(fun t -> t) ?timeout n ts
+end
+
+let unlinkat ?dir ?is_dir path =
+  match Unlinkat.submit ?dir ?is_dir path with
+  | Error error -> Some error
+  | Ok unlinkat -> Unlinkat.complete unlinkat
+
+let unlinkat_hlt ?dir ?is_dir path =
+  Unlinkat.(submit_hlt ?dir ?is_dir path |> complete_hlt)
+
+module Renameat = struct
+  type t = uns
+
+  external submit_inner: uns -> Stdlib.Bytes.t -> uns -> Stdlib.Bytes.t -> (sint * t) =
+    "hm_basis_os_renameat_submit_inner"
+
+  let submit ?dir ?new_dir path new_path =
+    submit_out (submit_inner (dirfd_of_dir dir) (bytes_of_path path) (dirfd_of_dir new_dir)
+      (bytes_of_path new_path))
+
+  let submit_hlt ?dir ?new_dir path new_path =
+    hlt (submit ?dir ?new_dir path new_path)
+
+  let complete t =
+    complete_base t
+
+  let complete_hlt t =
+    complete_hlt (complete t)
+
+  let is_complete t =
+    is_complete_inner t
+
+  let wait_any ?timeout ts =
+    wait_base ~inner_of:(fun t -> t) ?timeout 1L ts
+
+  let wait_any_hlt ?timeout ts =
+    wait_base_hlt ~inner_of:(fun t -> t) ?timeout 1L ts
+
+  let wait_n ?timeout n ts =
+    wait_base ~inner_of:(fun t -> t) ?timeout n ts
+
+  let wait_n_hlt ?timeout n ts =
+    wait_base_hlt ~inner_of:(fun t -> t) ?timeout n ts
+end
+
+let renameat ?dir ?new_dir path new_path =
+  match Renameat.submit ?dir ?new_dir path new_path with
+  | Error error -> Some error
+  | Ok renameat -> Renameat.complete renameat
+
+let renameat_hlt ?dir ?new_dir path new_path =
+  Renameat.(submit_hlt ?dir ?new_dir path new_path |> complete_hlt)
+
+module Stat = struct
+  type t = {
+    mode: uns;
+    nlink: uns;
+    uid: uns;
+    gid: uns;
+    ino: uns;
+    size: uns;
+    blocks: uns;
+    blksize: uns;
+    atime: uns;
+    mtime: uns;
+    ctime: uns;
+  }
+
+  (* Mode bits of the file type, as encoded by [S_IFMT]. *)
+  let fmt_bits = 0o170000L
+
+  let is_dir t =
+    Uns.(bit_and t.mode fmt_bits = 0o040000L)
+
+  let is_file t =
+    Uns.(bit_and t.mode fmt_bits = 0o100000L)
+
+  let is_symlink t =
+    Uns.(bit_and t.mode fmt_bits = 0o120000L)
+end
+
+module Statx = struct
+  type t = uns
+
+  external submit_inner: uns -> bool -> Stdlib.Bytes.t -> (sint * t) =
+    "hm_basis_os_statx_submit_inner"
+  external fields_inner: t -> uns array = "hm_basis_os_statx_fields_inner"
+
+  let submit ?dir ?(follow=true) path =
+    submit_out (submit_inner (dirfd_of_dir dir) follow (bytes_of_path path))
+
+  let submit_hlt ?dir ?follow path =
+    hlt (submit ?dir ?follow path)
+
+  let complete t =
+    match complete_base t with
+    | Some error -> Error error
+    | None -> begin
+        let fields = fields_inner t in
+        let field i = Array.get i fields in
+        Ok Stat.{mode=field 0L; nlink=field 1L; uid=field 2L; gid=field 3L; ino=field 4L;
+          size=field 5L; blocks=field 6L; blksize=field 7L; atime=field 8L; mtime=field 9L;
+          ctime=field 10L}
+      end
+
+  let complete_hlt t =
+    hlt (complete t)
+
+  let is_complete t =
+    is_complete_inner t
+
+  let wait_any ?timeout ts =
+    wait_base ~inner_of:(fun t -> t) ?timeout 1L ts
+
+  let wait_any_hlt ?timeout ts =
+    wait_base_hlt ~inner_of:(fun t -> t) ?timeout 1L ts
+
+  let wait_n ?timeout n ts =
+    wait_base ~inner_of:(fun t -> t) ?timeout n ts
+
+  let wait_n_hlt ?timeout n ts =
+    wait_base_hlt ~inner_of:(fun t -> t) ?timeout n ts
+end
+
+let statx ?dir ?follow path =
+  match Statx.submit ?dir ?follow path with
+  | Error error -> Error error
+  | Ok statx -> Statx.complete statx
+
+let statx_hlt ?dir ?follow path =
+  Statx.(submit_hlt ?dir ?follow path |> complete_hlt)
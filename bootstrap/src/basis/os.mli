@@ -1,12 +1,249 @@
 open RudimentsInt
 
-(** Operating system interfaces. *)
+(** Operating system interfaces. Filesystem operations are submitted to the executor's I/O ring, so
+    that they do not block the executor thread. Relative paths are resolved relative to the
+    directory corresponding to [dir], which defaults to the process's current working directory. *)
 
 val argv: Bytes.t array
 (** [argv] comprises the command line arguments, where the first element is the path to the program
     being executed. *)
 
+module Mkdirat: sig
+  type t
+  (* An internally immutable token backed by an external I/O mkdirat completion data structure. *)
+
+  val submit: ?dir:File.t -> ?mode:uns -> Path.t -> (t, Errno.t) result
+  (** [submit ~dir ~mode path] submits creation of a directory at [path] with file mode [mode],
+      which defaults to [0o755]. This operation does not block. Returns a [t] to the mkdirat
+      submission or an [Errno.t] if the mkdirat could not be submitted. *)
+
+  val submit_hlt: ?dir:File.t -> ?mode:uns -> Path.t -> t
+  (** [submit_hlt ~dir ~mode path] submits creation of a directory at [path] with file mode [mode],
+      which defaults to [0o755]. This operation does not block. Returns a [t] to the mkdirat
+      submission or halts if the mkdirat could not be submitted. *)
+
+  val complete: t -> Errno.t option
+  (** [complete t] blocks until the given [t] is complete. Returns [None] or an [Errno.t] if the
+      directory could not be created. *)
+
+  val complete_hlt: t -> unit
+  (** [complete_hlt t] blocks until the given [t] is complete. Returns a [unit] or halts if the
+      directory could not be created. *)
+
+  val is_complete: t -> bool
+  (** [is_complete t] returns true if the given [t] is complete, i.e. [complete t] would not block.
+  *)
+
+  val wait_any: ?timeout:uns -> t list -> (t list * t list, Errno.t) result
+  (** [wait_any ?timeout ts] blocks until at least one of the given [ts] is complete, or until
+      [timeout] nanoseconds elapse. Returns the [(complete, pending)] partition of [ts] or an
+      [Errno.t] if completions could not be reaped. *)
+
+  val wait_any_hlt: ?timeout:uns -> t list -> t list * t list
+  (** [wait_any_hlt ?timeout ts] is like [wait_any], but halts if completions could not be reaped.
+  *)
+
+  val wait_n: ?timeout:uns -> uns -> t list -> (t list * t list, Errno.t) result
+  (** [wait_n ?timeout n ts] blocks until at least [n] of the given [ts] are complete, or until
+      [timeout] nanoseconds elapse. Returns the [(complete, pending)] partition of [ts] or an
+      [Errno.t] if completions could not be reaped. *)
+
+  val wait_n_hlt: ?timeout:uns -> uns -> t list -> t list * t list
+  (** [wait_n_hlt ?timeout n ts] is like [wait_n], but halts if completions could not be reaped. *)
+end
+
 val mkdirat: ?dir:File.t -> ?mode:uns -> Path.t -> Errno.t option
 (** [mkdirat ~dir ~mode path] creates a directory at [path] with file mode [mode], which defaults to
-    [0o755]. If [path] is relative, the directory corresponding to [dir] is used as the starting
-    directory for path resolution. [dir] defaults to the process's current working directory. *)
+    [0o755]. Returns [None] or an [Errno.t] if the directory could not be created. *)
+
+val mkdirat_hlt: ?dir:File.t -> ?mode:uns -> Path.t -> unit
+(** [mkdirat_hlt ~dir ~mode path] creates a directory at [path] with file mode [mode], which
+    defaults to [0o755], or halts if the directory could not be created. *)
+
+module Unlinkat: sig
+  type t
+  (* An internally immutable token backed by an external I/O unlinkat completion data structure. *)
+
+  val submit: ?dir:File.t -> ?is_dir:bool -> Path.t -> (t, Errno.t) result
+  (** [submit ~dir ~is_dir path] submits removal of the file at [path], or of the empty directory at
+      [path] if [is_dir] is true (default false). This operation does not block. Returns a [t] to
+      the unlinkat submission or an [Errno.t] if the unlinkat could not be submitted. *)
+
+  val submit_hlt: ?dir:File.t -> ?is_dir:bool -> Path.t -> t
+  (** [submit_hlt ~dir ~is_dir path] is like [submit], but halts if the unlinkat could not be
+      submitted. *)
+
+  val complete: t -> Errno.t option
+  (** [complete t] blocks until the given [t] is complete. Returns [None] or an [Errno.t] if the
+      file could not be removed. *)
+
+  val complete_hlt: t -> unit
+  (** [complete_hlt t] blocks until the given [t] is complete. Returns a [unit] or halts if the file
+      could not be removed. *)
+
+  val is_complete: t -> bool
+  (** [is_complete t] returns true if the given [t] is complete, i.e. [complete t] would not block.
+  *)
+
+  val wait_any: ?timeout:uns -> t list -> (t list * t list, Errno.t) result
+  (** [wait_any ?timeout ts] is like [Mkdirat.wait_any]. *)
+
+  val wait_any_hlt: ?timeout:uns -> t list -> t list * t list
+  (** [wait_any_hlt ?timeout ts] is like [Mkdirat.wait_any_hlt]. *)
+
+  val wait_n: ?timeout:uns -> uns -> t list -> (t list * t list, Errno.t) result
+  (** [wait_n ?timeout n ts] is like [Mkdirat.wait_n]. *)
+
+  val wait_n_hlt: ?timeout:uns -> uns -> t list -> t list * t list
+  (** [wait_n_hlt ?timeout n ts] is like [Mkdirat.wait_n_hlt]. *)
+end
+
+val unlinkat: ?dir:File.t -> ?is_dir:bool -> Path.t -> Errno.t option
+(** [unlinkat ~dir ~is_dir path] removes the file at [path], or the empty directory at [path] if
+    [is_dir] is true (default false). Returns [None] or an [Errno.t] if the file could not be
+    removed. *)
+
+val unlinkat_hlt: ?dir:File.t -> ?is_dir:bool -> Path.t -> unit
+(** [unlinkat_hlt ~dir ~is_dir path] is like [unlinkat], but halts if the file could not be removed.
+*)
+
+module Renameat: sig
+  type t
+  (* An internally immutable token backed by an external I/O renameat completion data structure. *)
+
+  val submit: ?dir:File.t -> ?new_dir:File.t -> Path.t -> Path.t -> (t, Errno.t) result
+  (** [submit ~dir ~new_dir path new_path] submits renaming of [path] to [new_path], which if
+      relative is resolved relative to [new_dir]. This operation does not block. Returns a [t] to
+      the renameat submission or an [Errno.t] if the renameat could not be submitted. *)
+
+  val submit_hlt: ?dir:File.t -> ?new_dir:File.t -> Path.t -> Path.t -> t
+  (** [submit_hlt ~dir ~new_dir path new_path] is like [submit], but halts if the renameat could
+      not be submitted. *)
+
+  val complete: t -> Errno.t option
+  (** [complete t] blocks until the given [t] is complete. Returns [None] or an [Errno.t] if the
+      file could not be renamed. *)
+
+  val complete_hlt: t -> unit
+  (** [complete_hlt t] blocks until the given [t] is complete. Returns a [unit] or halts if the file
+      could not be renamed. *)
+
+  val is_complete: t -> bool
+  (** [is_complete t] returns true if the given [t] is complete, i.e. [complete t] would not block.
+  *)
+
+  val wait_any: ?timeout:uns -> t list -> (t list * t list, Errno.t) result
+  (** [wait_any ?timeout ts] is like [Mkdirat.wait_any]. *)
+
+  val wait_any_hlt: ?timeout:uns -> t list -> t list * t list
+  (** [wait_any_hlt ?timeout ts] is like [Mkdirat.wait_any_hlt]. *)
+
+  val wait_n: ?timeout:uns -> uns -> t list -> (t list * t list, Errno.t) result
+  (** [wait_n ?timeout n ts] is like [Mkdirat.wait_n]. *)
+
+  val wait_n_hlt: ?timeout:uns -> uns -> t list -> t list * t list
+  (** [wait_n_hlt ?timeout n ts] is like [Mkdirat.wait_n_hlt]. *)
+end
+
+val renameat: ?dir:File.t -> ?new_dir:File.t -> Path.t -> Path.t -> Errno.t option
+(** [renameat ~dir ~new_dir path new_path] atomically renames [path] to [new_path], replacing any
+    existing file at [new_path]. [new_path] is resolved relative to [new_dir] if relative. Returns
+    [None] or an [Errno.t] if the file could not be renamed. *)
+
+val renameat_hlt: ?dir:File.t -> ?new_dir:File.t -> Path.t -> Path.t -> unit
+(** [renameat_hlt ~dir ~new_dir path new_path] is like [renameat], but halts if the file could not
+    be renamed. *)
+
+(** File status, as reported by [statx]. *)
+module Stat: sig
+  type t = {
+    mode: uns;
+    (** File type and mode bits. *)
+
+    nlink: uns;
+    (** Number of hard links. *)
+
+    uid: uns;
+    (** Owner user ID. *)
+
+    gid: uns;
+    (** Owner group ID. *)
+
+    ino: uns;
+    (** Inode number. *)
+
+    size: uns;
+    (** Size in bytes. *)
+
+    blocks: uns;
+    (** Number of 512-byte blocks allocated. *)
+
+    blksize: uns;
+    (** Preferred I/O block size. *)
+
+    atime: uns;
+    (** Last access time, in nanoseconds since the epoch. *)
+
+    mtime: uns;
+    (** Last modification time, in nanoseconds since the epoch. *)
+
+    ctime: uns;
+    (** Last status change time, in nanoseconds since the epoch. *)
+  }
+
+  val is_dir: t -> bool
+  (** [is_dir t] returns true if [t] describes a directory. *)
+
+  val is_file: t -> bool
+  (** [is_file t] returns true if [t] describes a regular file. *)
+
+  val is_symlink: t -> bool
+  (** [is_symlink t] returns true if [t] describes a symbolic link. *)
+end
+
+module Statx: sig
+  type t
+  (* An internally immutable token backed by an external I/O statx completion data structure. *)
+
+  val submit: ?dir:File.t -> ?follow:bool -> Path.t -> (t, Errno.t) result
+  (** [submit ~dir ~follow path] submits a status query for the file at [path]. If [path] names a
+      symbolic link, it is followed if [follow] is true (default true). This operation does not
+      block. Returns a [t] to the statx submission or an [Errno.t] if the statx could not be
+      submitted. *)
+
+  val submit_hlt: ?dir:File.t -> ?follow:bool -> Path.t -> t
+  (** [submit_hlt ~dir ~follow path] is like [submit], but halts if the statx could not be
+      submitted. *)
+
+  val complete: t -> (Stat.t, Errno.t) result
+  (** [complete t] blocks until the given [t] is complete. Returns the file's [Stat.t] or an
+      [Errno.t] if its status could not be queried. *)
+
+  val complete_hlt: t -> Stat.t
+  (** [complete_hlt t] blocks until the given [t] is complete. Returns the file's [Stat.t] or halts
+      if its status could not be queried. *)
+
+  val is_complete: t -> bool
+  (** [is_complete t] returns true if the given [t] is complete, i.e. [complete t] would not block.
+  *)
+
+  val wait_any: ?timeout:uns -> t list -> (t list * t list, Errno.t) result
+  (** [wait_any ?timeout ts] is like [Mkdirat.wait_any]. *)
+
+  val wait_any_hlt: ?timeout:uns -> t list -> t list * t list
+  (** [wait_any_hlt ?timeout ts] is like [Mkdirat.wait_any_hlt]. *)
+
+  val wait_n: ?timeout:uns -> uns -> t list -> (t list * t list, Errno.t) result
+  (** [wait_n ?timeout n ts] is like [Mkdirat.wait_n]. *)
+
+  val wait_n_hlt: ?timeout:uns -> uns -> t list -> t list * t list
+  (** [wait_n_hlt ?timeout n ts] is like [Mkdirat.wait_n_hlt]. *)
+end
+
+val statx: ?dir:File.t -> ?follow:bool -> Path.t -> (Stat.t, Errno.t) result
+(** [statx ~dir ~follow path] returns the status of the file at [path], following a final symbolic
+    link if [follow] is true (default true), or an [Errno.t] if its status could not be queried. *)
+
+val statx_hlt: ?dir:File.t -> ?follow:bool -> Path.t -> Stat.t
+(** [statx_hlt ~dir ~follow path] is like [statx], but halts if the file's status could not be
+    queried. *)
@@ -166,7 +166,7 @@ module Segment = struct
     let join_bytes ts = begin
       of_bytes (Bytes.Slice.join (List.map ts ~f:(fun segment ->
         match segment with
-        | Empty -> Bytes.Slice.init [||]
+        | Empty -> Bytes.(Slice.init (of_array [||]))
         | Current
         | Parent -> not_reached ()
         | Sslice sslice -> Bytes.Slice.of_string_slice sslice
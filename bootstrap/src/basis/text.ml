@@ -102,7 +102,7 @@ module Excerpt = struct
   }
 
   (* Base excerpt, always hd of excerpts maps. *)
-  let base = {eind=0L; bytes=Bytes.Slice.init [||]}
+  let base = {eind=0L; bytes=Bytes.(Slice.init (of_array [||]))}
 
   (* val of_bytes_slice: t -> Bytes.Slice.t -> t *)
   let of_bytes_slice pred bytes =
@@ -219,6 +219,15 @@ let of_bytes_stream ?path ?(tabwidth=default_tabwidth) stream =
   let extend = susp_extend path excerpt excerpts stream in
   {path; tabwidth; excerpts; extend}
 
+let of_bytes_slice ?path ?(tabwidth=default_tabwidth) bytes =
+  let susp_extend () = lazy None in
+  let excerpt = Excerpt.(of_bytes_slice base bytes) in
+  let excerpts =
+    Map.singleton (module Uns) ~k:Excerpt.base.eind ~v:Excerpt.base
+    |> Map.insert ~k:excerpt.eind ~v:excerpt in
+  let extend = susp_extend () in
+  {path; tabwidth; excerpts; extend}
+
 let of_string_slice ?path ?(tabwidth=default_tabwidth) slice =
   let susp_extend () = lazy None in
   let excerpt = Excerpt.(of_string_slice base slice) in
@@ -17,6 +17,11 @@ val of_bytes_stream: ?path:Path.t -> ?tabwidth:uns -> Bytes.Slice.t Stream.t ->
 (** [of_string_stream ~path ~tabwidth stream] returns a text which streams from [stream].
     [~tabwidth] defaults to 8. *)
 
+val of_bytes_slice: ?path:Path.t -> ?tabwidth:uns -> Bytes.Slice.t -> t
+(** [of_bytes_slice ~path ~tabwidth bytes] returns an eagerly initialized text which views [bytes]
+    directly, e.g. as mapped by {!File.Mmap.of_path}. [bytes] must not be subsequently mutated.
+    [~tabwidth] defaults to 8. *)
+
 val of_string_slice: ?path:Path.t -> ?tabwidth:uns -> String.C.Slice.t -> t
 (** [of_string_slice ~path slice] returns an eagerly initialized text. [~tabwidth] defaults to 8. *)
 
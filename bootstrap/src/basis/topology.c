@@ -0,0 +1,245 @@
+#define _GNU_SOURCE
+#include <assert.h>
+#include <linux/mempolicy.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "common.h"
+#include "topology.h"
+
+#define HEMLOCK_INDENT_SIZE 4
+
+static hemlock_topology_t hemlock_topology;
+static bool hemlock_topology_read = false;
+
+void
+hemlock_topology_pp(int fd, int indent, hemlock_topology_t const *topology) {
+    dprintf(fd, "%*stopology:\n", indent, "");
+    indent += HEMLOCK_INDENT_SIZE;
+    dprintf(fd, "%*sn_nodes: %lu\n", indent, "", topology->n_nodes);
+    dprintf(fd, "%*scpus:\n", indent, "");
+    indent += HEMLOCK_INDENT_SIZE;
+    for (size_t i = 0; i < topology->n_cpus; i++) {
+        int cpu = topology->cpus[i];
+        dprintf(fd, "%*s%d: node=%d core=%d\n", indent, "", cpu, topology->node[cpu],
+          topology->core[cpu]);
+    }
+}
+
+// Parse a sysfs CPU list, e.g. "0-3,8-11", into `cpus`. Returns whether the list
+// could be read.
+static bool
+hemlock_topology_cpulist_read(char const *path, cpu_set_t *cpus) {
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        return false;
+    }
+    CPU_ZERO(cpus);
+    int lo, hi;
+    while (fscanf(f, "%d", &lo) == 1) {
+        hi = lo;
+        int c = fgetc(f);
+        if (c == '-') {
+            if (fscanf(f, "%d", &hi) != 1) {
+                break;
+            }
+            c = fgetc(f);
+        }
+        for (int cpu = lo; cpu <= hi && cpu < CPU_SETSIZE; cpu++) {
+            CPU_SET(cpu, cpus);
+        }
+        if (c != ',') {
+            break;
+        }
+    }
+    fclose(f);
+
+    return true;
+}
+
+static void
+hemlock_topology_setup(hemlock_topology_t *topology) {
+    memset(topology, 0, sizeof(hemlock_topology_t));
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof(cpu_set_t), &allowed) != 0) {
+        CPU_ZERO(&allowed);
+    }
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (CPU_ISSET(cpu, &allowed)) {
+            topology->cpus[topology->n_cpus] = cpu;
+            topology->n_cpus++;
+            topology->core[cpu] = cpu;
+        }
+    }
+
+    topology->n_nodes = 1;
+    char path[128];
+    cpu_set_t cpus;
+    for (int node = 0; node < HEMLOCK_TOPOLOGY_NODES_MAX; node++) {
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+        if (!hemlock_topology_cpulist_read(path, &cpus)) {
+            continue;
+        }
+        for (size_t i = 0; i < topology->n_cpus; i++) {
+            int cpu = topology->cpus[i];
+            if (CPU_ISSET(cpu, &cpus)) {
+                topology->node[cpu] = node;
+                if ((size_t)node >= topology->n_nodes) {
+                    topology->n_nodes = node + 1;
+                }
+            }
+        }
+    }
+
+    // SMT siblings share a physical core, which is identified by its lowest-numbered sibling.
+    for (size_t i = 0; i < topology->n_cpus; i++) {
+        int cpu = topology->cpus[i];
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/thread_siblings_list",
+          cpu);
+        if (hemlock_topology_cpulist_read(path, &cpus)) {
+            for (int sibling = 0; sibling < cpu; sibling++) {
+                if (CPU_ISSET(sibling, &cpus)) {
+                    topology->core[cpu] = sibling;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+hemlock_topology_t const *
+hemlock_topology_get(void) {
+    // Only called by the main executor, while holding the runtime lock.
+    if (!hemlock_topology_read) {
+        hemlock_topology_setup(&hemlock_topology);
+        hemlock_topology_read = true;
+    }
+
+    return &hemlock_topology;
+}
+
+void
+hemlock_topology_claims_setup(hemlock_topology_claims_t *claims) {
+    memset(claims, 0, sizeof(hemlock_topology_claims_t));
+    CPU_ZERO(&claims->cpus);
+    claims->home = -1;
+}
+
+// Placement preference for unclaimed `cpu`, where lesser values are preferred.
+static uint64_t
+hemlock_topology_rank(hemlock_topology_t const *topology, hemlock_topology_claims_t const *claims,
+  hemlock_topology_placement_t placement, int cpu) {
+    int node = topology->node[cpu];
+    switch (placement) {
+    case HEMLOCK_TOPOLOGY_DEPTH_FIRST:
+        if (node == claims->home) {
+            return 0;
+        }
+        return (claims->n_node[node] > 0) ? 1 : 2;
+    default:
+        assert(placement == HEMLOCK_TOPOLOGY_BREADTH_FIRST);
+        return ((uint64_t)claims->n_node[node] << 32) | claims->n_core[topology->core[cpu]];
+    }
+}
+
+int
+hemlock_topology_claim(hemlock_topology_t const *topology, hemlock_topology_claims_t *claims,
+  hemlock_topology_placement_t placement, uint64_t *rng) {
+    if (topology->n_cpus == 0) {
+        return -1;
+    }
+    if (claims->n_claimed == topology->n_cpus) {
+        int home = claims->home;
+        hemlock_topology_claims_setup(claims);
+        claims->home = home;
+    }
+
+    int claimed = -1;
+    if (placement == HEMLOCK_TOPOLOGY_RANDOM) {
+        // xorshift64.
+        uint64_t x = *rng;
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        *rng = x;
+        size_t k = x % (topology->n_cpus - claims->n_claimed);
+        for (size_t i = 0; i < topology->n_cpus; i++) {
+            int cpu = topology->cpus[i];
+            if (!CPU_ISSET(cpu, &claims->cpus)) {
+                if (k == 0) {
+                    claimed = cpu;
+                    break;
+                }
+                k--;
+            }
+        }
+    } else {
+        uint64_t claimed_rank = UINT64_MAX;
+        for (size_t i = 0; i < topology->n_cpus; i++) {
+            int cpu = topology->cpus[i];
+            if (!CPU_ISSET(cpu, &claims->cpus)) {
+                uint64_t rank = hemlock_topology_rank(topology, claims, placement, cpu);
+                if (rank < claimed_rank) {
+                    claimed = cpu;
+                    claimed_rank = rank;
+                }
+            }
+        }
+    }
+    assert(claimed >= 0);
+
+    CPU_SET(claimed, &claims->cpus);
+    claims->n_claimed++;
+    claims->n_node[topology->node[claimed]]++;
+    claims->n_core[topology->core[claimed]]++;
+    if (claims->home < 0) {
+        claims->home = topology->node[claimed];
+    }
+
+    return claimed;
+}
+
+// Node mask argument of `set_mempolicy(2)` and `mbind(2)`. The kernel ignores the last bit of
+// `maxnode`, hence the extra bit.
+#define HEMLOCK_TOPOLOGY_MAXNODE (HEMLOCK_TOPOLOGY_NODES_MAX + 1)
+typedef struct {
+    unsigned long bits[HEMLOCK_TOPOLOGY_NODES_MAX / (8 * sizeof(unsigned long))];
+} hemlock_topology_nodemask_t;
+
+static void
+hemlock_topology_nodemask_init(hemlock_topology_nodemask_t *mask, int node) {
+    memset(mask, 0, sizeof(hemlock_topology_nodemask_t));
+    size_t width = 8 * sizeof(unsigned long);
+    mask->bits[node / width] = 1UL << (node % width);
+}
+
+void
+hemlock_topology_prefer(hemlock_topology_t const *topology, int node) {
+    if (topology->n_nodes <= 1) {
+        return;
+    }
+    hemlock_topology_nodemask_t mask;
+    hemlock_topology_nodemask_init(&mask, node);
+    (void)syscall(SYS_set_mempolicy, MPOL_PREFERRED, mask.bits, HEMLOCK_TOPOLOGY_MAXNODE);
+}
+
+void
+hemlock_topology_move(hemlock_topology_t const *topology, int node, void *addr, size_t size) {
+    if (topology->n_nodes <= 1) {
+        return;
+    }
+    uintptr_t page_size = (uintptr_t)sysconf(_SC_PAGESIZE);
+    uintptr_t base = ((uintptr_t)addr + page_size - 1) & ~(page_size - 1);
+    uintptr_t end = ((uintptr_t)addr + size) & ~(page_size - 1);
+    if (end <= base) {
+        return;
+    }
+    hemlock_topology_nodemask_t mask;
+    hemlock_topology_nodemask_init(&mask, node);
+    (void)syscall(SYS_mbind, (void *)base, end - base, MPOL_PREFERRED, mask.bits,
+      HEMLOCK_TOPOLOGY_MAXNODE, MPOL_MF_MOVE);
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <sched.h>
+#include <stddef.h>
+
+#include "common.h"
+
+// Maximum number of NUMA nodes distinguished. CPUs on higher-numbered nodes are treated as being on
+// node 0.
+#define HEMLOCK_TOPOLOGY_NODES_MAX 64
+
+// CPU placement policies, in the same order as `Basis.Executor.Placement.t`.
+typedef enum {
+    // Pack executors onto as few NUMA nodes as possible: any unclaimed CPU on the node of the main
+    // executor, then any unclaimed CPU on the node of another executor, then any unclaimed CPU.
+    HEMLOCK_TOPOLOGY_DEPTH_FIRST,
+    // Spread executors across NUMA nodes, and within a node across physical cores: any unclaimed
+    // CPU on the node with the fewest claimed CPUs, preferring cores with the fewest claimed CPUs.
+    HEMLOCK_TOPOLOGY_BREADTH_FIRST,
+    // Any unclaimed CPU, chosen uniformly at random.
+    HEMLOCK_TOPOLOGY_RANDOM,
+} hemlock_topology_placement_t;
+
+// CPU topology of the CPUs the process may run on, as read from `/sys/devices/system/node` and
+// `/sys/devices/system/cpu`. If the topology cannot be read, e.g. in a container that hides sysfs,
+// all CPUs are taken to be distinct cores on node 0.
+typedef struct {
+    // CPUs the process may run on, in ascending order.
+    size_t n_cpus;
+    int cpus[CPU_SETSIZE];
+
+    // Number of NUMA nodes with CPUs the process may run on, i.e. 1 plus the maximum of `node`.
+    size_t n_nodes;
+
+    // NUMA node and physical core (unique across packages) of each CPU, indexed by CPU number.
+    int node[CPU_SETSIZE];
+    int core[CPU_SETSIZE];
+} hemlock_topology_t;
+void hemlock_topology_pp(int fd, int indent, hemlock_topology_t const *topology);
+
+// Read the topology, once, and return it.
+hemlock_topology_t const *hemlock_topology_get(void);
+
+// CPUs claimed by a group of executors, for placement of the next.
+typedef struct {
+    cpu_set_t cpus;
+    size_t n_claimed;
+
+    // Node of the first claimed CPU, i.e. the group's home node, or -1.
+    int home;
+
+    // Numbers of claimed CPUs per node, and per core, indexed as `hemlock_topology_t.core`.
+    uint32_t n_node[HEMLOCK_TOPOLOGY_NODES_MAX];
+    uint32_t n_core[CPU_SETSIZE];
+} hemlock_topology_claims_t;
+void hemlock_topology_claims_setup(hemlock_topology_claims_t *claims);
+
+// Claim the CPU on which the next executor of a group is to be pinned, according to `placement`,
+// and return it, or return -1 if the topology lists no CPUs. Once all CPUs have been claimed,
+// claims are reset, so that CPUs are shared as evenly as possible. `*rng` is the state of the
+// random number generator used by `HEMLOCK_TOPOLOGY_RANDOM`.
+int hemlock_topology_claim(hemlock_topology_t const *topology, hemlock_topology_claims_t *claims,
+  hemlock_topology_placement_t placement, uint64_t *rng);
+
+// Set the calling thread's memory policy to prefer allocations on `node`. Memory policy is
+// advisory, so failure, e.g. on kernels built without NUMA support, is ignored. A no-op on
+// single-node systems.
+void hemlock_topology_prefer(hemlock_topology_t const *topology, int node);
+
+// Migrate the whole pages within `[addr,addr+size)` to `node`, and prefer `node` for pages
+// subsequently faulted in. The pages should not be shared with unrelated data, since they are
+// migrated too. Failure is ignored, as for `hemlock_topology_prefer`.
+void hemlock_topology_move(hemlock_topology_t const *topology, int node, void *addr, size_t size);
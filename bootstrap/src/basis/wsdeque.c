@@ -0,0 +1,163 @@
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+#include "wsdeque.h"
+
+/*
+ * The deque follows "Correct and Efficient Work-Stealing for Weak Memory Models" by Le, Pop,
+ * Cohen, and Zappa Nardelli, which adapts the Chase-Lev deque to C11 atomics. Items occupy
+ * positions `[top,bottom)`. The owner alone moves `bottom`, and `top` only ever advances, via CAS
+ * by thieves, or by the owner when it races thieves for the last item. Positions are signed so that
+ * the owner may transiently decrement `bottom` below an empty deque's `top` of 0.
+ */
+
+#define HEMLOCK_INDENT_SIZE 4
+
+// Initial number of array slots. Must be a power of two.
+#define HEMLOCK_WSDEQUE_SIZE 64
+
+void
+hemlock_wsdeque_pp(int fd, int indent, hemlock_wsdeque_t *deque) {
+    dprintf(fd, "%*swsdeque:\n", indent, "");
+    indent += HEMLOCK_INDENT_SIZE;
+    dprintf(fd,
+        "%*stop: %ld\n"
+        "%*sbottom: %ld\n"
+        "%*ssize: %ld\n"
+        "%*sn_pushed: %lu\n"
+        "%*sn_popped: %lu\n"
+        ,
+        indent, "", atomic_load_explicit(&deque->top, memory_order_relaxed),
+        indent, "", atomic_load_explicit(&deque->bottom, memory_order_relaxed),
+        indent, "", atomic_load_explicit(&deque->array, memory_order_relaxed)->size,
+        indent, "", deque->n_pushed,
+        indent, "", deque->n_popped
+    );
+}
+
+static hemlock_wsdeque_array_t *
+hemlock_wsdeque_array_create(int64_t size) {
+    hemlock_wsdeque_array_t *array = (hemlock_wsdeque_array_t *)malloc(
+      sizeof(hemlock_wsdeque_array_t) + sizeof(void *) * size);
+    assert(array != NULL);
+    array->size = size;
+    array->retired = NULL;
+
+    return array;
+}
+
+void
+hemlock_wsdeque_setup(hemlock_wsdeque_t *deque) {
+    atomic_init(&deque->top, 0);
+    atomic_init(&deque->bottom, 0);
+    atomic_init(&deque->array, hemlock_wsdeque_array_create(HEMLOCK_WSDEQUE_SIZE));
+    deque->n_pushed = 0;
+    deque->n_popped = 0;
+}
+
+void
+hemlock_wsdeque_teardown(hemlock_wsdeque_t *deque) {
+    hemlock_wsdeque_array_t *array = atomic_load_explicit(&deque->array, memory_order_relaxed);
+    while (array != NULL) {
+        hemlock_wsdeque_array_t *retired = array->retired;
+        free(array);
+        array = retired;
+    }
+    memset(deque, 0, sizeof(hemlock_wsdeque_t));
+}
+
+// Replace the array with one twice the size, containing the same items at the same positions.
+static hemlock_wsdeque_array_t *
+hemlock_wsdeque_grow(hemlock_wsdeque_t *deque, int64_t top, int64_t bottom) {
+    hemlock_wsdeque_array_t *array = atomic_load_explicit(&deque->array, memory_order_relaxed);
+    hemlock_wsdeque_array_t *grown = hemlock_wsdeque_array_create(array->size * 2);
+    for (int64_t i = top; i < bottom; i++) {
+        void *item = atomic_load_explicit(&array->items[i & (array->size - 1)],
+          memory_order_relaxed);
+        atomic_store_explicit(&grown->items[i & (grown->size - 1)], item, memory_order_relaxed);
+    }
+    grown->retired = array;
+    atomic_store_explicit(&deque->array, grown, memory_order_release);
+
+    return grown;
+}
+
+bool
+hemlock_wsdeque_push(hemlock_wsdeque_t *deque, void *item) {
+    assert(item != NULL);
+    int64_t bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed);
+    int64_t top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    hemlock_wsdeque_array_t *array = atomic_load_explicit(&deque->array, memory_order_relaxed);
+    if (bottom - top > array->size - 1) {
+        array = hemlock_wsdeque_grow(deque, top, bottom);
+    }
+    atomic_store_explicit(&array->items[bottom & (array->size - 1)], item, memory_order_relaxed);
+    // Publish the item, and whatever it points to, to thieves.
+    atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_release);
+    deque->n_pushed++;
+
+    return bottom == top;
+}
+
+void *
+hemlock_wsdeque_pop(hemlock_wsdeque_t *deque) {
+    int64_t bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed) - 1;
+    hemlock_wsdeque_array_t *array = atomic_load_explicit(&deque->array, memory_order_relaxed);
+    atomic_store_explicit(&deque->bottom, bottom, memory_order_relaxed);
+    // Order the `bottom` store before the `top` load, so that the owner and a thief cannot both
+    // take the last item.
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t top = atomic_load_explicit(&deque->top, memory_order_relaxed);
+
+    void *item = NULL;
+    if (top <= bottom) {
+        item = atomic_load_explicit(&array->items[bottom & (array->size - 1)],
+          memory_order_relaxed);
+        if (top == bottom) {
+            // Last item. Race thieves for it.
+            if (!atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1,
+              memory_order_seq_cst, memory_order_relaxed)) {
+                item = NULL;
+            }
+            atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+        }
+    } else {
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+    }
+    if (item != NULL) {
+        deque->n_popped++;
+    }
+
+    return item;
+}
+
+void *
+hemlock_wsdeque_peek(hemlock_wsdeque_t *deque, int64_t *top) {
+    *top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t bottom = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+    if (*top >= bottom) {
+        return NULL;
+    }
+    hemlock_wsdeque_array_t *array = atomic_load_explicit(&deque->array, memory_order_acquire);
+
+    return atomic_load_explicit(&array->items[*top & (array->size - 1)], memory_order_relaxed);
+}
+
+bool
+hemlock_wsdeque_steal(hemlock_wsdeque_t *deque, int64_t top, void *item) {
+    int64_t top_cur;
+    if (hemlock_wsdeque_peek(deque, &top_cur) != item || top_cur != top) {
+        return false;
+    }
+
+    // The CAS fails if the owner popped the item or another thief stole it since the peek.
+    return atomic_compare_exchange_strong_explicit(&deque->top, &top_cur, top + 1,
+      memory_order_seq_cst, memory_order_relaxed);
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <stdatomic.h>
+#include <stddef.h>
+
+#include "common.h"
+
+// Circular array backing a work-stealing deque. `size` is a power of two.
+typedef struct hemlock_wsdeque_array_s {
+    int64_t size;
+    struct hemlock_wsdeque_array_s *retired;
+    void *_Atomic items[];
+} hemlock_wsdeque_array_t;
+
+// Chase-Lev work-stealing deque of non-NULL item pointers. The owner pushes and pops at the bottom
+// end, in LIFO order, and thieves steal from the top end, i.e. the oldest item. The array grows as
+// needed. Arrays that have been outgrown may still be read by concurrent thieves, so they are
+// retired rather than freed until teardown. The owner end and the thief end are on separate cache
+// lines so that thieves do not contend with the owner.
+typedef struct {
+    // Thief end. Position of the oldest item.
+    _Alignas(HEMLOCK_CACHE_LINE_SIZE) _Atomic int64_t top;
+
+    // Owner end. Position one past the newest item, and the current array.
+    _Alignas(HEMLOCK_CACHE_LINE_SIZE) _Atomic int64_t bottom;
+    hemlock_wsdeque_array_t *_Atomic array;
+
+    // Statistics, maintained by the owner.
+    uint64_t n_pushed;
+    uint64_t n_popped;
+} hemlock_wsdeque_t;
+void hemlock_wsdeque_pp(int fd, int indent, hemlock_wsdeque_t *deque);
+void hemlock_wsdeque_setup(hemlock_wsdeque_t *deque);
+void hemlock_wsdeque_teardown(hemlock_wsdeque_t *deque);
+
+// Push `item` onto the bottom of `deque`. Returns whether `deque` was empty beforehand. Only the
+// deque's owner may call this.
+bool hemlock_wsdeque_push(hemlock_wsdeque_t *deque, void *item);
+
+// Pop the newest item from the bottom of `deque`, or return NULL if `deque` is empty, e.g. because
+// all items have been stolen. Only the deque's owner may call this.
+void *hemlock_wsdeque_pop(hemlock_wsdeque_t *deque);
+
+// Return the oldest item in `deque` and store its position in `*top`, or return NULL if `deque`
+// appears empty. The item must not be dereferenced by anyone but the deque's owner, since the owner
+// may pop and free it at any time.
+void *hemlock_wsdeque_peek(hemlock_wsdeque_t *deque, int64_t *top);
+
+// Steal `item` from the top of `deque`, if it is still the oldest item and at position `top`, as
+// previously reported by `hemlock_wsdeque_peek`. Returns whether `item` was stolen.
+bool hemlock_wsdeque_steal(hemlock_wsdeque_t *deque, int64_t top, void *item);
@@ -0,0 +1,28 @@
+open! Basis.Rudiments
+open! Basis
+open Bytes
+
+let test () =
+  let test src_range dst_range = begin
+    let bytes = init (0L =:< 6L) ~f:(fun i -> U8.kv i) in
+    let src = Slice.init ~range:src_range bytes in
+    let dst = Slice.init ~range:dst_range bytes in
+    File.Fmt.stdout
+    |> Fmt.fmt "blit "
+    |> Slice.pp src
+    |> Fmt.fmt " "
+    |> Slice.pp dst
+    |> ignore;
+    Slice.blit src dst;
+    File.Fmt.stdout
+    |> Fmt.fmt " -> "
+    |> pp bytes
+    |> Fmt.fmt "\n"
+    |> ignore
+  end in
+  test (0L =:< 0L) (6L =:< 6L);
+  test (0L =:< 2L) (3L =:< 5L);
+  test (0L =:< 4L) (1L =:< 5L);
+  test (1L =:< 5L) (0L =:< 4L)
+
+let _ = test ()
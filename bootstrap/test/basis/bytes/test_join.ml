@@ -18,11 +18,11 @@ let test () =
     |> Fmt.fmt "\n"
     |> ignore
   end in
-  let e = Slice.init [||] in
-  let a = Slice.init [|U8.kv 0L|] in
-  let b = Slice.init [|U8.kv 1L|] in
-  let c = Slice.init [|U8.kv 2L|] in
-  let d = Slice.init [|U8.kv 3L|] in
+  let e = Slice.init (of_array [||]) in
+  let a = Slice.init (of_array [|U8.kv 0L|]) in
+  let b = Slice.init (of_array [|U8.kv 1L|]) in
+  let c = Slice.init (of_array [|U8.kv 2L|]) in
+  let d = Slice.init (of_array [|U8.kv 3L|]) in
   test [];
   test [e];
   test [e; e];
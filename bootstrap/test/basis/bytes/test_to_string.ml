@@ -87,7 +87,8 @@ let rev_to_string_replace bytes =
 
 let test () =
   let test_to_string (bytes_list:byte list) = begin
-    let bytes = Array.of_list bytes_list in
+    let array = Array.of_list bytes_list in
+    let bytes = of_array array in
 
     File.Fmt.stdout
     |> Fmt.fmt "to_string "
@@ -97,7 +98,7 @@ let test () =
     |> Fmt.fmt ", "
     |> String.pp (to_string_replace bytes)
     |> Fmt.fmt ", "
-    |> String.pp (rev_to_string_replace bytes)
+    |> String.pp (rev_to_string_replace array)
     |> Fmt.fmt "\n"
     |> ignore
   end in
@@ -0,0 +1,20 @@
+open! Basis.Rudiments
+open! Basis
+
+let test () =
+  List.iter [(0L, 0L, 0L); (2L, 1L, 1L); (1000L, 10L, 100L); (1001L, 1000L, 3L)]
+    ~f:(fun (n, active, rounds) ->
+      File.Fmt.stdout
+      |> Fmt.fmt "pingpong ~n:"
+      |> Uns.pp n
+      |> Fmt.fmt " ~active:"
+      |> Uns.pp active
+      |> Fmt.fmt " ~rounds:"
+      |> Uns.pp rounds
+      |> Fmt.fmt " -> "
+      |> Uns.pp (Executor.Actor.pingpong ~n ~active ~rounds)
+      |> Fmt.fmt "\n"
+      |> ignore
+    )
+
+let _ = test ()
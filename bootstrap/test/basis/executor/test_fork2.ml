@@ -0,0 +1,41 @@
+open! Basis.Rudiments
+open! Basis
+
+(* Sum [\[base, past)] by recursive halving, forking the upper half. *)
+let rec sum base past =
+  match past - base <= 4L with
+  | true -> Range.Uns.fold (base =:< past) ~init:0L ~f:(fun accum i -> accum + i)
+  | false -> begin
+      let mid = base + (past - base) / 2L in
+      let lo, hi = Executor.fork2 (fun () -> sum base mid) (fun () -> sum mid past) in
+      lo + hi
+    end
+
+let test () =
+  File.Fmt.stdout
+  |> Fmt.fmt "sum (no pool) -> "
+  |> Uns.pp (sum 0L 1000L)
+  |> Fmt.fmt "\n"
+  |> ignore;
+  Executor.Pool.start_hlt ~n:3L ();
+  File.Fmt.stdout
+  |> Fmt.fmt "sum (pool) -> "
+  |> Uns.pp (sum 0L 100_000L)
+  |> Fmt.fmt "\n"
+  |> ignore;
+  Executor.Pool.stop ();
+  File.Fmt.stdout
+  |> Fmt.fmt "fork2 -> "
+  |> (fun formatter ->
+    let a, b = Executor.fork2 (fun () -> "a") (fun () -> 42L) in
+    formatter
+    |> Fmt.fmt "("
+    |> String.pp a
+    |> Fmt.fmt ", "
+    |> Uns.pp b
+    |> Fmt.fmt ")"
+  )
+  |> Fmt.fmt "\n"
+  |> ignore
+
+let _ = test ()
@@ -0,0 +1,39 @@
+open! Basis.Rudiments
+open! Basis
+
+let pp_limits formatter =
+  let Executor.Conf.{iowq_max_bounded; iowq_max_unbounded; _} = Executor.conf () in
+  formatter
+  |> Fmt.fmt "iowq_max_bounded="
+  |> Uns.pp iowq_max_bounded
+  |> Fmt.fmt " iowq_max_unbounded="
+  |> Uns.pp iowq_max_unbounded
+
+let test () =
+  let conf = Executor.Conf.{default with iowq_max_bounded=4L} in
+  Executor.setup_hlt conf;
+  File.Fmt.stdout
+  |> Fmt.fmt "setup -> "
+  |> pp_limits
+  |> Fmt.fmt "\n"
+  |> ignore;
+  Executor.set_iowq_max_workers_hlt ~unbounded:8L ();
+  File.Fmt.stdout
+  |> Fmt.fmt "set_iowq_max_workers ~unbounded:8 -> "
+  |> pp_limits
+  |> Fmt.fmt "\n"
+  |> ignore;
+  (* Pool executors attach to the main executor's async backend. *)
+  let attached = Array.init (0L =:< 1L) ~f:(fun _ -> false) in
+  Executor.Pool.start_hlt ~conf ~n:1L ();
+  Executor.Pool.run 1L (fun () ->
+    Array.set_inplace 0L (Executor.conf ()).attach_wq attached
+  );
+  Executor.Pool.stop ();
+  File.Fmt.stdout
+  |> Fmt.fmt "pool attach_wq -> "
+  |> Bool.pp (Array.get 0L attached)
+  |> Fmt.fmt "\n"
+  |> ignore
+
+let _ = test ()
@@ -0,0 +1,34 @@
+open! Basis.Rudiments
+open! Basis
+
+let test () =
+  let n_producers = 2L in
+  let n = 1_000L in
+  Executor.Pool.start_hlt ~n:n_producers ();
+  (* Each producer sends enough messages to overflow the main executor's mailbox ring. *)
+  Range.Uns.iter (1L =:< (n_producers + 1L)) ~f:(fun i ->
+    Executor.Pool.run i (fun () ->
+      Executor.Mailbox.send ~n 0L i;
+      Executor.Mailbox.drain ()
+    )
+  );
+  Executor.Mailbox.send 0L 42L;
+  let payloads, _ = Executor.Mailbox.receive (n_producers * n + 1L) in
+  Executor.Pool.stop ();
+  Executor.Mailbox.drain ();
+  List.iter [1L; 2L; 42L] ~f:(fun payload ->
+    let count = Array.fold payloads ~init:0L ~f:(fun count payload' ->
+      match payload' = payload with
+      | true -> succ count
+      | false -> count
+    ) in
+    File.Fmt.stdout
+    |> Fmt.fmt "payload "
+    |> Uns.pp payload
+    |> Fmt.fmt " -> "
+    |> Uns.pp count
+    |> Fmt.fmt "\n"
+    |> ignore
+  )
+
+let _ = test ()
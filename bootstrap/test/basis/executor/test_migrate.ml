@@ -0,0 +1,31 @@
+open! Basis.Rudiments
+open! Basis
+
+let migrations () =
+  Range.Uns.fold (0L =:< Executor.length ()) ~init:0L ~f:(fun accum i ->
+    accum + (Executor.Stats.get i).migrations
+  )
+
+let test () =
+  let n = 16L in
+  (* Enough units that each actor outlasts several scheduling quanta, so that the main executor
+     offers its actors for migration while the pool executors are still idle. *)
+  let units = 100_000L in
+  let spin_main = Executor.Actor.spin ~n ~units in
+  File.Fmt.stdout
+  |> Fmt.fmt "migrations (no pool) -> "
+  |> Uns.pp (migrations ())
+  |> Fmt.fmt "\n"
+  |> ignore;
+  Executor.Pool.start_hlt ~n:2L ();
+  let spin_pool = Executor.Actor.spin ~n ~units in
+  File.Fmt.stdout
+  |> Fmt.fmt "migrations (pool) > 0 -> "
+  |> Bool.pp (migrations () > 0L)
+  |> Fmt.fmt "\nspin (pool) = spin (no pool) -> "
+  |> Bool.pp (Uns.(spin_pool = spin_main))
+  |> Fmt.fmt "\n"
+  |> ignore;
+  Executor.Pool.stop ()
+
+let _ = test ()
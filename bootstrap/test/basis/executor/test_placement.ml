@@ -0,0 +1,87 @@
+open! Basis.Rudiments
+open! Basis
+
+external topology: unit -> uns array array = "hemlock_basis_executor_topology_inner"
+external cpu: uns -> sint = "hemlock_basis_executor_cpu_inner"
+
+(* [|cpu; node; core|] of each CPU the process may run on, in ascending order. *)
+let cpus = topology ()
+
+let cpu_of triple = Array.get 0L triple
+let node_of triple = Array.get 1L triple
+let core_of triple = Array.get 2L triple
+
+let triple_of cpu =
+  match Array.find cpus ~f:(fun triple -> cpu_of triple = cpu) with
+  | Some triple -> triple
+  | None -> halt "Not a topology CPU"
+
+(* Whether [placement] prefers [triple] given the [prior] claims, most recent first. Depth-first
+   placement fills the node of the first claim before any other, and breadth-first placement claims
+   on a least claimed node, and within it on a least claimed core. *)
+let is_preferred placement prior triple =
+  let is_unclaimed t = not (List.for_any prior ~f:(fun p -> cpu_of p = cpu_of t)) in
+  let unclaimed = Array.filter cpus ~f:is_unclaimed in
+  match placement, List.rev prior with
+  | Executor.Placement.Depth_first, first :: _ ->
+    node_of triple = node_of first
+    || not (Array.for_any unclaimed ~f:(fun t -> node_of t = node_of first))
+  | Executor.Placement.Breadth_first, _ -> begin
+      let node_claims t = List.count prior ~f:(fun p -> node_of p = node_of t) in
+      let core_claims t = List.count prior ~f:(fun p -> core_of p = core_of t) in
+      Array.for_all unclaimed ~f:(fun t -> node_claims triple <= node_claims t)
+      && Array.for_all unclaimed ~f:(fun t ->
+        node_of t <> node_of triple || core_claims triple <= core_claims t)
+    end
+  | Executor.Placement.Depth_first, []
+  | Executor.Placement.Random, _ -> true
+
+let is_placed placement claims =
+  let _, placed = List.fold claims ~init:([], true) ~f:(fun (prior, placed) triple ->
+    triple :: prior, placed && is_preferred placement prior triple
+  ) in
+  placed
+
+let test () =
+  let n = 16L in
+  let units = 10L in
+  let spin_main = Executor.Actor.spin ~n ~units in
+  List.iter Executor.Placement.[Depth_first; Breadth_first; Random] ~f:(fun placement ->
+    Executor.Pool.start_hlt ~placement ~n:2L ();
+    let spin_pool = Executor.Actor.spin ~n ~units in
+    let length = Executor.length () in
+    let pool = Array.init (1L =:< length) ~f:(fun i -> triple_of (Uns.bits_of_sint (cpu i)))
+      |> Array.to_list in
+    (* The main executor claims a CPU first without being pinned to it, which for deterministic
+       placements is the first CPU. *)
+    let claims = match placement with
+      | Executor.Placement.Random -> pool
+      | Executor.Placement.Depth_first
+      | Executor.Placement.Breadth_first -> Array.get 0L cpus :: pool
+    in
+    (* Claims are reset once every CPU has been claimed. *)
+    let is_distinct = length > Array.length cpus || List.for_all claims ~f:(fun triple ->
+      List.count claims ~f:(fun t -> cpu_of t = cpu_of triple) = 1L) in
+    let ncpus = Array.init (1L =:< length) ~f:(fun _ -> 0L) in
+    Range.Uns.iter (1L =:< length) ~f:(fun i ->
+      Executor.Pool.run i (fun () -> Array.set_inplace (Uns.pred i) (Executor.ncpus ()) ncpus)
+    );
+    Executor.Pool.stop ();
+    File.Fmt.stdout
+    |> Fmt.fmt "placement="
+    |> Executor.Placement.pp placement
+    |> Fmt.fmt ": length="
+    |> Uns.pp length
+    |> Fmt.fmt " spin (pool) = spin (no pool) -> "
+    |> Bool.pp Uns.(spin_pool = spin_main)
+    |> Fmt.fmt "\n  distinct -> "
+    |> Bool.pp is_distinct
+    |> Fmt.fmt " placed -> "
+    |> Bool.pp (is_placed placement claims)
+    |> Fmt.fmt " pinned -> "
+    |> Bool.pp (Array.for_all ncpus ~f:(fun n -> n = 1L))
+    |> Fmt.fmt "\n"
+    |> ignore
+  )
+
+let _ = test ()
@@ -0,0 +1,44 @@
+open! Basis.Rudiments
+open! Basis
+
+let test () =
+  let n = 3L in
+  File.Fmt.stdout
+  |> Fmt.fmt "length (before start) -> "
+  |> Uns.pp (Executor.length ())
+  |> Fmt.fmt "\n"
+  |> ignore;
+  Executor.Pool.start_hlt ~n ();
+  File.Fmt.stdout
+  |> Fmt.fmt "length -> "
+  |> Uns.pp (Executor.length ())
+  |> Fmt.fmt "\nstart (running) -> "
+  |> Option.fmt Errno.pp (Executor.Pool.start ~n ())
+  |> Fmt.fmt "\n"
+  |> ignore;
+  (* Each closure does I/O on its own executor and records the executor it ran on. *)
+  let ids = Array.init (0L =:< n) ~f:(fun _ -> 0L) in
+  let nops = Array.init (0L =:< n) ~f:(fun _ -> 0L) in
+  Range.Uns.iter (1L =:< (n + 1L)) ~f:(fun i ->
+    Executor.Pool.run i (fun () ->
+      Array.set_inplace (i - 1L) (Executor.id ()) ids;
+      let file = File.of_path_hlt ~flag:File.Flag.R_O (Path.of_string "/dev/null") in
+      let buffer = File.read_hlt file in
+      Array.set_inplace (i - 1L) (Bytes.Slice.length buffer) nops;
+      File.close_hlt file
+    )
+  );
+  Executor.Pool.stop ();
+  File.Fmt.stdout
+  |> Fmt.fmt "ids -> "
+  |> (Array.fmt Uns.pp) ids
+  |> Fmt.fmt "\nlengths read -> "
+  |> (Array.fmt Uns.pp) nops
+  |> Fmt.fmt "\nid (main) -> "
+  |> Uns.pp (Executor.id ())
+  |> Fmt.fmt "\nlength (after stop) -> "
+  |> Uns.pp (Executor.length ())
+  |> Fmt.fmt "\n"
+  |> ignore
+
+let _ = test ()
@@ -0,0 +1,39 @@
+open! Basis.Rudiments
+open! Basis
+
+external nop_submit: unit -> (sint * uns) = "hemlock_basis_executor_nop_submit_inner"
+external complete: uns -> sint = "hemlock_basis_executor_complete_inner"
+external user_data_decref: uns -> unit = "hemlock_basis_executor_user_data_decref"
+
+let pp_setup conf formatter =
+  match Executor.setup conf with
+  | None -> formatter |> Fmt.fmt "None"
+  | Some error -> formatter |> Fmt.fmt "Some " |> Errno.pp error
+
+let pp_conf formatter =
+  let Executor.Conf.{sq_entries; cq_entries; _} = Executor.conf () in
+  formatter
+  |> Fmt.fmt "sq_entries="
+  |> Uns.pp sq_entries
+  |> Fmt.fmt " cq_entries="
+  |> Uns.pp cq_entries
+
+let test () =
+  let conf = Executor.Conf.{default with sq_entries=64L; cq_entries=256L} in
+  let _, user_data = nop_submit () in
+  File.Fmt.stdout
+  |> Fmt.fmt "setup (in flight) -> "
+  |> pp_setup conf
+  |> Fmt.fmt "\n"
+  |> ignore;
+  let _ = complete user_data in
+  user_data_decref user_data;
+  File.Fmt.stdout
+  |> Fmt.fmt "setup (quiescent) -> "
+  |> pp_setup conf
+  |> Fmt.fmt "\n"
+  |> pp_conf
+  |> Fmt.fmt "\n"
+  |> ignore
+
+let _ = test ()
@@ -0,0 +1,54 @@
+open! Basis.Rudiments
+open! Basis
+
+external nop_submit: unit -> (sint * uns) = "hemlock_basis_executor_nop_submit_inner"
+external complete: uns -> sint = "hemlock_basis_executor_complete_inner"
+external user_data_decref: uns -> unit = "hemlock_basis_executor_user_data_decref"
+external user_data_slab: unit -> uns array = "hemlock_basis_executor_user_data_slab_inner"
+
+(* Fields of [user_data_slab ()]. *)
+let n_slabs slab = Array.get 0L slab
+let n_allocs slab = Array.get 1L slab
+let n_live slab = Array.get 2L slab
+
+(* Enough nops in flight at once to span several slabs. *)
+let burst = 256L
+
+let submit n =
+  Array.init (0L =:< n) ~f:(fun _ -> let _, user_data = nop_submit () in user_data)
+
+let drain user_datas =
+  Array.iter user_datas ~f:(fun user_data ->
+    let _ : sint = complete user_data in
+    user_data_decref user_data
+  )
+
+let test () =
+  (* Sample the slab before printing anything, since output is itself submitted to the executor. *)
+  let slab0 = user_data_slab () in
+  let user_datas = submit burst in
+  let slab1 = user_data_slab () in
+  drain user_datas;
+  let slab2 = user_data_slab () in
+  drain (submit burst);
+  let slab3 = user_data_slab () in
+  Range.Uns.iter (0L =:< 100L) ~f:(fun _ -> drain (submit 32L));
+  let slab4 = user_data_slab () in
+  let is_reused slab = n_slabs slab = n_slabs slab1 && n_live slab = n_live slab0 in
+  File.Fmt.stdout
+  |> Fmt.fmt "burst live -> "
+  |> Uns.pp (n_live slab1 - n_live slab0)
+  |> Fmt.fmt "\nburst grew -> "
+  |> Bool.pp (n_slabs slab1 > n_slabs slab0)
+  |> Fmt.fmt "\ndrained -> "
+  |> Bool.pp (is_reused slab2)
+  |> Fmt.fmt "\nreburst reused -> "
+  |> Bool.pp (is_reused slab3)
+  |> Fmt.fmt "\ncycles reused -> "
+  |> Bool.pp (is_reused slab4)
+  |> Fmt.fmt "\nallocs -> "
+  |> Uns.pp (n_allocs slab4 - n_allocs slab0)
+  |> Fmt.fmt "\n"
+  |> ignore
+
+let _ = test ()
@@ -0,0 +1,28 @@
+open! Basis.Rudiments
+open! Basis
+
+let test () =
+  let pp_stats i =
+    let stats = Executor.Stats.get i in
+    File.Fmt.stdout
+    |> Fmt.fmt "executor "
+    |> Uns.pp i
+    |> Fmt.fmt ": runnable="
+    |> Uns.pp stats.runnable
+    |> Fmt.fmt " inflight="
+    |> Uns.pp stats.inflight
+    |> Fmt.fmt " idle_in_range="
+    |> Bool.pp Real.(stats.idle >= 0. && stats.idle <= 1.)
+    |> Fmt.fmt " unloaded="
+    |> Bool.pp Real.(Executor.Stats.load stats = 0.)
+    |> Fmt.fmt "\n"
+    |> ignore
+  in
+  pp_stats 0L;
+  let _ : uns = Executor.Actor.pingpong ~n:1000L ~active:10L ~rounds:100L in
+  pp_stats 0L;
+  Executor.Pool.start_hlt ~n:2L ();
+  Range.Uns.iter (Range.Uns.( =:< ) 0L (Executor.length ())) ~f:(fun i -> pp_stats i);
+  Executor.Pool.stop ()
+
+let _ = test ()
@@ -0,0 +1,37 @@
+open! Basis.Rudiments
+open! Basis
+
+let test () =
+  let path = Path.of_string "./stats_dump" in
+  let file = File.of_path_hlt ~flag:File.Flag.W path in
+  Executor.Stats.dump_start ~interval_ms:1L (File.fd file);
+  (* Restart the pool while the dump thread runs, so that it observes executors being removed, until
+     it has dumped at least once. *)
+  let rec churn i =
+    Executor.Pool.start_hlt ~n:2L ();
+    Executor.Pool.stop ();
+    match i = 0L || (Os.statx_hlt path).Os.Stat.size > 0L with
+    | true -> ()
+    | false -> churn (Uns.pred i)
+  in
+  churn 100_000L;
+  Executor.Stats.dump_stop ();
+  File.close_hlt file;
+  let lines = File.Mmap.of_path_hlt path
+    |> Bytes.Slice.to_string_hlt
+    |> String.split_lines
+    |> List.filter ~f:(fun line -> String.(line <> "")) in
+  let is_valid line =
+    String.is_prefix ~prefix:"t=" line
+    && Option.is_some (String.substr_find ~pattern:" executor=" line)
+    && Option.is_some (String.substr_find ~pattern:" migrations=" line)
+  in
+  File.Fmt.stdout
+  |> Fmt.fmt "dumped -> "
+  |> Bool.pp (List.length lines > 0L)
+  |> Fmt.fmt "\nlines valid -> "
+  |> Bool.pp (List.for_all lines ~f:is_valid)
+  |> Fmt.fmt "\n"
+  |> ignore
+
+let _ = test ()
@@ -0,0 +1,56 @@
+open! Basis.Rudiments
+open! Basis
+
+let slice_of_string s =
+  Bytes.Slice.of_string_slice (String.C.Slice.of_string s)
+
+let pp_result result formatter =
+  match result with
+  | Ok buffer -> formatter |> Fmt.fmt (Bytes.Slice.to_string_hlt buffer)
+  | Error error -> formatter |> Errno.pp error
+
+let test () =
+  let file = File.of_path_hlt ~flag:File.Flag.RW (Path.of_string "./file_cancel") in
+  File.write_hlt (slice_of_string "0123456789abcdef") file;
+  (* A generous timeout does not interfere with a read that completes promptly. *)
+  let read = File.Read.submit_hlt ~n:4L ~off:0L ~timeout:10_000_000_000L file in
+  File.Fmt.stdout
+  |> Fmt.fmt "Read ~timeout -> "
+  |> pp_result (File.Read.complete read)
+  |> Fmt.fmt "\n"
+  |> ignore;
+  (* Cancelling a complete read is a no-op. *)
+  File.Fmt.stdout
+  |> Fmt.fmt "Read.cancel (complete) -> "
+  |> (Option.fmt Errno.pp) (File.Read.cancel read)
+  |> Fmt.fmt " "
+  |> pp_result (File.Read.complete read)
+  |> Fmt.fmt "\n"
+  |> ignore;
+  (* A read cancelled in flight may or may not have completed beforehand, but it completes either
+     way, and the cancellation's ref on it keeps it valid even if it is dropped right away. *)
+  let reads = List.map [12L; 8L; 4L; 0L] ~f:(fun off -> File.Read.submit_hlt ~n:4L ~off file) in
+  List.iter reads ~f:File.Read.cancel_hlt;
+  let all_ok = List.for_all reads ~f:(fun read ->
+    match File.Read.complete read with
+    | Ok _ -> true
+    | Error Errno.ECANCELED -> true
+    | Error _ -> false
+  ) in
+  File.Fmt.stdout
+  |> Fmt.fmt "Read.cancel (in flight) -> "
+  |> Bool.pp all_ok
+  |> Fmt.fmt "\n"
+  |> ignore;
+  List.iter [0L; 4L] ~f:(fun off -> File.Read.(submit_hlt ~n:4L ~off file |> cancel_hlt));
+  Stdlib.Gc.full_major ();
+  let write = File.Write.submit_hlt ~off:0L ~timeout:10_000_000_000L (slice_of_string "XYZ") file in
+  let _ = File.Write.complete_hlt write in
+  File.Fmt.stdout
+  |> Fmt.fmt "Write ~timeout -> "
+  |> pp_result File.Read.(submit_hlt ~n:16L ~off:0L file |> complete)
+  |> Fmt.fmt "\n"
+  |> ignore;
+  File.close_hlt file
+
+let _ = test ()
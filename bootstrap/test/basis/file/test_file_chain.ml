@@ -0,0 +1,31 @@
+open! Basis.Rudiments
+open! Basis
+
+let test () =
+  let path = Path.of_string "./file_chain" in
+  let buffer = Bytes.Slice.of_string_slice (String.C.Slice.of_string "Hello, chain!\n") in
+  let write = File.Chain.Write.submit_hlt buffer path in
+  let remaining = File.Chain.Write.complete_hlt write in
+  File.Fmt.stdout
+  |> Fmt.fmt "Chain.Write -> remaining="
+  |> Uns.pp (Bytes.Slice.length remaining)
+  |> Fmt.fmt "\n"
+  |> ignore;
+  let read = File.Chain.Read.submit_hlt path in
+  let buffer = File.Chain.Read.complete_hlt read in
+  File.Fmt.stdout
+  |> Fmt.fmt "Chain.Read -> "
+  |> Fmt.fmt (Bytes.Slice.to_string_hlt buffer)
+  |> ignore;
+  let read = File.Chain.Read.submit_hlt (Path.of_string "./file_chain_nonexistent") in
+  File.Fmt.stdout
+  |> Fmt.fmt "Chain.Read (nonexistent) -> "
+  |> (fun formatter ->
+    match File.Chain.Read.complete read with
+    | Ok _ -> formatter |> Fmt.fmt "Ok"
+    | Error error -> formatter |> Fmt.fmt "Error " |> Errno.pp error
+  )
+  |> Fmt.fmt "\n"
+  |> ignore
+
+let _ = test ()
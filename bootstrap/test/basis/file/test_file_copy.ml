@@ -0,0 +1,45 @@
+open! Basis.Rudiments
+open! Basis
+
+let slice_of_string s =
+  Bytes.Slice.of_string_slice (String.C.Slice.of_string s)
+
+let pp_result result formatter =
+  match result with
+  | Ok n -> formatter |> Uns.pp n
+  | Error error -> formatter |> Errno.pp error
+
+let test_copy name src_path dst_path copy =
+  let src = File.of_path_hlt src_path in
+  let dst = File.of_path_hlt ~flag:File.Flag.W dst_path in
+  let result = copy src dst in
+  File.close_hlt src;
+  File.close_hlt dst;
+  File.Fmt.stdout
+  |> Fmt.fmt name
+  |> Fmt.fmt " -> "
+  |> pp_result result
+  |> Fmt.fmt " "
+  |> String.pp (Bytes.Slice.to_string_hlt (File.Mmap.of_path_hlt dst_path))
+  |> Fmt.fmt "\n"
+  |> ignore
+
+let test () =
+  let src_path = Path.of_string "./file_copy_src" in
+  let dst_path = Path.of_string "./file_copy_dst" in
+  let file = File.of_path_hlt ~flag:File.Flag.W src_path in
+  File.write_hlt (slice_of_string "Hello\ncopy\n") file;
+  File.close_hlt file;
+  test_copy "copy" src_path dst_path (fun src dst -> File.copy src dst);
+  test_copy "copy ~n:5" src_path dst_path (fun src dst -> File.copy ~n:5L src dst);
+  test_copy "copy ~kernel:false" src_path dst_path (fun src dst -> File.copy ~kernel:false src dst);
+  test_copy "copy ~n:5 ~kernel:false" src_path dst_path
+    (fun src dst -> File.copy ~n:5L ~kernel:false src dst);
+  test_copy "splice" src_path dst_path (fun src dst -> File.splice src dst);
+  test_copy "splice ~n:5" src_path dst_path (fun src dst -> File.splice ~n:5L src dst);
+  (* Depending on the kernel, copy_file_range(2) of procfs files fails or reports 0 bytes copied
+     despite the files not being empty. *)
+  test_copy "copy (procfs)" (Path.of_string "/proc/sys/kernel/ostype") dst_path
+    (fun src dst -> File.copy src dst)
+
+let _ = test ()
@@ -0,0 +1,97 @@
+open! Basis.Rudiments
+open! Basis
+
+let slice_of_string s =
+  Bytes.Slice.of_string_slice (String.C.Slice.of_string s)
+
+(* The alignment depends on the filesystem, and is 0 where direct I/O is unsupported. *)
+let is_valid_align align n =
+  align = 0L || Uns.(n % align) = 0L
+
+let rec consume n t =
+  match Lazy.force t with
+  | Stream.Nil -> n
+  | Stream.Cons(buffer, t') -> consume (n + Bytes.Slice.length buffer) t'
+
+let test () =
+  let path = Path.of_string "./file_direct" in
+  let file = File.of_path_hlt ~flag:File.Flag.W ~direct:true path in
+  let buffer = File.Direct.buffer 8192L file in
+  Stdlib.Bigarray.Array1.fill (Bytes.Slice.container buffer) 'x';
+  File.Fmt.stdout
+  |> Fmt.fmt "Direct.align -> "
+  |> Bool.pp (is_valid_align (File.Direct.align file) 8192L)
+  |> Fmt.fmt "\n"
+  |> Fmt.fmt "Direct.buffer -> "
+  |> Uns.pp (Bytes.Slice.length buffer)
+  |> Fmt.fmt "\n"
+  |> ignore;
+  File.write_hlt buffer file;
+  (* A misaligned write fails rather than reverting the file to buffered I/O, whereas files that
+     perform buffered I/O accept any alignment. *)
+  let align = File.Direct.align file in
+  let error = File.write (slice_of_string "tail\n") file in
+  File.Fmt.stdout
+  |> Fmt.fmt "write (misaligned) -> "
+  |> Bool.pp (match align, error with
+    | 0L, None
+    | _, Some Errno.EINVAL -> true
+    | _ -> false
+  )
+  |> Fmt.fmt "\n"
+  |> Fmt.fmt "Direct.align (misaligned) -> "
+  |> Bool.pp (File.Direct.align file = align)
+  |> Fmt.fmt "\n"
+  |> ignore;
+  File.close_hlt file;
+  (* A file that reuses the descriptor of a closed direct I/O file performs buffered I/O. *)
+  let file = File.of_path_hlt ~flag:File.Flag.W_A path in
+  File.Fmt.stdout
+  |> Fmt.fmt "Direct.align (reopened) -> "
+  |> Uns.pp (File.Direct.align file)
+  |> Fmt.fmt "\n"
+  |> ignore;
+  let () = match align with
+    | 0L -> ()
+    | _ -> File.write_hlt (slice_of_string "tail\n") file
+  in
+  File.close_hlt file;
+  let file = File.of_path_hlt ~direct:true path in
+  let bytes = File.Mmap.of_path_hlt path in
+  let tail = Bytes.Slice.of_cursors ~base:Bytes.(Cursor.seek 8190L (Slice.base bytes))
+      ~past:(Bytes.Slice.past bytes) in
+  File.Fmt.stdout
+  |> Fmt.fmt "Stream.of_file -> "
+  |> Uns.pp (consume 0L (File.Stream.of_file file))
+  |> Fmt.fmt "\n"
+  |> Fmt.fmt "Mmap.of_path -> "
+  |> String.pp (Bytes.Slice.to_string_hlt tail)
+  |> Fmt.fmt "\n"
+  |> ignore;
+  (* Exclusive creation succeeds exactly once, whether or not the filesystem supports direct I/O. *)
+  let path = Path.of_string "./file_direct_c" in
+  let _ = Os.unlinkat path in
+  let created = match File.of_path ~flag:File.Flag.W_C ~direct:true path with
+    | Error _ -> false
+    | Ok file -> begin
+        File.write_hlt (File.Direct.buffer 8192L file) file;
+        File.close_hlt file;
+        true
+      end
+  in
+  File.Fmt.stdout
+  |> Fmt.fmt "of_path ~flag:W_C -> "
+  |> Bool.pp created
+  |> Fmt.fmt "\n"
+  |> ignore;
+  File.Fmt.stdout
+  |> Fmt.fmt "of_path ~flag:W_C (exists) -> "
+  |> Bool.pp (match File.of_path ~flag:File.Flag.W_C ~direct:true path with
+    | Error Errno.EEXIST -> true
+    | _ -> false
+  )
+  |> Fmt.fmt "\n"
+  |> ignore;
+  Os.unlinkat_hlt path
+
+let _ = test ()
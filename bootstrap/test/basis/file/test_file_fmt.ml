@@ -0,0 +1,39 @@
+open! Basis.Rudiments
+open! Basis
+
+let slice_of_string s =
+  Bytes.Slice.of_string_slice (String.C.Slice.of_string s)
+
+let contents file =
+  Bytes.Slice.to_string_hlt File.Read.(submit_hlt ~n:64L ~off:0L file |> complete_hlt)
+
+let test () =
+  let file = File.of_path_hlt ~flag:File.Flag.RW (Path.of_string "./file_fmt") in
+  let writev = File.Writev.submit_hlt [slice_of_string "01"; slice_of_string "234"] file in
+  List.iter (File.Writev.complete_hlt writev) ~f:(fun remainder ->
+    File.Fmt.stdout
+    |> Fmt.fmt "Writev remainder -> \""
+    |> Fmt.fmt (Bytes.Slice.to_string_hlt remainder)
+    |> Fmt.fmt "\"\n"
+    |> ignore
+  );
+  (* Strings both smaller and larger than the buffers, so that buffers fill while writes are in
+     flight. *)
+  let formatter = File.Fmt.of_t ~bufsize:4L ~nbufs:3L file in
+  let formatter = List.fold ["5"; "67"; "89abcdefghij"; "k"; "lmnopqrs"; "t"] ~init:formatter
+      ~f:(fun formatter s -> Fmt.fmt s formatter) in
+  let _ = Fmt.flush formatter in
+  File.Fmt.stdout
+  |> Fmt.fmt "Fmt ~nbufs:3 -> "
+  |> Fmt.fmt (contents file)
+  |> Fmt.fmt "\n"
+  |> ignore;
+  let _ = formatter |> Fmt.fmt "uvwxy" |> Fmt.flush in
+  File.Fmt.stdout
+  |> Fmt.fmt "Fmt ~nbufs:3 -> "
+  |> Fmt.fmt (contents file)
+  |> Fmt.fmt "\n"
+  |> ignore;
+  File.close_hlt file
+
+let _ = test ()
@@ -0,0 +1,50 @@
+open! Basis.Rudiments
+open! Basis
+
+let slice_of_string s =
+  Bytes.Slice.of_string_slice (String.C.Slice.of_string s)
+
+let pp_result result formatter =
+  match result with
+  | Ok bytes -> formatter |> String.pp (Bytes.Slice.to_string_hlt bytes)
+  | Error error -> formatter |> Errno.pp error
+
+let test () =
+  let path = Path.of_string "./file_mmap" in
+  let file = File.of_path_hlt ~flag:File.Flag.W path in
+  File.write_hlt (slice_of_string "Hello\nmmap\n") file;
+  File.close_hlt file;
+  File.Fmt.stdout
+  |> Fmt.fmt "Mmap.of_path -> "
+  |> pp_result (File.Mmap.of_path path)
+  |> Fmt.fmt "\n"
+  |> Fmt.fmt "Mmap.of_path ~populate:true -> "
+  |> pp_result (File.Mmap.of_path ~populate:true path)
+  |> Fmt.fmt "\n"
+  |> ignore;
+  (* Mappings outlive collections as long as they are reachable, and are unmapped after. *)
+  let bytes = File.Mmap.of_path_hlt path in
+  Stdlib.Gc.full_major ();
+  let text = Text.of_bytes_slice ~path bytes in
+  let slice = Text.(Slice.init ~base:(Cursor.hd text) ~past:(Cursor.tl text) text) in
+  File.Fmt.stdout
+  |> Fmt.fmt "Text.of_bytes_slice -> "
+  |> String.pp (Text.Slice.to_string slice)
+  |> Fmt.fmt "\n"
+  |> ignore;
+  let file = File.of_path_hlt ~flag:File.Flag.W path in
+  File.close_hlt file;
+  File.Fmt.stdout
+  |> Fmt.fmt "Mmap.of_path (empty) -> "
+  |> pp_result (File.Mmap.of_path path)
+  |> Fmt.fmt "\n"
+  |> Fmt.fmt "Mmap.of_path (directory) -> "
+  |> pp_result (File.Mmap.of_path (Path.of_string "."))
+  |> Fmt.fmt "\n"
+  |> Fmt.fmt "Mmap.of_path (missing) -> "
+  |> pp_result (File.Mmap.of_path (Path.of_string "./file_mmap_missing"))
+  |> Fmt.fmt "\n"
+  |> ignore;
+  Stdlib.Gc.full_major ()
+
+let _ = test ()
@@ -0,0 +1,38 @@
+open! Basis.Rudiments
+open! Basis
+
+let slice_of_string s =
+  Bytes.Slice.of_string_slice (String.C.Slice.of_string s)
+
+let buffer n =
+  Bytes.(Slice.init (init (0L =:< n) ~f:(fun _ -> Byte.kv 0L)))
+
+let test () =
+  let file = File.of_path_hlt ~flag:File.Flag.RW (Path.of_string "./file_pread") in
+  File.write_hlt (slice_of_string "0123456789abcdef") file;
+  (* Submit all reads before completing any, in reverse offset order. *)
+  let reads = List.map [12L; 8L; 4L; 0L] ~f:(fun off -> File.Read.submit_hlt ~n:4L ~off file) in
+  List.iter reads ~f:(fun read ->
+    File.Fmt.stdout
+    |> Fmt.fmt "Read ~off -> "
+    |> Fmt.fmt (Bytes.Slice.to_string_hlt (File.Read.complete_hlt read))
+    |> Fmt.fmt "\n"
+    |> ignore
+  );
+  let pread = File.Pread.submit_hlt ~off:2L [buffer 3L; buffer 5L; buffer 100L] file in
+  List.iter (File.Pread.complete_hlt pread) ~f:(fun buffer ->
+    File.Fmt.stdout
+    |> Fmt.fmt "Pread -> \""
+    |> Fmt.fmt (Bytes.Slice.to_string_hlt buffer)
+    |> Fmt.fmt "\"\n"
+    |> ignore
+  );
+  let _ = File.Write.(submit_hlt ~off:0L (slice_of_string "XYZ") file |> complete_hlt) in
+  File.Fmt.stdout
+  |> Fmt.fmt "Write ~off -> "
+  |> Fmt.fmt (Bytes.Slice.to_string_hlt File.Read.(submit_hlt ~n:16L ~off:0L file |> complete_hlt))
+  |> Fmt.fmt "\n"
+  |> ignore;
+  File.close_hlt file
+
+let _ = test ()
@@ -0,0 +1,44 @@
+open! Basis.Rudiments
+open! Basis
+
+let slice_of_string s =
+  Bytes.Slice.of_string_slice (String.C.Slice.of_string s)
+
+let pp_result result formatter =
+  match result with
+  | Ok buffer -> formatter |> String.pp (Bytes.Slice.to_string_hlt buffer)
+  | Error error -> formatter |> Errno.pp error
+
+let test () =
+  let file = File.of_path_hlt ~flag:File.Flag.RW (Path.of_string "./file_select") in
+  File.write_hlt (slice_of_string "0123456789abcdef") file;
+  File.Fmt.stdout
+  |> Fmt.fmt "Read.submit_select -> "
+  |> pp_result File.Read.(submit_select_hlt ~n:4L ~off:2L file |> complete)
+  |> Fmt.fmt "\n"
+  |> Fmt.fmt "Read.submit_select (EOF) -> "
+  |> pp_result File.Read.(submit_select_hlt ~off:16L file |> complete)
+  |> Fmt.fmt "\n"
+  |> ignore;
+  (* Provided buffers return to the ring once reads and their slices are collected, so that many
+     more reads than there are provided buffers succeed. *)
+  let all_ok = Range.Uns.fold (0L =:< 1024L) ~init:true ~f:(fun all_ok i ->
+    let () = match Uns.(i % 64L) with
+      | 0L -> Stdlib.Gc.full_major ()
+      | _ -> ()
+    in
+    let off = Uns.(i % 16L) in
+    let expected = File.Read.(submit_hlt ~n:1L ~off file |> complete_hlt) in
+    match File.Read.(submit_select_hlt ~n:1L ~off file |> complete) with
+    | Ok buffer -> all_ok && String.(Bytes.Slice.to_string_hlt buffer
+        = Bytes.Slice.to_string_hlt expected)
+    | Error _ -> false
+  ) in
+  File.Fmt.stdout
+  |> Fmt.fmt "Read.submit_select (x1024) -> "
+  |> Bool.pp all_ok
+  |> Fmt.fmt "\n"
+  |> ignore;
+  File.close_hlt file
+
+let _ = test ()
@@ -0,0 +1,60 @@
+open! Basis.Rudiments
+open! Basis
+
+let slice_of_string s =
+  Bytes.Slice.of_string_slice (String.C.Slice.of_string s)
+
+let empty = Bytes.Slice.init (Bytes.create 0L)
+
+let pp_buffers buffers formatter =
+  formatter |> (Array.fmt String.pp) (Array.map buffers ~f:Bytes.Slice.to_string_hlt)
+
+(* Read [path] in four 4-byte buffer-selecting reads into [buffers]. *)
+let select_reads path buffers =
+  let file = File.of_path_hlt (Path.of_string path) in
+  Array.iteri buffers ~f:(fun i _ ->
+    let buffer = File.Read.(submit_select_hlt ~n:4L ~off:Uns.(i * 4L) file |> complete_hlt) in
+    Array.set_inplace i buffer buffers
+  );
+  File.close_hlt file
+
+let test () =
+  let path = "./file_select_stop" in
+  let file = File.of_path_hlt ~flag:File.Flag.W (Path.of_string path) in
+  File.write_hlt (slice_of_string "0123456789abcdef") file;
+  File.close_hlt file;
+  (* The bytes of buffer-selecting reads on a pool executor outlive the executor's provided buffer
+     ring. *)
+  let kept = Array.init (0L =:< 4L) ~f:(fun _ -> empty) in
+  Executor.Pool.start_hlt ~n:1L ();
+  Executor.Pool.run 1L (fun () -> select_reads path kept);
+  Executor.Pool.stop ();
+  File.Fmt.stdout
+  |> Fmt.fmt "after stop -> "
+  |> pp_buffers kept
+  |> Fmt.fmt "\n"
+  |> ignore;
+  (* Dropping them once the pool has restarted must not return their buffers to the new ring, which
+     would then hand out the same buffer twice. *)
+  Executor.Pool.start_hlt ~n:1L ();
+  Array.iteri kept ~f:(fun i _ -> Array.set_inplace i empty kept);
+  Stdlib.Gc.full_major ();
+  let results = Array.init (0L =:< 1L) ~f:(fun _ -> false) in
+  Executor.Pool.run 1L (fun () ->
+    let all_ok = Range.Uns.fold (0L =:< 256L) ~init:true ~f:(fun all_ok _ ->
+      let buffers = Array.init (0L =:< 4L) ~f:(fun _ -> empty) in
+      select_reads path buffers;
+      all_ok && String.(Array.fold buffers ~init:"" ~f:(fun s buffer ->
+        s ^ Bytes.Slice.to_string_hlt buffer) = "0123456789abcdef")
+    ) in
+    Array.set_inplace 0L all_ok results
+  );
+  Executor.Pool.stop ();
+  Stdlib.Gc.full_major ();
+  File.Fmt.stdout
+  |> Fmt.fmt "after restart (x256) -> "
+  |> Bool.pp (Array.get 0L results)
+  |> Fmt.fmt "\n"
+  |> ignore
+
+let _ = test ()
@@ -0,0 +1,55 @@
+open! Basis.Rudiments
+open! Basis
+
+let slice_of_string s =
+  Bytes.Slice.of_string_slice (String.C.Slice.of_string s)
+
+let pp_error_opt error_opt formatter =
+  match error_opt with
+  | None -> formatter |> Fmt.fmt "None"
+  | Some error -> formatter |> Errno.pp error
+
+let pp_size path formatter =
+  formatter |> Uns.pp (Os.statx_hlt path).Os.Stat.size
+
+let test () =
+  let path = Path.of_string "./file_sync" in
+  let file = File.of_path_hlt ~flag:File.Flag.W path in
+  File.write_hlt (slice_of_string "Hello\n") file;
+  File.Fmt.stdout
+  |> Fmt.fmt "fsync -> "
+  |> pp_error_opt (File.fsync file)
+  |> Fmt.fmt "\n"
+  |> Fmt.fmt "fsync ~datasync:true -> "
+  |> pp_error_opt (File.fsync ~datasync:true file)
+  |> Fmt.fmt "\n"
+  |> Fmt.fmt "fallocate ~keep_size:true -> "
+  |> pp_error_opt (File.fallocate ~keep_size:true ~off:0L ~n:65536L file)
+  |> Fmt.fmt " size="
+  |> pp_size path
+  |> Fmt.fmt "\n"
+  |> Fmt.fmt "fallocate -> "
+  |> pp_error_opt (File.fallocate ~off:4096L ~n:4096L file)
+  |> Fmt.fmt " size="
+  |> pp_size path
+  |> Fmt.fmt "\n"
+  |> ignore;
+  (* Submissions complete independently of one another. *)
+  let fsyncs = List.map [file; file; file] ~f:(fun file -> File.Fsync.submit_hlt file) in
+  let complete, pending = File.Fsync.wait_n_hlt 3L fsyncs in
+  List.iter complete ~f:File.Fsync.complete_hlt;
+  File.Fmt.stdout
+  |> Fmt.fmt "Fsync.wait_n -> "
+  |> Uns.pp (List.length complete)
+  |> Fmt.fmt " "
+  |> Uns.pp (List.length pending)
+  |> Fmt.fmt "\n"
+  |> ignore;
+  File.close_hlt file;
+  File.Fmt.stdout
+  |> Fmt.fmt "fsync (closed) -> "
+  |> pp_error_opt (File.fsync file)
+  |> Fmt.fmt "\n"
+  |> ignore
+
+let _ = test ()
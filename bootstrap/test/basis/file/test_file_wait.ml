@@ -0,0 +1,42 @@
+open! Basis.Rudiments
+open! Basis
+
+let pp_partition (complete, pending) formatter =
+  formatter
+  |> Fmt.fmt "complete="
+  |> Uns.pp (List.length complete)
+  |> Fmt.fmt " pending="
+  |> Uns.pp (List.length pending)
+
+let test () =
+  let path = Path.of_string "./file_wait" in
+  let submit () = File.Open.submit_hlt ~flag:File.Flag.W path in
+  let opens = [submit (); submit (); submit ()] in
+  let partition = File.Open.wait_n_hlt 3L opens in
+  File.Fmt.stdout
+  |> Fmt.fmt "Open.wait_n 3 -> "
+  |> pp_partition partition
+  |> Fmt.fmt "\n"
+  |> ignore;
+  let partition = File.Open.wait_any_hlt opens in
+  File.Fmt.stdout
+  |> Fmt.fmt "Open.wait_any (complete) -> "
+  |> pp_partition partition
+  |> Fmt.fmt "\n"
+  |> ignore;
+  let closes = List.map opens ~f:(fun open' -> File.(Close.submit_hlt (Open.complete_hlt open'))) in
+  let complete, _pending = File.Close.wait_any_hlt closes in
+  File.Fmt.stdout
+  |> Fmt.fmt "Close.wait_any -> "
+  |> Bool.pp (List.length complete > 0L)
+  |> Fmt.fmt "\n"
+  |> ignore;
+  let partition = File.Close.wait_n_hlt ~timeout:1_000_000_000L 3L closes in
+  File.Fmt.stdout
+  |> Fmt.fmt "Close.wait_n ~timeout 3 -> "
+  |> pp_partition partition
+  |> Fmt.fmt "\n"
+  |> ignore;
+  List.iter closes ~f:File.Close.complete_hlt
+
+let _ = test ()
@@ -0,0 +1,63 @@
+open! Basis.Rudiments
+open! Basis
+
+let slice_of_string s =
+  Bytes.Slice.of_string_slice (String.C.Slice.of_string s)
+
+let contents file =
+  Bytes.Slice.to_string_hlt (File.Mmap.of_file_hlt file)
+
+let words n =
+  List.init (0L =:< n) ~f:(fun i -> String.join [Uns.to_string ~zpad:true ~width:4L i; ","])
+
+let pp_result name expected file =
+  let contents = contents file in
+  File.Fmt.stdout
+  |> Fmt.fmt name
+  |> Fmt.fmt " -> length="
+  |> Uns.pp (String.B.length contents)
+  |> Fmt.fmt " match="
+  |> Bool.pp String.(contents = expected)
+  |> Fmt.fmt "\n"
+  |> ignore
+
+let test () =
+  let path = Path.of_string "./file_writev" in
+
+  (* Many small buffers, each in its own container, gathered by a single write. *)
+  let file = File.of_path_hlt ~flag:File.Flag.RW path in
+  let words = words 256L in
+  let remainders =
+    File.Writev.(submit_hlt ~off:0L (List.map words ~f:slice_of_string) file |> complete_hlt) in
+  File.Fmt.stdout
+  |> Fmt.fmt "Writev remainders empty -> "
+  |> Bool.pp (List.for_all remainders ~f:(fun remainder -> Bytes.Slice.length remainder = 0L))
+  |> Fmt.fmt "\n"
+  |> ignore;
+  pp_result "Writev (256 buffers)" (String.join words) file;
+  File.close_hlt file;
+
+  (* One buffer refilled and rewritten once each write completes. Writes are submitted straight
+     from the buffer, so completion must imply that the kernel is done with it. *)
+  let file = File.of_path_hlt ~flag:File.Flag.RW path in
+  let buf = Bytes.create 5L in
+  List.iter words ~f:(fun word ->
+    Bytes.Slice.blit_of_string 0L word (Bytes.Slice.init buf);
+    let _ : Bytes.Slice.t list =
+      File.Writev.(submit_hlt [Bytes.Slice.init buf] file |> complete_hlt) in
+    ()
+  );
+  pp_result "Writev (reused buffer)" (String.join words) file;
+  File.close_hlt file;
+
+  (* Many small strings through a formatter with two small buffers, which must be recycled, and
+     which fill while writes are in flight, so that queued buffers are coalesced. *)
+  let file = File.of_path_hlt ~flag:File.Flag.RW path in
+  let words = words 1024L in
+  let formatter = File.Fmt.of_t ~bufsize:8L ~nbufs:2L file in
+  let _ = List.fold words ~init:formatter ~f:(fun formatter word -> Fmt.fmt word formatter)
+    |> Fmt.flush in
+  pp_result "Fmt ~bufsize:8 ~nbufs:2" (String.join words) file;
+  File.close_hlt file
+
+let _ = test ()
@@ -0,0 +1,74 @@
+open! Basis.Rudiments
+open! Basis
+
+let pp_error_opt error_opt formatter =
+  match error_opt with
+  | None -> formatter |> Fmt.fmt "None"
+  | Some error -> formatter |> Errno.pp error
+
+let pp_stat result formatter =
+  match result with
+  | Ok (stat: Os.Stat.t) ->
+    formatter
+    |> Fmt.fmt "is_dir=" |> Bool.pp (Os.Stat.is_dir stat)
+    |> Fmt.fmt " is_file=" |> Bool.pp (Os.Stat.is_file stat)
+    |> Fmt.fmt " size=" |> Uns.pp (match Os.Stat.is_file stat with
+      | true -> stat.Os.Stat.size
+      | false -> 0L)
+  | Error error -> formatter |> Errno.pp error
+
+let test () =
+  let dir = Path.of_string "./os_dir" in
+  let a = Path.of_string "./os_dir/a" in
+  let b = Path.of_string "./os_dir/b" in
+  File.Fmt.stdout
+  |> Fmt.fmt "mkdirat -> "
+  |> pp_error_opt (Os.mkdirat dir)
+  |> Fmt.fmt "\n"
+  |> Fmt.fmt "mkdirat (exists) -> "
+  |> pp_error_opt (Os.mkdirat dir)
+  |> Fmt.fmt "\n"
+  |> Fmt.fmt "statx (dir) -> "
+  |> pp_stat (Os.statx dir)
+  |> Fmt.fmt "\n"
+  |> ignore;
+  let file = File.of_path_hlt ~flag:File.Flag.W a in
+  File.write_hlt (Bytes.Slice.of_string_slice (String.C.Slice.of_string "Hello\n")) file;
+  File.close_hlt file;
+  File.Fmt.stdout
+  |> Fmt.fmt "statx (file) -> "
+  |> pp_stat (Os.statx a)
+  |> Fmt.fmt "\n"
+  |> Fmt.fmt "renameat -> "
+  |> pp_error_opt (Os.renameat a b)
+  |> Fmt.fmt "\n"
+  |> Fmt.fmt "statx (renamed) -> "
+  |> pp_stat (Os.statx a)
+  |> Fmt.fmt " "
+  |> pp_stat (Os.statx b)
+  |> Fmt.fmt "\n"
+  |> Fmt.fmt "unlinkat ~is_dir:true (nonempty) -> "
+  |> pp_error_opt (Os.unlinkat ~is_dir:true dir)
+  |> Fmt.fmt "\n"
+  |> ignore;
+  (* Operations on independent paths may be in flight concurrently. *)
+  let paths = List.map ["./os_dir/c"; "./os_dir/d"; "./os_dir/e"] ~f:Path.of_string in
+  let mkdirats = List.map paths ~f:(fun path -> Os.Mkdirat.submit_hlt path) in
+  let complete, _ = Os.Mkdirat.wait_n_hlt 3L mkdirats in
+  List.iter complete ~f:Os.Mkdirat.complete_hlt;
+  let unlinkats = Os.Unlinkat.submit_hlt b
+    :: List.map paths ~f:(fun path -> Os.Unlinkat.submit_hlt ~is_dir:true path) in
+  List.iter unlinkats ~f:Os.Unlinkat.complete_hlt;
+  File.Fmt.stdout
+  |> Fmt.fmt "Mkdirat.wait_n -> "
+  |> Uns.pp (List.length complete)
+  |> Fmt.fmt "\n"
+  |> Fmt.fmt "unlinkat ~is_dir:true -> "
+  |> pp_error_opt (Os.unlinkat ~is_dir:true dir)
+  |> Fmt.fmt "\n"
+  |> Fmt.fmt "statx (removed) -> "
+  |> pp_stat (Os.statx dir)
+  |> Fmt.fmt "\n"
+  |> ignore
+
+let _ = test ()
@@ -79,15 +79,15 @@ let test_string () =
 let test_bytes () =
   List.iter [
     Bytes.Slice.of_string_slice (String.C.Slice.of_string "a/./../b");
-    Bytes.Slice.init [|
+    Bytes.Slice.init (Bytes.of_array [|
       U8.kv 0xffL; U8.kv 0x61L
-    |];
-    Bytes.Slice.init [|
+    |]);
+    Bytes.Slice.init (Bytes.of_array [|
       U8.kv 0xffL; U8.kv 0x61L;
       U8.kv 0x2fL;
       U8.kv 0xffL; U8.kv 0x62L
-    |];
-    Bytes.Slice.init [|
+    |]);
+    Bytes.Slice.init (Bytes.of_array [|
       U8.kv 0xffL; U8.kv 0x61L;
       U8.kv 0x2fL;
       U8.kv 0x2eL;
@@ -95,7 +95,7 @@ let test_bytes () =
       U8.kv 0x2eL; U8.kv 0x2eL;
       U8.kv 0x2fL;
       U8.kv 0xffL; U8.kv 0x62L
-    |];
+    |]);
   ] ~f:(fun path_bytes ->
     let path = of_bytes path_bytes in
     File.Fmt.stdout
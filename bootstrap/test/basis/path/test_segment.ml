@@ -48,46 +48,46 @@ let test_bytes () =
     Bytes.Slice.of_string_slice (String.C.Slice.of_string "basename.suf.ext");
     Bytes.Slice.of_string_slice (String.C.Slice.of_string ".suf");
     Bytes.Slice.of_string_slice (String.C.Slice.of_string ".suf.ext");
-    Bytes.Slice.init [|
+    Bytes.Slice.init (Bytes.of_array [|
       U8.kv 0x5fL; U8.kv 0x61L;
       U8.kv 0x2eL; U8.kv 0x5fL; U8.kv 0x62L;
       U8.kv 0x2eL; U8.kv 0x5fL; U8.kv 0x63L
-    |];
-    Bytes.Slice.init [|
+    |]);
+    Bytes.Slice.init (Bytes.of_array [|
       U8.kv 0x5fL; U8.kv 0x61L;
       U8.kv 0x2eL; U8.kv 0x5fL; U8.kv 0x62L;
       U8.kv 0x2eL; U8.kv 0xffL; U8.kv 0x63L
-    |];
-    Bytes.Slice.init [|
+    |]);
+    Bytes.Slice.init (Bytes.of_array [|
       U8.kv 0x5fL; U8.kv 0x61L;
       U8.kv 0x2eL; U8.kv 0xffL; U8.kv 0x62L;
       U8.kv 0x2eL; U8.kv 0x5fL; U8.kv 0x63L
-    |];
-    Bytes.Slice.init [|
+    |]);
+    Bytes.Slice.init (Bytes.of_array [|
       U8.kv 0x5fL; U8.kv 0x61L;
       U8.kv 0x2eL; U8.kv 0xffL; U8.kv 0x62L;
       U8.kv 0x2eL; U8.kv 0xffL; U8.kv 0x63L
-    |];
-    Bytes.Slice.init [|
+    |]);
+    Bytes.Slice.init (Bytes.of_array [|
       U8.kv 0xffL; U8.kv 0x61L;
       U8.kv 0x2eL; U8.kv 0x5fL; U8.kv 0x62L;
       U8.kv 0x2eL; U8.kv 0x5fL; U8.kv 0x63L
-    |];
-    Bytes.Slice.init [|
+    |]);
+    Bytes.Slice.init (Bytes.of_array [|
       U8.kv 0xffL; U8.kv 0x61L;
       U8.kv 0x2eL; U8.kv 0x5fL; U8.kv 0x62L;
       U8.kv 0x2eL; U8.kv 0xffL; U8.kv 0x63L
-    |];
-    Bytes.Slice.init [|
+    |]);
+    Bytes.Slice.init (Bytes.of_array [|
       U8.kv 0xffL; U8.kv 0x61L;
       U8.kv 0x2eL; U8.kv 0xffL; U8.kv 0x62L;
       U8.kv 0x2eL; U8.kv 0x5fL; U8.kv 0x63L
-    |];
-    Bytes.Slice.init [|
+    |]);
+    Bytes.Slice.init (Bytes.of_array [|
       U8.kv 0xffL; U8.kv 0x61L;
       U8.kv 0x2eL; U8.kv 0xffL; U8.kv 0x62L;
       U8.kv 0x2eL; U8.kv 0xffL; U8.kv 0x63L
-    |]
+    |])
   ] ~f:(fun path_bytes ->
     let path = of_bytes path_bytes in
     let segment = Option.value_hlt (basename path) in
@@ -11,7 +11,7 @@ let stream_of_bytes_list bl =
 
 let stream_of_byte_list bl =
   stream_of_bytes_list (List.map bl ~f:(fun b ->
-    let bytes = [|b|] in
+    let bytes = Bytes.of_array [|b|] in
     Bytes.(Slice.of_cursors ~base:(Cursor.hd bytes) ~past:(Cursor.tl bytes))
   ))
 